@@ -0,0 +1,279 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * Emulated JTAG scan chain.
+ *
+ * Implements the JTAG driver API with a bit level model of a chain of TAP controllers, so the
+ * CMSIS-DAP JTAG vendor commands and host tools can be exercised on a bare probe. Each TAP has an
+ * instruction register and IDCODE and BYPASS data registers, see rfpros_jtag_emul.yaml.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "jtag.h"
+
+#define DT_DRV_COMPAT rfpros_jtag_emul
+LOG_MODULE_REGISTER(jtag_emul, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+#define JTAG_EMUL_TAPS_MAX 8
+
+/* Arm debug port IDCODE instruction, cut to the IR length */
+#define JTAG_EMUL_IDCODE 0x0E
+
+enum tap_state {
+	TAP_RESET,
+	TAP_IDLE,
+	TAP_SELECT_DR,
+	TAP_CAPTURE_DR,
+	TAP_SHIFT_DR,
+	TAP_EXIT1_DR,
+	TAP_PAUSE_DR,
+	TAP_EXIT2_DR,
+	TAP_UPDATE_DR,
+	TAP_SELECT_IR,
+	TAP_CAPTURE_IR,
+	TAP_SHIFT_IR,
+	TAP_EXIT1_IR,
+	TAP_PAUSE_IR,
+	TAP_EXIT2_IR,
+	TAP_UPDATE_IR,
+};
+
+/* Next state for TMS low and high, IEEE 1149.1 figure 6-1 */
+static const uint8_t tap_next[][2] = {
+	[TAP_RESET] = {TAP_IDLE, TAP_RESET},
+	[TAP_IDLE] = {TAP_IDLE, TAP_SELECT_DR},
+	[TAP_SELECT_DR] = {TAP_CAPTURE_DR, TAP_SELECT_IR},
+	[TAP_CAPTURE_DR] = {TAP_SHIFT_DR, TAP_EXIT1_DR},
+	[TAP_SHIFT_DR] = {TAP_SHIFT_DR, TAP_EXIT1_DR},
+	[TAP_EXIT1_DR] = {TAP_PAUSE_DR, TAP_UPDATE_DR},
+	[TAP_PAUSE_DR] = {TAP_PAUSE_DR, TAP_EXIT2_DR},
+	[TAP_EXIT2_DR] = {TAP_SHIFT_DR, TAP_UPDATE_DR},
+	[TAP_UPDATE_DR] = {TAP_IDLE, TAP_SELECT_DR},
+	[TAP_SELECT_IR] = {TAP_CAPTURE_IR, TAP_RESET},
+	[TAP_CAPTURE_IR] = {TAP_SHIFT_IR, TAP_EXIT1_IR},
+	[TAP_SHIFT_IR] = {TAP_SHIFT_IR, TAP_EXIT1_IR},
+	[TAP_EXIT1_IR] = {TAP_PAUSE_IR, TAP_UPDATE_IR},
+	[TAP_PAUSE_IR] = {TAP_PAUSE_IR, TAP_EXIT2_IR},
+	[TAP_EXIT2_IR] = {TAP_SHIFT_IR, TAP_UPDATE_IR},
+	[TAP_UPDATE_IR] = {TAP_IDLE, TAP_SELECT_DR},
+};
+
+struct jtag_emul_config {
+	const uint32_t *ir_lengths;
+	const uint32_t *idcodes;
+	uint8_t count;
+};
+
+struct jtag_emul_tap {
+	uint32_t ir;
+	uint32_t ir_shift;
+	uint32_t dr_shift;
+	uint8_t dr_len;
+};
+
+struct jtag_emul_data {
+	struct jtag_emul_tap taps[JTAG_EMUL_TAPS_MAX];
+	enum tap_state state;
+	bool on;
+};
+
+static uint32_t ir_mask(uint32_t len)
+{
+	return len >= 32 ? UINT32_MAX : BIT(len) - 1;
+}
+
+static uint32_t idcode_instr(uint32_t len)
+{
+	return JTAG_EMUL_IDCODE & ir_mask(len);
+}
+
+static uint32_t shift_reg(uint32_t *reg, uint32_t len, uint32_t in)
+{
+	uint32_t out = *reg & 1;
+
+	*reg = (*reg >> 1) | (in << (len - 1));
+
+	return out;
+}
+
+static void tap_enter(const struct device *dev, enum tap_state state)
+{
+	const struct jtag_emul_config *config = dev->config;
+	struct jtag_emul_data *data = dev->data;
+
+	for (int i = 0; i < config->count; i++) {
+		struct jtag_emul_tap *tap = &data->taps[i];
+		uint32_t len = config->ir_lengths[i];
+
+		switch (state) {
+		case TAP_RESET:
+			tap->ir = config->idcodes[i] ? idcode_instr(len) : ir_mask(len);
+			break;
+		case TAP_UPDATE_IR:
+			tap->ir = tap->ir_shift & ir_mask(len);
+			break;
+		default:
+			break;
+		}
+	}
+
+	data->state = state;
+}
+
+static void tap_capture(const struct device *dev)
+{
+	const struct jtag_emul_config *config = dev->config;
+	struct jtag_emul_data *data = dev->data;
+
+	for (int i = 0; i < config->count; i++) {
+		struct jtag_emul_tap *tap = &data->taps[i];
+		uint32_t len = config->ir_lengths[i];
+
+		if (data->state == TAP_CAPTURE_IR) {
+			/* IEEE 1149.1 requires the two LSBs to capture 01 */
+			tap->ir_shift = 0x1;
+		} else if (config->idcodes[i] != 0 && tap->ir == idcode_instr(len)) {
+			tap->dr_shift = config->idcodes[i];
+			tap->dr_len = 32;
+		} else {
+			tap->dr_shift = 0;
+			tap->dr_len = 1;
+		}
+	}
+}
+
+static uint32_t tap_clock(const struct device *dev, uint32_t tms, uint32_t tdi)
+{
+	const struct jtag_emul_config *config = dev->config;
+	struct jtag_emul_data *data = dev->data;
+	uint32_t bit = tdi;
+
+	switch (data->state) {
+	case TAP_CAPTURE_DR:
+	case TAP_CAPTURE_IR:
+		tap_capture(dev);
+		bit = 0;
+		break;
+	case TAP_SHIFT_DR:
+		/* TDI enters the last TAP, TAP 0 drives TDO */
+		for (int i = config->count - 1; i >= 0; i--) {
+			bit = shift_reg(&data->taps[i].dr_shift, data->taps[i].dr_len, bit);
+		}
+		break;
+	case TAP_SHIFT_IR:
+		for (int i = config->count - 1; i >= 0; i--) {
+			bit = shift_reg(&data->taps[i].ir_shift, config->ir_lengths[i], bit);
+		}
+		break;
+	default:
+		bit = 0;
+		break;
+	}
+
+	tap_enter(dev, tap_next[data->state][tms]);
+
+	return bit;
+}
+
+static int jtag_emul_shift(const struct device *dev, bool tms, const uint8_t *tdi, uint8_t *tdo,
+			   uint32_t bits)
+{
+	struct jtag_emul_data *data = dev->data;
+	uint32_t in;
+	uint32_t out;
+
+	if (!data->on) {
+		return -EIO;
+	}
+
+	for (uint32_t i = 0; i < bits; i++) {
+		in = tdi != NULL ? (tdi[i / 8] >> (i % 8)) & 1 : 1;
+		out = tap_clock(dev, tms, in);
+		if (tdo != NULL) {
+			if (i % 8 == 0) {
+				tdo[i / 8] = 0;
+			}
+
+			tdo[i / 8] |= out << (i % 8);
+		}
+	}
+
+	return 0;
+}
+
+static int jtag_emul_port_on(const struct device *dev)
+{
+	struct jtag_emul_data *data = dev->data;
+
+	data->on = true;
+
+	return 0;
+}
+
+static int jtag_emul_port_off(const struct device *dev)
+{
+	struct jtag_emul_data *data = dev->data;
+
+	data->on = false;
+
+	return 0;
+}
+
+static int jtag_emul_set_clock(const struct device *dev, uint32_t clock)
+{
+	ARG_UNUSED(dev);
+
+	return clock == 0 ? -EINVAL : 0;
+}
+
+static const struct jtag_driver_api jtag_emul_api = {
+	.port_on = jtag_emul_port_on,
+	.port_off = jtag_emul_port_off,
+	.set_clock = jtag_emul_set_clock,
+	.shift = jtag_emul_shift,
+};
+
+static int jtag_emul_init(const struct device *dev)
+{
+	const struct jtag_emul_config *config = dev->config;
+
+	for (int i = 0; i < config->count; i++) {
+		if (config->ir_lengths[i] < 2 || config->ir_lengths[i] > 32) {
+			LOG_ERR("%s: TAP %d: bad IR length %u", dev->name, i,
+				config->ir_lengths[i]);
+			return -EINVAL;
+		}
+	}
+
+	tap_enter(dev, TAP_RESET);
+
+	return 0;
+}
+
+#define JTAG_EMUL_INIT(n)                                                                          \
+	BUILD_ASSERT(DT_INST_PROP_LEN(n, ir_lengths) == DT_INST_PROP_LEN(n, idcodes),              \
+		     "ir-lengths and idcodes must have one entry per TAP");                        \
+	BUILD_ASSERT(DT_INST_PROP_LEN(n, ir_lengths) <= JTAG_EMUL_TAPS_MAX, "too many TAPs");      \
+                                                                                                   \
+	static const uint32_t jtag_emul_ir_lengths_##n[] = DT_INST_PROP(n, ir_lengths);            \
+	static const uint32_t jtag_emul_idcodes_##n[] = DT_INST_PROP(n, idcodes);                  \
+                                                                                                   \
+	static const struct jtag_emul_config jtag_emul_cfg_##n = {                                 \
+		.ir_lengths = jtag_emul_ir_lengths_##n,                                            \
+		.idcodes = jtag_emul_idcodes_##n,                                                  \
+		.count = DT_INST_PROP_LEN(n, ir_lengths),                                          \
+	};                                                                                         \
+                                                                                                   \
+	static struct jtag_emul_data jtag_emul_data_##n;                                           \
+                                                                                                   \
+	DEVICE_DT_INST_DEFINE(n, jtag_emul_init, NULL, &jtag_emul_data_##n, &jtag_emul_cfg_##n,    \
+			      POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY, &jtag_emul_api);
+
+DT_INST_FOREACH_STATUS_OKAY(JTAG_EMUL_INIT)
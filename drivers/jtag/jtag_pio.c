@@ -0,0 +1,413 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * JTAG on one RP2040 PIO state machine.
+ *
+ * The state machine pulls a bit count, then shifts TDI out on the falling edge of TCK and samples
+ * TDO on the rising edge, four PIO clocks per bit (31.25 MHz TCK at 125 MHz). TMS is a plain GPIO
+ * that only changes between shifts, which is all DAP_JTAG_Sequence needs. Data moves a byte at a
+ * time through the FIFOs, fed by two DMA channels for long shifts.
+ *
+ * TCK and TMS are usually the SWCLK and SWDIO pins of the SWD port, so the pins are only taken
+ * while the JTAG port is on. They are claimed in pin_claim.h against the IO bus, ADC capture and
+ * vendor IO, and their previous state is restored when the port is turned off.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/misc/pio_rpi_pico/pio_rpi_pico.h>
+#include <zephyr/drivers/pinctrl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/pio.h>
+#include <hardware/structs/padsbank0.h>
+
+#include "jtag.h"
+#include "pin_claim.h"
+
+#define DT_DRV_COMPAT rfpros_pio_jtag
+LOG_MODULE_REGISTER(jtag_pio, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+#define JTAG_PIO_CYCLES_PER_BIT 4
+
+/* Shorter shifts are fed by the CPU, DMA setup costs more than it saves */
+#define JTAG_PIO_DMA_MIN_BYTES 16
+#define JTAG_PIO_CHUNK_BYTES   CONFIG_RFPROS_PIO_JTAG_CHUNK_SIZE
+
+/* TCK, TDI, TDO and TMS */
+#define JTAG_PIO_PINS 4
+
+/* clang-format off */
+RPI_PICO_PIO_DEFINE_PROGRAM(jtag, 0, 5,
+		/*     .wrap_target */
+	0x80a0, /*  0: pull   block           side 0     */
+	0x6020, /*  1: out    x, 32           side 0     */
+	0x6101, /*  2: out    pins, 1         side 0 [1] */
+	0x5001, /*  3: in     pins, 1         side 1     */
+	0x1042, /*  4: jmp    x--, 2          side 1     */
+	0x8020, /*  5: push   block           side 0     */
+		/*     .wrap */
+);
+/* clang-format on */
+
+struct jtag_pio_config {
+	const struct device *piodev;
+	const struct pinctrl_dev_config *pcfg;
+	const struct device *clk_dev;
+	clock_control_subsys_t clk_id;
+	struct gpio_dt_spec tms;
+	uint32_t tck_pin;
+	uint32_t tdi_pin;
+	uint32_t tdo_pin;
+	uint32_t clock;
+};
+
+struct jtag_pio_pin_state {
+	enum gpio_function function;
+	uint32_t pad;
+	bool out;
+	bool level;
+};
+
+struct jtag_pio_data {
+	size_t sm;
+	uint32_t offset;
+	int tx_dma;
+	int rx_dma;
+	bool on;
+	/* State of the pins before the port was turned on */
+	struct jtag_pio_pin_state saved[JTAG_PIO_PINS];
+	/* One spare byte for the word pushed after the last bit */
+	uint8_t rx_buf[JTAG_PIO_CHUNK_BYTES + 1];
+	uint32_t clock;
+};
+
+static const uint8_t tdi_ones = 0xFF;
+
+static int jtag_pio_set_clock(const struct device *dev, uint32_t clock)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	uint32_t clock_freq;
+	uint64_t div_q8;
+	int ret;
+
+	if (clock == 0) {
+		return -EINVAL;
+	}
+
+	ret = clock_control_get_rate(config->clk_dev, config->clk_id, &clock_freq);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* 16.8 fixed point clock divider, rounded up so TCK never exceeds the request */
+	div_q8 = DIV_ROUND_UP((uint64_t)clock_freq << 8, (uint64_t)clock * JTAG_PIO_CYCLES_PER_BIT);
+	div_q8 = MAX(div_q8, 1 << 8);
+	if (div_q8 > (0xFFFFULL << 8)) {
+		return -EINVAL;
+	}
+
+	pio_sm_set_clkdiv_int_frac(pio, data->sm, div_q8 >> 8, div_q8 & 0xFF);
+	pio_sm_clkdiv_restart(pio, data->sm);
+	data->clock = ((uint64_t)clock_freq << 8) / (div_q8 * JTAG_PIO_CYCLES_PER_BIT);
+	LOG_DBG("TCK %u Hz", data->clock);
+
+	return 0;
+}
+
+static void jtag_pio_xfer_cpu(PIO pio, size_t sm, const uint8_t *tdi, uint8_t *rx, size_t nbytes,
+			      size_t rx_bytes)
+{
+	size_t sent = 0;
+	size_t recv = 0;
+
+	/* Keep both FIFOs moving, the state machine stalls when the RX FIFO is full */
+	while (recv < rx_bytes) {
+		if (sent < nbytes && !pio_sm_is_tx_fifo_full(pio, sm)) {
+			pio_sm_put(pio, sm, tdi != NULL ? tdi[sent] : 0xFF);
+			sent++;
+		}
+
+		if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+			rx[recv++] = pio_sm_get(pio, sm) >> 24;
+		}
+	}
+}
+
+static void jtag_pio_xfer_dma(const struct device *dev, PIO pio, const uint8_t *tdi, uint8_t *rx,
+			      size_t nbytes, size_t rx_bytes)
+{
+	struct jtag_pio_data *data = dev->data;
+	dma_channel_config cfg;
+
+	cfg = dma_channel_get_default_config(data->rx_dma);
+	channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+	channel_config_set_read_increment(&cfg, false);
+	channel_config_set_write_increment(&cfg, true);
+	channel_config_set_dreq(&cfg, pio_get_dreq(pio, data->sm, false));
+	/* The in shift is to the right, the received byte is the top byte of the FIFO word */
+	dma_channel_configure(data->rx_dma, &cfg, rx, (io_rw_8 *)&pio->rxf[data->sm] + 3, rx_bytes,
+			      true);
+
+	cfg = dma_channel_get_default_config(data->tx_dma);
+	channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+	channel_config_set_read_increment(&cfg, tdi != NULL);
+	channel_config_set_write_increment(&cfg, false);
+	channel_config_set_dreq(&cfg, pio_get_dreq(pio, data->sm, true));
+	dma_channel_configure(data->tx_dma, &cfg, &pio->txf[data->sm],
+			      tdi != NULL ? tdi : &tdi_ones, nbytes, true);
+
+	/* RX completes last, once the final bit is clocked */
+	while (dma_channel_is_busy(data->rx_dma)) {
+		k_yield();
+	}
+}
+
+static int jtag_pio_shift(const struct device *dev, bool tms, const uint8_t *tdi, uint8_t *tdo,
+			  uint32_t bits)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	uint32_t n;
+	size_t nbytes;
+	size_t rx_bytes;
+
+	if (!data->on) {
+		return -EIO;
+	}
+
+	gpio_pin_set_dt(&config->tms, tms);
+
+	while (bits > 0) {
+		n = MIN(bits, JTAG_PIO_CHUNK_BYTES * 8);
+		nbytes = DIV_ROUND_UP(n, 8);
+		/* Every full byte is pushed by autopush, then the program pushes the rest */
+		rx_bytes = n / 8 + 1;
+
+		pio_sm_put(pio, data->sm, n - 1);
+		if (nbytes >= JTAG_PIO_DMA_MIN_BYTES) {
+			jtag_pio_xfer_dma(dev, pio, tdi, data->rx_buf, nbytes, rx_bytes);
+		} else {
+			jtag_pio_xfer_cpu(pio, data->sm, tdi, data->rx_buf, nbytes, rx_bytes);
+		}
+
+		if (tdo != NULL) {
+			if (n % 8) {
+				data->rx_buf[n / 8] >>= 8 - (n % 8);
+			}
+
+			memcpy(tdo, data->rx_buf, nbytes);
+			tdo += nbytes;
+		}
+
+		if (tdi != NULL) {
+			tdi += nbytes;
+		}
+
+		bits -= n;
+	}
+
+	return 0;
+}
+
+static void jtag_pio_pins(const struct jtag_pio_config *config, uint32_t pins[JTAG_PIO_PINS])
+{
+	pins[0] = config->tck_pin;
+	pins[1] = config->tdi_pin;
+	pins[2] = config->tdo_pin;
+	pins[3] = config->tms.pin;
+}
+
+static uint32_t jtag_pio_pin_mask(const struct jtag_pio_config *config)
+{
+	return BIT(config->tck_pin) | BIT(config->tdi_pin) | BIT(config->tdo_pin) |
+	       BIT(config->tms.pin);
+}
+
+static void jtag_pio_save_pins(const struct device *dev)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	uint32_t pins[JTAG_PIO_PINS];
+
+	jtag_pio_pins(config, pins);
+	for (size_t i = 0; i < JTAG_PIO_PINS; i++) {
+		data->saved[i].function = gpio_get_function(pins[i]);
+		data->saved[i].pad = pads_bank0_hw->io[pins[i]];
+		data->saved[i].out = gpio_get_dir(pins[i]);
+		data->saved[i].level = gpio_get_out_level(pins[i]);
+	}
+}
+
+static void jtag_pio_restore_pins(const struct device *dev)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	uint32_t pins[JTAG_PIO_PINS];
+
+	jtag_pio_pins(config, pins);
+	for (size_t i = 0; i < JTAG_PIO_PINS; i++) {
+		/* Level and direction first so a restored output never glitches */
+		gpio_put(pins[i], data->saved[i].level);
+		gpio_set_dir(pins[i], data->saved[i].out);
+		gpio_set_function(pins[i], data->saved[i].function);
+		pads_bank0_hw->io[pins[i]] = data->saved[i].pad;
+	}
+}
+
+static int jtag_pio_port_on(const struct device *dev)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	int ret;
+
+	if (data->on) {
+		return 0;
+	}
+
+	ret = pin_claim(jtag_pio_pin_mask(config), PIN_OWNER_JTAG);
+	if (ret < 0) {
+		return ret;
+	}
+
+	jtag_pio_save_pins(dev);
+
+	ret = gpio_pin_configure_dt(&config->tms, GPIO_OUTPUT_ACTIVE);
+	ret = ret ? ret : pinctrl_apply_state(config->pcfg, PINCTRL_STATE_DEFAULT);
+	if (ret < 0) {
+		jtag_pio_restore_pins(dev);
+		pin_release(jtag_pio_pin_mask(config), PIN_OWNER_JTAG);
+		return ret;
+	}
+
+	pio_sm_set_pins_with_mask(pio, data->sm, BIT(config->tdi_pin),
+				  BIT(config->tck_pin) | BIT(config->tdi_pin));
+	pio_sm_set_pindirs_with_mask(pio, data->sm, BIT(config->tck_pin) | BIT(config->tdi_pin),
+				     BIT(config->tck_pin) | BIT(config->tdi_pin) |
+					     BIT(config->tdo_pin));
+	pio_sm_clear_fifos(pio, data->sm);
+	pio_sm_restart(pio, data->sm);
+	pio_sm_exec(pio, data->sm, pio_encode_jmp(data->offset));
+	pio_sm_set_enabled(pio, data->sm, true);
+	data->on = true;
+
+	return 0;
+}
+
+static int jtag_pio_port_off(const struct device *dev)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	if (!data->on) {
+		return 0;
+	}
+
+	pio_sm_set_enabled(pio, data->sm, false);
+	/* Hand the pins back as they were, the SWD port reconfigures its own when turned on */
+	jtag_pio_restore_pins(dev);
+	pin_release(jtag_pio_pin_mask(config), PIN_OWNER_JTAG);
+	data->on = false;
+
+	return 0;
+}
+
+static const struct jtag_driver_api jtag_pio_api = {
+	.port_on = jtag_pio_port_on,
+	.port_off = jtag_pio_port_off,
+	.set_clock = jtag_pio_set_clock,
+	.shift = jtag_pio_shift,
+};
+
+static int jtag_pio_init(const struct device *dev)
+{
+	const struct jtag_pio_config *config = dev->config;
+	struct jtag_pio_data *data = dev->data;
+	PIO pio;
+	pio_sm_config sm_cfg;
+	int ret;
+
+	if (!device_is_ready(config->piodev) || !device_is_ready(config->clk_dev) ||
+	    !gpio_is_ready_dt(&config->tms)) {
+		return -ENODEV;
+	}
+
+	pio = pio_rpi_pico_get_pio(config->piodev);
+
+	ret = pio_rpi_pico_allocate_sm(config->piodev, &data->sm);
+	if (ret < 0) {
+		LOG_ERR("%s: no free state machine", dev->name);
+		return -EBUSY;
+	}
+
+	if (!pio_can_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(jtag))) {
+		LOG_ERR("%s: no room for the PIO program", dev->name);
+		return -EBUSY;
+	}
+
+	data->tx_dma = dma_claim_unused_channel(false);
+	data->rx_dma = dma_claim_unused_channel(false);
+	if (data->tx_dma < 0 || data->rx_dma < 0) {
+		LOG_ERR("%s: no free DMA channels", dev->name);
+		return -EBUSY;
+	}
+
+	data->offset = pio_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(jtag));
+
+	sm_cfg = pio_get_default_sm_config();
+	sm_config_set_wrap(&sm_cfg, data->offset + RPI_PICO_PIO_GET_WRAP_TARGET(jtag),
+			   data->offset + RPI_PICO_PIO_GET_WRAP(jtag));
+	sm_config_set_sideset(&sm_cfg, 1, false, false);
+	sm_config_set_sideset_pins(&sm_cfg, config->tck_pin);
+	sm_config_set_out_pins(&sm_cfg, config->tdi_pin, 1);
+	sm_config_set_in_pins(&sm_cfg, config->tdo_pin);
+	/* LSB first, a byte per FIFO word in both directions */
+	sm_config_set_out_shift(&sm_cfg, true, true, 8);
+	sm_config_set_in_shift(&sm_cfg, true, true, 8);
+	pio_sm_init(pio, data->sm, data->offset, &sm_cfg);
+
+	ret = jtag_pio_set_clock(dev, config->clock);
+	if (ret < 0) {
+		LOG_ERR("%s: unsupported clock %u", dev->name, config->clock);
+		return ret;
+	}
+
+	return 0;
+}
+
+#define JTAG_PIO_INIT(n)                                                                           \
+	PINCTRL_DT_INST_DEFINE(n);                                                                 \
+                                                                                                   \
+	static const struct jtag_pio_config jtag_pio_cfg_##n = {                                   \
+		.piodev = DEVICE_DT_GET(DT_INST_PARENT(n)),                                        \
+		.pcfg = PINCTRL_DT_INST_DEV_CONFIG_GET(n),                                         \
+		.clk_dev = DEVICE_DT_GET(DT_CLOCKS_CTLR(DT_INST_PARENT(n))),                       \
+		.clk_id = (clock_control_subsys_t)DT_PHA_BY_IDX(DT_INST_PARENT(n), clocks, 0,     \
+								  clk_id),                         \
+		.tms = GPIO_DT_SPEC_INST_GET(n, tms_gpios),                                        \
+		.tck_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(n, default, 0, tck_pins, 0),           \
+		.tdi_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(n, default, 0, tdi_pins, 0),           \
+		.tdo_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(n, default, 0, tdo_pins, 0),           \
+		.clock = DT_INST_PROP(n, clock_frequency),                                         \
+	};                                                                                         \
+                                                                                                   \
+	static struct jtag_pio_data jtag_pio_data_##n;                                             \
+                                                                                                   \
+	DEVICE_DT_INST_DEFINE(n, jtag_pio_init, NULL, &jtag_pio_data_##n, &jtag_pio_cfg_##n,       \
+			      POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY, &jtag_pio_api);
+
+DT_INST_FOREACH_STATUS_OKAY(JTAG_PIO_INIT)
@@ -0,0 +1,667 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * I2C and SPI master on the dynamic GPIO pins, see io_bus.h.
+ *
+ * SPI runs on one PIO state machine with the spi_cpha0/spi_cpha1 programs from the Pico SDK
+ * examples, four PIO clocks per bit and CPOL applied by inverting the SCK output. The pins are
+ * picked at run time, so they are set up with the SDK instead of pinctrl.
+ *
+ * I2C is bit-banged on the CPU with open-drain pins, the PIO I2C program does not fit next to the
+ * JTAG and LED programs. It runs up to about 400 kHz and waits for slaves stretching the clock.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/misc/pio_rpi_pico/pio_rpi_pico.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <hardware/gpio.h>
+#include <hardware/pio.h>
+
+#include "io_bus.h"
+#include "pin_claim.h"
+
+#define DT_DRV_COMPAT rfpros_pio_io_bus
+LOG_MODULE_REGISTER(io_bus, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+#define IO_BUS_SPI_CYCLES_PER_BIT 4
+#define IO_BUS_I2C_MAX_HZ         400000
+#define IO_BUS_STRETCH_TIMEOUT_US 10000
+
+#define GPIO_DYNAMIC_NODE DT_PATH(gpio_dynamic)
+#define GPIO_PIN_FROM_CHILD(child_node) DT_GPIO_PIN(child_node, gpios),
+
+/* clang-format off */
+RPI_PICO_PIO_DEFINE_PROGRAM(spi_cpha0, 0, 1,
+		/*     .wrap_target */
+	0x6101, /*  0: out    pins, 1         side 0 [1] */
+	0x5101, /*  1: in     pins, 1         side 1 [1] */
+		/*     .wrap */
+);
+
+RPI_PICO_PIO_DEFINE_PROGRAM(spi_cpha1, 0, 2,
+		/*     .wrap_target */
+	0x6021, /*  0: out    x, 1            side 0     */
+	0xb101, /*  1: mov    pins, x         side 1 [1] */
+	0x4001, /*  2: in     pins, 1         side 0     */
+		/*     .wrap */
+);
+/* clang-format on */
+
+struct io_bus_pio_config {
+	const struct device *piodev;
+	const struct device *clk_dev;
+	clock_control_subsys_t clk_id;
+};
+
+struct io_bus_pio_data {
+	size_t sm;
+	uint32_t cpha0_offset;
+	uint32_t cpha1_offset;
+	struct io_bus_config bus;
+	/* I2C half clock period */
+	uint32_t half_us;
+	/* I2C start sent or SPI chip select asserted */
+	bool active;
+};
+
+static const uint8_t dynamic_pins[] = {DT_FOREACH_CHILD(GPIO_DYNAMIC_NODE, GPIO_PIN_FROM_CHILD)};
+
+static const struct device *const bus_dev = DEVICE_DT_INST_GET(0);
+
+static bool pin_valid(uint8_t pin)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(dynamic_pins); i++) {
+		if (dynamic_pins[i] == pin) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint32_t pins_mask(const struct io_bus_config *bus)
+{
+	uint32_t mask = 0;
+
+	for (int i = 0; i < IO_BUS_PIN_COUNT; i++) {
+		if (bus->pins[i] != IO_BUS_PIN_NONE) {
+			mask |= BIT(bus->pins[i]);
+		}
+	}
+
+	return mask;
+}
+
+static void pins_release(struct io_bus_pio_data *data)
+{
+	for (int i = 0; i < IO_BUS_PIN_COUNT; i++) {
+		if (data->bus.pins[i] != IO_BUS_PIN_NONE) {
+			gpio_set_outover(data->bus.pins[i], GPIO_OVERRIDE_NORMAL);
+			gpio_init(data->bus.pins[i]);
+		}
+	}
+
+	pin_release(pins_mask(&data->bus), PIN_OWNER_IO_BUS);
+	for (int i = 0; i < IO_BUS_PIN_COUNT; i++) {
+		data->bus.pins[i] = IO_BUS_PIN_NONE;
+	}
+}
+
+/* I2C */
+
+static void i2c_delay(struct io_bus_pio_data *data)
+{
+	k_busy_wait(data->half_us);
+}
+
+static void i2c_low(uint8_t pin)
+{
+	gpio_set_dir(pin, GPIO_OUT);
+}
+
+static void i2c_release(uint8_t pin)
+{
+	gpio_set_dir(pin, GPIO_IN);
+}
+
+static int i2c_scl_release(struct io_bus_pio_data *data)
+{
+	uint8_t scl = data->bus.pins[IO_BUS_PIN_CLK];
+
+	i2c_release(scl);
+	for (int i = 0; !gpio_get(scl); i++) {
+		if (i >= IO_BUS_STRETCH_TIMEOUT_US) {
+			return -ETIMEDOUT;
+		}
+
+		k_busy_wait(1);
+	}
+
+	return 0;
+}
+
+static int i2c_start(struct io_bus_pio_data *data)
+{
+	uint8_t sda = data->bus.pins[IO_BUS_PIN_DATA];
+	int ret;
+
+	/* Repeated start: SDA high while SCL is low, then SCL high */
+	i2c_release(sda);
+	i2c_delay(data);
+	ret = i2c_scl_release(data);
+	if (ret) {
+		return ret;
+	}
+
+	if (!gpio_get(sda)) {
+		return -EBUSY;
+	}
+
+	i2c_delay(data);
+	i2c_low(sda);
+	i2c_delay(data);
+	i2c_low(data->bus.pins[IO_BUS_PIN_CLK]);
+	data->active = true;
+
+	return 0;
+}
+
+static int i2c_stop(struct io_bus_pio_data *data)
+{
+	uint8_t sda = data->bus.pins[IO_BUS_PIN_DATA];
+	int ret;
+
+	i2c_low(sda);
+	i2c_delay(data);
+	ret = i2c_scl_release(data);
+	i2c_delay(data);
+	i2c_release(sda);
+	i2c_delay(data);
+	data->active = false;
+
+	return ret;
+}
+
+static int i2c_bit(struct io_bus_pio_data *data, bool out, bool *in)
+{
+	uint8_t sda = data->bus.pins[IO_BUS_PIN_DATA];
+	int ret;
+
+	if (out) {
+		i2c_release(sda);
+	} else {
+		i2c_low(sda);
+	}
+
+	i2c_delay(data);
+	ret = i2c_scl_release(data);
+	if (ret) {
+		return ret;
+	}
+
+	*in = gpio_get(sda);
+	i2c_delay(data);
+	i2c_low(data->bus.pins[IO_BUS_PIN_CLK]);
+
+	return 0;
+}
+
+static int i2c_write_byte(struct io_bus_pio_data *data, uint8_t val)
+{
+	bool bit;
+	int ret = 0;
+
+	for (int i = 7; i >= 0 && ret == 0; i--) {
+		ret = i2c_bit(data, (val >> i) & 1, &bit);
+	}
+
+	/* Release SDA for the slave's acknowledge */
+	ret = ret ? ret : i2c_bit(data, true, &bit);
+	if (ret == 0 && bit) {
+		return -EIO;
+	}
+
+	return ret;
+}
+
+static int i2c_read_byte(struct io_bus_pio_data *data, uint8_t *val, bool ack)
+{
+	bool bit;
+	int ret = 0;
+
+	*val = 0;
+	for (int i = 7; i >= 0 && ret == 0; i--) {
+		ret = i2c_bit(data, true, &bit);
+		*val |= bit << i;
+	}
+
+	return ret ? ret : i2c_bit(data, !ack, &bit);
+}
+
+static int i2c_xfer(struct io_bus_pio_data *data, uint8_t addr, bool read, const uint8_t *tx,
+		    uint8_t *rx, uint16_t len)
+{
+	int ret;
+
+	ret = i2c_start(data);
+	ret = ret ? ret : i2c_write_byte(data, (addr << 1) | read);
+	if (ret == -EIO) {
+		return -ENXIO;
+	}
+
+	for (uint16_t i = 0; i < len && ret == 0; i++) {
+		if (read) {
+			/* Acknowledge all but the last byte */
+			ret = i2c_read_byte(data, &rx[i], i + 1 < len);
+		} else {
+			ret = i2c_write_byte(data, tx[i]);
+		}
+	}
+
+	return ret;
+}
+
+/* SPI */
+
+static void spi_cs(struct io_bus_pio_data *data, bool active)
+{
+	if (data->bus.pins[IO_BUS_PIN_CS] != IO_BUS_PIN_NONE) {
+		gpio_put(data->bus.pins[IO_BUS_PIN_CS], !active);
+	}
+
+	data->active = active;
+}
+
+static void spi_xfer(const struct device *dev, const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+	const struct io_bus_pio_config *config = dev->config;
+	struct io_bus_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	uint16_t sent = 0;
+	uint16_t recv = 0;
+	uint8_t in;
+
+	if (!data->active) {
+		spi_cs(data, true);
+	}
+
+	/* MSB first, the byte is shifted out of the top of the FIFO word */
+	while (recv < len) {
+		if (sent < len && !pio_sm_is_tx_fifo_full(pio, data->sm)) {
+			pio_sm_put(pio, data->sm, (uint32_t)(tx != NULL ? tx[sent] : 0xFF) << 24);
+			sent++;
+		}
+
+		if (!pio_sm_is_rx_fifo_empty(pio, data->sm)) {
+			in = pio_sm_get(pio, data->sm);
+			if (rx != NULL) {
+				rx[recv] = in;
+			}
+
+			recv++;
+		}
+	}
+}
+
+static int spi_setup(const struct device *dev, uint32_t *frequency)
+{
+	const struct io_bus_pio_config *config = dev->config;
+	struct io_bus_pio_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	const uint8_t *pins = data->bus.pins;
+	bool cpha = data->bus.spi_mode & BIT(0);
+	bool cpol = data->bus.spi_mode & BIT(1);
+	uint32_t offset = cpha ? data->cpha1_offset : data->cpha0_offset;
+	pio_sm_config sm_cfg;
+	uint32_t clock_freq;
+	uint64_t div_q8;
+	int ret;
+
+	ret = clock_control_get_rate(config->clk_dev, config->clk_id, &clock_freq);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* 16.8 fixed point clock divider, rounded up so SCK never exceeds the request */
+	div_q8 = DIV_ROUND_UP((uint64_t)clock_freq << 8,
+			      (uint64_t)data->bus.frequency * IO_BUS_SPI_CYCLES_PER_BIT);
+	div_q8 = MAX(div_q8, 1 << 8);
+	if (div_q8 > (0xFFFFULL << 8)) {
+		return -EINVAL;
+	}
+
+	pio_sm_set_enabled(pio, data->sm, false);
+	sm_cfg = pio_get_default_sm_config();
+	sm_config_set_wrap(&sm_cfg, offset,
+			   offset + (cpha ? RPI_PICO_PIO_GET_WRAP(spi_cpha1)
+					  : RPI_PICO_PIO_GET_WRAP(spi_cpha0)));
+	sm_config_set_sideset(&sm_cfg, 1, false, false);
+	sm_config_set_sideset_pins(&sm_cfg, pins[IO_BUS_PIN_CLK]);
+	sm_config_set_out_pins(&sm_cfg, pins[IO_BUS_PIN_DATA], 1);
+	sm_config_set_in_pins(&sm_cfg, pins[IO_BUS_PIN_MISO]);
+	sm_config_set_out_shift(&sm_cfg, false, true, 8);
+	sm_config_set_in_shift(&sm_cfg, false, true, 8);
+	sm_config_set_clkdiv_int_frac(&sm_cfg, div_q8 >> 8, div_q8 & 0xFF);
+
+	pio_sm_set_pins_with_mask(pio, data->sm, 0,
+				  BIT(pins[IO_BUS_PIN_CLK]) | BIT(pins[IO_BUS_PIN_DATA]));
+	pio_sm_set_pindirs_with_mask(pio, data->sm,
+				     BIT(pins[IO_BUS_PIN_CLK]) | BIT(pins[IO_BUS_PIN_DATA]),
+				     BIT(pins[IO_BUS_PIN_CLK]) | BIT(pins[IO_BUS_PIN_DATA]) |
+					     BIT(pins[IO_BUS_PIN_MISO]));
+	pio_gpio_init(pio, pins[IO_BUS_PIN_CLK]);
+	pio_gpio_init(pio, pins[IO_BUS_PIN_DATA]);
+	pio_gpio_init(pio, pins[IO_BUS_PIN_MISO]);
+	gpio_set_outover(pins[IO_BUS_PIN_CLK], cpol ? GPIO_OVERRIDE_INVERT : GPIO_OVERRIDE_NORMAL);
+
+	if (pins[IO_BUS_PIN_CS] != IO_BUS_PIN_NONE) {
+		gpio_init(pins[IO_BUS_PIN_CS]);
+		gpio_put(pins[IO_BUS_PIN_CS], 1);
+		gpio_set_dir(pins[IO_BUS_PIN_CS], GPIO_OUT);
+	}
+
+	pio_sm_init(pio, data->sm, offset, &sm_cfg);
+	pio_sm_set_enabled(pio, data->sm, true);
+
+	*frequency = ((uint64_t)clock_freq << 8) / (div_q8 * IO_BUS_SPI_CYCLES_PER_BIT);
+
+	return 0;
+}
+
+static int i2c_setup(struct io_bus_pio_data *data, uint32_t *frequency)
+{
+	for (int i = IO_BUS_PIN_CLK; i <= IO_BUS_PIN_DATA; i++) {
+		/* Open drain: the output latch stays low, the direction drives the line */
+		gpio_init(data->bus.pins[i]);
+		gpio_pull_up(data->bus.pins[i]);
+	}
+
+	data->half_us = DIV_ROUND_UP(USEC_PER_SEC / 2, MIN(data->bus.frequency, IO_BUS_I2C_MAX_HZ));
+	*frequency = USEC_PER_SEC / 2 / data->half_us;
+
+	return 0;
+}
+
+static int bus_finish(const struct device *dev)
+{
+	struct io_bus_pio_data *data = dev->data;
+
+	if (!data->active) {
+		return 0;
+	}
+
+	if (data->bus.mode == IO_BUS_I2C) {
+		return i2c_stop(data);
+	}
+
+	spi_cs(data, false);
+
+	return 0;
+}
+
+static void bus_off(const struct device *dev)
+{
+	const struct io_bus_pio_config *config = dev->config;
+	struct io_bus_pio_data *data = dev->data;
+
+	(void)bus_finish(dev);
+	if (data->bus.mode == IO_BUS_SPI) {
+		pio_sm_set_enabled(pio_rpi_pico_get_pio(config->piodev), data->sm, false);
+	}
+
+	pins_release(data);
+	data->bus.mode = IO_BUS_OFF;
+}
+
+static int bus_op(const struct device *dev, uint8_t op, uint8_t addr, const uint8_t *tx,
+		  uint8_t *rx, uint16_t len)
+{
+	struct io_bus_pio_data *data = dev->data;
+
+	if (data->bus.mode == IO_BUS_I2C) {
+		switch (op & IO_BUS_OP_TYPE_MASK) {
+		case IO_BUS_OP_WRITE:
+			return i2c_xfer(data, addr, false, tx, NULL, len);
+		case IO_BUS_OP_READ:
+			return i2c_xfer(data, addr, true, NULL, rx, len);
+		default:
+			return -EINVAL;
+		}
+	}
+
+	switch (op & IO_BUS_OP_TYPE_MASK) {
+	case IO_BUS_OP_WRITE:
+		spi_xfer(dev, tx, NULL, len);
+		return 0;
+	case IO_BUS_OP_READ:
+		spi_xfer(dev, NULL, rx, len);
+		return 0;
+	case IO_BUS_OP_TRANSFER:
+		spi_xfer(dev, tx, rx, len);
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+int io_bus_configure(const struct io_bus_config *config, uint32_t *frequency)
+{
+	struct io_bus_pio_data *data = bus_dev->data;
+	struct io_bus_config bus = *config;
+	uint32_t applied = 0;
+	int pins;
+	int ret;
+
+	switch (config->mode) {
+	case IO_BUS_OFF:
+		pins = 0;
+		break;
+	case IO_BUS_I2C:
+		pins = IO_BUS_PIN_DATA + 1;
+		break;
+	case IO_BUS_SPI:
+		pins = IO_BUS_PIN_MISO + 1;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if ((config->mode != IO_BUS_OFF && config->frequency == 0) || config->spi_mode > 3) {
+		return -EINVAL;
+	}
+
+	/* Chip select is optional, the pins a mode does not use are ignored */
+	if (config->mode == IO_BUS_SPI) {
+		pins = config->pins[IO_BUS_PIN_CS] != IO_BUS_PIN_NONE ? IO_BUS_PIN_CS + 1 : pins;
+	}
+
+	for (int i = 0; i < IO_BUS_PIN_COUNT; i++) {
+		if (i >= pins) {
+			bus.pins[i] = IO_BUS_PIN_NONE;
+			continue;
+		}
+
+		if (!pin_valid(bus.pins[i])) {
+			return -EINVAL;
+		}
+
+		for (int j = 0; j < i; j++) {
+			if (bus.pins[j] == bus.pins[i]) {
+				return -EINVAL;
+			}
+		}
+	}
+
+	bus_off(bus_dev);
+
+	/* Pins in use by the vendor IO commands, ADC capture or JTAG are not taken over */
+	ret = pin_claim(pins_mask(&bus), PIN_OWNER_IO_BUS);
+	if (ret) {
+		return ret;
+	}
+
+	data->bus = bus;
+	data->active = false;
+
+	switch (config->mode) {
+	case IO_BUS_I2C:
+		ret = i2c_setup(data, &applied);
+		break;
+	case IO_BUS_SPI:
+		ret = spi_setup(bus_dev, &applied);
+		break;
+	default:
+		ret = 0;
+		break;
+	}
+
+	if (ret) {
+		bus_off(bus_dev);
+		return ret;
+	}
+
+	LOG_DBG("mode %u, %u Hz", config->mode, applied);
+	if (frequency != NULL) {
+		*frequency = applied;
+	}
+
+	return 0;
+}
+
+int io_bus_batch(const uint8_t *ops, size_t ops_len, uint8_t count, uint8_t *rx, size_t rx_size,
+		 size_t *rx_len, uint8_t *done)
+{
+	struct io_bus_pio_data *data = bus_dev->data;
+	const uint8_t *end = ops + ops_len;
+	uint16_t len;
+	uint8_t op;
+	int ret = 0;
+
+	*rx_len = 0;
+	*done = 0;
+
+	if (data->bus.mode == IO_BUS_OFF) {
+		return -ENOTCONN;
+	}
+
+	for (uint8_t i = 0; i < count && ret == 0; i++) {
+		if (end - ops < 3) {
+			ret = -EMSGSIZE;
+			break;
+		}
+
+		op = ops[0];
+
+		if ((op & IO_BUS_OP_TYPE_MASK) == IO_BUS_OP_DELAY) {
+			len = sys_get_le16(&ops[1]);
+			ops += 3;
+			if (len < USEC_PER_MSEC) {
+				k_busy_wait(len);
+			} else {
+				k_usleep(len);
+			}
+		} else {
+			if (end - ops < 4) {
+				ret = -EMSGSIZE;
+				break;
+			}
+
+			len = sys_get_le16(&ops[2]);
+			if ((op & IO_BUS_OP_TYPE_MASK) != IO_BUS_OP_READ && end - ops < 4 + len) {
+				ret = -EMSGSIZE;
+				break;
+			}
+
+			if ((op & IO_BUS_OP_TYPE_MASK) != IO_BUS_OP_WRITE &&
+			    rx_size - *rx_len < len) {
+				ret = -EMSGSIZE;
+				break;
+			}
+
+			ret = bus_op(bus_dev, op, ops[1], &ops[4], &rx[*rx_len], len);
+			ops += 4;
+			if ((op & IO_BUS_OP_TYPE_MASK) != IO_BUS_OP_READ) {
+				ops += len;
+			}
+
+			if ((op & IO_BUS_OP_TYPE_MASK) != IO_BUS_OP_WRITE) {
+				*rx_len += len;
+			}
+		}
+
+		if (ret == 0 && (op & IO_BUS_OP_STOP)) {
+			ret = bus_finish(bus_dev);
+		}
+
+		if (ret == 0) {
+			(*done)++;
+		}
+	}
+
+	if (ret) {
+		LOG_DBG("operation %u failed: %d", *done, ret);
+		(void)bus_finish(bus_dev);
+	}
+
+	return ret;
+}
+
+static int io_bus_pio_init(const struct device *dev)
+{
+	const struct io_bus_pio_config *config = dev->config;
+	struct io_bus_pio_data *data = dev->data;
+	PIO pio;
+	int ret;
+
+	if (!device_is_ready(config->piodev) || !device_is_ready(config->clk_dev)) {
+		return -ENODEV;
+	}
+
+	pio = pio_rpi_pico_get_pio(config->piodev);
+
+	ret = pio_rpi_pico_allocate_sm(config->piodev, &data->sm);
+	if (ret < 0) {
+		LOG_ERR("%s: no free state machine", dev->name);
+		return -EBUSY;
+	}
+
+	if (!pio_can_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(spi_cpha0))) {
+		LOG_ERR("%s: no room for the PIO programs", dev->name);
+		return -EBUSY;
+	}
+
+	data->cpha0_offset = pio_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(spi_cpha0));
+	if (!pio_can_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(spi_cpha1))) {
+		LOG_ERR("%s: no room for the PIO programs", dev->name);
+		return -EBUSY;
+	}
+
+	data->cpha1_offset = pio_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(spi_cpha1));
+
+	for (int i = 0; i < IO_BUS_PIN_COUNT; i++) {
+		data->bus.pins[i] = IO_BUS_PIN_NONE;
+	}
+
+	return 0;
+}
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "one rfpros_pio_io_bus node expected");
+
+static const struct io_bus_pio_config io_bus_pio_cfg = {
+	.piodev = DEVICE_DT_GET(DT_INST_PARENT(0)),
+	.clk_dev = DEVICE_DT_GET(DT_CLOCKS_CTLR(DT_INST_PARENT(0))),
+	.clk_id = (clock_control_subsys_t)DT_PHA_BY_IDX(DT_INST_PARENT(0), clocks, 0, clk_id),
+};
+
+static struct io_bus_pio_data io_bus_pio_data;
+
+DEVICE_DT_INST_DEFINE(0, io_bus_pio_init, NULL, &io_bus_pio_data, &io_bus_pio_cfg, POST_KERNEL,
+		      CONFIG_APPLICATION_INIT_PRIORITY, NULL);
@@ -0,0 +1,758 @@
+/**
+ * @file uart_adc_capture.c
+ * @brief Streaming ADC capture on a bridgeable serial device
+ *
+ * A background thread reads blocks of round-robin samples of the enabled io-channels into a ring
+ * buffer with one ADC sequence per block. In continuous mode every block is streamed on the
+ * rfpros_adc_capture virtual UART as it completes, rounds that do not fit are dropped and counted.
+ * In triggered mode the ring keeps filling until the trigger channel crosses the level, then once
+ * the post-trigger rounds are in, the whole ring is streamed and capture stops.
+ *
+ * On the RP2040 ADC the conversions are paced by the ADC clock divider in free-running round-robin
+ * mode and two DMA channels empty the FIFO into the ring without an interrupt per sample, so every
+ * rate the divider reaches is exact up to the 500 kHz of the ADC. One channel writes the blocks,
+ * the other reloads its write address from a small table the thread keeps ahead of it. Below the
+ * divider range, and on the ADC emulator, rates the kernel timer can pace use the sequence
+ * interval and faster rates run the ADC back to back through the Zephyr ADC API. The measured rate
+ * is reported in the statistics.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "adc_capture.h"
+#include "pin_claim.h"
+#include "vuart.h"
+
+#if defined(CONFIG_APP_ADC_EMUL)
+#include <zephyr/drivers/adc/adc_emul.h>
+#endif
+
+#define DT_DRV_COMPAT rfpros_adc_capture
+
+#define CAPTURE_ADC_NODE DT_IO_CHANNELS_CTLR_BY_IDX(DT_DRV_INST(0), 0)
+#define CAPTURE_DMA      DT_NODE_HAS_COMPAT(CAPTURE_ADC_NODE, raspberrypi_pico_adc)
+
+#if CAPTURE_DMA
+#include <zephyr/drivers/clock_control.h>
+#include <hardware/adc.h>
+#include <hardware/dma.h>
+#endif
+
+LOG_MODULE_REGISTER(uart_adc_capture, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define CAPTURE_CHANNELS DT_INST_PROP_LEN(0, io_channels)
+
+/* Longest block, bounds how late a reconfiguration is seen */
+#define CAPTURE_BLOCK_MS       20
+/* Shorter sequence intervals are below the kernel timer resolution */
+#define CAPTURE_TIMED_MIN_US   (2 * USEC_PER_SEC / CONFIG_SYS_CLOCK_TICKS_PER_SEC)
+#define CAPTURE_FRAME_MAX      512
+#define CAPTURE_STREAM_WAIT_MS 1
+
+#define CAPTURE_RECONFIGURE 0
+
+/* ADC inputs 0 to 3 are GP26 to GP29 */
+#define CAPTURE_ADC_GPIO_BASE 26
+
+/* A conversion takes 96 ADC clocks, the divider is 16.8 fixed point and paces one per 1 + DIV */
+#define CAPTURE_ADC_CYCLES  96
+#define CAPTURE_ADC_DIV_MAX 0xFFFF
+/* Write addresses queued for the DMA, the thread may fall this many blocks behind */
+#define CAPTURE_DMA_TABLE   8
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "One rfpros_adc_capture node supported");
+BUILD_ASSERT(CAPTURE_CHANNELS <= ADC_CAPTURE_CHANNELS_MAX, "Too many ADC capture io-channels");
+
+struct channel_sum {
+	uint16_t min;
+	uint16_t max;
+	uint64_t sum;
+	uint32_t samples;
+};
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct device *const stream_dev = DEVICE_DT_INST_GET(0);
+
+#define CHANNEL_SPEC(node_id, prop, idx) ADC_DT_SPEC_GET_BY_IDX(node_id, idx),
+
+static const struct adc_dt_spec channels[] = {
+	DT_INST_FOREACH_PROP_ELEM(0, io_channels, CHANNEL_SPEC)};
+
+/* Pin of each channel on the RP2040 ADC, none on the emulator */
+#define CHANNEL_PIN(node_id, prop, idx)                                                            \
+	(DT_NODE_HAS_COMPAT(DT_IO_CHANNELS_CTLR_BY_IDX(node_id, idx), raspberrypi_pico_adc)        \
+		 ? BIT(CAPTURE_ADC_GPIO_BASE + DT_IO_CHANNELS_INPUT_BY_IDX(node_id, idx))          \
+		 : 0),
+
+static const uint32_t channel_pins[] = {DT_INST_FOREACH_PROP_ELEM(0, io_channels, CHANNEL_PIN)};
+
+static K_SEM_DEFINE(capture_wake, 0, 1);
+static ATOMIC_DEFINE(capture_flags, 1);
+static bool channels_ready;
+
+/* Protects the requested configuration, the statistics and the reduction */
+static struct k_spinlock capture_lock;
+static struct adc_capture_config req;
+static struct adc_capture_stats stats;
+static struct channel_sum reduction[CAPTURE_CHANNELS];
+
+/* Only used by the capture thread */
+static uint16_t ring[CONFIG_APP_ADC_CAPTURE_DEPTH];
+static uint8_t frame_buf[CAPTURE_FRAME_MAX];
+static struct adc_capture_config run;
+static uint8_t run_index[CAPTURE_CHANNELS];
+static uint8_t run_count;
+static uint8_t trigger_pos;
+static uint32_t ring_rounds;
+static uint32_t block_rounds;
+static uint32_t interval_us;
+static uint32_t head;
+static int64_t start_ms;
+static bool armed_valid;
+static uint16_t armed_prev;
+static bool use_dma;
+
+#if CAPTURE_DMA
+static const struct device *const adc_clk_dev = DEVICE_DT_GET(DT_CLOCKS_CTLR(CAPTURE_ADC_NODE));
+static uint32_t adc_clk_hz;
+static int data_dma = -1;
+static int ctrl_dma = -1;
+static uint32_t dma_head;
+static int64_t dma_start_ms;
+/* Read by the control channel, wraps on its size */
+static uint32_t dma_table[CAPTURE_DMA_TABLE] __aligned(CAPTURE_DMA_TABLE * sizeof(uint32_t));
+#endif
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static uint16_t *ring_round(uint32_t round)
+{
+	return &ring[(round % ring_rounds) * run_count];
+}
+
+static uint32_t stream_put(uint32_t first, uint32_t count)
+{
+	uint32_t frame_rounds = (sizeof(frame_buf) - ADC_CAPTURE_FRAME_HDR_SIZE) / 2 / run_count;
+	uint32_t done = 0;
+	uint32_t n;
+	uint16_t *src;
+	uint8_t *p;
+
+	while (done < count) {
+		/* A frame never wraps around the end of the ring */
+		n = MIN(count - done, frame_rounds);
+		n = MIN(n, ring_rounds - (first + done) % ring_rounds);
+		if (vuart_rx_space(stream_dev) < ADC_CAPTURE_FRAME_HDR_SIZE + n * run_count * 2) {
+			break;
+		}
+
+		p = frame_buf;
+		*p++ = ADC_CAPTURE_FRAME_MAGIC;
+		*p++ = run.channels;
+		sys_put_le16(n, p);
+		sys_put_le32(first + done, p + 2);
+		p += 6;
+
+		src = ring_round(first + done);
+		for (uint32_t i = 0; i < n * run_count; i++, p += 2) {
+			sys_put_le16(src[i], p);
+		}
+
+		(void)vuart_rx_put(stream_dev, frame_buf, p - frame_buf);
+		done += n;
+	}
+
+	return done;
+}
+
+static void reduce(const uint16_t *samples, uint32_t rounds)
+{
+	struct channel_sum block[CAPTURE_CHANNELS];
+	k_spinlock_key_t key;
+	struct channel_sum *r;
+	uint16_t v;
+
+	for (uint8_t c = 0; c < run_count; c++) {
+		block[c] = (struct channel_sum){.min = UINT16_MAX};
+	}
+
+	for (uint32_t i = 0; i < rounds; i++) {
+		for (uint8_t c = 0; c < run_count; c++) {
+			v = *samples++;
+			block[c].min = MIN(block[c].min, v);
+			block[c].max = MAX(block[c].max, v);
+			block[c].sum += v;
+		}
+	}
+
+	key = k_spin_lock(&capture_lock);
+	for (uint8_t c = 0; c < run_count; c++) {
+		r = &reduction[run_index[c]];
+		r->min = r->samples ? MIN(r->min, block[c].min) : block[c].min;
+		r->max = r->samples ? MAX(r->max, block[c].max) : block[c].max;
+		r->sum += block[c].sum;
+		r->samples += rounds;
+	}
+	k_spin_unlock(&capture_lock, key);
+}
+
+static bool find_trigger(const uint16_t *samples, uint32_t rounds, uint32_t *round)
+{
+	bool falling = run.flags & ADC_CAPTURE_FALLING;
+	uint16_t level = run.trigger_level;
+	uint16_t v;
+
+	for (uint32_t i = 0; i < rounds; i++) {
+		v = samples[i * run_count + trigger_pos];
+		if (armed_valid && ((!falling && armed_prev < level && v >= level) ||
+				    (falling && armed_prev > level && v <= level))) {
+			*round = head + i;
+			return true;
+		}
+
+		armed_prev = v;
+		armed_valid = true;
+	}
+
+	return false;
+}
+
+static void stats_update(enum adc_capture_state state, int error, uint32_t overruns)
+{
+	int64_t elapsed = k_uptime_get() - start_ms;
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	stats.state = state;
+	stats.error = error;
+	stats.rounds = head;
+	stats.overruns += overruns;
+	if (elapsed > 0) {
+		stats.rate_hz = (uint64_t)head * run_count * MSEC_PER_SEC / elapsed;
+	}
+	k_spin_unlock(&capture_lock, key);
+}
+
+static int read_block(void)
+{
+	uint16_t *dst = ring_round(head);
+	struct adc_sequence_options options = {
+		.interval_us = interval_us,
+		.extra_samplings = block_rounds - 1,
+	};
+	struct adc_sequence sequence = {
+		.options = &options,
+		.buffer = dst,
+		.buffer_size = block_rounds * run_count * sizeof(ring[0]),
+		.resolution = channels[0].resolution,
+		.oversampling = channels[0].oversampling,
+	};
+
+	for (uint8_t c = 0; c < run_count; c++) {
+		sequence.channels |= BIT(channels[run_index[c]].channel_id);
+	}
+
+	return adc_read(channels[0].dev, &sequence);
+}
+
+#if CAPTURE_DMA
+static void dma_start(void)
+{
+	uint64_t div_q8 = ((uint64_t)adc_clk_hz << 8) / run.rate_hz;
+	dma_channel_config cfg;
+	uint32_t inputs = 0;
+
+	for (uint8_t c = 0; c < run_count; c++) {
+		inputs |= BIT(channels[run_index[c]].channel_id);
+	}
+
+	for (uint8_t i = 0; i < CAPTURE_DMA_TABLE; i++) {
+		dma_table[i] = (uintptr_t)ring_round(head + (i + 1) * block_rounds);
+	}
+
+	/* Round robin continues upwards from the selected input, lowest channel first */
+	adc_run(false);
+	adc_fifo_setup(true, true, 1, false, false);
+	adc_fifo_drain();
+	adc_select_input(channels[run_index[0]].channel_id);
+	adc_set_round_robin(inputs);
+	adc_hw->div = div_q8 - BIT(8);
+
+	cfg = dma_channel_get_default_config(ctrl_dma);
+	channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+	channel_config_set_read_increment(&cfg, true);
+	channel_config_set_write_increment(&cfg, false);
+	channel_config_set_ring(&cfg, false, LOG2(sizeof(dma_table)));
+	dma_channel_configure(ctrl_dma, &cfg, &dma_hw->ch[data_dma].al2_write_addr_trig, dma_table,
+			      1, false);
+
+	cfg = dma_channel_get_default_config(data_dma);
+	channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+	channel_config_set_read_increment(&cfg, false);
+	channel_config_set_write_increment(&cfg, true);
+	channel_config_set_dreq(&cfg, DREQ_ADC);
+	channel_config_set_chain_to(&cfg, ctrl_dma);
+	dma_channel_configure(data_dma, &cfg, ring_round(head), &adc_hw->fifo,
+			      block_rounds * run_count, true);
+
+	dma_head = head;
+	dma_start_ms = k_uptime_get();
+	adc_run(true);
+}
+
+static void dma_stop(void)
+{
+	adc_run(false);
+
+	/* Unchain first, aborting a chained channel can trigger the other one (RP2040-E13) */
+	hw_write_masked(&dma_hw->ch[data_dma].al1_ctrl, data_dma << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB,
+			DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+	dma_channel_abort(data_dma);
+	dma_channel_abort(ctrl_dma);
+
+	adc_fifo_setup(false, false, 0, false, false);
+	adc_fifo_drain();
+	adc_set_round_robin(0);
+}
+
+/* Ring block the data channel is writing, the one after the last when it just completed */
+static uint32_t dma_block(void)
+{
+	uint32_t sample = (dma_hw->ch[data_dma].write_addr - (uintptr_t)ring) / sizeof(ring[0]);
+
+	return sample / (block_rounds * run_count) % (ring_rounds / block_rounds);
+}
+
+/* Waits until the DMA has filled the block at head, the thread must stay inside the table */
+static int dma_read_block(uint32_t *lost)
+{
+	uint32_t block = (head % ring_rounds) / block_rounds;
+	uint32_t blocks = ring_rounds / block_rounds;
+	uint32_t done = (head - dma_head) / block_rounds;
+	uint64_t expected;
+
+	expected = (uint64_t)(k_uptime_get() - dma_start_ms) * run.rate_hz / MSEC_PER_SEC /
+		   (block_rounds * run_count);
+	if (expected >= done + MIN(blocks, CAPTURE_DMA_TABLE) - 1) {
+		*lost = (expected - done) * block_rounds;
+		return -EOVERFLOW;
+	}
+
+	while (dma_block() == block) {
+		if (atomic_test_bit(capture_flags, CAPTURE_RECONFIGURE)) {
+			return -EAGAIN;
+		}
+
+		k_sleep(K_MSEC(1));
+	}
+
+	/* The control channel took this entry to start the next block, queue the one after */
+	dma_table[done % CAPTURE_DMA_TABLE] =
+		(uintptr_t)ring_round(head + (CAPTURE_DMA_TABLE + 1) * block_rounds);
+
+	return 0;
+}
+#endif
+
+static void capture_stop(void)
+{
+#if CAPTURE_DMA
+	if (use_dma) {
+		dma_stop();
+	}
+#endif
+	use_dma = false;
+}
+
+static int capture_read(uint32_t *lost)
+{
+#if CAPTURE_DMA
+	if (use_dma) {
+		return dma_read_block(lost);
+	}
+#endif
+	return read_block();
+}
+
+static bool stream_wait(uint32_t first, uint32_t count)
+{
+	uint32_t done = 0;
+
+	while (done < count) {
+		done += stream_put(first + done, count - done);
+		if (done < count) {
+			k_sleep(K_MSEC(CAPTURE_STREAM_WAIT_MS));
+			if (atomic_test_bit(capture_flags, CAPTURE_RECONFIGURE)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool capture_block(void)
+{
+	uint32_t trigger_round;
+	uint32_t lost = 0;
+	uint32_t first;
+	uint32_t sent;
+	int ret;
+
+	ret = capture_read(&lost);
+	if (ret == -EAGAIN) {
+		/* Reconfiguration pending */
+		return true;
+	}
+
+#if CAPTURE_DMA
+	if (ret == -EOVERFLOW) {
+		/* The ring was overwritten, skip the lost rounds and restart at a block boundary */
+		dma_stop();
+		head += lost;
+		armed_valid = false;
+		dma_start();
+		stats_update(stats.state, 0, lost);
+		return true;
+	}
+#endif
+
+	if (ret) {
+		LOG_ERR("capture stopped: %d", ret);
+		capture_stop();
+		stats_update(ADC_CAPTURE_IDLE, ret, 0);
+		return false;
+	}
+
+	reduce(ring_round(head), block_rounds);
+
+	if (!(run.flags & ADC_CAPTURE_TRIGGERED)) {
+		sent = stream_put(head, block_rounds);
+		head += block_rounds;
+		stats_update(ADC_CAPTURE_RUNNING, 0, block_rounds - sent);
+		return true;
+	}
+
+	if (stats.state == ADC_CAPTURE_ARMED &&
+	    find_trigger(ring_round(head), block_rounds, &trigger_round)) {
+		k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+		stats.state = ADC_CAPTURE_RUNNING;
+		stats.trigger_round = trigger_round;
+		k_spin_unlock(&capture_lock, key);
+		LOG_DBG("trigger at round %u", trigger_round);
+	}
+
+	head += block_rounds;
+	if (stats.state != ADC_CAPTURE_RUNNING || head < stats.trigger_round + run.post_rounds) {
+		stats_update(stats.state, 0, 0);
+		return true;
+	}
+
+	/* Ring holds the last ring_rounds rounds, the trigger is well inside them */
+	capture_stop();
+	first = head > ring_rounds ? head - ring_rounds : 0;
+	stats_update(ADC_CAPTURE_RUNNING, 0, 0);
+	if (stream_wait(first, head - first)) {
+		stats_update(ADC_CAPTURE_DONE, 0, 0);
+	}
+
+	return false;
+}
+
+static bool apply_config(void)
+{
+	k_spinlock_key_t key;
+	uint32_t round_hz;
+
+	capture_stop();
+
+	key = k_spin_lock(&capture_lock);
+	run = req;
+	if (run.flags & ADC_CAPTURE_ENABLE) {
+		memset(&stats, 0, sizeof(stats));
+		memset(reduction, 0, sizeof(reduction));
+		stats.state = (run.flags & ADC_CAPTURE_TRIGGERED) ? ADC_CAPTURE_ARMED
+								  : ADC_CAPTURE_RUNNING;
+	} else if (stats.state != ADC_CAPTURE_DONE) {
+		stats.state = ADC_CAPTURE_IDLE;
+	}
+	k_spin_unlock(&capture_lock, key);
+
+	if (!(run.flags & ADC_CAPTURE_ENABLE)) {
+		return false;
+	}
+
+	run_count = 0;
+	for (uint8_t i = 0; i < CAPTURE_CHANNELS; i++) {
+		if (run.channels & BIT(i)) {
+			if (i == run.trigger_channel) {
+				trigger_pos = run_count;
+			}
+
+			run_index[run_count++] = i;
+		}
+	}
+
+	round_hz = MAX(run.rate_hz / run_count, 1);
+	interval_us = USEC_PER_SEC / round_hz;
+	if (interval_us < CAPTURE_TIMED_MIN_US) {
+		interval_us = 0;
+	}
+
+	/* Blocks of at most CAPTURE_BLOCK_MS, a whole number of them fills the ring */
+	ring_rounds = ARRAY_SIZE(ring) / run_count;
+	block_rounds = CLAMP((uint64_t)round_hz * CAPTURE_BLOCK_MS / MSEC_PER_SEC, 1,
+			     ring_rounds / 4);
+	ring_rounds -= ring_rounds % block_rounds;
+
+	head = 0;
+	armed_valid = false;
+	start_ms = k_uptime_get();
+	vuart_reset(stream_dev);
+
+#if CAPTURE_DMA
+	/* The divider cannot pace slower rates, those stay on the timed sequences */
+	use_dma = data_dma >= 0 && ctrl_dma >= 0 &&
+		  (uint64_t)run.rate_hz * (CAPTURE_ADC_DIV_MAX + 1) >= adc_clk_hz;
+	if (use_dma) {
+		dma_start();
+	}
+#endif
+
+	LOG_INF("capturing channels 0x%02x at %u Hz, %u rounds per block, %s %u us",
+		run.channels, run.rate_hz, block_rounds, use_dma ? "DMA" : "interval",
+		interval_us);
+
+	return true;
+}
+
+static void capture_thread_fn(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	bool running = false;
+
+	while (true) {
+		if (!running) {
+			(void)k_sem_take(&capture_wake, K_FOREVER);
+		}
+
+		if (atomic_test_and_clear_bit(capture_flags, CAPTURE_RECONFIGURE)) {
+			running = apply_config();
+		}
+
+		if (running) {
+			running = capture_block();
+		}
+	}
+}
+
+K_THREAD_DEFINE(adc_capture_thread, CONFIG_APP_ADC_CAPTURE_STACK_SIZE, capture_thread_fn, NULL,
+		NULL, NULL, CONFIG_APP_ADC_CAPTURE_THREAD_PRIORITY, 0, 0);
+
+#if defined(CONFIG_APP_ADC_EMUL)
+/* Rails come up one after the other and drop together, every CONFIG_APP_ADC_EMUL_PERIOD_MS */
+static int emul_rail(const struct device *dev, unsigned int chan, void *data, uint32_t *result)
+{
+	static const uint16_t rail_mv[] = {3300, 1800, 1200, 1000};
+	uint32_t t = k_uptime_get() % CONFIG_APP_ADC_EMUL_PERIOD_MS;
+	uint32_t on = (uint32_t)(uintptr_t)data * CONFIG_APP_ADC_EMUL_PERIOD_MS / 8;
+	uint32_t off = CONFIG_APP_ADC_EMUL_PERIOD_MS * 3 / 4;
+	uint32_t ramp = CONFIG_APP_ADC_EMUL_PERIOD_MS / 32 + 1;
+	uint16_t mv = rail_mv[(uintptr_t)data % ARRAY_SIZE(rail_mv)];
+
+	ARG_UNUSED(dev);
+	ARG_UNUSED(chan);
+
+	if (t < on || t >= off) {
+		*result = 0;
+	} else {
+		*result = MIN(t - on, ramp) * mv / ramp;
+	}
+
+	return 0;
+}
+#endif
+
+static void capture_tx_ready(const struct device *dev)
+{
+	uint8_t discard[16];
+
+	/* The stream is one way, drop anything the host writes */
+	while (vuart_tx_get(dev, discard, sizeof(discard)) > 0) {
+	}
+}
+
+static const struct vuart_backend_api capture_backend_api = {
+	.tx_ready = capture_tx_ready,
+};
+
+static int capture_stream_init(const struct device *dev)
+{
+	int ret = 0;
+
+	/* One sequence samples all channels, lowest channel first */
+	for (uint8_t i = 0; i < CAPTURE_CHANNELS && ret == 0; i++) {
+		if (channels[i].dev != channels[0].dev ||
+		    channels[i].resolution != channels[0].resolution ||
+		    (i > 0 && channels[i].channel_id <= channels[i - 1].channel_id)) {
+			LOG_ERR("io-channels must be ascending channels of one ADC");
+			ret = -EINVAL;
+		} else if (!adc_is_ready_dt(&channels[i])) {
+			ret = -ENODEV;
+		} else {
+			ret = adc_channel_setup_dt(&channels[i]);
+		}
+
+#if defined(CONFIG_APP_ADC_EMUL)
+		ret = ret ? ret
+			  : adc_emul_value_func_set(channels[i].dev, channels[i].channel_id,
+						    emul_rail, (void *)(uintptr_t)i);
+#endif
+	}
+
+#if CAPTURE_DMA
+	ret = ret ? ret
+		  : clock_control_get_rate(adc_clk_dev,
+					   (clock_control_subsys_t)DT_PHA_BY_IDX(CAPTURE_ADC_NODE,
+										 clocks, 0, clk_id),
+					   &adc_clk_hz);
+	if (ret == 0 && adc_clk_hz / CAPTURE_ADC_CYCLES < CONFIG_APP_ADC_CAPTURE_RATE_MAX) {
+		LOG_ERR("ADC clock %u Hz is too slow for the maximum rate", adc_clk_hz);
+		ret = -EINVAL;
+	}
+
+	/* Without DMA channels every rate uses the Zephyr ADC API */
+	data_dma = ret ? -1 : dma_claim_unused_channel(false);
+	ctrl_dma = data_dma < 0 ? -1 : dma_claim_unused_channel(false);
+	if (ret == 0 && ctrl_dma < 0) {
+		LOG_WRN("no DMA channels, ADC capture limited to the back to back rate");
+		if (data_dma >= 0) {
+			dma_channel_unclaim(data_dma);
+			data_dma = -1;
+		}
+	}
+#endif
+
+	if (ret) {
+		LOG_ERR("ADC setup failed: %d", ret);
+	}
+
+	channels_ready = ret == 0;
+
+	/* The stream works without the ADC, it just stays empty */
+	return vuart_init(dev);
+}
+
+VUART_DT_INST_DEFINE(0, CONFIG_APP_ADC_CAPTURE_BUF_SIZE, 16, &capture_backend_api,
+		     capture_stream_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int adc_capture_configure(const struct adc_capture_config *config)
+{
+	uint8_t count = POPCOUNT(config->channels);
+	uint32_t all_pins = 0;
+	uint32_t pins = 0;
+	k_spinlock_key_t key;
+	int ret;
+
+	if (config->flags & ADC_CAPTURE_ENABLE) {
+		if (!channels_ready) {
+			return -ENODEV;
+		}
+
+		if (count == 0 || config->channels >= BIT(CAPTURE_CHANNELS) ||
+		    config->rate_hz < count || config->rate_hz > CONFIG_APP_ADC_CAPTURE_RATE_MAX) {
+			return -EINVAL;
+		}
+
+		if ((config->flags & ADC_CAPTURE_TRIGGERED) &&
+		    (!(config->channels & BIT(config->trigger_channel)) ||
+		     config->post_rounds > ARRAY_SIZE(ring) / count / 2)) {
+			return -EINVAL;
+		}
+	}
+
+	for (uint8_t i = 0; i < CAPTURE_CHANNELS; i++) {
+		all_pins |= channel_pins[i];
+		if ((config->flags & ADC_CAPTURE_ENABLE) && (config->channels & BIT(i))) {
+			pins |= channel_pins[i];
+		}
+	}
+
+	/* The pins of the enabled channels are held until capture is disabled */
+	ret = pin_claim(pins, PIN_OWNER_ADC_CAPTURE);
+	if (ret) {
+		return ret;
+	}
+
+	pin_release(all_pins & ~pins, PIN_OWNER_ADC_CAPTURE);
+
+	key = k_spin_lock(&capture_lock);
+	req = *config;
+	k_spin_unlock(&capture_lock, key);
+
+	atomic_set_bit(capture_flags, CAPTURE_RECONFIGURE);
+	k_sem_give(&capture_wake);
+
+	return 0;
+}
+
+void adc_capture_stats_get(struct adc_capture_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+	*out = stats;
+	k_spin_unlock(&capture_lock, key);
+}
+
+void adc_capture_reduction_get(struct adc_capture_reduction *out)
+{
+	struct channel_sum sums[CAPTURE_CHANNELS];
+	k_spinlock_key_t key;
+	int32_t mv[3];
+
+	key = k_spin_lock(&capture_lock);
+	memcpy(sums, reduction, sizeof(sums));
+	memset(reduction, 0, sizeof(reduction));
+	k_spin_unlock(&capture_lock, key);
+
+	memset(out, 0, ADC_CAPTURE_CHANNELS_MAX * sizeof(*out));
+	for (uint8_t i = 0; i < CAPTURE_CHANNELS; i++) {
+		if (sums[i].samples == 0) {
+			continue;
+		}
+
+		mv[0] = sums[i].min;
+		mv[1] = sums[i].max;
+		mv[2] = sums[i].sum / sums[i].samples;
+		for (uint8_t j = 0; j < ARRAY_SIZE(mv); j++) {
+			(void)adc_raw_to_millivolts_dt(&channels[i], &mv[j]);
+		}
+
+		out[i].min_mv = CLAMP(mv[0], 0, UINT16_MAX);
+		out[i].max_mv = CLAMP(mv[1], 0, UINT16_MAX);
+		out[i].mean_mv = CLAMP(mv[2], 0, UINT16_MAX);
+		out[i].samples = sums[i].samples;
+	}
+}
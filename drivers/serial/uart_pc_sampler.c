@@ -0,0 +1,372 @@
+/**
+ * @file uart_pc_sampler.c
+ * @brief Statistical PC sampling profiler streamed on a bridgeable serial device
+ *
+ * A background thread samples the target PC at the configured rate, reading DWT_PCSR while the
+ * target keeps running, or halting the core for each sample when the target has no PCSR and the
+ * host allows it. The samples are counted in an on-probe histogram and the rfpros_pc_sampler
+ * virtual UART streams a histogram frame every CONFIG_APP_PC_SAMPLER_REPORT_MS, see
+ * pc_histogram.h. Samples keep being counted while the USB side is slow, only the report rate
+ * drops.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "pc_histogram.h"
+#include "pc_sampler.h"
+#include "swd_target.h"
+#include "target_cortexm.h"
+#include "vuart.h"
+
+#define DT_DRV_COMPAT rfpros_pc_sampler
+LOG_MODULE_REGISTER(uart_pc_sampler, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define SAMPLER_HOST_IDLE_MS 2
+/* Faster rates take several samples per tick */
+#define SAMPLER_TICK_MIN_US  1000
+#define SAMPLER_FRAME_MAX    256
+#define PCSR_PROBE_READS     8
+
+#define SAMPLER_RECONFIGURE 0
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "One rfpros_pc_sampler node supported");
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct device *const stream_dev = DEVICE_DT_INST_GET(0);
+
+static K_SEM_DEFINE(sampler_wake, 0, 1);
+static K_TIMER_DEFINE(sampler_timer, NULL, NULL);
+static ATOMIC_DEFINE(sampler_flags, 1);
+
+/* Protects the requested configuration and the statistics */
+static struct k_spinlock sampler_lock;
+static uint8_t req_flags;
+static uint8_t req_shift;
+static uint32_t req_rate_hz;
+static struct pc_sampler_stats stats;
+
+/* Only used by the sampler thread */
+PC_HISTOGRAM_DEFINE(histogram, CONFIG_APP_PC_SAMPLER_BUCKETS);
+static uint32_t raw_samples[CONFIG_APP_PC_SAMPLER_RAW_DEPTH];
+static size_t raw_count;
+static uint8_t frame_buf[SAMPLER_FRAME_MAX];
+static uint8_t run_flags;
+static uint32_t per_tick;
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static int detect_mode(enum pc_sampler_mode *mode)
+{
+	uint32_t demcr;
+	uint32_t pcsr;
+	int ret;
+
+	/* The DWT is only clocked with TRCENA set */
+	ret = swd_target_mem_read32(CORTEXM_DEMCR, &demcr);
+	ret = ret ? ret : swd_target_mem_write32(CORTEXM_DEMCR, demcr | DEMCR_TRCENA);
+	if (ret) {
+		return ret;
+	}
+
+	/* Without PCSR the register reads as zero or faults */
+	for (int i = 0; i < PCSR_PROBE_READS; i++) {
+		ret = swd_target_mem_read32(CORTEXM_DWT_PCSR, &pcsr);
+		if (ret) {
+			break;
+		}
+
+		if (pcsr != 0) {
+			*mode = PC_SAMPLER_PCSR;
+			return 0;
+		}
+	}
+
+	if (!(run_flags & PC_SAMPLER_ALLOW_HALT)) {
+		return -ENOTSUP;
+	}
+
+	*mode = PC_SAMPLER_HALT;
+	/* After a fault the port needs a new batch before the first halt sample */
+	return ret ? -EAGAIN : 0;
+}
+
+static int halt_sample(uint32_t *pc)
+{
+	uint32_t dhcsr;
+	int ret;
+
+	ret = cortexm_status(&dhcsr);
+	if (ret) {
+		return ret;
+	}
+
+	/* Stopped by someone else, leave it alone */
+	if (dhcsr & DHCSR_S_HALT) {
+		*pc = PC_SAMPLE_IDLE;
+		return 0;
+	}
+
+	ret = cortexm_halt();
+	ret = ret ? ret : cortexm_reg_read(CORTEXM_REG_PC, pc);
+	if (cortexm_resume() != 0 && ret == 0) {
+		ret = -EIO;
+	}
+
+	return ret;
+}
+
+static void report(void)
+{
+	size_t used;
+	size_t len;
+
+	while (vuart_rx_space(stream_dev) >= sizeof(frame_buf)) {
+		if (run_flags & PC_SAMPLER_RAW) {
+			len = pc_raw_encode(raw_samples, raw_count, frame_buf, sizeof(frame_buf),
+					    &used);
+			raw_count -= used;
+			memmove(raw_samples, &raw_samples[used],
+				raw_count * sizeof(raw_samples[0]));
+		} else {
+			len = pc_histogram_encode(&histogram, frame_buf, sizeof(frame_buf));
+		}
+
+		if (len == 0) {
+			break;
+		}
+
+		(void)vuart_rx_put(stream_dev, frame_buf, len);
+	}
+}
+
+static void record(uint32_t pc, struct pc_sampler_stats *tick)
+{
+	uint32_t lost = histogram.lost;
+
+	tick->samples++;
+	if (pc == PC_SAMPLE_IDLE) {
+		tick->idle++;
+	}
+
+	if (!(run_flags & PC_SAMPLER_RAW)) {
+		pc_histogram_add(&histogram, pc);
+		tick->lost += histogram.lost - lost;
+	} else if (raw_count < ARRAY_SIZE(raw_samples)) {
+		raw_samples[raw_count++] = pc;
+	} else {
+		tick->lost++;
+	}
+}
+
+static void stats_add(const struct pc_sampler_stats *tick, enum pc_sampler_mode mode, int error)
+{
+	k_spinlock_key_t key = k_spin_lock(&sampler_lock);
+
+	stats.mode = mode;
+	stats.error = error;
+	stats.samples += tick->samples;
+	stats.idle += tick->idle;
+	stats.lost += tick->lost;
+	stats.skipped += tick->skipped;
+	k_spin_unlock(&sampler_lock, key);
+}
+
+static int sample_tick(enum pc_sampler_mode *mode)
+{
+	struct pc_sampler_stats tick = {0};
+	uint32_t pc;
+	int ret;
+
+	ret = swd_target_begin(SAMPLER_HOST_IDLE_MS);
+	if (ret) {
+		/* Host busy or no target, try again on the next tick */
+		tick.skipped = 1;
+		stats_add(&tick, *mode, 0);
+		return 0;
+	}
+
+	if (*mode == PC_SAMPLER_OFF) {
+		ret = detect_mode(mode);
+		LOG_DBG("mode %d: %d", *mode, ret);
+	}
+
+	for (uint32_t i = 0; i < per_tick && ret == 0; i++) {
+		if (*mode == PC_SAMPLER_PCSR) {
+			ret = swd_target_mem_read32(CORTEXM_DWT_PCSR, &pc);
+		} else {
+			ret = halt_sample(&pc);
+		}
+
+		if (ret == 0) {
+			record(pc, &tick);
+		}
+	}
+
+	swd_target_end();
+
+	if (ret == -EAGAIN) {
+		ret = 0;
+	} else if (ret == -EIO) {
+		/* Lost the target, detect the mode again once it answers */
+		*mode = PC_SAMPLER_OFF;
+		tick.skipped++;
+		ret = 0;
+	}
+
+	stats_add(&tick, *mode, ret);
+
+	return ret;
+}
+
+static bool apply_config(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&sampler_lock);
+	uint32_t rate_hz = req_rate_hz;
+	uint32_t tick_us;
+	uint8_t shift = req_shift;
+
+	run_flags = req_flags;
+	if (run_flags & PC_SAMPLER_ENABLE) {
+		memset(&stats, 0, sizeof(stats));
+	} else {
+		stats.mode = PC_SAMPLER_OFF;
+	}
+
+	k_spin_unlock(&sampler_lock, key);
+
+	k_timer_stop(&sampler_timer);
+	if (!(run_flags & PC_SAMPLER_ENABLE)) {
+		swd_target_release();
+		return false;
+	}
+
+	pc_histogram_reset(&histogram, shift);
+	raw_count = 0;
+	tick_us = MAX(USEC_PER_SEC / rate_hz, SAMPLER_TICK_MIN_US);
+	per_tick = MAX((uint64_t)rate_hz * tick_us / USEC_PER_SEC, 1);
+	k_timer_start(&sampler_timer, K_USEC(tick_us), K_USEC(tick_us));
+	LOG_INF("sampling at %u Hz, %u per %u us", rate_hz, per_tick, tick_us);
+
+	return true;
+}
+
+static void sampler_thread_fn(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	enum pc_sampler_mode mode = PC_SAMPLER_OFF;
+	int64_t next_report = 0;
+	bool running = false;
+	int ret;
+
+	while (true) {
+		if (running) {
+			(void)k_timer_status_sync(&sampler_timer);
+		} else {
+			(void)k_sem_take(&sampler_wake, K_FOREVER);
+		}
+
+		if (atomic_test_and_clear_bit(sampler_flags, SAMPLER_RECONFIGURE)) {
+			if (running) {
+				/* Send what was counted with the old settings */
+				report();
+			}
+
+			running = apply_config();
+			mode = PC_SAMPLER_OFF;
+			next_report = k_uptime_get() + CONFIG_APP_PC_SAMPLER_REPORT_MS;
+		}
+
+		if (!running) {
+			continue;
+		}
+
+		ret = sample_tick(&mode);
+		if (ret) {
+			LOG_ERR("sampling stopped: %d", ret);
+			k_timer_stop(&sampler_timer);
+			swd_target_release();
+			running = false;
+			continue;
+		}
+
+		if (k_uptime_get() >= next_report || raw_count >= ARRAY_SIZE(raw_samples) / 2) {
+			report();
+			next_report = k_uptime_get() + CONFIG_APP_PC_SAMPLER_REPORT_MS;
+		}
+	}
+}
+
+K_THREAD_DEFINE(pc_sampler_thread, CONFIG_APP_PC_SAMPLER_STACK_SIZE, sampler_thread_fn, NULL,
+		NULL, NULL, CONFIG_APP_PC_SAMPLER_THREAD_PRIORITY, 0, 0);
+
+static void sampler_tx_ready(const struct device *dev)
+{
+	uint8_t discard[16];
+
+	/* The stream is one way, drop anything the host writes */
+	while (vuart_tx_get(dev, discard, sizeof(discard)) > 0) {
+	}
+}
+
+static const struct vuart_backend_api sampler_backend_api = {
+	.tx_ready = sampler_tx_ready,
+};
+
+static int sampler_stream_init(const struct device *dev)
+{
+	return vuart_init(dev);
+}
+
+VUART_DT_INST_DEFINE(0, CONFIG_APP_PC_SAMPLER_BUF_SIZE, 16, &sampler_backend_api,
+		     sampler_stream_init, POST_KERNEL, CONFIG_SERIAL_INIT_PRIORITY);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int pc_sampler_configure(uint8_t flags, uint8_t shift, uint32_t rate_hz)
+{
+	k_spinlock_key_t key;
+
+	if ((flags & PC_SAMPLER_ENABLE) &&
+	    (rate_hz == 0 || rate_hz > CONFIG_APP_PC_SAMPLER_RATE_MAX)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&sampler_lock);
+	req_flags = flags;
+	req_shift = shift;
+	req_rate_hz = rate_hz;
+	k_spin_unlock(&sampler_lock, key);
+
+	atomic_set_bit(sampler_flags, SAMPLER_RECONFIGURE);
+	/* Wakes the thread whether it waits for the next tick or for a start */
+	k_timer_stop(&sampler_timer);
+	k_sem_give(&sampler_wake);
+
+	return 0;
+}
+
+void pc_sampler_stats_get(struct pc_sampler_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&sampler_lock);
+
+	*out = stats;
+	k_spin_unlock(&sampler_lock, key);
+}
@@ -0,0 +1,494 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * Interrupt driven UART on two RP2040 PIO state machines (one for TX, one for RX).
+ *
+ * The PIO programs are the 8N1 uart_tx/uart_rx programs from the Pico SDK examples. Each bit
+ * takes 8 PIO clocks, so the baud rate can be anything from a few hundred baud up to
+ * clk_sys / 8 with a fractional divider (15.6 Mbaud at 125 MHz).
+ *
+ * The tx program sends its stop bit with its own instruction instead of the delay of the next
+ * pull, so it only stalls once the stop bit is complete. The pull adds one PIO clock, the stop
+ * bit of back to back bytes is 1.125 bits long.
+ *
+ * The programs are loaded once per PIO block, all the instances on a block share them.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/misc/pio_rpi_pico/pio_rpi_pico.h>
+#include <zephyr/drivers/pinctrl.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/irq.h>
+#include <zephyr/logging/log.h>
+
+#include <hardware/pio.h>
+#include <hardware/regs/intctrl.h>
+
+#define DT_DRV_COMPAT rfpros_pio_uart
+LOG_MODULE_REGISTER(uart_pio, CONFIG_UART_LOG_LEVEL);
+
+#define PIO_UART_CYCLES_PER_BIT 8
+
+/* clang-format off */
+RPI_PICO_PIO_DEFINE_PROGRAM(uart_tx, 0, 4,
+		/*     .wrap_target */
+	0x98a0, /*  0: pull   block           side 1      */
+	0xf727, /*  1: set    x, 7            side 0 [7]  */
+	0x6001, /*  2: out    pins, 1                     */
+	0x0642, /*  3: jmp    x--, 2                 [6]  */
+	0xbf42, /*  4: nop                    side 1 [7]  */
+		/*     .wrap */
+);
+
+RPI_PICO_PIO_DEFINE_PROGRAM(uart_rx, 0, 8,
+		/*     .wrap_target */
+	0x2020, /*  0: wait   0 pin, 0                    */
+	0xea27, /*  1: set    x, 7                   [10] */
+	0x4001, /*  2: in     pins, 1                     */
+	0x0642, /*  3: jmp    x--, 2                 [6]  */
+	0x00c8, /*  4: jmp    pin, 8                      */
+	0xc014, /*  5: irq    nowait 4 rel                */
+	0x20a0, /*  6: wait   1 pin, 0                    */
+	0x0000, /*  7: jmp    0                           */
+	0x8020, /*  8: push   block                       */
+		/*     .wrap */
+);
+/* clang-format on */
+
+/* Offsets of the programs in each PIO block, loaded by the first instance on the block */
+struct pio_uart_programs {
+	bool loaded;
+	uint32_t tx_offset;
+	uint32_t rx_offset;
+};
+
+static struct pio_uart_programs pio_uart_programs[NUM_PIOS];
+
+struct pio_uart_config {
+	const struct device *piodev;
+	const struct pinctrl_dev_config *pcfg;
+	const struct device *clk_dev;
+	clock_control_subsys_t clk_id;
+	uint32_t tx_pin;
+	uint32_t rx_pin;
+	uint32_t baudrate;
+	uint8_t irq_index;
+	void (*irq_config_func)(void);
+};
+
+struct pio_uart_data {
+	struct uart_config uart_cfg;
+	size_t tx_sm;
+	size_t rx_sm;
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+	uart_irq_callback_user_data_t cb;
+	void *cb_data;
+	bool tx_irq_enabled;
+	bool rx_irq_enabled;
+#endif
+};
+
+static int pio_uart_set_baudrate(const struct device *dev, uint32_t baudrate)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	uint32_t clock_freq;
+	uint64_t div_q8;
+	int ret;
+
+	if (baudrate == 0) {
+		return -EINVAL;
+	}
+
+	ret = clock_control_get_rate(config->clk_dev, config->clk_id, &clock_freq);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* 16.8 fixed point clock divider */
+	div_q8 = ((uint64_t)clock_freq << 8) / ((uint64_t)baudrate * PIO_UART_CYCLES_PER_BIT);
+	if (div_q8 < (1 << 8) || div_q8 > (0xFFFFULL << 8)) {
+		return -EINVAL;
+	}
+
+	pio_sm_set_clkdiv_int_frac(pio, data->tx_sm, div_q8 >> 8, div_q8 & 0xFF);
+	pio_sm_set_clkdiv_int_frac(pio, data->rx_sm, div_q8 >> 8, div_q8 & 0xFF);
+	pio_sm_clkdiv_restart(pio, data->tx_sm);
+	pio_sm_clkdiv_restart(pio, data->rx_sm);
+
+	data->uart_cfg.baudrate = baudrate;
+
+	return 0;
+}
+
+static int pio_uart_poll_in(const struct device *dev, unsigned char *c)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	if (pio_sm_is_rx_fifo_empty(pio, data->rx_sm)) {
+		return -1;
+	}
+
+	/* The rx program shifts right, the received byte ends up in the top byte */
+	*c = (uint8_t)(pio_sm_get(pio, data->rx_sm) >> 24);
+
+	return 0;
+}
+
+static void pio_uart_poll_out(const struct device *dev, unsigned char c)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	pio_sm_put_blocking(pio, data->tx_sm, c);
+}
+
+#ifdef CONFIG_UART_USE_RUNTIME_CONFIGURE
+static int pio_uart_configure(const struct device *dev, const struct uart_config *cfg)
+{
+	struct pio_uart_data *data = dev->data;
+	int ret;
+
+	if (cfg->data_bits != UART_CFG_DATA_BITS_8 || cfg->parity != UART_CFG_PARITY_NONE ||
+	    cfg->stop_bits != UART_CFG_STOP_BITS_1) {
+		return -ENOTSUP;
+	}
+
+	ret = pio_uart_set_baudrate(dev, cfg->baudrate);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* There are no handshake lines, the requested flow control is only reported back */
+	data->uart_cfg = *cfg;
+
+	return 0;
+}
+
+static int pio_uart_config_get(const struct device *dev, struct uart_config *cfg)
+{
+	struct pio_uart_data *data = dev->data;
+
+	*cfg = data->uart_cfg;
+
+	return 0;
+}
+#endif /* CONFIG_UART_USE_RUNTIME_CONFIGURE */
+
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+static int pio_uart_fifo_fill(const struct device *dev, const uint8_t *tx_data, int len)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	int n = 0;
+
+	while (n < len && !pio_sm_is_tx_fifo_full(pio, data->tx_sm)) {
+		pio_sm_put(pio, data->tx_sm, tx_data[n++]);
+	}
+
+	if (n > 0) {
+		/* Re-armed by the tx program stalling on an empty fifo, see irq_tx_complete */
+		pio->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + data->tx_sm);
+	}
+
+	return n;
+}
+
+static int pio_uart_fifo_read(const struct device *dev, uint8_t *rx_data, const int size)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+	int n = 0;
+
+	while (n < size && !pio_sm_is_rx_fifo_empty(pio, data->rx_sm)) {
+		rx_data[n++] = (uint8_t)(pio_sm_get(pio, data->rx_sm) >> 24);
+	}
+
+	return n;
+}
+
+static void pio_uart_irq_tx_enable(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	data->tx_irq_enabled = true;
+	pio_set_irqn_source_enabled(pio, config->irq_index,
+				    pis_sm0_tx_fifo_not_full + data->tx_sm, true);
+}
+
+static void pio_uart_irq_tx_disable(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	pio_set_irqn_source_enabled(pio, config->irq_index,
+				    pis_sm0_tx_fifo_not_full + data->tx_sm, false);
+	data->tx_irq_enabled = false;
+}
+
+static int pio_uart_irq_tx_ready(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	return data->tx_irq_enabled && !pio_sm_is_tx_fifo_full(pio, data->tx_sm);
+}
+
+static int pio_uart_irq_tx_complete(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	/* The pull stalls only after the stop bit instruction of the last byte has run */
+	return pio_sm_is_tx_fifo_empty(pio, data->tx_sm) &&
+	       (pio->fdebug & (1u << (PIO_FDEBUG_TXSTALL_LSB + data->tx_sm))) != 0;
+}
+
+static void pio_uart_irq_rx_enable(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	data->rx_irq_enabled = true;
+	pio_set_irqn_source_enabled(pio, config->irq_index,
+				    pis_sm0_rx_fifo_not_empty + data->rx_sm, true);
+}
+
+static void pio_uart_irq_rx_disable(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	pio_set_irqn_source_enabled(pio, config->irq_index,
+				    pis_sm0_rx_fifo_not_empty + data->rx_sm, false);
+	data->rx_irq_enabled = false;
+}
+
+static int pio_uart_irq_rx_ready(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio = pio_rpi_pico_get_pio(config->piodev);
+
+	return data->rx_irq_enabled && !pio_sm_is_rx_fifo_empty(pio, data->rx_sm);
+}
+
+static int pio_uart_irq_is_pending(const struct device *dev)
+{
+	return pio_uart_irq_tx_ready(dev) || pio_uart_irq_rx_ready(dev);
+}
+
+static int pio_uart_irq_update(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 1;
+}
+
+static void pio_uart_irq_callback_set(const struct device *dev, uart_irq_callback_user_data_t cb,
+				      void *cb_data)
+{
+	struct pio_uart_data *data = dev->data;
+
+	data->cb = cb;
+	data->cb_data = cb_data;
+}
+
+static void pio_uart_isr(const struct device *dev)
+{
+	struct pio_uart_data *data = dev->data;
+
+	if (data->cb != NULL) {
+		data->cb(dev, data->cb_data);
+	}
+}
+#endif /* CONFIG_UART_INTERRUPT_DRIVEN */
+
+/* Instances are initialized one after the other before the kernel starts, no lock is needed */
+static int pio_uart_load_programs(PIO pio, struct pio_uart_programs **programs)
+{
+	struct pio_uart_programs *p = &pio_uart_programs[pio_get_index(pio)];
+
+	if (!p->loaded) {
+		if (!pio_can_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(uart_tx)) ||
+		    !pio_can_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(uart_rx))) {
+			return -EBUSY;
+		}
+
+		p->tx_offset = pio_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(uart_tx));
+		p->rx_offset = pio_add_program(pio, RPI_PICO_PIO_GET_PROGRAM(uart_rx));
+		p->loaded = true;
+	}
+
+	*programs = p;
+
+	return 0;
+}
+
+static int pio_uart_init(const struct device *dev)
+{
+	const struct pio_uart_config *config = dev->config;
+	struct pio_uart_data *data = dev->data;
+	PIO pio;
+	pio_sm_config sm_cfg;
+	struct pio_uart_programs *programs;
+	uint32_t tx_offset;
+	uint32_t rx_offset;
+	int ret;
+
+	if (!device_is_ready(config->piodev) || !device_is_ready(config->clk_dev)) {
+		return -ENODEV;
+	}
+
+	pio = pio_rpi_pico_get_pio(config->piodev);
+
+	ret = pio_rpi_pico_allocate_sm(config->piodev, &data->tx_sm);
+	if (ret == 0) {
+		ret = pio_rpi_pico_allocate_sm(config->piodev, &data->rx_sm);
+	}
+	if (ret < 0) {
+		LOG_ERR("%s: no free state machines", dev->name);
+		return -EBUSY;
+	}
+
+	ret = pio_uart_load_programs(pio, &programs);
+	if (ret < 0) {
+		LOG_ERR("%s: no room for the PIO programs", dev->name);
+		return ret;
+	}
+
+	tx_offset = programs->tx_offset;
+	rx_offset = programs->rx_offset;
+
+	ret = pinctrl_apply_state(config->pcfg, PINCTRL_STATE_DEFAULT);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* TX: idle high, out pin and side-set pin are both the TX pin */
+	pio_sm_set_pins_with_mask(pio, data->tx_sm, BIT(config->tx_pin), BIT(config->tx_pin));
+	pio_sm_set_pindirs_with_mask(pio, data->tx_sm, BIT(config->tx_pin), BIT(config->tx_pin));
+	sm_cfg = pio_get_default_sm_config();
+	sm_config_set_wrap(&sm_cfg, tx_offset + RPI_PICO_PIO_GET_WRAP_TARGET(uart_tx),
+			   tx_offset + RPI_PICO_PIO_GET_WRAP(uart_tx));
+	sm_config_set_sideset(&sm_cfg, 2, true, false);
+	sm_config_set_out_shift(&sm_cfg, true, false, 32);
+	sm_config_set_out_pins(&sm_cfg, config->tx_pin, 1);
+	sm_config_set_sideset_pins(&sm_cfg, config->tx_pin);
+	sm_config_set_fifo_join(&sm_cfg, PIO_FIFO_JOIN_TX);
+	pio_sm_init(pio, data->tx_sm, tx_offset, &sm_cfg);
+
+	/* RX: sample the RX pin, jump on it to check the stop bit */
+	pio_sm_set_pindirs_with_mask(pio, data->rx_sm, 0, BIT(config->rx_pin));
+	sm_cfg = pio_get_default_sm_config();
+	sm_config_set_wrap(&sm_cfg, rx_offset + RPI_PICO_PIO_GET_WRAP_TARGET(uart_rx),
+			   rx_offset + RPI_PICO_PIO_GET_WRAP(uart_rx));
+	sm_config_set_in_pins(&sm_cfg, config->rx_pin);
+	sm_config_set_jmp_pin(&sm_cfg, config->rx_pin);
+	sm_config_set_in_shift(&sm_cfg, true, false, 32);
+	sm_config_set_fifo_join(&sm_cfg, PIO_FIFO_JOIN_RX);
+	pio_sm_init(pio, data->rx_sm, rx_offset, &sm_cfg);
+
+	data->uart_cfg = (struct uart_config){
+		.baudrate = config->baudrate,
+		.parity = UART_CFG_PARITY_NONE,
+		.stop_bits = UART_CFG_STOP_BITS_1,
+		.data_bits = UART_CFG_DATA_BITS_8,
+		.flow_ctrl = UART_CFG_FLOW_CTRL_NONE,
+	};
+
+	ret = pio_uart_set_baudrate(dev, config->baudrate);
+	if (ret < 0) {
+		LOG_ERR("%s: unsupported baudrate %u", dev->name, config->baudrate);
+		return ret;
+	}
+
+	pio_sm_set_enabled(pio, data->tx_sm, true);
+	pio_sm_set_enabled(pio, data->rx_sm, true);
+
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+	config->irq_config_func();
+#endif
+
+	return 0;
+}
+
+static const struct uart_driver_api pio_uart_driver_api = {
+	.poll_in = pio_uart_poll_in,
+	.poll_out = pio_uart_poll_out,
+#ifdef CONFIG_UART_USE_RUNTIME_CONFIGURE
+	.configure = pio_uart_configure,
+	.config_get = pio_uart_config_get,
+#endif
+#ifdef CONFIG_UART_INTERRUPT_DRIVEN
+	.fifo_fill = pio_uart_fifo_fill,
+	.fifo_read = pio_uart_fifo_read,
+	.irq_tx_enable = pio_uart_irq_tx_enable,
+	.irq_tx_disable = pio_uart_irq_tx_disable,
+	.irq_tx_ready = pio_uart_irq_tx_ready,
+	.irq_tx_complete = pio_uart_irq_tx_complete,
+	.irq_rx_enable = pio_uart_irq_rx_enable,
+	.irq_rx_disable = pio_uart_irq_rx_disable,
+	.irq_rx_ready = pio_uart_irq_rx_ready,
+	.irq_is_pending = pio_uart_irq_is_pending,
+	.irq_update = pio_uart_irq_update,
+	.irq_callback_set = pio_uart_irq_callback_set,
+#endif
+};
+
+/*
+ * Each PIO block has two interrupt lines. Every instance owns one of them so the ISR does not
+ * have to look for the instance that raised it.
+ */
+#define PIO_UART_IRQ_INDEX(n) ((DT_INST_IRQN(n) - PIO0_IRQ_0) & 1)
+
+#define PIO_UART_IRQ_CONFIG(n)                                                                     \
+	static void pio_uart_irq_config_##n(void)                                                  \
+	{                                                                                          \
+		IRQ_CONNECT(DT_INST_IRQN(n), DT_INST_IRQ(n, priority), pio_uart_isr,               \
+			    DEVICE_DT_INST_GET(n), 0);                                             \
+		irq_enable(DT_INST_IRQN(n));                                                       \
+	}
+
+#define PIO_UART_INIT(n)                                                                           \
+	PINCTRL_DT_INST_DEFINE(n);                                                                 \
+	IF_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN, (PIO_UART_IRQ_CONFIG(n)))                        \
+                                                                                                   \
+	static const struct pio_uart_config pio_uart_cfg_##n = {                                   \
+		.piodev = DEVICE_DT_GET(DT_INST_PARENT(n)),                                        \
+		.pcfg = PINCTRL_DT_INST_DEV_CONFIG_GET(n),                                         \
+		.clk_dev = DEVICE_DT_GET(DT_CLOCKS_CTLR(DT_INST_PARENT(n))),                       \
+		.clk_id = (clock_control_subsys_t)DT_PHA_BY_IDX(DT_INST_PARENT(n), clocks, 0,     \
+								  clk_id),                         \
+		.tx_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(n, default, 0, tx_pins, 0),             \
+		.rx_pin = DT_INST_RPI_PICO_PIO_PIN_BY_NAME(n, default, 0, rx_pins, 0),             \
+		.baudrate = DT_INST_PROP(n, current_speed),                                        \
+		.irq_index = PIO_UART_IRQ_INDEX(n),                                                \
+		IF_ENABLED(CONFIG_UART_INTERRUPT_DRIVEN,                                           \
+			   (.irq_config_func = pio_uart_irq_config_##n,))                          \
+	};                                                                                         \
+                                                                                                   \
+	static struct pio_uart_data pio_uart_data_##n;                                             \
+                                                                                                   \
+	DEVICE_DT_INST_DEFINE(n, pio_uart_init, NULL, &pio_uart_data_##n, &pio_uart_cfg_##n,       \
+			      PRE_KERNEL_2, CONFIG_SERIAL_INIT_PRIORITY, &pio_uart_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(PIO_UART_INIT)
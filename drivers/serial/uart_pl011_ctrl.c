@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * Receive FIFO level and loopback of the RP2040 PL011 UARTs, see uart_pl011_ctrl.h.
+ *
+ * The driver writes the interrupt FIFO level select register only in its init, and the control
+ * register when it sets RTS or applies a configuration. Both are read, modified and written back
+ * with interrupts locked so that the bridge threads cannot interleave with each other or with the
+ * driver.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/irq.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/sys_io.h>
+#include <zephyr/sys/util.h>
+
+#include "uart_pl011_ctrl.h"
+
+LOG_MODULE_REGISTER(uart_pl011_ctrl, CONFIG_UART_LOG_LEVEL);
+
+#define PL011_CR            0x30
+#define PL011_CR_LBE        7
+#define PL011_IFLS          0x34
+#define PL011_IFLS_RXIFLSEL GENMASK(5, 3)
+
+struct pl011_ctrl_entry {
+	const struct device *dev;
+	mem_addr_t base;
+};
+
+#define PL011_CTRL_ENTRY(node) {DEVICE_DT_GET(node), DT_REG_ADDR(node)},
+
+/* Every enabled RP2040 UART */
+static const struct pl011_ctrl_entry pl011_ctrl[] = {
+	DT_FOREACH_STATUS_OKAY(raspberrypi_pico_uart, PL011_CTRL_ENTRY)};
+
+/* Bytes per RXIFLSEL value */
+static const uint8_t rx_levels[] = {4, 8, 16, 24, 28};
+
+static mem_addr_t pl011_ctrl_base(const struct device *dev)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(pl011_ctrl); i++) {
+		if (pl011_ctrl[i].dev == dev) {
+			return pl011_ctrl[i].base;
+		}
+	}
+
+	return 0;
+}
+
+bool uart_pl011_ctrl_supported(const struct device *dev)
+{
+	return pl011_ctrl_base(dev) != 0;
+}
+
+int uart_pl011_rx_level_set(const struct device *dev, uint8_t level)
+{
+	mem_addr_t base = pl011_ctrl_base(dev);
+	unsigned int key;
+
+	if (base == 0) {
+		return -ENOTSUP;
+	}
+
+	for (uint32_t sel = 0; sel < ARRAY_SIZE(rx_levels); sel++) {
+		if (rx_levels[sel] == level) {
+			key = irq_lock();
+			sys_write32((sys_read32(base + PL011_IFLS) & ~PL011_IFLS_RXIFLSEL) |
+					    FIELD_PREP(PL011_IFLS_RXIFLSEL, sel),
+				    base + PL011_IFLS);
+			irq_unlock(key);
+			LOG_DBG("%s: rx fifo level %u", dev->name, level);
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+int uart_pl011_loopback_set(const struct device *dev, bool enable)
+{
+	mem_addr_t base = pl011_ctrl_base(dev);
+	unsigned int key;
+
+	if (base == 0) {
+		return -ENOTSUP;
+	}
+
+	key = irq_lock();
+	if (enable) {
+		sys_set_bit(base + PL011_CR, PL011_CR_LBE);
+	} else {
+		sys_clear_bit(base + PL011_CR, PL011_CR_LBE);
+	}
+	irq_unlock(key);
+
+	return 0;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file uart_rtt.c
+ * @brief SEGGER RTT channels of the target as bridgeable serial devices
+ *
+ * Every rfpros_rtt_channel node is a virtual UART connected to one up (target to host) and one
+ * down (host to target) buffer of the RTT control block in target RAM. A background thread
+ * searches the control block and then polls the buffers over SWD with MEM-AP block transfers,
+ * sharing the port with the CMSIS-DAP host through swd_target.
+ *
+ * The poll interval adapts to the traffic: it drops to the minimum whenever data moved and
+ * doubles on every idle poll up to the maximum, so an idle target costs almost no SWD bandwidth.
+ *
+ * The thread only touches the SWD port while a host has one of the bridged ports open (DTR
+ * raised) or rtt_run() asked for it, otherwise the port stays unpowered and the pins idle.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "rtt.h"
+#include "swd_target.h"
+#include "vuart.h"
+
+#define DT_DRV_COMPAT rfpros_rtt_channel
+LOG_MODULE_REGISTER(uart_rtt, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define RTT_ID_SIZE       16
+#define RTT_CB_HDR_SIZE   (RTT_ID_SIZE + 8)
+#define RTT_MAX_BUFFERS   32
+#define RTT_CHANNEL_MAX   8
+#define RTT_XFER_CHUNK    512
+/* Consecutive search reads overlap so an ID that crosses a chunk boundary is found */
+#define RTT_SCAN_STEP     (RTT_XFER_CHUNK - RTT_ID_SIZE)
+#define RTT_HOST_IDLE_MS  2
+#define RTT_RESCAN_MS     1000
+#define RTT_CHANNEL_COUNT DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT)
+/* rtt_run_mask bit of rtt_run(), the channels use the bit of their index */
+#define RTT_RUN_REQUEST   BIT(31)
+
+BUILD_ASSERT(RTT_CHANNEL_COUNT > 0, "No rfpros_rtt_channel nodes enabled");
+BUILD_ASSERT(RTT_CHANNEL_COUNT < 31, "Too many rfpros_rtt_channel nodes for rtt_run_mask");
+
+/* SEGGER_RTT_BUFFER_UP / SEGGER_RTT_BUFFER_DOWN in target memory */
+struct rtt_desc {
+	uint32_t name;
+	uint32_t buffer;
+	uint32_t size;
+	uint32_t wr_off;
+	uint32_t rd_off;
+	uint32_t flags;
+};
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+#define RTT_CHANNEL_DEV(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const rtt_channels[] = {
+	DT_INST_FOREACH_STATUS_OKAY(RTT_CHANNEL_DEV)};
+
+static const char rtt_id[RTT_ID_SIZE] = "SEGGER RTT";
+
+static K_SEM_DEFINE(rtt_wake, 0, 1);
+static atomic_t rtt_run_mask;
+
+/* Only used by the RTT thread */
+static bool rtt_active;
+static uint32_t rtt_cb_addr;
+static uint32_t rtt_num_up;
+static uint32_t rtt_num_down;
+static uint32_t rtt_scan_addr;
+static bool rtt_scan_done;
+static uint8_t rtt_buf[RTT_XFER_CHUNK];
+static struct rtt_desc rtt_up[RTT_CHANNEL_MAX];
+static struct rtt_desc rtt_down[RTT_CHANNEL_MAX];
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static uint8_t rtt_channel_of(const struct device *dev)
+{
+	const struct vuart_config *config = dev->config;
+
+	return config->channel;
+}
+
+static void rtt_detach(void)
+{
+	if (rtt_cb_addr != 0) {
+		LOG_INF("RTT control block at 0x%08x lost", rtt_cb_addr);
+	}
+
+	rtt_cb_addr = 0;
+	rtt_scan_addr = CONFIG_APP_RTT_CB_ADDRESS ? CONFIG_APP_RTT_CB_ADDRESS
+						  : CONFIG_APP_RTT_SEARCH_START;
+	rtt_scan_done = false;
+}
+
+static int rtt_attach(uint32_t addr)
+{
+	uint32_t hdr[2];
+	int ret;
+
+	ret = swd_target_mem_read(addr + RTT_ID_SIZE, (uint8_t *)hdr, sizeof(hdr));
+	if (ret) {
+		return ret;
+	}
+
+	if (hdr[0] == 0 || hdr[0] > RTT_MAX_BUFFERS || hdr[1] > RTT_MAX_BUFFERS) {
+		LOG_DBG("0x%08x: not a control block (%u up, %u down)", addr, hdr[0], hdr[1]);
+		return 0;
+	}
+
+	rtt_cb_addr = addr;
+	rtt_num_up = hdr[0];
+	rtt_num_down = hdr[1];
+	LOG_INF("RTT control block at 0x%08x, %u up and %u down buffers", addr, rtt_num_up,
+		rtt_num_down);
+
+	return 0;
+}
+
+/* Search one chunk of the configured RAM range per batch to keep batches short */
+static int rtt_search(void)
+{
+	uint32_t end = CONFIG_APP_RTT_SEARCH_START + CONFIG_APP_RTT_SEARCH_SIZE;
+	uint32_t len;
+	int ret;
+
+	if (CONFIG_APP_RTT_CB_ADDRESS != 0) {
+		ret = swd_target_mem_read(CONFIG_APP_RTT_CB_ADDRESS, rtt_buf, RTT_ID_SIZE);
+		if (ret == 0 && memcmp(rtt_buf, rtt_id, RTT_ID_SIZE) == 0) {
+			ret = rtt_attach(CONFIG_APP_RTT_CB_ADDRESS);
+		}
+
+		rtt_scan_done = rtt_cb_addr == 0;
+		return ret;
+	}
+
+	len = MIN(RTT_XFER_CHUNK, end - rtt_scan_addr);
+	ret = swd_target_mem_read(rtt_scan_addr, rtt_buf, len);
+	if (ret) {
+		return ret;
+	}
+
+	/* The control block is word aligned */
+	for (uint32_t off = 0; off + RTT_ID_SIZE <= len; off += 4) {
+		if (memcmp(&rtt_buf[off], rtt_id, RTT_ID_SIZE) == 0) {
+			ret = rtt_attach(rtt_scan_addr + off);
+			if (ret || rtt_cb_addr != 0) {
+				return ret;
+			}
+		}
+	}
+
+	if (rtt_scan_addr + len >= end) {
+		rtt_scan_done = true;
+		rtt_scan_addr = CONFIG_APP_RTT_SEARCH_START;
+	} else {
+		rtt_scan_addr += RTT_SCAN_STEP;
+	}
+
+	return 0;
+}
+
+static bool rtt_desc_valid(const struct rtt_desc *d)
+{
+	return d->buffer != 0 && d->size != 0 && d->wr_off < d->size && d->rd_off < d->size;
+}
+
+/* Target to host */
+static int rtt_poll_up(const struct device *dev, const struct rtt_desc *d, uint32_t desc_addr,
+		       bool *moved)
+{
+	uint32_t avail;
+	uint32_t first;
+	uint32_t n;
+	int ret;
+
+	if (d->wr_off == d->rd_off) {
+		return 0;
+	}
+
+	avail = (d->wr_off + d->size - d->rd_off) % d->size;
+	n = MIN(avail, MIN(vuart_rx_space(dev), sizeof(rtt_buf)));
+	if (n == 0) {
+		return 0;
+	}
+
+	first = MIN(n, d->size - d->rd_off);
+	ret = swd_target_mem_read(d->buffer + d->rd_off, rtt_buf, first);
+	if (ret == 0 && n > first) {
+		ret = swd_target_mem_read(d->buffer, &rtt_buf[first], n - first);
+	}
+
+	if (ret == 0) {
+		ret = swd_target_mem_write32(desc_addr + offsetof(struct rtt_desc, rd_off),
+					     (d->rd_off + n) % d->size);
+	}
+
+	if (ret) {
+		return ret;
+	}
+
+	(void)vuart_rx_put(dev, rtt_buf, n);
+	*moved = true;
+
+	return 0;
+}
+
+/* Host to target */
+static int rtt_poll_down(const struct device *dev, const struct rtt_desc *d, uint32_t desc_addr,
+			 bool *moved)
+{
+	uint32_t space;
+	uint32_t first;
+	uint32_t n;
+	int ret;
+
+	space = (d->rd_off + d->size - d->wr_off - 1) % d->size;
+	n = MIN(space, MIN(vuart_tx_pending(dev), sizeof(rtt_buf)));
+	if (n == 0) {
+		return 0;
+	}
+
+	n = vuart_tx_get(dev, rtt_buf, n);
+	first = MIN(n, d->size - d->wr_off);
+	ret = swd_target_mem_write(d->buffer + d->wr_off, rtt_buf, first);
+	if (ret == 0 && n > first) {
+		ret = swd_target_mem_write(d->buffer, &rtt_buf[first], n - first);
+	}
+
+	if (ret == 0) {
+		ret = swd_target_mem_write32(desc_addr + offsetof(struct rtt_desc, wr_off),
+					     (d->wr_off + n) % d->size);
+	}
+
+	if (ret) {
+		LOG_WRN("%s: %u bytes lost", dev->name, n);
+		return ret;
+	}
+
+	*moved = true;
+
+	return 0;
+}
+
+static int rtt_poll(bool verify, bool *moved)
+{
+	uint32_t up_addr = rtt_cb_addr + RTT_CB_HDR_SIZE;
+	uint32_t down_addr = up_addr + rtt_num_up * sizeof(struct rtt_desc);
+	uint32_t num_up = MIN(rtt_num_up, RTT_CHANNEL_MAX);
+	uint32_t num_down = MIN(rtt_num_down, RTT_CHANNEL_MAX);
+	uint8_t ch;
+	int ret;
+
+	if (verify) {
+		/* The target may have been reset or reprogrammed while idle */
+		ret = swd_target_mem_read(rtt_cb_addr, rtt_buf, RTT_ID_SIZE);
+		if (ret || memcmp(rtt_buf, rtt_id, RTT_ID_SIZE) != 0) {
+			return -ENOENT;
+		}
+	}
+
+	/* One block read for each descriptor array */
+	ret = swd_target_mem_read(up_addr, (uint8_t *)rtt_up, num_up * sizeof(struct rtt_desc));
+	if (ret == 0 && num_down > 0) {
+		ret = swd_target_mem_read(down_addr, (uint8_t *)rtt_down,
+					  num_down * sizeof(struct rtt_desc));
+	}
+
+	if (ret) {
+		return ret;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(rtt_channels) && ret == 0; i++) {
+		ch = rtt_channel_of(rtt_channels[i]);
+		if (ch < num_up && rtt_desc_valid(&rtt_up[ch])) {
+			ret = rtt_poll_up(rtt_channels[i], &rtt_up[ch],
+					  up_addr + ch * sizeof(struct rtt_desc), moved);
+		}
+
+		if (ret == 0 && ch < num_down && rtt_desc_valid(&rtt_down[ch])) {
+			ret = rtt_poll_down(rtt_channels[i], &rtt_down[ch],
+					    down_addr + ch * sizeof(struct rtt_desc), moved);
+		}
+	}
+
+	return ret;
+}
+
+static void rtt_thread_fn(void *p1, void *p2, void *p3)
+{
+	uint32_t interval_ms = CONFIG_APP_RTT_POLL_MIN_MS;
+	bool moved;
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	rtt_detach();
+
+	while (true) {
+		if (atomic_get(&rtt_run_mask) == 0) {
+			if (rtt_active) {
+				LOG_INF("RTT stopped");
+				rtt_detach();
+				swd_target_release();
+				rtt_active = false;
+			}
+
+			(void)k_sem_take(&rtt_wake, K_FOREVER);
+			interval_ms = CONFIG_APP_RTT_POLL_MIN_MS;
+			continue;
+		}
+
+		rtt_active = true;
+		(void)k_sem_take(&rtt_wake, K_MSEC(interval_ms));
+
+		ret = swd_target_begin(RTT_HOST_IDLE_MS);
+		if (ret == -EBUSY) {
+			continue;
+		} else if (ret) {
+			/* No target on the port */
+			rtt_detach();
+			swd_target_release();
+			interval_ms = RTT_RESCAN_MS;
+			continue;
+		}
+
+		moved = false;
+		if (rtt_cb_addr == 0) {
+			ret = rtt_search();
+		} else {
+			ret = rtt_poll(interval_ms >= CONFIG_APP_RTT_POLL_MAX_MS, &moved);
+		}
+
+		swd_target_end();
+
+		if (ret) {
+			LOG_DBG("poll failed: %d", ret);
+			rtt_detach();
+		}
+
+		if (rtt_cb_addr == 0) {
+			if (rtt_scan_done) {
+				/* Nothing found, leave the port to the host until the next pass */
+				swd_target_release();
+				rtt_scan_done = false;
+				interval_ms = RTT_RESCAN_MS;
+			} else {
+				interval_ms = CONFIG_APP_RTT_POLL_MIN_MS;
+			}
+		} else if (moved) {
+			interval_ms = CONFIG_APP_RTT_POLL_MIN_MS;
+		} else {
+			interval_ms = MIN(interval_ms * 2, CONFIG_APP_RTT_POLL_MAX_MS);
+		}
+	}
+}
+
+K_THREAD_DEFINE(rtt_thread, CONFIG_APP_RTT_STACK_SIZE, rtt_thread_fn, NULL, NULL, NULL,
+		CONFIG_APP_RTT_THREAD_PRIORITY, 0, 0);
+
+static void rtt_tx_ready(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_sem_give(&rtt_wake);
+}
+
+static void rtt_rx_consumed(const struct device *dev, size_t len)
+{
+	/* The ring was full, the target may be blocked on a full up buffer */
+	if (vuart_rx_space(dev) == len) {
+		k_sem_give(&rtt_wake);
+	}
+}
+
+static void rtt_host_attach(const struct device *dev, bool attached)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(rtt_channels); i++) {
+		if (rtt_channels[i] != dev) {
+			continue;
+		}
+
+		if (attached) {
+			(void)atomic_or(&rtt_run_mask, BIT(i));
+		} else {
+			(void)atomic_and(&rtt_run_mask, ~BIT(i));
+		}
+	}
+
+	k_sem_give(&rtt_wake);
+}
+
+static const struct vuart_backend_api rtt_backend_api = {
+	.tx_ready = rtt_tx_ready,
+	.rx_consumed = rtt_rx_consumed,
+	.host_attach = rtt_host_attach,
+};
+
+static int rtt_channel_init(const struct device *dev)
+{
+	return vuart_init(dev);
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void rtt_run(bool run)
+{
+	if (run) {
+		(void)atomic_or(&rtt_run_mask, RTT_RUN_REQUEST);
+	} else {
+		(void)atomic_and(&rtt_run_mask, ~RTT_RUN_REQUEST);
+	}
+
+	k_sem_give(&rtt_wake);
+}
+
+void rtt_status_get(struct rtt_status *status)
+{
+	status->running = atomic_get(&rtt_run_mask) != 0;
+	status->requested = (atomic_get(&rtt_run_mask) & RTT_RUN_REQUEST) != 0;
+	status->cb_addr = rtt_cb_addr;
+}
+
+#define RTT_CHANNEL_DEFINE(n)                                                                      \
+	BUILD_ASSERT(DT_INST_PROP(n, channel) < RTT_CHANNEL_MAX, "RTT channel out of range");      \
+	VUART_DT_INST_DEFINE(n, CONFIG_APP_RTT_BUF_SIZE, CONFIG_APP_RTT_BUF_SIZE,                  \
+			     &rtt_backend_api, rtt_channel_init, POST_KERNEL,                      \
+			     CONFIG_SERIAL_INIT_PRIORITY)
+
+DT_INST_FOREACH_STATUS_OKAY(RTT_CHANNEL_DEFINE)
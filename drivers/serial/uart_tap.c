@@ -0,0 +1,134 @@
+/**
+ * @file uart_tap.c
+ * @brief Timestamped traffic tap of the uart bridges streamed on a bridgeable serial device
+ *
+ * The bridges call uart_tap_put() from their receive isr with the data still in their own ring
+ * buffer. The data is framed and copied once, straight into the rx ring of the rfpros_uart_tap
+ * virtual UART, see uart_tap.h. A frame that does not fit is dropped whole so the host never
+ * sees a partial frame.
+ *
+ * The copy is deliberate. Referencing the data in the bridge rings instead would keep it there
+ * until the host read the tap, so a slow tap reader would fill the rings and pause the bridged
+ * ports, and the tap must never hold up the bridged data. The stream also interleaves the
+ * bursts of several bridges and both directions, each behind its own header, so it is not a
+ * view of any one ring and would need the copy at read time instead.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#if !defined(CONFIG_ARCH_POSIX)
+#include <hardware/structs/timer.h>
+#endif
+#include "uart_tap.h"
+#include "vuart.h"
+
+#define DT_DRV_COMPAT rfpros_uart_tap
+LOG_MODULE_REGISTER(uart_tap, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define TAP_DROP_SIZE sizeof(uint32_t)
+
+BUILD_ASSERT(DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT) == 1, "One rfpros_uart_tap node supported");
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+/* Keeps the frames of concurrent bridge isrs whole and in timestamp order */
+static struct k_spinlock tap_lock;
+/* Data bytes lost since the last frame that made it into the stream */
+static uint32_t tap_dropped;
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static uint32_t tap_time_us(void)
+{
+#if defined(CONFIG_ARCH_POSIX)
+	/* native_sim tests */
+	return k_cyc_to_us_floor32(k_cycle_get_32());
+#else
+	/* Free running 1 MHz system timer, no conversion needed in the isr */
+	return timer_hw->timerawl;
+#endif
+}
+
+static void tap_header_put(const struct device *tap, uint8_t source, uint16_t len, uint32_t us)
+{
+	uint8_t hdr[UART_TAP_FRAME_HDR_SIZE];
+
+	hdr[0] = UART_TAP_FRAME_MAGIC;
+	hdr[1] = source;
+	sys_put_le16(len, &hdr[2]);
+	sys_put_le32(us, &hdr[4]);
+	(void)vuart_rx_put(tap, hdr, sizeof(hdr));
+}
+
+static void tap_tx_ready(const struct device *dev)
+{
+	uint8_t discard[16];
+
+	/* The stream is one way, drop anything the host writes */
+	while (vuart_tx_get(dev, discard, sizeof(discard)) > 0) {
+	}
+}
+
+static const struct vuart_backend_api tap_backend_api = {
+	.tx_ready = tap_tx_ready,
+};
+
+static int tap_stream_init(const struct device *dev)
+{
+	return vuart_init(dev);
+}
+
+VUART_DT_INST_DEFINE(0, CONFIG_APP_UART_TAP_BUF_SIZE, 16, &tap_backend_api, tap_stream_init,
+		     POST_KERNEL, CONFIG_SERIAL_INIT_PRIORITY);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void uart_tap_put(const struct device *tap, uint8_t source, const uint8_t *data, size_t len)
+{
+	uint32_t us = tap_time_us();
+	uint8_t drop[TAP_DROP_SIZE];
+	k_spinlock_key_t key;
+	size_t need;
+
+	if (len == 0 || len > UINT16_MAX) {
+		return;
+	}
+
+	key = k_spin_lock(&tap_lock);
+	need = UART_TAP_FRAME_HDR_SIZE + len;
+	if (tap_dropped != 0) {
+		need += UART_TAP_FRAME_HDR_SIZE + TAP_DROP_SIZE;
+	}
+
+	if (vuart_rx_space(tap) < need) {
+		tap_dropped += len;
+		k_spin_unlock(&tap_lock, key);
+		return;
+	}
+
+	if (tap_dropped != 0) {
+		sys_put_le32(tap_dropped, drop);
+		tap_header_put(tap, UART_TAP_SRC_DROP, sizeof(drop), us);
+		(void)vuart_rx_put(tap, drop, sizeof(drop));
+		tap_dropped = 0;
+	}
+
+	tap_header_put(tap, source, len, us);
+	(void)vuart_rx_put(tap, data, len);
+	k_spin_unlock(&tap_lock, key);
+}
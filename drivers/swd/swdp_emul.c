@@ -0,0 +1,433 @@
+/*
+ * Copyright 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/*
+ * Emulated SWD debug port.
+ *
+ * Implements the SWDP driver API with a transfer level model of an ADIv5 SW-DP and one AHB-AP
+ * in front of a RAM array, so swd_target and the engines built on it can be exercised without a
+ * target, for example in the native_sim tests. AP reads are posted and TAR auto-increments
+ * within 1 KiB blocks as on real hardware. An access outside the RAM sets STICKYERR, after which
+ * AP accesses are answered with FAULT until ABORT clears it.
+ *
+ * The core is modelled just enough for the PC sampler: DEMCR is stored and DWT_PCSR returns
+ * synthetic PCs spread over the configured code regions once TRCENA is set. See
+ * rfpros_swdp_emul.yaml.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/swdp.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#include "swd_target.h"
+#include "target_cortexm.h"
+
+#define DT_DRV_COMPAT rfpros_swdp_emul
+LOG_MODULE_REGISTER(swdp_emul, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+#define ABORT_STKERRCLR     BIT(2)
+#define CTRL_STAT_STICKYERR BIT(5)
+/* CSYSPWRUPREQ and CDBGPWRUPREQ, acknowledged one bit higher */
+#define CTRL_STAT_PWRUPREQ  (BIT(30) | BIT(28))
+
+#define SELECT_APSEL_SHIFT 24
+#define SELECT_APBANK_MASK 0xF0
+#define SELECT_DPBANK_MASK 0x0F
+
+#define AP_IDR     0xFC
+/* AHB-AP of a Cortex-M0+ */
+#define AP_IDR_AHB 0x04770031
+
+#define CSW_SIZE_MASK      0x07
+#define CSW_ADDRINC_MASK   0x30
+#define CSW_ADDRINC_SINGLE 0x10
+/* DbgStatus, always set */
+#define CSW_DBGSTATUS      BIT(6)
+
+#define TAR_AUTOINC_MASK 0x3FF
+
+/* What a floating SWDIO reads as when nothing answers */
+#define ACK_NONE 0x07
+
+/* Address, size and weight of each pcsr-regions entry */
+#define PCSR_REGION_CELLS 3
+#define PRNG_SEED         0x2545F491
+
+struct swdp_emul_config {
+	uint8_t *ram;
+	uint32_t ram_base;
+	uint32_t ram_size;
+	uint32_t idcode;
+	uint32_t cpuid;
+	const uint32_t *pcsr_regions;
+	size_t pcsr_len;
+};
+
+struct swdp_emul_data {
+	uint32_t ctrl_stat;
+	uint32_t select;
+	uint32_t csw;
+	uint32_t tar;
+	uint32_t rdbuff;
+	uint32_t demcr;
+	uint32_t pcsr_weight;
+	uint32_t prng;
+	uint8_t pins;
+	bool on;
+};
+
+static bool mem_in_ram(const struct swdp_emul_config *config, uint32_t addr, uint32_t size)
+{
+	return addr >= config->ram_base && addr - config->ram_base + size <= config->ram_size;
+}
+
+/* Pick a region by weight, then a halfword in it, with a xorshift32 generator */
+static uint32_t pcsr_sample(const struct device *dev)
+{
+	const struct swdp_emul_config *config = dev->config;
+	struct swdp_emul_data *data = dev->data;
+	const uint32_t *region = config->pcsr_regions;
+	uint32_t pick;
+
+	if (!(data->demcr & DEMCR_TRCENA) || data->pcsr_weight == 0) {
+		/* Not clocked, or a core without PCSR */
+		return 0;
+	}
+
+	data->prng ^= data->prng << 13;
+	data->prng ^= data->prng >> 17;
+	data->prng ^= data->prng << 5;
+	pick = data->prng % data->pcsr_weight;
+	for (size_t i = 0; i < config->pcsr_len; i += PCSR_REGION_CELLS) {
+		if (pick < region[i + 2]) {
+			return region[i] + ((data->prng >> 8) % MAX(region[i + 1] / 2, 1)) * 2;
+		}
+
+		pick -= region[i + 2];
+	}
+
+	return 0;
+}
+
+static int mem_read(const struct device *dev, uint32_t addr, uint32_t *val)
+{
+	const struct swdp_emul_config *config = dev->config;
+	struct swdp_emul_data *data = dev->data;
+
+	if (mem_in_ram(config, addr & ~3, 4)) {
+		*val = sys_get_le32(&config->ram[(addr & ~3) - config->ram_base]);
+		return 0;
+	}
+
+	switch (addr & ~3) {
+	case CORTEXM_CPUID:
+		*val = config->cpuid;
+		return 0;
+	case CORTEXM_DHCSR:
+		/* Running, no debugger attached to the core */
+		*val = 0;
+		return 0;
+	case CORTEXM_DEMCR:
+		*val = data->demcr;
+		return 0;
+	case CORTEXM_DWT_PCSR:
+		*val = pcsr_sample(dev);
+		return 0;
+	default:
+		return -EFAULT;
+	}
+}
+
+/* val holds the data on its byte lanes, as on the AHB */
+static int mem_write(const struct device *dev, uint32_t addr, uint32_t val, uint32_t size)
+{
+	const struct swdp_emul_config *config = dev->config;
+	struct swdp_emul_data *data = dev->data;
+	uint32_t lane;
+
+	addr &= ~(size - 1);
+	lane = addr & 3;
+	if (addr == CORTEXM_DEMCR && size == 4) {
+		data->demcr = val;
+		return 0;
+	}
+
+	if (!mem_in_ram(config, addr, size)) {
+		return -EFAULT;
+	}
+
+	for (uint32_t i = 0; i < size; i++) {
+		config->ram[addr - config->ram_base + i] = val >> ((lane + i) * 8);
+	}
+
+	return 0;
+}
+
+static void tar_increment(struct swdp_emul_data *data, uint32_t size)
+{
+	if ((data->csw & CSW_ADDRINC_MASK) == CSW_ADDRINC_SINGLE) {
+		data->tar = (data->tar & ~TAR_AUTOINC_MASK) |
+			    ((data->tar + size) & TAR_AUTOINC_MASK);
+	}
+}
+
+static uint8_t ap_access(const struct device *dev, uint8_t addr, bool read, uint32_t *val)
+{
+	struct swdp_emul_data *data = dev->data;
+	uint32_t size = BIT(MIN(data->csw & CSW_SIZE_MASK, 2));
+	uint32_t reg = (data->select & SELECT_APBANK_MASK) | addr;
+	uint32_t result = 0;
+	int ret = 0;
+
+	if (data->ctrl_stat & CTRL_STAT_STICKYERR) {
+		return SWDP_ACK_FAULT;
+	}
+
+	if ((data->select >> SELECT_APSEL_SHIFT) != 0) {
+		/* No AP at this index, reads as zero */
+		reg = UINT32_MAX;
+	}
+
+	switch (reg) {
+	case SWD_AP_CSW:
+		if (read) {
+			result = data->csw | CSW_DBGSTATUS;
+		} else {
+			data->csw = *val & (CSW_SIZE_MASK | CSW_ADDRINC_MASK);
+		}
+		break;
+	case SWD_AP_TAR:
+		if (read) {
+			result = data->tar;
+		} else {
+			data->tar = *val;
+		}
+		break;
+	case SWD_AP_DRW:
+		if (read) {
+			ret = mem_read(dev, data->tar, &result);
+		} else {
+			ret = mem_write(dev, data->tar, *val, size);
+		}
+
+		tar_increment(data, size);
+		break;
+	case AP_IDR:
+		result = AP_IDR_AHB;
+		break;
+	default:
+		break;
+	}
+
+	if (ret) {
+		LOG_DBG("%s: bus fault at 0x%08x", dev->name, data->tar);
+		data->ctrl_stat |= CTRL_STAT_STICKYERR;
+	}
+
+	/* Posted: the read returns the previous result and leaves this one in RDBUFF */
+	if (read) {
+		*val = data->rdbuff;
+		data->rdbuff = result;
+	}
+
+	return SWDP_ACK_OK;
+}
+
+static uint8_t dp_access(const struct device *dev, uint8_t addr, bool read, uint32_t *val)
+{
+	const struct swdp_emul_config *config = dev->config;
+	struct swdp_emul_data *data = dev->data;
+
+	switch (addr) {
+	case SWD_DP_IDCODE:
+		if (read) {
+			*val = config->idcode;
+		} else if (*val & ABORT_STKERRCLR) {
+			data->ctrl_stat &= ~CTRL_STAT_STICKYERR;
+		}
+		break;
+	case SWD_DP_CTRL_STAT:
+		if ((data->select & SELECT_DPBANK_MASK) != 0) {
+			/* TARGETID, DLPIDR and the other banks are not implemented */
+			if (read) {
+				*val = 0;
+			}
+		} else if (read) {
+			*val = data->ctrl_stat | ((data->ctrl_stat & CTRL_STAT_PWRUPREQ) << 1);
+		} else {
+			data->ctrl_stat = (*val & CTRL_STAT_PWRUPREQ) |
+					  (data->ctrl_stat & CTRL_STAT_STICKYERR);
+		}
+		break;
+	case SWD_DP_SELECT:
+		if (!read) {
+			data->select = *val;
+		}
+		break;
+	case SWD_DP_RDBUFF:
+		/* TARGETSEL writes are not acknowledged by anyone, ignore them */
+		if (read) {
+			*val = data->rdbuff;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return SWDP_ACK_OK;
+}
+
+static int swdp_emul_transfer(const struct device *dev, uint8_t request, uint32_t *val,
+			      uint8_t idle_cycles, uint8_t *response)
+{
+	struct swdp_emul_data *data = dev->data;
+	uint8_t addr = request & (SWDP_REQUEST_A2 | SWDP_REQUEST_A3);
+	bool read = request & SWDP_REQUEST_RnW;
+
+	ARG_UNUSED(idle_cycles);
+
+	if (!data->on) {
+		*response = ACK_NONE;
+		return 0;
+	}
+
+	if (request & SWDP_REQUEST_APnDP) {
+		*response = ap_access(dev, addr, read, val);
+	} else {
+		*response = dp_access(dev, addr, read, val);
+	}
+
+	return 0;
+}
+
+static int swdp_emul_output_sequence(const struct device *dev, uint32_t count,
+				     const uint8_t *seq)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(count);
+	ARG_UNUSED(seq);
+
+	return 0;
+}
+
+static int swdp_emul_input_sequence(const struct device *dev, uint32_t count, uint8_t *seq)
+{
+	ARG_UNUSED(dev);
+
+	/* Nothing drives the line, the pull-up reads as ones */
+	memset(seq, 0xFF, DIV_ROUND_UP(count, 8));
+
+	return 0;
+}
+
+static int swdp_emul_set_pins(const struct device *dev, uint8_t pins, uint8_t value)
+{
+	struct swdp_emul_data *data = dev->data;
+
+	data->pins = (data->pins & ~pins) | (value & pins);
+
+	return 0;
+}
+
+static int swdp_emul_get_pins(const struct device *dev, uint8_t *state)
+{
+	struct swdp_emul_data *data = dev->data;
+
+	*state = data->pins;
+
+	return 0;
+}
+
+static int swdp_emul_set_clock(const struct device *dev, uint32_t clock)
+{
+	ARG_UNUSED(dev);
+
+	return clock == 0 ? -EINVAL : 0;
+}
+
+static int swdp_emul_configure(const struct device *dev, uint8_t turnaround, bool data_phase)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(turnaround);
+	ARG_UNUSED(data_phase);
+
+	return 0;
+}
+
+static int swdp_emul_port_on(const struct device *dev)
+{
+	struct swdp_emul_data *data = dev->data;
+
+	data->on = true;
+
+	return 0;
+}
+
+static int swdp_emul_port_off(const struct device *dev)
+{
+	struct swdp_emul_data *data = dev->data;
+
+	data->on = false;
+
+	return 0;
+}
+
+static const struct swdp_api swdp_emul_api = {
+	.swdp_output_sequence = swdp_emul_output_sequence,
+	.swdp_input_sequence = swdp_emul_input_sequence,
+	.swdp_transfer = swdp_emul_transfer,
+	.swdp_set_pins = swdp_emul_set_pins,
+	.swdp_get_pins = swdp_emul_get_pins,
+	.swdp_set_clock = swdp_emul_set_clock,
+	.swdp_configure = swdp_emul_configure,
+	.swdp_port_on = swdp_emul_port_on,
+	.swdp_port_off = swdp_emul_port_off,
+};
+
+static int swdp_emul_init(const struct device *dev)
+{
+	const struct swdp_emul_config *config = dev->config;
+	struct swdp_emul_data *data = dev->data;
+
+	for (size_t i = 0; i < config->pcsr_len; i += PCSR_REGION_CELLS) {
+		data->pcsr_weight += config->pcsr_regions[i + 2];
+	}
+
+	data->prng = PRNG_SEED;
+
+	/* SWCLK, SWDIO and nRESET idle high */
+	data->pins = BIT(SWDP_SWCLK_PIN) | BIT(SWDP_SWDIO_PIN) | BIT(SWDP_nRESET_PIN);
+
+	return 0;
+}
+
+#define SWDP_EMUL_INIT(n)                                                                          \
+	BUILD_ASSERT(DT_INST_PROP(n, ram_size) % 4 == 0, "ram-size must be a multiple of 4");      \
+	BUILD_ASSERT(DT_INST_PROP_LEN_OR(n, pcsr_regions, 0) % PCSR_REGION_CELLS == 0,             \
+		     "pcsr-regions must have address, size and weight per region");                \
+                                                                                                   \
+	static uint8_t swdp_emul_ram_##n[DT_INST_PROP(n, ram_size)] __aligned(4);                  \
+	static const uint32_t swdp_emul_pcsr_##n[] = DT_INST_PROP_OR(n, pcsr_regions, {0});        \
+                                                                                                   \
+	static const struct swdp_emul_config swdp_emul_cfg_##n = {                                 \
+		.ram = swdp_emul_ram_##n,                                                          \
+		.ram_base = DT_INST_PROP(n, ram_base),                                             \
+		.ram_size = DT_INST_PROP(n, ram_size),                                             \
+		.idcode = DT_INST_PROP(n, idcode),                                                 \
+		.cpuid = DT_INST_PROP(n, cpuid),                                                   \
+		.pcsr_regions = swdp_emul_pcsr_##n,                                                \
+		.pcsr_len = DT_INST_PROP_LEN_OR(n, pcsr_regions, 0),                               \
+	};                                                                                         \
+                                                                                                   \
+	static struct swdp_emul_data swdp_emul_data_##n;                                           \
+                                                                                                   \
+	DEVICE_DT_INST_DEFINE(n, swdp_emul_init, NULL, &swdp_emul_data_##n, &swdp_emul_cfg_##n,    \
+			      POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &swdp_emul_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SWDP_EMUL_INIT)
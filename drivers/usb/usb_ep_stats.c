@@ -0,0 +1,198 @@
+/**
+ * @file usb_ep_stats.c
+ * @brief Transfer counters of every non-control endpoint, taken at the USB device controller
+ *
+ * The build links udc_init() and udc_ep_enqueue() with --wrap. The wrapped udc_init() puts
+ * ep_stats_event() in front of the event callback of the device stack, so every transfer
+ * completion passes through here before the classes see it, whichever class owns the endpoint.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/usb/udc.h>
+#include <zephyr/sys/atomic.h>
+#include "usb_ep_stats.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define EP_STATS_PER_DIR (USB_EP_STATS_MAX / 2)
+
+struct ep_state {
+	/* Transfers queued on the endpoint */
+	atomic_t queued;
+	/* Completion that left the endpoint empty, 0 if none */
+	uint32_t done_cycles;
+	uint32_t transfers;
+	uint32_t empty_windows;
+	uint32_t rearm_max_cyc;
+	uint64_t rearm_sum_cyc;
+	uint32_t rearm_samples;
+};
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static udc_event_cb_t ep_stats_next_cb;
+/* Protects the counters */
+static struct k_spinlock ep_stats_lock;
+/* OUT endpoints 1 to 15, then IN endpoints 1 to 15 */
+static struct ep_state ep_state[USB_EP_STATS_MAX];
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+int __real_udc_init(const struct device *dev, udc_event_cb_t event_cb,
+		    const void *const event_ctx);
+int __real_udc_ep_enqueue(const struct device *dev, struct net_buf *const buf);
+int __wrap_udc_init(const struct device *dev, udc_event_cb_t event_cb,
+		    const void *const event_ctx);
+int __wrap_udc_ep_enqueue(const struct device *dev, struct net_buf *const buf);
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static struct ep_state *ep_state_get(uint8_t ep)
+{
+	uint8_t idx = USB_EP_GET_IDX(ep);
+
+	if (idx == 0 || idx > EP_STATS_PER_DIR) {
+		return NULL;
+	}
+
+	return &ep_state[(USB_EP_DIR_IS_IN(ep) ? EP_STATS_PER_DIR : 0) + idx - 1];
+}
+
+/* Same accounting as the serial mux endpoints, without knowing if more data is waiting */
+static void ep_stats_done(struct ep_state *state, int err)
+{
+	k_spinlock_key_t key;
+	bool last;
+
+	last = atomic_dec(&state->queued) == 1;
+	if (err != 0) {
+		return;
+	}
+
+	key = k_spin_lock(&ep_stats_lock);
+	state->transfers++;
+	if (last) {
+		state->empty_windows++;
+		state->done_cycles = MAX(k_cycle_get_32(), 1);
+	}
+	k_spin_unlock(&ep_stats_lock, key);
+}
+
+static void ep_stats_queued(struct ep_state *state)
+{
+	k_spinlock_key_t key;
+	uint32_t rearm;
+
+	key = k_spin_lock(&ep_stats_lock);
+	if (state->done_cycles != 0) {
+		rearm = k_cycle_get_32() - state->done_cycles;
+		state->rearm_max_cyc = MAX(state->rearm_max_cyc, rearm);
+		state->rearm_sum_cyc += rearm;
+		state->rearm_samples++;
+		state->done_cycles = 0;
+	}
+	k_spin_unlock(&ep_stats_lock, key);
+}
+
+/* Called by the controller driver, possibly from its ISR */
+static int ep_stats_event(const struct device *dev, const struct udc_event *const event)
+{
+	struct udc_buf_info *bi;
+	struct ep_state *state;
+
+	if (event->type == UDC_EVT_EP_REQUEST) {
+		bi = udc_get_buf_info(event->buf);
+		state = ep_state_get(bi->ep);
+		if (state != NULL) {
+			ep_stats_done(state, bi->err);
+		}
+	}
+
+	return ep_stats_next_cb(dev, event);
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int __wrap_udc_init(const struct device *dev, udc_event_cb_t event_cb,
+		    const void *const event_ctx)
+{
+	ep_stats_next_cb = event_cb;
+
+	return __real_udc_init(dev, ep_stats_event, event_ctx);
+}
+
+int __wrap_udc_ep_enqueue(const struct device *dev, struct net_buf *const buf)
+{
+	struct ep_state *state = ep_state_get(udc_get_buf_info(buf)->ep);
+	int ret;
+
+	/* Counted before, the transfer may complete before the call returns */
+	if (state != NULL) {
+		atomic_inc(&state->queued);
+	}
+
+	ret = __real_udc_ep_enqueue(dev, buf);
+	if (state != NULL) {
+		if (ret == 0) {
+			ep_stats_queued(state);
+		} else {
+			atomic_dec(&state->queued);
+		}
+	}
+
+	return ret;
+}
+
+uint8_t usb_ep_stats_get(struct usb_ep_stats *stats, uint8_t max, bool clear)
+{
+	struct ep_state *state;
+	k_spinlock_key_t key;
+	uint8_t n = 0;
+
+	key = k_spin_lock(&ep_stats_lock);
+	for (uint8_t i = 0; i < USB_EP_STATS_MAX && n < max; i++) {
+		state = &ep_state[i];
+		if (state->transfers == 0) {
+			continue;
+		}
+
+		stats[n].ep = (i < EP_STATS_PER_DIR ? USB_EP_DIR_OUT : USB_EP_DIR_IN) |
+			      (i % EP_STATS_PER_DIR + 1);
+		stats[n].transfers = state->transfers;
+		stats[n].empty_windows = state->empty_windows;
+		stats[n].rearm_avg_us =
+			state->rearm_samples == 0
+				? 0
+				: k_cyc_to_us_floor32(
+					  (uint32_t)(state->rearm_sum_cyc / state->rearm_samples));
+		stats[n].rearm_max_us = k_cyc_to_us_floor32(state->rearm_max_cyc);
+		n++;
+	}
+
+	if (clear) {
+		for (uint8_t i = 0; i < USB_EP_STATS_MAX; i++) {
+			state = &ep_state[i];
+			state->transfers = 0;
+			state->empty_windows = 0;
+			state->rearm_max_cyc = 0;
+			state->rearm_sum_cyc = 0;
+			state->rearm_samples = 0;
+		}
+	}
+	k_spin_unlock(&ep_stats_lock, key);
+
+	return n;
+}
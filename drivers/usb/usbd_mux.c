@@ -0,0 +1,625 @@
+/**
+ * @file usbd_mux.c
+ * @brief Multiplexed vendor bulk interface for the uart bridges
+ *
+ * Every rfpros_usb_mux_channel node is a virtual UART that can be a uart bridge peer. The
+ * channel data is carried over a single vendor class interface, see usbd_mux.h for the framing.
+ *
+ * CONFIG_APP_USBD_MUX_EP_QUEUE_DEPTH transfers are kept queued on each endpoint, so with two the
+ * device stack has the next buffer queued while the previous one is parsed or filled and the
+ * host is not NAKed in between. Only the mux endpoints are covered, the DAP bulk pair and the
+ * CDC-ACM data endpoints are queued by their Zephyr classes, see usb_ep_stats.h for their
+ * counters.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/usb/udc.h>
+#include <zephyr/usb/usbd.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "usbd_mux.h"
+#include "uart_bridge.h"
+#include "vuart.h"
+
+#define DT_DRV_COMPAT rfpros_usb_mux_channel
+LOG_MODULE_REGISTER(usbd_mux, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define MUX_CHANNEL_COUNT DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT)
+#define MUX_CHANNEL_MAX   (MUX_CHANNEL_MASK + 1)
+#define MUX_CREDIT_BATCH  64
+#define MUX_CTRL_LEN_CREDIT      3
+#define MUX_CTRL_LEN_LINE_CODING 9
+
+/* Transfers queued per endpoint, from at most half of the UDC buffer pool */
+#define MUX_EP_DEPTH                                                                               \
+	CLAMP(CONFIG_UDC_BUF_POOL_SIZE / 2 / (2 * MUX_TRANSFER_SIZE), 1,                           \
+	      CONFIG_APP_USBD_MUX_EP_QUEUE_DEPTH)
+
+BUILD_ASSERT(MUX_CHANNEL_COUNT > 0, "No rfpros_usb_mux_channel nodes enabled");
+
+enum {
+	MUX_STATE_ENABLED,
+};
+
+struct mux_ep_state {
+	/* Transfers queued on the endpoint */
+	atomic_t queued;
+	/* Completion time of the transfer that is waiting to be replaced, 0 if none */
+	uint32_t done_cycles;
+	uint32_t transfers;
+	uint32_t nak_windows;
+	uint32_t rearm_max_cyc;
+	uint64_t rearm_sum_cyc;
+	uint32_t rearm_samples;
+};
+
+struct mux_desc {
+	struct usb_if_descriptor if0;
+	struct usb_ep_descriptor if0_out_ep;
+	struct usb_ep_descriptor if0_in_ep;
+	struct usb_ep_descriptor if0_hs_out_ep;
+	struct usb_ep_descriptor if0_hs_in_ep;
+	struct usb_desc_header nil_desc;
+};
+
+struct mux_channel_state {
+	/* Data bytes the host allows us to send */
+	atomic_t tx_credit;
+	/* Buffer space freed by the bridge that was not granted to the host yet */
+	atomic_t rx_grant;
+};
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+#define MUX_CHANNEL_ENTRY(n) [DT_INST_PROP(n, channel)] = DEVICE_DT_INST_GET(n),
+
+static const struct device *const mux_channels[MUX_CHANNEL_MAX] = {
+	DT_INST_FOREACH_STATUS_OKAY(MUX_CHANNEL_ENTRY)};
+
+static struct mux_channel_state mux_ch[MUX_CHANNEL_MAX];
+static struct usbd_class_data *mux_c_data;
+static atomic_t mux_state;
+static struct k_work mux_in_work;
+static uint8_t mux_rr_start;
+/* Protects the endpoint counters */
+static struct k_spinlock mux_stats_lock;
+static struct mux_ep_state mux_ep[USBD_MUX_EP_COUNT];
+
+USBD_DESC_STRING_DEFINE(mux_if_str, "DVK Probe Serial Mux", USBD_DUT_STRING_INTERFACE);
+
+static struct mux_desc mux_desc = {
+	.if0 = {
+		.bLength = sizeof(struct usb_if_descriptor),
+		.bDescriptorType = USB_DESC_INTERFACE,
+		.bInterfaceNumber = 0,
+		.bAlternateSetting = 0,
+		.bNumEndpoints = 2,
+		.bInterfaceClass = USB_BCC_VENDOR,
+		.bInterfaceSubClass = 0,
+		.bInterfaceProtocol = 0,
+		.iInterface = 0,
+	},
+	.if0_out_ep = {
+		.bLength = sizeof(struct usb_ep_descriptor),
+		.bDescriptorType = USB_DESC_ENDPOINT,
+		.bEndpointAddress = 0x01,
+		.bmAttributes = USB_EP_TYPE_BULK,
+		.wMaxPacketSize = sys_cpu_to_le16(64U),
+		.bInterval = 0x00,
+	},
+	.if0_in_ep = {
+		.bLength = sizeof(struct usb_ep_descriptor),
+		.bDescriptorType = USB_DESC_ENDPOINT,
+		.bEndpointAddress = 0x81,
+		.bmAttributes = USB_EP_TYPE_BULK,
+		.wMaxPacketSize = sys_cpu_to_le16(64U),
+		.bInterval = 0x00,
+	},
+	.if0_hs_out_ep = {
+		.bLength = sizeof(struct usb_ep_descriptor),
+		.bDescriptorType = USB_DESC_ENDPOINT,
+		.bEndpointAddress = 0x01,
+		.bmAttributes = USB_EP_TYPE_BULK,
+		.wMaxPacketSize = sys_cpu_to_le16(512U),
+		.bInterval = 0x00,
+	},
+	.if0_hs_in_ep = {
+		.bLength = sizeof(struct usb_ep_descriptor),
+		.bDescriptorType = USB_DESC_ENDPOINT,
+		.bEndpointAddress = 0x81,
+		.bmAttributes = USB_EP_TYPE_BULK,
+		.wMaxPacketSize = sys_cpu_to_le16(512U),
+		.bInterval = 0x00,
+	},
+	.nil_desc = {
+		.bLength = 0,
+		.bDescriptorType = 0,
+	},
+};
+
+static const struct usb_desc_header *mux_fs_desc[] = {
+	(struct usb_desc_header *)&mux_desc.if0,
+	(struct usb_desc_header *)&mux_desc.if0_out_ep,
+	(struct usb_desc_header *)&mux_desc.if0_in_ep,
+	(struct usb_desc_header *)&mux_desc.nil_desc,
+};
+
+static const struct usb_desc_header *mux_hs_desc[] = {
+	(struct usb_desc_header *)&mux_desc.if0,
+	(struct usb_desc_header *)&mux_desc.if0_hs_out_ep,
+	(struct usb_desc_header *)&mux_desc.if0_hs_in_ep,
+	(struct usb_desc_header *)&mux_desc.nil_desc,
+};
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static bool mux_is_hs(struct usbd_class_data *const c_data)
+{
+	return usbd_bus_speed(usbd_class_get_ctx(c_data)) == USBD_SPEED_HS;
+}
+
+static uint8_t mux_get_bulk_out(struct usbd_class_data *const c_data)
+{
+	return mux_is_hs(c_data) ? mux_desc.if0_hs_out_ep.bEndpointAddress
+				 : mux_desc.if0_out_ep.bEndpointAddress;
+}
+
+static uint8_t mux_get_bulk_in(struct usbd_class_data *const c_data)
+{
+	return mux_is_hs(c_data) ? mux_desc.if0_hs_in_ep.bEndpointAddress
+				 : mux_desc.if0_in_ep.bEndpointAddress;
+}
+
+/* A transfer finished, the controller NAKs the host if it was the last one queued */
+static void mux_ep_done(struct mux_ep_state *ep, int err, bool data_pending)
+{
+	k_spinlock_key_t key;
+	bool last;
+
+	last = atomic_dec(&ep->queued) == 1;
+	if (err != 0) {
+		return;
+	}
+
+	key = k_spin_lock(&mux_stats_lock);
+	ep->transfers++;
+	if (last && data_pending) {
+		ep->nak_windows++;
+	}
+
+	/* Re-arm latency runs from the oldest completion not replaced yet, while there is data */
+	if (data_pending && ep->done_cycles == 0) {
+		ep->done_cycles = MAX(k_cycle_get_32(), 1);
+	}
+	k_spin_unlock(&mux_stats_lock, key);
+}
+
+static void mux_ep_queued(struct mux_ep_state *ep)
+{
+	k_spinlock_key_t key;
+	uint32_t rearm;
+
+	key = k_spin_lock(&mux_stats_lock);
+	atomic_inc(&ep->queued);
+	if (ep->done_cycles != 0) {
+		rearm = k_cycle_get_32() - ep->done_cycles;
+		ep->rearm_max_cyc = MAX(ep->rearm_max_cyc, rearm);
+		ep->rearm_sum_cyc += rearm;
+		ep->rearm_samples++;
+		ep->done_cycles = 0;
+	}
+	k_spin_unlock(&mux_stats_lock, key);
+}
+
+static bool mux_in_pending(void)
+{
+	for (uint8_t ch = 0; ch < MUX_CHANNEL_MAX; ch++) {
+		if (mux_channels[ch] != NULL &&
+		    ((vuart_tx_pending(mux_channels[ch]) > 0 &&
+		      atomic_get(&mux_ch[ch].tx_credit) > 0) ||
+		     atomic_get(&mux_ch[ch].rx_grant) >= MUX_CREDIT_BATCH)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void mux_channel_open(uint8_t ch)
+{
+	vuart_reset(mux_channels[ch]);
+	atomic_set(&mux_ch[ch].tx_credit, 0);
+	atomic_set(&mux_ch[ch].rx_grant, vuart_rx_space(mux_channels[ch]));
+}
+
+static void mux_handle_ctrl(uint8_t ch, const uint8_t *payload, uint8_t len)
+{
+	struct uart_config cfg;
+
+	switch (payload[0]) {
+	case MUX_CTRL_NOP:
+		break;
+
+	case MUX_CTRL_CREDIT:
+		if (len >= MUX_CTRL_LEN_CREDIT) {
+			atomic_add(&mux_ch[ch].tx_credit, sys_get_le16(&payload[1]));
+			k_work_submit(&mux_in_work);
+		}
+		break;
+
+	case MUX_CTRL_LINE_CODING:
+		if (len >= MUX_CTRL_LEN_LINE_CODING) {
+			cfg.baudrate = sys_get_le32(&payload[1]);
+			cfg.parity = payload[5];
+			cfg.stop_bits = payload[6];
+			cfg.data_bits = payload[7];
+			cfg.flow_ctrl = payload[8];
+			vuart_set_config(mux_channels[ch], &cfg);
+			uart_bridge_peer_configure(mux_channels[ch]);
+		}
+		break;
+
+	case MUX_CTRL_OPEN:
+		mux_channel_open(ch);
+		k_work_submit(&mux_in_work);
+		break;
+
+	default:
+		LOG_DBG("ch%u: unknown control frame 0x%02x", ch, payload[0]);
+		break;
+	}
+}
+
+static void mux_parse_out(const uint8_t *buf, size_t len)
+{
+	size_t pos = 0;
+	uint8_t ch;
+	uint8_t frame_len;
+
+	while (pos + MUX_FRAME_HDR_SIZE <= len) {
+		ch = buf[pos] & MUX_CHANNEL_MASK;
+		frame_len = buf[pos + 1];
+		if (pos + MUX_FRAME_HDR_SIZE + frame_len > len) {
+			LOG_WRN("Truncated frame, dropping %u bytes", (uint32_t)(len - pos));
+			return;
+		}
+
+		if (mux_channels[ch] == NULL) {
+			LOG_DBG("Frame for unknown channel %u", ch);
+		} else if (buf[pos] & MUX_CTRL_FLAG) {
+			if (frame_len > 0) {
+				mux_handle_ctrl(ch, &buf[pos + MUX_FRAME_HDR_SIZE], frame_len);
+			}
+		} else {
+			(void)vuart_rx_put(mux_channels[ch], &buf[pos + MUX_FRAME_HDR_SIZE],
+					   frame_len);
+		}
+
+		pos += MUX_FRAME_HDR_SIZE + frame_len;
+	}
+}
+
+static int mux_out_arm(struct usbd_class_data *const c_data)
+{
+	struct net_buf *buf;
+	int ret;
+
+	buf = usbd_ep_buf_alloc(c_data, mux_get_bulk_out(c_data), MUX_TRANSFER_SIZE);
+	if (buf == NULL) {
+		return -ENOMEM;
+	}
+
+	mux_ep_queued(&mux_ep[USBD_MUX_EP_OUT]);
+	ret = usbd_ep_enqueue(c_data, buf);
+	if (ret) {
+		usbd_ep_buf_free(usbd_class_get_ctx(c_data), buf);
+		atomic_dec(&mux_ep[USBD_MUX_EP_OUT].queued);
+	}
+
+	return ret;
+}
+
+static size_t mux_room(struct net_buf *buf)
+{
+	return MIN(net_buf_tailroom(buf), MUX_TRANSFER_SIZE - buf->len);
+}
+
+static void mux_add_credit_frames(struct net_buf *buf)
+{
+	atomic_val_t grant;
+
+	for (uint8_t ch = 0; ch < MUX_CHANNEL_MAX; ch++) {
+		if (mux_channels[ch] == NULL || atomic_get(&mux_ch[ch].rx_grant) == 0) {
+			continue;
+		}
+
+		if (mux_room(buf) < MUX_FRAME_HDR_SIZE + MUX_CTRL_LEN_CREDIT) {
+			return;
+		}
+
+		grant = MIN(atomic_set(&mux_ch[ch].rx_grant, 0), UINT16_MAX);
+		net_buf_add_u8(buf, MUX_CTRL_FLAG | ch);
+		net_buf_add_u8(buf, MUX_CTRL_LEN_CREDIT);
+		net_buf_add_u8(buf, MUX_CTRL_CREDIT);
+		net_buf_add_le16(buf, grant);
+	}
+}
+
+static void mux_add_data_frames(struct net_buf *buf)
+{
+	uint8_t *hdr;
+	size_t len;
+	size_t got;
+	uint8_t ch;
+
+	for (uint8_t i = 0; i < MUX_CHANNEL_MAX; i++) {
+		/* Rotate the first channel so a busy channel cannot starve the others */
+		ch = (mux_rr_start + i) % MUX_CHANNEL_MAX;
+		if (mux_channels[ch] == NULL) {
+			continue;
+		}
+
+		if (mux_room(buf) <= MUX_FRAME_HDR_SIZE) {
+			break;
+		}
+
+		len = MIN(vuart_tx_pending(mux_channels[ch]), atomic_get(&mux_ch[ch].tx_credit));
+		len = MIN(len, MIN(MUX_FRAME_MAX_PAYLOAD, mux_room(buf) - MUX_FRAME_HDR_SIZE));
+		if (len == 0) {
+			continue;
+		}
+
+		hdr = net_buf_add(buf, MUX_FRAME_HDR_SIZE);
+		got = vuart_tx_get(mux_channels[ch], net_buf_tail(buf), len);
+		if (got == 0) {
+			(void)net_buf_remove_mem(buf, MUX_FRAME_HDR_SIZE);
+			continue;
+		}
+
+		net_buf_add(buf, got);
+		hdr[0] = ch;
+		hdr[1] = got;
+		atomic_sub(&mux_ch[ch].tx_credit, got);
+	}
+
+	mux_rr_start = (mux_rr_start + 1) % MUX_CHANNEL_MAX;
+}
+
+/* Returns true if a transfer was queued */
+static bool mux_in_queue(struct usbd_class_data *const c_data)
+{
+	uint16_t mps;
+	struct net_buf *buf;
+	int ret;
+
+	buf = usbd_ep_buf_alloc(c_data, mux_get_bulk_in(c_data), MUX_TRANSFER_SIZE);
+	if (buf == NULL) {
+		LOG_WRN("No buffer for IN transfer");
+		return false;
+	}
+
+	mux_add_credit_frames(buf);
+	mux_add_data_frames(buf);
+
+	if (buf->len == 0) {
+		usbd_ep_buf_free(usbd_class_get_ctx(c_data), buf);
+		return false;
+	}
+
+	/* Never end a short transfer on a packet boundary, see usbd_mux.h */
+	mps = mux_is_hs(c_data) ? 512U : 64U;
+	if ((buf->len % mps) == 0 && buf->len < MUX_TRANSFER_SIZE) {
+		net_buf_add_u8(buf, MUX_CTRL_FLAG);
+		net_buf_add_u8(buf, 1);
+		net_buf_add_u8(buf, MUX_CTRL_NOP);
+	}
+
+	/* Count it first, the transfer can complete before usbd_ep_enqueue() returns */
+	mux_ep_queued(&mux_ep[USBD_MUX_EP_IN]);
+	ret = usbd_ep_enqueue(c_data, buf);
+	if (ret) {
+		LOG_ERR("Failed to enqueue IN transfer: %d", ret);
+		usbd_ep_buf_free(usbd_class_get_ctx(c_data), buf);
+		atomic_dec(&mux_ep[USBD_MUX_EP_IN].queued);
+		return false;
+	}
+
+	return true;
+}
+
+static void mux_in_work_handler(struct k_work *work)
+{
+	struct usbd_class_data *c_data = mux_c_data;
+
+	ARG_UNUSED(work);
+
+	/* Only this work item queues IN transfers, frames go out in the order they were built */
+	while (atomic_test_bit(&mux_state, MUX_STATE_ENABLED) &&
+	       atomic_get(&mux_ep[USBD_MUX_EP_IN].queued) < MUX_EP_DEPTH) {
+		if (!mux_in_queue(c_data)) {
+			break;
+		}
+	}
+}
+
+static void mux_tx_ready(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_work_submit(&mux_in_work);
+}
+
+static void mux_rx_consumed(const struct device *dev, size_t len)
+{
+	const struct vuart_config *config = dev->config;
+
+	if (atomic_add(&mux_ch[config->channel].rx_grant, len) + len >= MUX_CREDIT_BATCH) {
+		k_work_submit(&mux_in_work);
+	}
+}
+
+static const struct vuart_backend_api mux_backend_api = {
+	.tx_ready = mux_tx_ready,
+	.rx_consumed = mux_rx_consumed,
+};
+
+static int mux_request(struct usbd_class_data *const c_data, struct net_buf *buf, int err)
+{
+	struct usbd_context *uds_ctx = usbd_class_get_ctx(c_data);
+	struct udc_buf_info *bi = udc_get_buf_info(buf);
+
+	if (bi->ep == mux_get_bulk_out(c_data)) {
+		/* Only a full transfer means the host has more to send, a short one ends a write */
+		mux_ep_done(&mux_ep[USBD_MUX_EP_OUT], err, buf->len == MUX_TRANSFER_SIZE);
+		if (err == 0) {
+			mux_parse_out(buf->data, buf->len);
+		}
+
+		usbd_ep_buf_free(uds_ctx, buf);
+		if (err != -ECONNABORTED && atomic_test_bit(&mux_state, MUX_STATE_ENABLED)) {
+			if (mux_out_arm(c_data)) {
+				LOG_ERR("Failed to re-arm OUT transfer");
+			}
+		}
+
+		return 0;
+	}
+
+	if (bi->ep == mux_get_bulk_in(c_data)) {
+		usbd_ep_buf_free(uds_ctx, buf);
+		mux_ep_done(&mux_ep[USBD_MUX_EP_IN], err, mux_in_pending());
+		k_work_submit(&mux_in_work);
+
+		return 0;
+	}
+
+	return usbd_ep_buf_free(uds_ctx, buf);
+}
+
+static void *mux_get_desc(struct usbd_class_data *const c_data, const enum usbd_speed speed)
+{
+	ARG_UNUSED(c_data);
+
+	return speed == USBD_SPEED_HS ? (void *)mux_hs_desc : (void *)mux_fs_desc;
+}
+
+static void mux_enable(struct usbd_class_data *const c_data)
+{
+	for (uint8_t ch = 0; ch < MUX_CHANNEL_MAX; ch++) {
+		if (mux_channels[ch] != NULL) {
+			mux_channel_open(ch);
+		}
+	}
+
+	atomic_set_bit(&mux_state, MUX_STATE_ENABLED);
+	for (int i = 0; i < MUX_EP_DEPTH; i++) {
+		if (mux_out_arm(c_data)) {
+			LOG_ERR("Failed to arm OUT transfer");
+		}
+	}
+
+	k_work_submit(&mux_in_work);
+	LOG_INF("Serial mux enabled, %u channels, %u transfers per endpoint", MUX_CHANNEL_COUNT,
+		MUX_EP_DEPTH);
+}
+
+static void mux_disable(struct usbd_class_data *const c_data)
+{
+	ARG_UNUSED(c_data);
+
+	/* The queued transfers are cancelled through mux_request() */
+	atomic_clear_bit(&mux_state, MUX_STATE_ENABLED);
+	LOG_INF("Serial mux disabled");
+}
+
+static int mux_init(struct usbd_class_data *const c_data)
+{
+	struct usbd_context *uds_ctx = usbd_class_get_ctx(c_data);
+	int err;
+
+	mux_c_data = c_data;
+	k_work_init(&mux_in_work, mux_in_work_handler);
+
+	err = usbd_add_descriptor(uds_ctx, &mux_if_str);
+	if (err) {
+		LOG_ERR("Failed to add interface string descriptor: %d", err);
+		return err;
+	}
+
+	mux_desc.if0.iInterface = usbd_str_desc_get_idx(&mux_if_str);
+
+	return 0;
+}
+
+static struct usbd_class_api mux_api = {
+	.request = mux_request,
+	.enable = mux_enable,
+	.disable = mux_disable,
+	.init = mux_init,
+	.get_desc = mux_get_desc,
+};
+
+/* Classes register in name order: cdc_acm_*, then DAP, then this one (see msosv2.h) */
+USBD_DEFINE_CLASS(vendor_mux, &mux_api, NULL, NULL);
+
+static int mux_channel_init(const struct device *dev)
+{
+	return vuart_init(dev);
+}
+
+#define MUX_CHANNEL_DEFINE(n)                                                                      \
+	BUILD_ASSERT(DT_INST_PROP(n, channel) < MUX_CHANNEL_MAX, "mux channel out of range");      \
+	VUART_DT_INST_DEFINE(n, CONFIG_APP_USBD_MUX_BUF_SIZE, CONFIG_APP_USBD_MUX_BUF_SIZE,        \
+			     &mux_backend_api, mux_channel_init, POST_KERNEL,                      \
+			     CONFIG_SERIAL_INIT_PRIORITY)
+
+DT_INST_FOREACH_STATUS_OKAY(MUX_CHANNEL_DEFINE)
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+uint8_t usbd_mux_ep_depth(void)
+{
+	return MUX_EP_DEPTH;
+}
+
+void usbd_mux_ep_stats_get(struct usbd_mux_ep_stats stats[USBD_MUX_EP_COUNT], bool clear)
+{
+	struct mux_ep_state *ep;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&mux_stats_lock);
+	for (int i = 0; i < USBD_MUX_EP_COUNT; i++) {
+		ep = &mux_ep[i];
+		stats[i].transfers = ep->transfers;
+		stats[i].nak_windows = ep->nak_windows;
+		stats[i].rearm_avg_us =
+			ep->rearm_samples == 0
+				? 0
+				: k_cyc_to_us_floor32(
+					  (uint32_t)(ep->rearm_sum_cyc / ep->rearm_samples));
+		stats[i].rearm_max_us = k_cyc_to_us_floor32(ep->rearm_max_cyc);
+		if (clear) {
+			ep->transfers = 0;
+			ep->nak_windows = 0;
+			ep->rearm_max_cyc = 0;
+			ep->rearm_sum_cyc = 0;
+			ep->rearm_samples = 0;
+		}
+	}
+	k_spin_unlock(&mux_stats_lock, key);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file adc_capture.h
+ * @brief Streaming ADC capture on the analog capable dynamic GPIO pins
+ *
+ * Samples the io-channels of the rfpros_adc_capture node round-robin into a ring buffer and
+ * streams them on its serial device, either continuously or once around a trigger. Every sample
+ * is also folded into a per-channel min/max/mean that the host can poll without reading the
+ * stream.
+ *
+ * Stream frames, all fields little endian:
+ * [ADC_CAPTURE_FRAME_MAGIC][u8 channel mask][u16 rounds][u32 index of the first round]
+ * [u16 sample × channels × rounds]
+ * A round holds one sample of each enabled channel, lowest channel first. A gap in the round index
+ * means rounds were dropped because the host did not read the stream fast enough.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __ADC_CAPTURE_H__
+#define __ADC_CAPTURE_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define ADC_CAPTURE_ENABLE         BIT(0)
+/* Capture once around a trigger instead of streaming continuously */
+#define ADC_CAPTURE_TRIGGERED      BIT(1)
+/* Trigger on a falling instead of a rising level crossing */
+#define ADC_CAPTURE_FALLING        BIT(2)
+
+#define ADC_CAPTURE_CHANNELS_MAX   4
+#define ADC_CAPTURE_FRAME_MAGIC    0xAD
+#define ADC_CAPTURE_FRAME_HDR_SIZE 8
+/* clang-format on */
+
+enum adc_capture_state {
+	ADC_CAPTURE_IDLE = 0,
+	ADC_CAPTURE_RUNNING,
+	/* Triggered mode, waiting for the trigger */
+	ADC_CAPTURE_ARMED,
+	/* Triggered mode, capture complete and streamed */
+	ADC_CAPTURE_DONE,
+};
+
+struct adc_capture_config {
+	uint8_t flags;
+	/* Bit n enables io-channel n */
+	uint8_t channels;
+	/* Total sample rate of all enabled channels */
+	uint32_t rate_hz;
+	/* Triggered mode only */
+	uint8_t trigger_channel;
+	/* Raw ADC value */
+	uint16_t trigger_level;
+	/* Rounds captured after the trigger, the rest of the ring is captured before it */
+	uint32_t post_rounds;
+};
+
+struct adc_capture_reduction {
+	uint16_t min_mv;
+	uint16_t max_mv;
+	uint16_t mean_mv;
+	/* Samples since the last poll, 0 if the channel is not enabled */
+	uint32_t samples;
+};
+
+struct adc_capture_stats {
+	enum adc_capture_state state;
+	/** Negative errno if capture stopped on an error */
+	int error;
+	/** Rounds captured since the start */
+	uint32_t rounds;
+	/** Rounds dropped because the stream was full */
+	uint32_t overruns;
+	/** Index of the trigger round in triggered mode */
+	uint32_t trigger_round;
+	/** Measured total sample rate */
+	uint32_t rate_hz;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Start, restart or stop capturing
+ *
+ * @param config Without ADC_CAPTURE_ENABLE capture stops
+ * @return int 0 on success, -EINVAL for an invalid channel, rate or trigger, -EBUSY if another
+ *         function holds the pin of an enabled channel, see pin_claim.h
+ */
+int adc_capture_configure(const struct adc_capture_config *config);
+
+/**
+ * @brief Get the counters of the current or last capture
+ */
+void adc_capture_stats_get(struct adc_capture_stats *stats);
+
+/**
+ * @brief Get and restart the per-channel reduction
+ *
+ * @param reduction Indexed by io-channel, ADC_CAPTURE_CHANNELS_MAX entries
+ */
+void adc_capture_reduction_get(struct adc_capture_reduction *reduction);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ADC_CAPTURE_H__ */
@@ -0,0 +1,64 @@
+/**
+ * @file boot_profile.h
+ * @brief Timestamps of the boot phases
+ *
+ * The boot to USB enumeration budget is only checked on hardware, by tests/boot_profile.py.
+ * native_sim has no USB device controller to enumerate, so CI does not check it.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __BOOT_PROFILE_H__
+#define __BOOT_PROFILE_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* Reported in this order by ID_DAP_VENDOR_BOOT_PROFILE, only append */
+enum boot_phase {
+	/** main() entered, all drivers initialized */
+	BOOT_PHASE_MAIN = 0,
+	BOOT_PHASE_DAP_READY,
+	BOOT_PHASE_SETTINGS_LOADED,
+	BOOT_PHASE_USB_INIT,
+	BOOT_PHASE_USB_ENABLED,
+	/** Host selected a configuration, enumeration is complete */
+	BOOT_PHASE_USB_CONFIGURED,
+	BOOT_PHASE_TARGET_RESET_RELEASED,
+	BOOT_PHASE_OFFLINE_PROG_READY,
+	BOOT_PHASE_COUNT,
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Record that a phase was reached, only the first call per phase counts
+ *
+ * Can be called from an ISR.
+ */
+void boot_profile_mark(enum boot_phase phase);
+
+/**
+ * @brief Get the time a phase was reached
+ *
+ * @return uint32_t microseconds since the kernel started, 0 if the phase was not reached
+ */
+uint32_t boot_profile_get(enum boot_phase phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOT_PROFILE_H__ */
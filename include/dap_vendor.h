@@ -12,6 +12,9 @@
 /**************************************************************************************************/
 /* Includes                                                                                       */
 /**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/iterable_sections.h>
 #include <cmsis_dap.h>
 
 #ifdef __cplusplus
@@ -28,6 +31,7 @@ extern "C" {
  * @param uint8_t gpio to set
  * @param uint8_t direction 1 = output, 0 = input
  * @param uint8_t option 0 = no-pull, 1 = pull-up, 2 = pull-down, 3 = disconnect
+ * @note Fails with DAP_VENDOR_ERR_BUSY while JTAG, the IO bus or ADC capture holds the gpio
  */
 #define ID_DAP_VENDOR_SET_IO_DIR        ID_DAP_VENDOR31
 /**
@@ -70,14 +74,341 @@ extern "C" {
  */
 #define ID_DAP_VENDOR_WRITE_SETTINGS        (ID_DAP_VENDOR31 - 7)
 
+/**
+ * @brief Read the counters of a uart bridge
+ * @param uint8_t bridge index
+ * @param uint8_t flags, bit 0 = clear the counters after reading
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t number of bridges
+ * @return uint8_t bridge priority
+ * @return 2 x {uint32_t bytes, uint32_t avg queue delay us, uint32_t max queue delay us,
+ *         uint32_t throttle count}, one per port in peers order (little endian)
+ * @return 2 x {uint32_t rx interrupts, uint32_t rx interrupts per KiB}, one per port in peers
+ *         order (little endian)
+ * @return uint32_t USB suspends, uint32_t bytes held for the host at the last resume,
+ *         uint32_t last resume latency us, uint32_t max resume latency us (little endian)
+ * @return 2 x {uint32_t isr calls, uint32_t avg isr cycles, uint32_t max isr cycles}, one per
+ *         port in peers order, zero without CONFIG_RFPROS_UART_BRIDGE_ISR_STATS,
+ *         uint32_t cycles per second (little endian)
+ */
+#define ID_DAP_VENDOR_BRIDGE_STATS          (ID_DAP_VENDOR31 - 8)
+
+/**
+ * @brief Hash target memory on the probe
+ * @param uint8_t algorithm 0 = CRC32 (zlib), 1 = SHA-256
+ * @param uint8_t number of regions (max DAP_VENDOR_MEM_HASH_MAX_REGIONS)
+ * @param {uint32_t address, uint32_t length}[] regions, hashed in order as one buffer
+ *        (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t[] digest, 4 bytes little endian for CRC32, 32 bytes for SHA-256
+ */
+#define ID_DAP_VENDOR_MEM_HASH              (ID_DAP_VENDOR31 - 9)
+#define DAP_VENDOR_MEM_HASH_MAX_REGIONS     32
+
+/**
+ * @brief Write a chunk of an offline programming upload, see offline_prog.h
+ * @param uint32_t offset in the upload, 0 starts a new upload
+ * @param uint16_t chunk size (max DAP_VENDOR_IMAGE_CHUNK_MAX)
+ * @param uint8_t* chunk
+ * @return int8_t result 0 on success, < 0 indicates error
+ */
+#define ID_DAP_VENDOR_IMAGE_WRITE           (ID_DAP_VENDOR31 - 10)
+#define DAP_VENDOR_IMAGE_CHUNK_MAX          256
+
+/**
+ * @brief Check and store an offline programming upload
+ * @param struct offline_prog_header image description
+ * @return int8_t result 0 on success, < 0 indicates error
+ */
+#define ID_DAP_VENDOR_IMAGE_COMMIT          (ID_DAP_VENDOR31 - 11)
+
+/**
+ * @brief Start offline programming or read its progress
+ * @param uint8_t 1 = start programming, 0 = read the progress only
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t state, see enum offline_prog_state
+ * @return int8_t negative errno of the failed step
+ * @return uint32_t bytes done in the current state (little endian)
+ * @return uint32_t bytes total in the current state (little endian)
+ */
+#define ID_DAP_VENDOR_IMAGE_PROGRAM         (ID_DAP_VENDOR31 - 12)
+
+/**
+ * @brief Configure the background target monitor, see target_monitor.h
+ * @param uint8_t flags, bit 0 = enable, bit 1 = capture registers on halt,
+ *        bit 2 = halt on HardFault
+ * @param uint16_t poll interval in ms, 0 = default (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ */
+#define ID_DAP_VENDOR_TARGET_MONITOR        (ID_DAP_VENDOR31 - 13)
+
+/**
+ * @brief Wait for a target state change reported by the target monitor
+ *
+ * The wait blocks the CMSIS-DAP thread, so it is capped well below the usual host command
+ * timeouts and hosts poll again on a timeout instead of waiting for seconds.
+ * @param uint16_t timeout in ms, max DAP_VENDOR_TARGET_EVENT_TIMEOUT_MAX (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t events since the last read, 0 on timeout, see TARGET_EVT_*
+ * @return uint8_t target state, see enum target_state
+ * @return uint32_t probe uptime of the last event in ms (little endian)
+ * @return uint32_t DHCSR (little endian)
+ * @return uint32_t DFSR of the last halt (little endian)
+ * @return uint8_t number of registers, 0 if not captured
+ * @return uint32_t[] R0 to R12, SP, LR, PC and xPSR of the last halt (little endian)
+ */
+#define ID_DAP_VENDOR_TARGET_EVENT          (ID_DAP_VENDOR31 - 14)
+#define DAP_VENDOR_TARGET_EVENT_TIMEOUT_MAX 250
+
+/**
+ * @brief Start, stop or query the PC sampling profiler, see pc_sampler.h
+ * @param uint8_t flags, bit 0 = enable, bit 1 = raw samples, bit 2 = allow halting the core,
+ *        bit 7 = only read the counters
+ * @param uint8_t histogram bucket size as a power of two
+ * @param uint32_t sample rate in Hz (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t mode, 0 = off, 1 = DWT_PCSR, 2 = halt and read
+ * @return int8_t negative errno if sampling stopped on an error
+ * @return uint32_t samples, idle samples, lost samples, skipped periods (little endian)
+ */
+#define ID_DAP_VENDOR_PC_SAMPLER            (ID_DAP_VENDOR31 - 15)
+
+/**
+ * @brief Calibrate the SWD clock or read the clock and transfer statistics, see swd_target.h
+ * @param uint8_t operation, 0 = read, 1 = read and clear the counters, 2 = calibrate and save the
+ *        limit of the connected target, 3 = forget the saved limit of the connected target
+ * @param uint32_t highest clock to calibrate in Hz, 0 = default (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint32_t IDCODE, host clock, applied clock, clock limit, transfers, WAIT responses,
+ *         FAULT responses, protocol errors, clamped host requests, calibrations, failed
+ *         calibrations, last calibrated clock, measured bit rate (little endian)
+ */
+#define ID_DAP_VENDOR_SWD_CLOCK             (ID_DAP_VENDOR31 - 16)
+
+/**
+ * @brief Connect the JTAG port and configure the scan chain, see jtag_chain.h. The SWD port is
+ *        released while JTAG is connected.
+ * @param uint32_t TCK frequency in Hz, 0 = disconnect (little endian)
+ * @param uint8_t number of TAPs, max JTAG_CHAIN_TAPS_MAX, as DAP_JTAG_Configure
+ * @param uint8_t[] IR length of each TAP, TAP 0 closest to TDO
+ * @return int8_t result 0 on success, < 0 indicates error
+ */
+#define ID_DAP_VENDOR_JTAG_CONNECT          (ID_DAP_VENDOR31 - 17)
+
+/**
+ * @brief Run JTAG sequences, same format as DAP_JTAG_Sequence
+ * @param uint8_t number of sequences
+ * @param uint8_t info of each sequence, bits 5:0 = TCK cycles (0 = 64), bit 6 = TMS,
+ *        bit 7 = capture TDO, followed by the TDI bits, LSB first
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t[] TDO bits of the capturing sequences, each one starting on a byte boundary
+ */
+#define ID_DAP_VENDOR_JTAG_SEQUENCE         (ID_DAP_VENDOR31 - 18)
+
+/**
+ * @brief Read the IDCODE of a TAP, as DAP_JTAG_IDCODE. The TAPs must be in Run-Test/Idle.
+ * @param uint8_t TAP index
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint32_t IDCODE (little endian)
+ */
+#define ID_DAP_VENDOR_JTAG_IDCODE           (ID_DAP_VENDOR31 - 19)
+
+/**
+ * @brief Enumerate the targets on a multi-drop SWD bus or read the selection counters, see
+ *        swd_target.h
+ * @param uint8_t flags, bit 0 = try all 16 instances of each candidate
+ * @param uint8_t number of candidates, max DAP_VENDOR_SWD_TARGETS_MAX, 0 = only read the counters
+ * @param uint32_t[] candidate TARGETSEL values (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint32_t selected TARGETSEL (0 = none), host TARGETSEL writes that switched the target,
+ *         host line resets and TARGETSEL writes dropped (little endian)
+ * @return uint8_t number of targets found, max DAP_VENDOR_SWD_TARGETS_MAX
+ * @return uint32_t[] TARGETSEL, IDCODE and TARGETID of each target found (little endian)
+ */
+#define ID_DAP_VENDOR_SWD_TARGETS           (ID_DAP_VENDOR31 - 20)
+#define DAP_VENDOR_SWD_TARGETS_MAX          16
+
+/**
+ * @brief Set up I2C or SPI on the dynamic GPIO pins, see io_bus.h
+ * @param uint8_t mode, 0 = off, 1 = I2C, 2 = SPI
+ * @param uint8_t SPI mode 0 to 3
+ * @param uint32_t clock in Hz (little endian)
+ * @param uint8_t[4] GPIO numbers of SCL/SCK, SDA/MOSI, MISO and chip select, 0xFF = none
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint32_t applied clock in Hz (little endian)
+ */
+#define ID_DAP_VENDOR_IO_BUS_CONFIG         (ID_DAP_VENDOR31 - 21)
+
+/**
+ * @brief Run a batch of I2C or SPI write, read and delay operations, see io_bus.h
+ * @param uint8_t number of operations
+ * @param uint8_t[] operations
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t number of operations completed
+ * @return uint8_t[] read data of all operations
+ */
+#define ID_DAP_VENDOR_IO_BUS_BATCH          (ID_DAP_VENDOR31 - 22)
+
+/**
+ * @brief Start, stop or poll the ADC capture, see adc_capture.h
+ * @param uint8_t flags, bit 0 = enable, bit 1 = triggered, bit 2 = falling edge trigger,
+ *        bit 7 = only read the counters
+ * @param uint8_t channel mask, bit n = io-channel n
+ * @param uint32_t total sample rate in Hz (little endian)
+ * @param uint8_t trigger channel
+ * @param uint16_t trigger level, raw ADC value (little endian)
+ * @param uint32_t rounds captured after the trigger (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t state, 0 = idle, 1 = running, 2 = waiting for the trigger, 3 = done
+ * @return int8_t negative errno if capture stopped on an error
+ * @return uint32_t rounds, dropped rounds, trigger round, measured rate in Hz (little endian)
+ * @return 4 x {uint16_t min mV, uint16_t max mV, uint16_t mean mV, uint32_t samples} per channel
+ *         since the last poll (little endian)
+ */
+#define ID_DAP_VENDOR_ADC_CAPTURE           (ID_DAP_VENDOR31 - 23)
+
+/**
+ * @brief Read the boot phase timestamps, see boot_profile.h
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t number of phases
+ * @return uint32_t[] microseconds since the kernel started of each phase, 0 if not reached
+ *         (little endian)
+ */
+#define ID_DAP_VENDOR_BOOT_PROFILE          (ID_DAP_VENDOR31 - 24)
+
+/**
+ * @brief Run a PRBS test on one side of a uart bridge instead of forwarding, see uart_bridge.h
+ * @param uint8_t bridge index
+ * @param uint8_t mode, 0 = stop, 1 = USB side looped back by the host, 2 = UART side with an
+ *        external loopback, 3 = UART side with the internal loopback, bit 7 = only read the
+ *        counters
+ * @param uint8_t pattern, 7 = PRBS-7, 15 = PRBS-15, 31 = PRBS-31
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t mode
+ * @return uint8_t 1 if the checker is locked to the received pattern
+ * @return uint32_t elapsed ms, bytes sent, bytes received, bits checked, bit errors, resyncs,
+ *         min, avg and max round trip latency in us (little endian)
+ */
+#define ID_DAP_VENDOR_BRIDGE_PRBS           (ID_DAP_VENDOR31 - 25)
+
+/**
+ * @brief Read the endpoint counters of the serial mux and of the device controller, see
+ *        usbd_mux.h and usb_ep_stats.h
+ * @param uint8_t flags, bit 0 = clear the counters after reading
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t transfers kept queued per serial mux endpoint, 0 without the serial mux
+ * @return 2 x {uint32_t transfers, uint32_t NAK windows, uint32_t avg re-arm us,
+ *         uint32_t max re-arm us}, serial mux OUT then IN, zero without it (little endian)
+ * @return uint8_t number of endpoints, 0 without CONFIG_APP_USB_EP_STATS
+ * @return {uint8_t endpoint address, uint32_t transfers, uint32_t empty windows,
+ *         uint32_t avg re-arm us, uint32_t max re-arm us} per endpoint (little endian)
+ */
+#define ID_DAP_VENDOR_USB_EP_STATS          (ID_DAP_VENDOR31 - 26)
+
+/**
+ * @brief Detect the baud rate of the target on the hardware side of a uart bridge, see
+ *        uart_bridge.h
+ * @param uint8_t bridge index
+ * @param uint8_t flags, bit 0 = configure the bridge to the detected rate
+ * @param uint16_t timeout in ms, max DAP_VENDOR_AUTOBAUD_TIMEOUT_MAX (little endian)
+ * @return int8_t result 0 on success, < 0 indicates error, DAP_VENDOR_ERR_RANGE above 230400
+ *         baud
+ * @return uint32_t detected rate, a standard rate if one is within 3 % (little endian)
+ * @return uint32_t measured rate (little endian)
+ * @return uint16_t edge intervals used (little endian)
+ */
+#define ID_DAP_VENDOR_BRIDGE_AUTOBAUD       (ID_DAP_VENDOR31 - 27)
+#define DAP_VENDOR_AUTOBAUD_TIMEOUT_MAX      5000
+
+/**
+ * @brief Report the vendor commands and limits of this firmware in one round trip
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint32_t supported commands, bit n = ID_DAP_VENDOR0 + n (little endian)
+ * @return uint16_t DAP packet size (little endian)
+ * @return uint16_t smallest uart bridge buffer size per direction (little endian)
+ * @return uint8_t number of command limits
+ * @return {uint8_t command ID, uint16_t limit} per command with a limit: the maximum regions,
+ *         chunk size, batch size, targets or timeout in ms of its request (little endian)
+ */
+#define ID_DAP_VENDOR_CAPABILITIES          (ID_DAP_VENDOR31 - 28)
+
+/**
+ * @brief Start, stop or query the background RTT engine, see rtt.h
+ *
+ * The engine runs while a host has an RTT port open (DTR raised) or this command requested it.
+ * Builds without per-port DTR, such as the mux, need this command to read RTT.
+ * @param uint8_t flags, bit 0 = run without an open port, bit 7 = only read the state
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint8_t state, bit 0 = running, bit 1 = run requested by this command
+ * @return uint32_t control block address, 0 if not found (little endian)
+ */
+#define ID_DAP_VENDOR_RTT_CONTROL           (ID_DAP_VENDOR31 - 29)
+
+/**
+ * @brief Save the current line coding of a uart bridge as its power-on default, see uart_bridge.h
+ * @param uint8_t bridge index
+ * @param uint8_t flags, bit 0 = remove the saved line coding
+ * @return int8_t result 0 on success, < 0 indicates error
+ * @return uint16_t bridge ID the entry is saved under (little endian)
+ * @return uint32_t baud rate (little endian)
+ * @return uint8_t data bits, 5 to 9
+ * @return uint8_t parity, 0 = none, 1 = odd, 2 = even, 3 = mark, 4 = space
+ * @return uint8_t stop bits, 0 = 0.5, 1 = 1, 2 = 1.5, 3 = 2
+ */
+#define ID_DAP_VENDOR_BRIDGE_SAVE           (ID_DAP_VENDOR31 - 30)
+
 /* clang-format on */
 
 enum {
 	DAP_VENDOR_ERR_INVALID_IO = 1,
 	DAP_VENDOR_ERR_INVALID_IO_OPTION,
 	DAP_VENDOR_ERR_INVALID_SIZE,
+	DAP_VENDOR_ERR_INVALID_INDEX,
+	DAP_VENDOR_ERR_INVALID_ARG,
+	DAP_VENDOR_ERR_TARGET,
+	DAP_VENDOR_ERR_BUSY,
+	DAP_VENDOR_ERR_CHECKSUM,
+	DAP_VENDOR_ERR_NO_IMAGE,
+	DAP_VENDOR_ERR_STORAGE,
+	DAP_VENDOR_ERR_RANGE,
 };
 
+/**
+ * @brief Handler of a vendor command
+ *
+ * @param request Request data after the command ID
+ * @param response Response buffer, response[0] is already set to the command ID
+ * @return uint16_t Response length, including the command ID
+ */
+typedef uint16_t (*dap_vendor_cmd_handler_t)(const uint8_t *request, uint8_t *response);
+
+/**
+ * @brief Vendor command, registered with DAP_VENDOR_CMD_DEFINE()
+ */
+struct dap_vendor_cmd {
+	/** ID_DAP_VENDOR0 to ID_DAP_VENDOR31 */
+	uint8_t id;
+	/** Command specific limit reported by ID_DAP_VENDOR_CAPABILITIES, 0 for none */
+	uint16_t limit;
+	dap_vendor_cmd_handler_t handler;
+	/** Returns whether the request flashes the activity LED, NULL to always flash */
+	bool (*flash_led)(const uint8_t *request);
+};
+
+/**
+ * @brief Register a vendor command
+ *
+ * Commands can be registered from any source file, the dispatcher and the capabilities command
+ * pick them up from a linker section.
+ */
+#define DAP_VENDOR_CMD_DEFINE(_name, _id, _handler, _flash_led, _limit)                            \
+	static const STRUCT_SECTION_ITERABLE(dap_vendor_cmd, dap_vendor_cmd_##_name) = {           \
+		.id = (_id),                                                                       \
+		.limit = (_limit),                                                                 \
+		.handler = (_handler),                                                             \
+		.flash_led = (_flash_led),                                                         \
+	}
+
 enum {
 	IO_OPTION_NO_PULL = 0,
 	IO_OPTION_PULL_UP,
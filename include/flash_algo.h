@@ -0,0 +1,93 @@
+/**
+ * @file flash_algo.h
+ * @brief Runner for CMSIS-Pack flash algorithms on the target
+ *
+ * A flash algorithm is the position dependent blob of a .FLM file, as extracted by pyOCD. It is
+ * loaded into target RAM and its functions are called by setting up the core registers of the
+ * halted target and letting it run until it hits the breakpoint at the start of the blob.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __FLASH_ALGO_H__
+#define __FLASH_ALGO_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/** Operation passed to the Init and UnInit functions */
+enum flash_algo_fnc {
+	FLASH_ALGO_FNC_ERASE = 1,
+	FLASH_ALGO_FNC_PROGRAM,
+	FLASH_ALGO_FNC_VERIFY,
+};
+
+/**
+ * Flash algorithm description, all addresses are target addresses. Same names as the pyOCD
+ * flash algorithm dictionary.
+ */
+struct flash_algo {
+	/** RAM address of the blob, the blob starts with a breakpoint instruction */
+	uint32_t load_address;
+	uint32_t pc_init;
+	uint32_t pc_uninit;
+	uint32_t pc_erase_sector;
+	uint32_t pc_program_page;
+	uint32_t static_base;
+	uint32_t begin_stack;
+	/** Page buffers in target RAM, the second one is 0 if there is room for one page only */
+	uint32_t page_buffers[2];
+	uint32_t page_size;
+	uint32_t sector_size;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Start a function of the algorithm
+ *
+ * The core must be halted and the blob loaded. Manages its own swd_target batch.
+ *
+ * @param algo Flash algorithm
+ * @param pc Function address
+ * @param r0 .. r2 Function arguments
+ * @return int 0 on success, -EIO on a transfer error
+ */
+int flash_algo_start(const struct flash_algo *algo, uint32_t pc, uint32_t r0, uint32_t r1,
+		     uint32_t r2);
+
+/**
+ * @brief Wait for the function started with flash_algo_start() to return
+ *
+ * The debug port is free between two polls, so the next page can be loaded meanwhile.
+ *
+ * @param algo Flash algorithm
+ * @param timeout_ms Time limit
+ * @return int 0 if the function returned 0, -EFAULT if it returned an error or the core
+ * stopped elsewhere, -ETIMEDOUT, or -EIO on a transfer error
+ */
+int flash_algo_wait(const struct flash_algo *algo, uint32_t timeout_ms);
+
+/**
+ * @brief Call a function of the algorithm and wait for it to return
+ */
+int flash_algo_call(const struct flash_algo *algo, uint32_t pc, uint32_t r0, uint32_t r1,
+		    uint32_t r2, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_ALGO_H__ */
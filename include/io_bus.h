@@ -0,0 +1,121 @@
+/**
+ * @file io_bus.h
+ * @brief I2C and SPI master on the dynamic GPIO pins
+ *
+ * The host picks the pins from the gpio_dynamic list and sends batches of write, read and delay
+ * operations, so a fixture step that talks to an EEPROM or a PMIC is one USB round trip. SPI runs
+ * on a PIO state machine, I2C is bit-banged with open-drain pins and clock stretching.
+ *
+ * A transaction may span several batches: the I2C bus is only stopped, and SPI chip select only
+ * released, by an operation with IO_BUS_OP_STOP or by an error.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __IO_BUS_H__
+#define __IO_BUS_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+enum io_bus_mode {
+	IO_BUS_OFF = 0,
+	IO_BUS_I2C,
+	IO_BUS_SPI,
+};
+
+enum io_bus_pin {
+	/* SCL or SCK */
+	IO_BUS_PIN_CLK = 0,
+	/* SDA or MOSI */
+	IO_BUS_PIN_DATA,
+	/* MISO, SPI only */
+	IO_BUS_PIN_MISO,
+	/* Active low chip select, SPI only, optional */
+	IO_BUS_PIN_CS,
+	IO_BUS_PIN_COUNT,
+};
+
+#define IO_BUS_PIN_NONE 0xFF
+
+/*
+ * Batch operations, a type in bits 3:0 and flags:
+ * write    [op][I2C address][u16 length][data]
+ * read     [op][I2C address][u16 length]
+ * transfer [op][unused][u16 length][data], SPI only, reads while writing
+ * delay    [op][u16 microseconds]
+ * Lengths and delays are little endian, the I2C address is 7-bit.
+ */
+enum io_bus_op {
+	IO_BUS_OP_WRITE = 0,
+	IO_BUS_OP_READ,
+	IO_BUS_OP_DELAY,
+	IO_BUS_OP_TRANSFER,
+};
+
+#define IO_BUS_OP_TYPE_MASK 0x0F
+/* Stop the I2C bus or release SPI chip select after the operation */
+#define IO_BUS_OP_STOP      BIT(7)
+
+struct io_bus_config {
+	uint8_t mode;
+	/* SPI mode 0 to 3, bit 1 is CPOL and bit 0 CPHA */
+	uint8_t spi_mode;
+	/* GPIO numbers from the gpio_dynamic list, indexed by enum io_bus_pin */
+	uint8_t pins[IO_BUS_PIN_COUNT];
+	uint32_t frequency;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Set up the bus
+ *
+ * Releases the pins of the previous bus. IO_BUS_OFF only releases the pins.
+ *
+ * @param config Bus mode, pins and clock
+ * @param frequency Applied clock, rounded down from the requested one, may be NULL
+ * @return int 0 on success, -EINVAL on a bad mode, pin or clock, -EBUSY if another function
+ *         holds one of the pins, see pin_claim.h
+ */
+int io_bus_configure(const struct io_bus_config *config, uint32_t *frequency);
+
+/**
+ * @brief Run a batch of operations
+ *
+ * Stops at the first failing operation, then stops the I2C bus or releases SPI chip select.
+ *
+ * @param ops Operations
+ * @param ops_len Size of ops, operations must not run past it
+ * @param count Number of operations
+ * @param rx Read data of all operations, in order
+ * @param rx_size Size of rx
+ * @param rx_len Bytes written to rx
+ * @param done Number of operations that completed
+ * @return int 0 on success, -ENOTCONN if no bus is set up, -EINVAL on a malformed operation,
+ * -EMSGSIZE if the operations or read data do not fit, -ENXIO if an I2C address is not
+ * acknowledged, -EIO if I2C data is not acknowledged, -ETIMEDOUT if the clock is stretched too
+ * long, -EBUSY if SDA is held low
+ */
+int io_bus_batch(const uint8_t *ops, size_t ops_len, uint8_t count, uint8_t *rx, size_t rx_size,
+		 size_t *rx_len, uint8_t *done);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IO_BUS_H__ */
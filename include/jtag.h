@@ -0,0 +1,106 @@
+/**
+ * @file jtag.h
+ * @brief JTAG transport driver API
+ *
+ * A JTAG driver clocks TCK while shifting TDI out and TDO in with a constant TMS level. TAP
+ * state changes are short shifts with TMS high or low, so everything the CMSIS-DAP JTAG
+ * commands need is built on top of jtag_shift().
+ *
+ * Bits are shifted LSB first: bit 0 of tdi[0] is the first bit out, bit 0 of tdo[0] the first
+ * bit in.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __JTAG_H__
+#define __JTAG_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+__subsystem struct jtag_driver_api {
+	int (*port_on)(const struct device *dev);
+	int (*port_off)(const struct device *dev);
+	int (*set_clock)(const struct device *dev, uint32_t clock);
+	int (*shift)(const struct device *dev, bool tms, const uint8_t *tdi, uint8_t *tdo,
+		     uint32_t bits);
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Take the JTAG pins and drive TCK low
+ *
+ * @param dev JTAG device
+ * @return int 0 on success, -EBUSY if another function holds one of the pins, see pin_claim.h,
+ *         < 0 on other failures
+ */
+static inline int jtag_port_on(const struct device *dev)
+{
+	const struct jtag_driver_api *api = dev->api;
+
+	return api->port_on(dev);
+}
+
+/**
+ * @brief Release the JTAG pins and restore their state from before jtag_port_on
+ *
+ * @param dev JTAG device
+ * @return int 0 on success, < 0 on failure
+ */
+static inline int jtag_port_off(const struct device *dev)
+{
+	const struct jtag_driver_api *api = dev->api;
+
+	return api->port_off(dev);
+}
+
+/**
+ * @brief Set the TCK frequency
+ *
+ * @param dev JTAG device
+ * @param clock Frequency in Hz, rounded down to what the driver can do
+ * @return int 0 on success, -EINVAL if the driver cannot go that slow
+ */
+static inline int jtag_set_clock(const struct device *dev, uint32_t clock)
+{
+	const struct jtag_driver_api *api = dev->api;
+
+	return api->set_clock(dev, clock);
+}
+
+/**
+ * @brief Clock bits through the scan chain
+ *
+ * @param dev JTAG device
+ * @param tms TMS level for all bits
+ * @param tdi Bits to shift out, NULL shifts ones
+ * @param tdo Buffer for the bits shifted in, NULL discards them
+ * @param bits Number of TCK cycles
+ * @return int 0 on success, < 0 on failure
+ */
+static inline int jtag_shift(const struct device *dev, bool tms, const uint8_t *tdi, uint8_t *tdo,
+			     uint32_t bits)
+{
+	const struct jtag_driver_api *api = dev->api;
+
+	return api->shift(dev, tms, tdi, tdo, bits);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JTAG_H__ */
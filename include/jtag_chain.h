@@ -0,0 +1,73 @@
+/**
+ * @file jtag_chain.h
+ * @brief JTAG scan chain access for the CMSIS-DAP JTAG vendor commands
+ *
+ * Works on the JTAG port selected with the rfpros,jtag chosen node, either the PIO driver or an
+ * emulated chain. While connected, the SWD pins are lent to the JTAG port, see
+ * swd_target_lend().
+ *
+ * TAP 0 is the one closest to TDO, as in DAP_JTAG_Configure.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __JTAG_CHAIN_H__
+#define __JTAG_CHAIN_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+#define JTAG_CHAIN_TAPS_MAX 8
+
+/* Arm debug port IDCODE instruction, cut to the IR length of the TAP */
+#define JTAG_CHAIN_IDCODE_INSTR 0x0E
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Connect or disconnect the JTAG port and describe the scan chain
+ *
+ * @param clock TCK frequency in Hz, 0 disconnects and gives the pins back to SWD
+ * @param count Number of TAPs, may be 0 when only raw shifts are used
+ * @param ir_lengths Instruction register length of each TAP
+ * @return int 0 on success, -ENODEV if there is no JTAG port, -EINVAL for a bad chain or clock
+ */
+int jtag_chain_connect(uint32_t clock, uint8_t count, const uint8_t *ir_lengths);
+
+/**
+ * @brief Clock bits through the scan chain, see jtag_shift()
+ *
+ * @return int 0 on success, -ENOTCONN if not connected, < 0 on a driver error
+ */
+int jtag_chain_shift(bool tms, const uint8_t *tdi, uint8_t *tdo, uint32_t bits);
+
+/**
+ * @brief Read the IDCODE of a TAP, like DAP_JTAG_IDCODE
+ *
+ * Starts and ends in Run-Test/Idle. Loads the IDCODE instruction into the TAP and BYPASS
+ * into all others, then reads its data register.
+ *
+ * @param index TAP index
+ * @param idcode Destination
+ * @return int 0 on success, -EINVAL for a bad index, -ENOTCONN if not connected
+ */
+int jtag_chain_idcode(uint8_t index, uint32_t *idcode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JTAG_CHAIN_H__ */
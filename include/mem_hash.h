@@ -0,0 +1,62 @@
+/**
+ * @file mem_hash.h
+ * @brief Digest of target memory computed on the probe
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __MEM_HASH_H__
+#define __MEM_HASH_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+enum mem_hash_algo {
+	/** CRC-32/ISO-HDLC as computed by zlib.crc32(), 4 byte little endian digest */
+	MEM_HASH_CRC32 = 0,
+	/** SHA-256, 32 byte digest */
+	MEM_HASH_SHA256,
+};
+
+#define MEM_HASH_MAX_DIGEST_SIZE 32
+
+struct mem_region {
+	uint32_t addr;
+	uint32_t len;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Hash target memory read over SWD
+ *
+ * The regions are hashed in order as if they were one contiguous buffer.
+ *
+ * @param algo Digest algorithm
+ * @param regions Target address ranges
+ * @param count Number of regions
+ * @param digest Destination, at least MEM_HASH_MAX_DIGEST_SIZE bytes
+ * @return int digest size on success, -EINVAL for an unknown algorithm, -EIO if the target
+ * could not be read
+ */
+int mem_hash(enum mem_hash_algo algo, const struct mem_region *regions, size_t count,
+	     uint8_t *digest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_HASH_H__ */
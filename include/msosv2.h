@@ -27,6 +27,17 @@
 		0x00, '4', 0x00, '3', 0x00, '2', 0x00, '1', 0x00, 'F', 0x00, 'E', 0x00, '}', 0x00, \
 		0x00, 0x00, 0x00, 0x00
 
+#if defined(CONFIG_APP_USBD_MUX)
+/* {A3C1D8E2-5B74-4F19-9E06-2D7B8C41F0A5} */
+#define SERIAL_MUX_DEVICE_INTERFACE_GUID                                                           \
+	'{', 0x00, 'A', 0x00, '3', 0x00, 'C', 0x00, '1', 0x00, 'D', 0x00, '8', 0x00, 'E', 0x00,    \
+		'2', 0x00, '-', 0x00, '5', 0x00, 'B', 0x00, '7', 0x00, '4', 0x00, '-', 0x00, '4',  \
+		0x00, 'F', 0x00, '1', 0x00, '9', 0x00, '-', 0x00, '9', 0x00, 'E', 0x00, '0', 0x00, \
+		'6', 0x00, '-', 0x00, '2', 0x00, 'D', 0x00, '7', 0x00, 'B', 0x00, '8', 0x00, 'C',  \
+		0x00, '4', 0x00, '1', 0x00, 'F', 0x00, '0', 0x00, 'A', 0x00, '5', 0x00, '}', 0x00, \
+		0x00, 0x00, 0x00, 0x00
+#endif
+
 /*
  * Calculate the DAP interface number dynamically based on CDC ACM instances.
  * Each CDC ACM instance uses 2 interfaces (control + data), so the DAP interface
@@ -35,6 +46,19 @@
 #define CDC_ACM_INSTANCE_COUNT DT_NUM_INST_STATUS_OKAY(zephyr_cdc_acm_uart)
 #define DAP_INTERFACE_NUMBER   (CDC_ACM_INSTANCE_COUNT * 2)
 
+/*
+ * The serial mux vendor class registers after the DAP class, so it takes the next interface.
+ */
+#define MUX_INTERFACE_NUMBER (DAP_INTERFACE_NUMBER + 1)
+#define MUX_IN_ENDPOINTS     COND_CODE_1(CONFIG_APP_USBD_MUX, (1), (0))
+
+/*
+ * Each CDC ACM instance takes two of the 15 IN endpoints, DAP and the serial mux one each. The
+ * overlays that add a port disable another one, see debug.overlay.
+ */
+BUILD_ASSERT(CDC_ACM_INSTANCE_COUNT * 2 + 1 + MUX_IN_ENDPOINTS <= 15,
+	     "Not enough IN endpoints for the DAP and serial mux interfaces");
+
 /*
  * The DAP function subset contains the WinUSB compatible ID and device interface GUID.
  */
@@ -51,6 +75,12 @@ struct msosv2_descriptor {
 	struct msosv2_function_subset_header dap_subset_header;
 	struct msosv2_compatible_id compatible_id;
 	struct msosv2_guids_property guids_property;
+#if defined(CONFIG_APP_USBD_MUX)
+	/* Serial mux interface function subset */
+	struct msosv2_function_subset_header mux_subset_header;
+	struct msosv2_compatible_id mux_compatible_id;
+	struct msosv2_guids_property mux_guids_property;
+#endif
 } __packed;
 
 const struct msosv2_descriptor msosv2_desc = {
@@ -86,6 +116,32 @@ const struct msosv2_descriptor msosv2_desc = {
 			.wPropertyDataLength = 80,
 			.bPropertyData = {CMSIS_DAP_V2_DEVICE_INTERFACE_GUID},
 		},
+#if defined(CONFIG_APP_USBD_MUX)
+	.mux_subset_header =
+		{
+			.wLength = sizeof(struct msosv2_function_subset_header),
+			.wDescriptorType = MS_OS_20_SUBSET_HEADER_FUNCTION,
+			.bFirstInterface = MUX_INTERFACE_NUMBER,
+			.bReserved = 0,
+			.wSubsetLength = DAP_FUNCTION_SUBSET_LENGTH,
+		},
+	.mux_compatible_id =
+		{
+			.wLength = sizeof(struct msosv2_compatible_id),
+			.wDescriptorType = MS_OS_20_FEATURE_COMPATIBLE_ID,
+			.CompatibleID = {'W', 'I', 'N', 'U', 'S', 'B', 0x00, 0x00},
+		},
+	.mux_guids_property =
+		{
+			.wLength = sizeof(struct msosv2_guids_property),
+			.wDescriptorType = MS_OS_20_FEATURE_REG_PROPERTY,
+			.wPropertyDataType = MS_OS_20_PROPERTY_DATA_REG_MULTI_SZ,
+			.wPropertyNameLength = 42,
+			.PropertyName = {DEVICE_INTERFACE_GUIDS_PROPERTY_NAME},
+			.wPropertyDataLength = 80,
+			.bPropertyData = {SERIAL_MUX_DEVICE_INTERFACE_GUID},
+		},
+#endif
 };
 
 /*
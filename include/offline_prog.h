@@ -0,0 +1,128 @@
+/**
+ * @file offline_prog.h
+ * @brief Standalone target programming from an image stored on the probe
+ *
+ * The host uploads a flash algorithm and a target image into the image partition once. The probe
+ * then programs the target on its own when triggered by a vendor command, the trigger button or
+ * at boot, so a programming station does not need a PC per DVK.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __OFFLINE_PROG_H__
+#define __OFFLINE_PROG_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include "flash_algo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define OFFLINE_PROG_MAGIC              0x494B5644 /* "DVKI" */
+#define OFFLINE_PROG_VERSION            1
+
+/* Program the target every time the probe boots */
+#define OFFLINE_PROG_FLAG_AT_BOOT       BIT(0)
+/* clang-format on */
+
+enum offline_prog_state {
+	OFFLINE_PROG_IDLE = 0,
+	OFFLINE_PROG_ERASE,
+	OFFLINE_PROG_PROGRAM,
+	OFFLINE_PROG_VERIFY,
+	OFFLINE_PROG_DONE,
+	OFFLINE_PROG_FAILED,
+};
+
+/**
+ * Image description, stored in the first sector of the image partition. The uploaded data is
+ * the flash algorithm blob followed by the target image at image_offset.
+ */
+#pragma pack(1)
+struct offline_prog_header {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t flags;
+	uint16_t reserved;
+	/** Size and CRC32 (zlib) of the uploaded data, algorithm and image */
+	uint32_t data_size;
+	uint32_t data_crc;
+	/** Offset of the image in the uploaded data, the algorithm blob size rounded up */
+	uint32_t image_offset;
+	/** Target flash address of the image */
+	uint32_t image_address;
+	struct flash_algo algo;
+};
+#pragma pack()
+
+struct offline_prog_status {
+	enum offline_prog_state state;
+	/** Negative errno of the failed step */
+	int error;
+	/** Bytes done in the current state */
+	uint32_t done;
+	uint32_t total;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Open the image partition and set up the trigger button
+ *
+ * Starts programming if the stored image has OFFLINE_PROG_FLAG_AT_BOOT set.
+ */
+void offline_prog_init(void);
+
+/**
+ * @brief Store a chunk of the upload
+ *
+ * Chunks must be written in order, offset 0 starts a new upload and invalidates the stored
+ * image.
+ *
+ * @param offset Offset in the uploaded data
+ * @param data Chunk
+ * @param len Chunk size
+ * @return int 0 on success, -EINVAL if the offset is out of order, -EFBIG if the partition is
+ * full, -EBUSY while programming, -EIO on a flash error
+ */
+int offline_prog_write(uint32_t offset, const uint8_t *data, size_t len);
+
+/**
+ * @brief Check the upload against its CRC and store the image description
+ *
+ * @param header Image description
+ * @return int 0 on success, -EINVAL for an invalid description, -EBADMSG on a CRC mismatch,
+ * -EBUSY while programming, -EIO on a flash error
+ */
+int offline_prog_commit(const struct offline_prog_header *header);
+
+/**
+ * @brief Start programming the target with the stored image
+ *
+ * @return int 0 on success, -ENOENT if no image is stored, -EBUSY while programming
+ */
+int offline_prog_start(void);
+
+/**
+ * @brief Get the progress of the last programming run
+ */
+void offline_prog_status_get(struct offline_prog_status *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OFFLINE_PROG_H__ */
@@ -0,0 +1,129 @@
+/**
+ * @file pc_histogram.h
+ * @brief Sparse histogram of sampled program counters and its stream encoding
+ *
+ * Samples are counted per bucket of 2^shift bytes of code in an open addressing table, so the
+ * probe keeps up with the sample rate and only the aggregate is sent to the host.
+ *
+ * Stream frames start with a 4 byte header: 0xA5, frame type, payload length (uint16_t little
+ * endian). Numbers in the payload are LEB128 varints.
+ *
+ * Histogram frame payload: uint8_t shift, samples, idle samples, lost samples, entry count and
+ * entry count times {bucket delta, count}. Buckets are sorted, the first delta is from 0. The
+ * totals are sent once, later frames of the same report carry 0.
+ *
+ * Raw frame payload: sample count and sample count times the zigzag encoded difference to the
+ * previous PC, starting from 0.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __PC_HISTOGRAM_H__
+#define __PC_HISTOGRAM_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define PC_FRAME_SYNC           0xA5
+#define PC_FRAME_HISTOGRAM      1
+#define PC_FRAME_RAW            2
+#define PC_FRAME_HDR_SIZE       4
+
+/* Sample value for a core that is halted, sleeping without PCSR support or not sampled */
+#define PC_SAMPLE_IDLE          0xFFFFFFFF
+/* clang-format on */
+
+struct pc_histogram {
+	/** Bucket number + 1, 0 for a free slot */
+	uint32_t *keys;
+	uint32_t *counts;
+	/** Sort scratch space */
+	uint16_t *order;
+	/** Number of slots, a power of two */
+	size_t size;
+	size_t used;
+	uint8_t shift;
+	uint32_t samples;
+	uint32_t idle;
+	uint32_t lost;
+};
+
+/**
+ * @brief Define a histogram with sz slots
+ */
+#define PC_HISTOGRAM_DEFINE(name, sz)                                                              \
+	BUILD_ASSERT(IS_POWER_OF_TWO(sz) && (sz) <= UINT16_MAX, "Invalid histogram size");         \
+	static uint32_t name##_keys[sz];                                                           \
+	static uint32_t name##_counts[sz];                                                         \
+	static uint16_t name##_order[sz];                                                          \
+	static struct pc_histogram name = {                                                        \
+		.keys = name##_keys,                                                               \
+		.counts = name##_counts,                                                           \
+		.order = name##_order,                                                             \
+		.size = sz,                                                                        \
+	}
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Empty the histogram
+ *
+ * @param h Histogram
+ * @param shift Bucket size is 2^shift bytes
+ */
+void pc_histogram_reset(struct pc_histogram *h, uint8_t shift);
+
+/**
+ * @brief Count a sample
+ *
+ * @param h Histogram
+ * @param pc Sampled PC or PC_SAMPLE_IDLE
+ */
+void pc_histogram_add(struct pc_histogram *h, uint32_t pc);
+
+/**
+ * @brief Encode the next histogram frame
+ *
+ * The buckets that fit in the frame are cleared, call again until it returns 0 to send the
+ * whole histogram. The frame with the last bucket empties the table, so the keys of buckets
+ * that were sent do not fill it up over a long run.
+ *
+ * @param h Histogram
+ * @param buf Frame buffer
+ * @param size Buffer size, at least 32 bytes
+ * @return size_t frame size, 0 if there is nothing to send
+ */
+size_t pc_histogram_encode(struct pc_histogram *h, uint8_t *buf, size_t size);
+
+/**
+ * @brief Encode raw samples in a frame
+ *
+ * @param pcs Samples
+ * @param count Number of samples
+ * @param buf Frame buffer
+ * @param size Buffer size, at least 16 bytes
+ * @param used Number of samples encoded
+ * @return size_t frame size, 0 if count is 0
+ */
+size_t pc_raw_encode(const uint32_t *pcs, size_t count, uint8_t *buf, size_t size, size_t *used);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PC_HISTOGRAM_H__ */
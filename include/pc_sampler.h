@@ -0,0 +1,78 @@
+/**
+ * @file pc_sampler.h
+ * @brief Statistical PC sampling profiler
+ *
+ * Samples the target program counter over SWD without stopping it, from DWT_PCSR, or by halting
+ * the core briefly on targets without PCSR. The samples are aggregated on the probe, see
+ * pc_histogram.h, and streamed on the rfpros_pc_sampler serial device.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __PC_SAMPLER_H__
+#define __PC_SAMPLER_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define PC_SAMPLER_ENABLE       BIT(0)
+/* Stream every sample instead of the histogram */
+#define PC_SAMPLER_RAW          BIT(1)
+/* Halt the core to read the PC if the target has no DWT_PCSR */
+#define PC_SAMPLER_ALLOW_HALT   BIT(2)
+/* clang-format on */
+
+enum pc_sampler_mode {
+	PC_SAMPLER_OFF = 0,
+	PC_SAMPLER_PCSR,
+	PC_SAMPLER_HALT,
+};
+
+struct pc_sampler_stats {
+	enum pc_sampler_mode mode;
+	/** Negative errno if sampling stopped on an error */
+	int error;
+	uint32_t samples;
+	uint32_t idle;
+	/** Samples dropped because the histogram or raw buffer was full */
+	uint32_t lost;
+	/** Sample periods skipped while the host was using the debug port */
+	uint32_t skipped;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Start, reconfigure or stop sampling
+ *
+ * @param flags PC_SAMPLER_* flags, without PC_SAMPLER_ENABLE sampling stops
+ * @param shift Histogram bucket size is 2^shift bytes
+ * @param rate_hz Sample rate, 1 to CONFIG_APP_PC_SAMPLER_RATE_MAX
+ * @return int 0 on success, -EINVAL for an invalid rate
+ */
+int pc_sampler_configure(uint8_t flags, uint8_t shift, uint32_t rate_hz);
+
+/**
+ * @brief Get the counters of the current or last run
+ */
+void pc_sampler_stats_get(struct pc_sampler_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PC_SAMPLER_H__ */
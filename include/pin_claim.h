@@ -0,0 +1,75 @@
+/**
+ * @file pin_claim.h
+ * @brief Ownership of the GPIO pins shared by the vendor functions
+ *
+ * The dynamic IO pins double as ADC inputs, I2C and SPI bus pins and JTAG TDI and TDO. A function
+ * claims its pins before it reconfigures them and releases them when it lets go, so that one
+ * function cannot take over the pins another one is driving.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __PIN_CLAIM_H__
+#define __PIN_CLAIM_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+enum pin_owner {
+	PIN_OWNER_NONE = 0,
+	/** ID_DAP_VENDOR_SET_IO_DIR, until the pin is disconnected again */
+	PIN_OWNER_IO,
+	/** I2C or SPI bus, until the bus is turned off */
+	PIN_OWNER_IO_BUS,
+	/** Enabled ADC capture channels, until capture is disabled */
+	PIN_OWNER_ADC_CAPTURE,
+	/** JTAG port, while it is on */
+	PIN_OWNER_JTAG,
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Claim a set of pins, all of them or none
+ *
+ * Pins the owner already holds can be claimed again.
+ *
+ * @param mask Bit n = GPIO n
+ * @param owner Function taking the pins
+ * @return int 0 on success, -EBUSY if another function holds one of the pins
+ */
+int pin_claim(uint32_t mask, enum pin_owner owner);
+
+/**
+ * @brief Release the pins of a set that the owner holds, the others are left alone
+ *
+ * @param mask Bit n = GPIO n
+ * @param owner Function letting go of the pins
+ */
+void pin_release(uint32_t mask, enum pin_owner owner);
+
+/**
+ * @brief Get the function holding a pin
+ *
+ * @param pin GPIO number
+ * @return enum pin_owner PIN_OWNER_NONE if the pin is free
+ */
+enum pin_owner pin_owner_get(uint8_t pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PIN_CLAIM_H__ */
@@ -0,0 +1,93 @@
+/**
+ * @file prbs.h
+ * @brief PRBS-7/15/31 pattern generator and bit error checker
+ *
+ * Patterns follow ITU-T O.150 (x^7 + x^6 + 1, x^15 + x^14 + 1, x^31 + x^28 + 1) with an all ones
+ * seed. Bits are packed least significant bit first, the order a UART sends them in, so a
+ * serial loopback sees one continuous sequence.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __PRBS_H__
+#define __PRBS_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+struct prbs_gen {
+	uint32_t state;
+	/* Generated bits not packed into a byte yet */
+	uint32_t acc;
+	uint8_t acc_bits;
+	uint8_t order;
+	uint8_t tap_shift;
+	/* Bits generated per step */
+	uint8_t chunk;
+};
+
+struct prbs_check {
+	/* Free running reference, loaded from the received data */
+	struct prbs_gen gen;
+	bool locked;
+	uint8_t sync_bits;
+	/* Errors of the bytes compared since the last full window */
+	uint8_t win_bytes;
+	uint32_t win_errors;
+	/** Bits compared while locked */
+	uint32_t bits;
+	/** Bit errors while locked, slips excluded */
+	uint32_t errors;
+	/** Times the checker lost lock, for example after dropped bytes */
+	uint32_t resyncs;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Start a pattern from the seed
+ *
+ * @param gen Generator
+ * @param order 7, 15 or 31
+ * @return int 0 on success, -EINVAL for an unsupported order
+ */
+int prbs_init(struct prbs_gen *gen, uint8_t order);
+
+/**
+ * @brief Write the next bytes of the pattern
+ */
+void prbs_fill(struct prbs_gen *gen, uint8_t *buf, size_t len);
+
+/**
+ * @brief Reset a checker, it locks onto the first order + 8 error free bits it receives
+ *
+ * @param check Checker
+ * @param order 7, 15 or 31
+ * @return int 0 on success, -EINVAL for an unsupported order
+ */
+int prbs_check_init(struct prbs_check *check, uint8_t order);
+
+/**
+ * @brief Compare received bytes with the pattern and count the bit errors
+ */
+void prbs_check(struct prbs_check *check, const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PRBS_H__ */
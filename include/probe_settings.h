@@ -23,6 +23,10 @@ extern "C" {
 #define PROBE_SETTINGS_INVALID_00   0x00
 #define PROBE_SETTINGS_V1       	0x01
 #define PROBE_SETTINGS_V2      		0x02
+#define PROBE_SETTINGS_V3      		0x03
+#define PROBE_SETTINGS_V4      		0x04
+#define PROBE_SETTINGS_SWD_CLOCKS	8
+#define PROBE_SETTINGS_UARTS		8
 /* clang-format on */
 
 #pragma pack(1)
@@ -49,10 +53,51 @@ typedef struct {
 	uint16_t usb_pid;
 } probe_settings_v2_t;
 
+typedef struct {
+	uint32_t idcode;
+	uint32_t max_clock_hz;
+} probe_settings_swd_clock_t;
+
+typedef struct {
+	uint8_t version;
+	char target_device_vendor[32];
+	char target_device_name[32];
+	char target_board_vendor[32];
+	char target_board_name[32];
+	uint16_t usb_vid;
+	uint16_t usb_pid;
+	/* Calibrated SWD clock limits by DP IDCODE, most recent first, unused entries are 0 */
+	probe_settings_swd_clock_t swd_clock[PROBE_SETTINGS_SWD_CLOCKS];
+} probe_settings_v3_t;
+
+typedef struct {
+	/* See uart_bridge_id_get() */
+	uint16_t bridge_id;
+	uint32_t baudrate;
+	/* Data bits, parity and stop bits, packed by the uart bridge */
+	uint8_t format;
+} probe_settings_uart_t;
+
+typedef struct {
+	uint8_t version;
+	char target_device_vendor[32];
+	char target_device_name[32];
+	char target_board_vendor[32];
+	char target_board_name[32];
+	uint16_t usb_vid;
+	uint16_t usb_pid;
+	/* Calibrated SWD clock limits by DP IDCODE, most recent first, unused entries are 0 */
+	probe_settings_swd_clock_t swd_clock[PROBE_SETTINGS_SWD_CLOCKS];
+	/* Power-on line coding by uart bridge ID, most recent first, unused entries are 0 */
+	probe_settings_uart_t uart[PROBE_SETTINGS_UARTS];
+} probe_settings_v4_t;
+
 typedef union {
 	probe_settings_base_t base;
 	probe_settings_v1_t v1;
 	probe_settings_v2_t v2;
+	probe_settings_v3_t v3;
+	probe_settings_v4_t v4;
 } probe_settings_ut;
 #pragma pack()
 
@@ -79,6 +124,46 @@ void probe_settings_init(void);
  */
 int write_internal_settings(const probe_settings_ut *settings, uint16_t size);
 
+/**
+ * @brief Get the saved SWD clock limit of a target
+ *
+ * @param idcode DP IDCODE of the target
+ * @return uint32_t clock limit in Hz, 0 if none is saved
+ */
+uint32_t probe_settings_swd_clock_get(uint32_t idcode);
+
+/**
+ * @brief Save the SWD clock limit of a target
+ *
+ * The least recently saved entry is dropped when the table is full.
+ *
+ * @param idcode DP IDCODE of the target
+ * @param max_clock_hz clock limit in Hz, 0 removes the entry
+ * @return int 0 on success, < 0 on failure
+ */
+int probe_settings_swd_clock_set(uint32_t idcode, uint32_t max_clock_hz);
+
+/**
+ * @brief Get the saved power-on line coding of a uart bridge
+ *
+ * @param bridge_id ID of the bridge, see uart_bridge_id_get()
+ * @param uart Filled with the saved entry
+ * @return int 0 on success, -ENOENT if none is saved
+ */
+int probe_settings_uart_get(uint16_t bridge_id, probe_settings_uart_t *uart);
+
+/**
+ * @brief Save the power-on line coding of a uart bridge
+ *
+ * The least recently saved entry is dropped when the table is full.
+ *
+ * @param bridge_id ID of the bridge, see uart_bridge_id_get()
+ * @param baudrate baud rate, 0 removes the entry
+ * @param format data bits, parity and stop bits, packed by the uart bridge
+ * @return int 0 on success, < 0 on failure
+ */
+int probe_settings_uart_set(uint16_t bridge_id, uint32_t baudrate, uint8_t format);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+/**
+ * @file rtt.h
+ * @brief Control of the background RTT engine
+ *
+ * The engine polls the target over SWD only while a host has an RTT port open or rtt_run()
+ * requested it, for example from a vendor command on builds without per-port DTR.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __RTT_H__
+#define __RTT_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+struct rtt_status {
+	/** The engine is polling, for an open port or a request */
+	bool running;
+	/** rtt_run() requested the engine to run */
+	bool requested;
+	/** Address of the control block, 0 if not found (yet) */
+	uint32_t cb_addr;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Run the engine even if no RTT port is open, or drop that request
+ *
+ * @param run True to run, false to only run while a port is open
+ */
+void rtt_run(bool run);
+
+/**
+ * @brief Get the state of the engine
+ */
+void rtt_status_get(struct rtt_status *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTT_H__ */
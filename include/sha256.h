@@ -0,0 +1,49 @@
+/**
+ * @file sha256.h
+ * @brief Small streaming SHA-256 (FIPS 180-4)
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __SHA256_H__
+#define __SHA256_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE  64
+
+struct sha256_ctx {
+	uint32_t state[8];
+	uint64_t total;
+	uint8_t block[SHA256_BLOCK_SIZE];
+	size_t used;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+void sha256_init(struct sha256_ctx *ctx);
+
+void sha256_update(struct sha256_ctx *ctx, const uint8_t *data, size_t len);
+
+void sha256_final(struct sha256_ctx *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SHA256_H__ */
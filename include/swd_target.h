@@ -0,0 +1,263 @@
+/**
+ * @file swd_target.h
+ * @brief Shared access to the target debug port
+ *
+ * The CMSIS-DAP host and the probe's own background engines (RTT, ...) share one SWD port.
+ * The DAP controller is set up with the swd_target device, a proxy of the swdp-gpio driver that
+ * serializes access and keeps track of the host's debug port state, so that a background batch
+ * between two host commands is invisible to the host. That includes the sticky DHCSR bits, which
+ * a background read clears: they are kept and added to the host's next DHCSR read.
+ *
+ * Background users bracket their accesses with swd_target_begin() and swd_target_end(). Inside
+ * a batch the MEM-AP of AP 0 is set up for 32-bit accesses with address auto-increment.
+ *
+ * The proxy also limits the SWD clock. swd_target_calibrate() finds the highest clock the
+ * connected target and cable handle reliably and saves it by DP IDCODE in the probe settings.
+ * Whenever a target with a saved limit is identified, host clock requests above the limit are
+ * clamped to it.
+ *
+ * On a multi-drop bus the proxy tracks the target the host selected with TARGETSEL. A line reset
+ * followed by a TARGETSEL write of the target that is already selected is dropped when the wire
+ * is in sync, so hosts that re-select on every core switch only pay for actual switches.
+ * Background batches connect to the host's target, and swd_target_enumerate() finds the targets
+ * on the bus.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __SWD_TARGET_H__
+#define __SWD_TARGET_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define SWD_DP_ABORT            0x00
+#define SWD_DP_IDCODE           0x00
+#define SWD_DP_CTRL_STAT        0x04
+#define SWD_DP_SELECT           0x08
+#define SWD_DP_RDBUFF           0x0C
+#define SWD_DP_TARGETSEL        0x0C
+
+/* DP SELECT bank of the registers at address 0x4 */
+#define SWD_DP_BANK_TARGETID    0x2
+#define SWD_DP_BANK_DLPIDR      0x3
+
+#define SWD_TARGETSEL_INSTANCE_MASK  0xF0000000
+
+#define SWD_AP_CSW              0x00
+#define SWD_AP_TAR              0x04
+#define SWD_AP_DRW              0x0C
+/* clang-format on */
+
+struct swd_target_stats {
+	/* DP IDCODE of the last identified target */
+	uint32_t idcode;
+	/* Clock requested by the host, 0 if it did not set one */
+	uint32_t host_clock;
+	/* Clock applied to the port */
+	uint32_t clock;
+	/* Saved limit of the target, 0 if none */
+	uint32_t clock_limit;
+	uint32_t transfers;
+	uint32_t waits;
+	uint32_t faults;
+	/* Transfers without a valid acknowledge or with a parity error */
+	uint32_t errors;
+	/* Host clock requests above the limit */
+	uint32_t clamps;
+	uint32_t calibrations;
+	uint32_t calib_failures;
+	/* Highest clock that passed the last calibration */
+	uint32_t calib_max_hz;
+	/* Measured SWD bit rate at calib_max_hz */
+	uint32_t calib_effective_hz;
+	/* TARGETSEL of the selected multi-drop target, 0 if none */
+	uint32_t targetsel;
+	/* Host TARGETSEL writes that switched the target */
+	uint32_t reselects;
+	/* Host line resets and TARGETSEL writes dropped because the target was already selected */
+	uint32_t reselects_skipped;
+};
+
+struct swd_target_drop {
+	/* TARGETSEL of the target, from its TARGETID and DLPIDR */
+	uint32_t targetsel;
+	uint32_t idcode;
+	uint32_t targetid;
+};
+
+/* The CMSIS-DAP controller must be set up with this device, see dap_setup() */
+DEVICE_DECLARE(swd_target);
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Check if the host left the debug port alone for a while
+ *
+ * @param idle_ms Minimum time since the last host access
+ * @return true if the host did not access the port for idle_ms
+ */
+bool swd_target_host_idle(uint32_t idle_ms);
+
+/**
+ * @brief Start a background batch
+ *
+ * Takes the port if the host is idle for idle_ms, powers it and connects to the target if
+ * needed and saves the host's MEM-AP state. Must be followed by swd_target_end() on success.
+ *
+ * @param idle_ms Minimum time since the last host access. 0 waits for the port instead, for
+ * requests made on behalf of the host such as vendor commands.
+ * @return int 0 on success, -EBUSY if the host is using the port, -EIO if the target does not
+ * respond
+ */
+int swd_target_begin(uint32_t idle_ms);
+
+/**
+ * @brief End a background batch
+ *
+ * Restores the host's MEM-AP and DP SELECT state, clears sticky errors caused by the batch and
+ * releases the port.
+ */
+void swd_target_end(void);
+
+/**
+ * @brief Release the port when no background user needs it any more
+ *
+ * Powers the port off if the host did not power it on.
+ */
+void swd_target_release(void);
+
+/**
+ * @brief Lend the SWD pins to another transport
+ *
+ * Powers the port off. While the pins are lent, background batches and calibration fail with
+ * -EBUSY. Host SWD commands still reach the port, the host must not mix them with JTAG.
+ *
+ * @param lend true to lend the pins, false to take them back
+ */
+void swd_target_lend(bool lend);
+
+/**
+ * @brief Read a debug port register inside a batch
+ */
+int swd_target_dp_read(uint8_t addr, uint32_t *val);
+
+/**
+ * @brief Write a debug port register inside a batch
+ */
+int swd_target_dp_write(uint8_t addr, uint32_t val);
+
+/**
+ * @brief Read a register of AP 0 inside a batch
+ */
+int swd_target_ap_read(uint8_t addr, uint32_t *val);
+
+/**
+ * @brief Write a register of AP 0 inside a batch
+ */
+int swd_target_ap_write(uint8_t addr, uint32_t val);
+
+/**
+ * @brief Read a 32-bit word of target memory inside a batch
+ */
+int swd_target_mem_read32(uint32_t addr, uint32_t *val);
+
+/**
+ * @brief Write a 32-bit word of target memory inside a batch
+ */
+int swd_target_mem_write32(uint32_t addr, uint32_t val);
+
+/**
+ * @brief Read target memory inside a batch
+ *
+ * Uses auto-incrementing word block reads, addr and len need not be aligned.
+ *
+ * @param addr Target address
+ * @param buf Destination buffer
+ * @param len Number of bytes to read
+ * @return int 0 on success, -EIO on a transfer error
+ */
+int swd_target_mem_read(uint32_t addr, uint8_t *buf, size_t len);
+
+/**
+ * @brief Write target memory inside a batch
+ *
+ * Uses auto-incrementing word block writes, unaligned head and tail bytes are written with
+ * byte accesses.
+ *
+ * @param addr Target address
+ * @param buf Source buffer
+ * @param len Number of bytes to write
+ * @return int 0 on success, -EIO on a transfer error
+ */
+int swd_target_mem_write(uint32_t addr, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Find and save the highest reliable SWD clock of the connected target
+ *
+ * Steps the clock up from CONFIG_APP_SWD_CALIB_MIN_HZ, checking IDCODE, MEM-AP TAR readback and
+ * CPUID at each step, until a step fails, the maximum is reached or the measured bit rate stops
+ * increasing. The limit saved for the target is CONFIG_APP_SWD_CALIB_MARGIN percent below the
+ * highest passing step if a step failed, else the highest passing step. Waits for the port like
+ * requests made on behalf of the host, and restores the host's clock and debug port state.
+ *
+ * @param max_hz Highest clock to try, 0 for CONFIG_APP_SWD_CALIB_MAX_HZ
+ * @param limit_hz Saved limit on success, may be NULL
+ * @return int 0 on success, -EIO if the target does not respond at the start clock, -EBUSY if
+ * the pins are lent to JTAG, or a negative errno if the limit could not be saved
+ */
+int swd_target_calibrate(uint32_t max_hz, uint32_t *limit_hz);
+
+/**
+ * @brief Forget the saved SWD clock limit of the last identified target
+ *
+ * @return int 0 on success, -ENODEV if no target was identified yet, or a negative errno if the
+ * settings could not be written
+ */
+int swd_target_clock_forget(void);
+
+/**
+ * @brief Find the targets on a multi-drop bus
+ *
+ * Wakes the bus from the dormant state and selects each candidate in turn, recording the ones
+ * that answer an IDCODE read. Waits for the port like requests made on behalf of the host, then
+ * re-selects the host's target and restores its debug port state.
+ *
+ * @param candidates TARGETSEL values to try
+ * @param count Number of candidates
+ * @param instances Try all 16 instances of each candidate instead of the given one
+ * @param found Targets that answered
+ * @param max Size of found
+ * @return int number of targets found, or -EBUSY if the pins are lent to JTAG, or a negative
+ * errno if the port could not be powered
+ */
+int swd_target_enumerate(const uint32_t *candidates, size_t count, bool instances,
+			 struct swd_target_drop *found, size_t max);
+
+/**
+ * @brief Read the clock and transfer statistics
+ *
+ * @param stats Destination
+ * @param clear Reset the counters after reading
+ */
+void swd_target_stats_get(struct swd_target_stats *stats, bool clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SWD_TARGET_H__ */
@@ -0,0 +1,122 @@
+/**
+ * @file target_cortexm.h
+ * @brief Cortex-M core control over the shared debug port
+ *
+ * Helpers for the debug registers of the System Control Space. All functions must be called
+ * inside a swd_target batch, see swd_target_begin().
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __TARGET_CORTEXM_H__
+#define __TARGET_CORTEXM_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define CORTEXM_CPUID           0xE000ED00
+#define CORTEXM_AIRCR           0xE000ED0C
+#define CORTEXM_DFSR            0xE000ED30
+#define CORTEXM_DHCSR           0xE000EDF0
+#define CORTEXM_DCRSR           0xE000EDF4
+#define CORTEXM_DCRDR           0xE000EDF8
+#define CORTEXM_DEMCR           0xE000EDFC
+#define CORTEXM_DWT_PCSR        0xE000101C
+
+#define DHCSR_DBGKEY            0xA05F0000
+#define DHCSR_C_DEBUGEN         BIT(0)
+#define DHCSR_C_HALT            BIT(1)
+#define DHCSR_C_MASKINTS        BIT(3)
+#define DHCSR_S_REGRDY          BIT(16)
+#define DHCSR_S_HALT            BIT(17)
+#define DHCSR_S_SLEEP           BIT(18)
+#define DHCSR_S_LOCKUP          BIT(19)
+#define DHCSR_S_RETIRE_ST       BIT(24)
+#define DHCSR_S_RESET_ST        BIT(25)
+
+#define DEMCR_VC_CORERESET      BIT(0)
+#define DEMCR_VC_HARDERR        BIT(10)
+#define DEMCR_TRCENA            BIT(24)
+
+#define AIRCR_VECTKEY           0x05FA0000
+#define AIRCR_SYSRESETREQ       BIT(2)
+
+#define XPSR_T                  BIT(24)
+/* clang-format on */
+
+/** Core register numbers as used by DCRSR.REGSEL */
+enum cortexm_reg {
+	CORTEXM_REG_R0 = 0,
+	CORTEXM_REG_R1,
+	CORTEXM_REG_R2,
+	CORTEXM_REG_R3,
+	CORTEXM_REG_R9 = 9,
+	CORTEXM_REG_R12 = 12,
+	CORTEXM_REG_SP,
+	CORTEXM_REG_LR,
+	CORTEXM_REG_PC,
+	CORTEXM_REG_XPSR,
+	CORTEXM_REG_MSP,
+	CORTEXM_REG_PSP,
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Read the Debug Halting Control and Status Register
+ *
+ * Note that the S_RETIRE_ST and S_RESET_ST bits are cleared by the read. swd_target keeps them
+ * and adds them to the next DHCSR read of the host, so the host still sees a reset.
+ */
+int cortexm_status(uint32_t *dhcsr);
+
+/**
+ * @brief Halt the core and wait until it is halted
+ *
+ * @return int 0 on success, -ETIMEDOUT if the core does not halt, -EIO on a transfer error
+ */
+int cortexm_halt(void);
+
+/**
+ * @brief Let a halted core run, debug stays enabled
+ */
+int cortexm_resume(void);
+
+/**
+ * @brief Request a system reset
+ *
+ * @param halt Halt the core on the reset vector, the caller waits for S_HALT outside the batch.
+ * Without halt, debug is disabled first so the target runs freely.
+ */
+int cortexm_reset(bool halt);
+
+/**
+ * @brief Read a core register of a halted core
+ */
+int cortexm_reg_read(enum cortexm_reg reg, uint32_t *val);
+
+/**
+ * @brief Write a core register of a halted core
+ */
+int cortexm_reg_write(enum cortexm_reg reg, uint32_t val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TARGET_CORTEXM_H__ */
@@ -0,0 +1,100 @@
+/**
+ * @file target_monitor.h
+ * @brief Background target state monitor
+ *
+ * Polls the Cortex-M DHCSR over the shared debug port so the host does not have to. The host
+ * waits for a state change with a single long-poll vendor command instead of polling DHCSR over
+ * USB while the target runs.
+ *
+ * Reading DHCSR clears its sticky S_RESET_ST bit, target resets are reported as an event
+ * instead.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __TARGET_MONITOR_H__
+#define __TARGET_MONITOR_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+/* Configuration flags */
+#define TARGET_MONITOR_ENABLE           BIT(0)
+/* Read the core registers when the target halts */
+#define TARGET_MONITOR_CAPTURE_REGS     BIT(1)
+/* Set the HardFault vector catch so a fault halts the target */
+#define TARGET_MONITOR_CATCH_HARDFAULT  BIT(2)
+
+/* Events, accumulated until read */
+#define TARGET_EVT_HALT                 BIT(0)
+#define TARGET_EVT_RUN                  BIT(1)
+#define TARGET_EVT_RESET                BIT(2)
+#define TARGET_EVT_LOCKUP               BIT(3)
+#define TARGET_EVT_HARDFAULT            BIT(4)
+#define TARGET_EVT_LOST                 BIT(5)
+
+/* R0 to R12, SP, LR, PC and xPSR */
+#define TARGET_MONITOR_REG_COUNT        17
+/* clang-format on */
+
+enum target_state {
+	TARGET_STATE_UNKNOWN = 0,
+	TARGET_STATE_RUNNING,
+	TARGET_STATE_SLEEPING,
+	TARGET_STATE_HALTED,
+	TARGET_STATE_LOCKUP,
+};
+
+struct target_monitor_event {
+	/** TARGET_EVT_* since the last read */
+	uint8_t events;
+	enum target_state state;
+	/** Probe uptime of the last state change */
+	uint32_t timestamp_ms;
+	uint32_t dhcsr;
+	/** Read on halt only */
+	uint32_t dfsr;
+	/** Registers of the last halt, if captured */
+	bool regs_valid;
+	uint32_t regs[TARGET_MONITOR_REG_COUNT];
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Configure the monitor
+ *
+ * @param flags TARGET_MONITOR_* flags, without TARGET_MONITOR_ENABLE the monitor stops
+ * @param interval_ms Poll interval, 0 for CONFIG_APP_TARGET_MONITOR_INTERVAL_MS
+ */
+void target_monitor_configure(uint8_t flags, uint16_t interval_ms);
+
+/**
+ * @brief Wait for a target state change
+ *
+ * @param timeout_ms Time limit
+ * @param event Events since the last call and the current state, also filled in on timeout
+ * @return int 0 on an event, -EAGAIN on timeout, -ENODEV if the monitor is not enabled
+ */
+int target_monitor_wait(uint32_t timeout_ms, struct target_monitor_event *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TARGET_MONITOR_H__ */
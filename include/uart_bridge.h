@@ -9,6 +9,95 @@
 #define RFPROS_UART_BRIDGE_H
 
 #include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+
+/**
+ * @brief Counters of one bridge port, for data received on the port and sent to its peer
+ */
+struct uart_bridge_port_stats {
+	/** Bytes forwarded to the peer */
+	uint32_t bytes;
+	/** Average time the data spent queued in the bridge */
+	uint32_t delay_avg_us;
+	/** Longest time data spent queued in the bridge */
+	uint32_t delay_max_us;
+	/** Number of times the port was paused for a higher priority bridge */
+	uint32_t throttled;
+	/** Receive interrupts serviced */
+	uint32_t rx_irqs;
+	/** Receive interrupts per 1024 bytes forwarded */
+	uint32_t rx_irqs_per_kb;
+	/** Calls of the uart isr of the port, rx and tx, 0 without
+	 * CONFIG_RFPROS_UART_BRIDGE_ISR_STATS
+	 */
+	uint32_t isr_calls;
+	/** Average and longest time in the isr, in k_cycle_get_32() cycles */
+	uint32_t isr_avg_cyc;
+	uint32_t isr_max_cyc;
+};
+
+/**
+ * @brief Side of a bridge that generates and checks a PRBS pattern in test mode
+ */
+enum uart_bridge_prbs_mode {
+	UART_BRIDGE_PRBS_OFF = 0,
+	/** USB side, the host loops the pattern back: USB and firmware throughput */
+	UART_BRIDGE_PRBS_USB,
+	/** Hardware UART side, with TX wired to RX on the target connector */
+	UART_BRIDGE_PRBS_UART,
+	/** Hardware UART side, looped back inside the UART */
+	UART_BRIDGE_PRBS_UART_INTERNAL,
+};
+
+/**
+ * @brief Counters of a PRBS test since it started
+ */
+struct uart_bridge_prbs_stats {
+	enum uart_bridge_prbs_mode mode;
+	/** The checker is in step with the received data */
+	bool locked;
+	uint32_t elapsed_ms;
+	uint32_t tx_bytes;
+	uint32_t rx_bytes;
+	/** Bits compared and bit errors, see struct prbs_check */
+	uint32_t bits;
+	uint32_t bit_errors;
+	uint32_t resyncs;
+	/** Time from sending a byte to receiving it back */
+	uint32_t latency_min_us;
+	uint32_t latency_avg_us;
+	uint32_t latency_max_us;
+};
+
+/**
+ * @brief Baud rate detected on the hardware side of a bridge
+ */
+struct uart_bridge_autobaud_result {
+	/** Standard rate within 3 % of the measured one, or the measured rate if there is none */
+	uint32_t baudrate;
+	/** Rate computed from the edge timings */
+	uint32_t measured;
+	/** Edge intervals that were a whole number of bits and went into the measurement */
+	uint16_t intervals;
+};
+
+/**
+ * @brief Counters of the USB suspends of a bridge
+ */
+struct uart_bridge_suspend_stats {
+	/** USB bus suspends */
+	uint32_t suspends;
+	/** Bytes from the target queued for the host at the last resume */
+	uint32_t held_bytes;
+	/** Time from the last resume until the USB side was serviced again */
+	uint32_t resume_latency_us;
+	uint32_t resume_latency_max_us;
+};
+
+/**
+ * @brief Called to ask the host for a remote wakeup
+ */
+typedef void (*uart_bridge_wakeup_cb_t)(void);
 
 /**
  * @brief Update the hardware port settings on a uart bridge
@@ -21,6 +110,50 @@
  */
 void uart_bridge_settings_update(const struct device *dev, const struct device *bridge_dev);
 
+/**
+ * @brief Find the uart bridge that contains dev
+ *
+ * Constant time, the bridges map the device handles of their peers when they initialize. It is
+ * not on the isr path, the isrs get their bridge from their struct uart_bridge_port.
+ *
+ * @param dev A peer device, for example a USB CDC-ACM port
+ * @return const struct device* The bridge device, or NULL if dev is not bridged
+ */
+const struct device *uart_bridge_find(const struct device *dev);
+
+/**
+ * @brief Apply the uart configuration of dev to its peer in whichever bridge contains it
+ *
+ * Used by virtual UART backends that do not know their bridge, for example the
+ * serial mux when the host changes the line coding of a channel.
+ */
+void uart_bridge_peer_configure(const struct device *dev);
+
+/**
+ * @brief Set the receive FIFO interrupt level of the hardware UART of a uart bridge
+ *
+ * Uses the rx-fifo-threshold of the bridge, or without one the highest level that fills within
+ * CONFIG_RFPROS_UART_BRIDGE_RX_LATENCY_US at the baud rate, so there are fewer interrupts per
+ * byte at high rates. The FIFOs stay enabled at every rate: at low rates a byte that does not
+ * reach the level is forwarded after the receive timeout, about 3 characters later. Call after
+ * reconfiguring the hardware UART. The bridge also records the flow control mode here, which
+ * decides whether the port can be paused when throttled.
+ *
+ * If the hardware UART is not a PL011 then only the flow control mode is recorded.
+ */
+void uart_bridge_rx_tune(const struct device *bridge_dev);
+
+/**
+ * @brief Check if a uart bridge runs its hardware side in half-duplex (RS-485) mode
+ *
+ * Half-duplex bridges drive their DE pin around every transmission and must
+ * not use RTS/CTS flow control.
+ *
+ * @param bridge_dev The uart bridge device
+ * @return true if the bridge has a DE pin configured
+ */
+bool uart_bridge_is_half_duplex(const struct device *bridge_dev);
+
 /**
  * @brief Get the peer device in a uart bridge
  *
@@ -31,4 +164,175 @@ void uart_bridge_settings_update(const struct device *dev, const struct device *
 const struct device *uart_bridge_get_peer(const struct device *dev,
 					  const struct device *bridge_dev);
 
+/**
+ * @brief Mirror the host modem control lines onto the target pins of a uart bridge
+ *
+ * If dev is part of bridge_dev, the DTR and RTS state of dev is applied to the
+ * dtr-gpios and rts-gpios pins of the bridge node. This is called directly from
+ * the USB message callback so the target sees the change within microseconds of
+ * the control transfer.
+ *
+ * If dev is not part of bridge_dev or no pins are mapped then the function is a no-op.
+ */
+void uart_bridge_modem_update(const struct device *dev, const struct device *bridge_dev);
+
+/**
+ * @brief Tell a uart bridge whether a host has the port of dev open
+ *
+ * Bridges with a history-size keep the most recent hardware UART output in a
+ * history ring while no host is attached, and replay it to dev when the host
+ * attaches, before any newer data.
+ *
+ * The attach state is also passed on as DTR to the other peer, which lets a
+ * virtual UART such as an RTT channel run its backend only while a host has the
+ * port open.
+ *
+ * If dev is not the USB side of bridge_dev then the function is a no-op.
+ *
+ * @param dev The USB side device, typically a CDC-ACM port
+ * @param bridge_dev The uart bridge device
+ * @param attached True once the host raised DTR, false when it dropped it
+ */
+void uart_bridge_attach(const struct device *dev, const struct device *bridge_dev, bool attached);
+
+/**
+ * @brief Apply the power-on line coding saved in the probe settings to all bridges
+ *
+ * Entries are found by bridge ID, so they follow a bridge when the devicetree adds or reorders
+ * others. Bridges without an entry keep their devicetree current-speed.
+ */
+void uart_bridge_defaults_apply(void);
+
+/**
+ * @brief Save the current line coding of a uart bridge as its power-on default
+ *
+ * Saves the baud rate, data bits, parity and stop bits the hardware UART runs at, as set by the
+ * host or by autobaud.
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param clear Remove the saved entry instead, the bridge starts at its devicetree current-speed
+ * @param line Set to the current line coding
+ * @return 0 on success, -EINVAL if idx is out of range, < 0 if the settings write failed
+ */
+int uart_bridge_line_save(uint8_t idx, bool clear, struct uart_config *line);
+
+/**
+ * @brief Stable ID of a uart bridge
+ *
+ * CRC-16/CCITT of the devicetree path of the bridge node, it does not change with the index of
+ * the bridge.
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @return Bridge ID, 0 if idx is out of range
+ */
+uint16_t uart_bridge_id_get(uint8_t idx);
+
+/**
+ * @brief Suspend all uart bridges while the USB bus is suspended
+ *
+ * The USB sides stop. With CONFIG_RFPROS_UART_BRIDGE_SUSPEND_RX the hardware sides keep receiving
+ * into the bridge buffers until they are full and flow control holds the targets off, otherwise
+ * they stop as well. The host port settings and attach state are kept.
+ *
+ * @param wakeup Called from the system work queue the first time a target sends while the bus is
+ * suspended, to request a remote wakeup. NULL for none.
+ */
+void uart_bridge_usb_suspend(uart_bridge_wakeup_cb_t wakeup);
+
+/**
+ * @brief Resume all uart bridges after the USB bus resumed
+ *
+ * Re-arms the USB sides, data held during the suspend is sent to the host without waiting for a
+ * DTR toggle or more target data.
+ */
+void uart_bridge_usb_resume(void);
+
+/**
+ * @brief Read the USB suspend counters of a uart bridge
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param stats Filled with the counters
+ * @param clear Reset the counters after reading them
+ * @return 0 on success, -EINVAL if idx is out of range
+ */
+int uart_bridge_suspend_stats_get(uint8_t idx, struct uart_bridge_suspend_stats *stats,
+				  bool clear);
+
+/**
+ * @brief Number of initialized uart bridges
+ */
+uint8_t uart_bridge_count_get(void);
+
+/**
+ * @brief Smallest ring size of the uart bridges
+ *
+ * Every bridge has one ring per direction of its buf-size property, or
+ * CONFIG_RFPROS_UART_BRIDGE_BUF_SIZE.
+ *
+ * @return Bytes of the smallest ring, 0 without bridges
+ */
+uint32_t uart_bridge_buf_size_min(void);
+
+/**
+ * @brief Read the counters of a uart bridge
+ *
+ * Bridges are numbered in initialization order, ports in the order of the
+ * peers property.
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param priority Set to the devicetree priority of the bridge
+ * @param stats Filled with the counters of both ports
+ * @param clear Reset the counters after reading them
+ * @return 0 on success, -EINVAL if idx is out of range
+ */
+int uart_bridge_stats_get(uint8_t idx, uint8_t *priority, struct uart_bridge_port_stats stats[2],
+			  bool clear);
+
+/**
+ * @brief Start or stop the PRBS test mode of a uart bridge
+ *
+ * While the test runs the bridge stops forwarding: the tested side sends the pattern and checks
+ * whatever it receives, data received on the other side is dropped. Data queued in the bridge
+ * when the mode changes is dropped.
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param mode Side under test, UART_BRIDGE_PRBS_OFF resumes forwarding
+ * @param order PRBS-7, 15 or 31
+ * @return 0 on success, -EINVAL for an invalid index, mode or order, -ENOTSUP if the hardware
+ * UART cannot loop back internally
+ */
+int uart_bridge_prbs_set(uint8_t idx, enum uart_bridge_prbs_mode mode, uint8_t order);
+
+/**
+ * @brief Read the counters of the current or last PRBS test of a uart bridge
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param stats Filled with the counters
+ * @return 0 on success, -EINVAL if idx is out of range
+ */
+int uart_bridge_prbs_stats_get(uint8_t idx, struct uart_bridge_prbs_stats *stats);
+
+/**
+ * @brief Detect the baud rate the target transmits at on a uart bridge
+ *
+ * Times the edges on the autobaud-gpios pin of the bridge, the receive pin of its hardware UART.
+ * The target must send during the measurement, data with single bit pulses such as text or 'U'
+ * characters gives the best results. Interrupt latency limits the detection to about 230400 baud.
+ * The bridge keeps forwarding while it measures.
+ *
+ * When applied, both sides of the bridge are set to the detected rate, so the host reads it back
+ * as the line coding of its port. A later line coding change of the host overrides it.
+ *
+ * @param idx Bridge index, less than uart_bridge_count_get()
+ * @param timeout_ms Time to wait for the target to send
+ * @param apply Configure the bridge to the detected rate
+ * @param result Filled with the detected rate
+ * @return 0 on success, -EINVAL if idx is out of range, -ENOTSUP if the bridge has no
+ * autobaud-gpios, -EAGAIN if the target sent too little before the timeout, -EIO if the edges do
+ * not agree on a bit time, -ERANGE if the rate is above 230400 baud or the edges come faster
+ * than the edge interrupt can time them
+ */
+int uart_bridge_autobaud(uint8_t idx, uint32_t timeout_ms, bool apply,
+			 struct uart_bridge_autobaud_result *result);
+
 #endif /* RFPROS_UART_BRIDGE_H */
@@ -0,0 +1,71 @@
+/**
+ * @file uart_pl011_ctrl.h
+ * @brief Receive FIFO level and loopback of the RP2040 PL011 UARTs
+ *
+ * The Zephyr driver of the RP2040 UARTs has no API for these, so they are set here, next to it.
+ * Only registers the driver does not write after its init are changed, and never the line
+ * control register: the FIFOs stay enabled as the driver left them, and the UART is not disabled
+ * while its isr may run.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __UART_PL011_CTRL_H__
+#define __UART_PL011_CTRL_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* Lowest receive FIFO interrupt level, 1/8 of the 32 byte FIFO */
+#define UART_PL011_RX_LEVEL_MIN 4
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Whether dev is a PL011 UART these functions can control
+ */
+bool uart_pl011_ctrl_supported(const struct device *dev);
+
+/**
+ * @brief Set the receive FIFO level at which the UART interrupts
+ *
+ * Takes effect on the next byte received. Bytes below the level interrupt after the receive
+ * timeout, 32 bit periods without a new byte.
+ *
+ * @param dev RP2040 UART
+ * @param level 4, 8, 16, 24 or 28 bytes
+ * @return 0 on success, -EINVAL for another level, -ENOTSUP if dev is not a PL011 UART
+ */
+int uart_pl011_rx_level_set(const struct device *dev, uint8_t level);
+
+/**
+ * @brief Route the transmitter of the UART to its receiver instead of the pins
+ *
+ * Call with the interrupts of the UART disabled, a byte in flight when it switches is lost or
+ * garbled.
+ *
+ * @param dev RP2040 UART
+ * @param enable Loop back, false to use the pins
+ * @return 0 on success, -ENOTSUP if dev is not a PL011 UART
+ */
+int uart_pl011_loopback_set(const struct device *dev, bool enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_PL011_CTRL_H__ */
@@ -0,0 +1,67 @@
+/**
+ * @file uart_tap.h
+ * @brief Timestamped traffic tap of the uart bridges
+ *
+ * A bridge with a tap phandle copies every burst it receives, in both directions, to the
+ * rfpros_uart_tap virtual UART as one frame tagged with the time the receive isr ran. The
+ * bridged data path is not changed: when the tap stream is full the frame is dropped and
+ * reported in a drop record once there is room again.
+ *
+ * Stream frames, all fields little endian:
+ * [UART_TAP_FRAME_MAGIC][u8 source][u16 length][u32 timestamp in microseconds][data]
+ * The source is the bridge index, as used by the ID_DAP_VENDOR_BRIDGE_STATS command, shifted left
+ * by one, ored with the index of the peer that received the data. A drop record has source
+ * UART_TAP_SRC_DROP and a u32 count of the data bytes lost since the previous frame.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __UART_TAP_H__
+#define __UART_TAP_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define UART_TAP_FRAME_MAGIC    0x7A
+#define UART_TAP_FRAME_HDR_SIZE 8
+#define UART_TAP_SRC_DROP       0xFF
+
+#define UART_TAP_SRC(bridge, peer) (((bridge) << 1) | (peer))
+/* clang-format on */
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Queue one timestamped frame on a tap stream
+ *
+ * Called from the receive isr of a bridge right after the data was read from the UART. The data
+ * is copied from where it was received, straight into the tap stream, so that the bridge can
+ * free it as soon as its peer has sent it, whether or not the host reads the tap.
+ *
+ * @param tap rfpros_uart_tap device
+ * @param source UART_TAP_SRC() of the receiving port
+ * @param data Received data
+ * @param len Number of bytes received
+ */
+void uart_tap_put(const struct device *tap, uint8_t source, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_TAP_H__ */
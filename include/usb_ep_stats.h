@@ -0,0 +1,65 @@
+/**
+ * @file usb_ep_stats.h
+ * @brief Transfer counters of every non-control endpoint, taken at the USB device controller
+ *
+ * The DAP bulk pair and the CDC-ACM data endpoints are queued by their Zephyr classes, so the
+ * counters are taken below them: udc_ep_enqueue() marks a queued transfer and the completion
+ * event of the controller driver marks its end. The controller NAKs the host on an endpoint with
+ * no transfer queued, see struct usb_ep_stats for what that means per direction.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __USB_EP_STATS_H__
+#define __USB_EP_STATS_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* Endpoints 1 to 15 in each direction */
+#define USB_EP_STATS_MAX 30
+
+struct usb_ep_stats {
+	/** Endpoint address */
+	uint8_t ep;
+	/** Completed transfers */
+	uint32_t transfers;
+	/** Completions that left no transfer queued. On an OUT endpoint the host is NAKed until the
+	 * class queues the next one. An IN endpoint also empties whenever there is nothing to send.
+	 */
+	uint32_t empty_windows;
+	/** Time from such a completion to queueing the next transfer */
+	uint32_t rearm_avg_us;
+	uint32_t rearm_max_us;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Read the counters of the endpoints that completed a transfer
+ *
+ * @param stats Filled in endpoint address order, OUT endpoints first
+ * @param max Size of stats
+ * @param clear Reset the counters after reading them
+ * @return Number of endpoints written to stats
+ */
+uint8_t usb_ep_stats_get(struct usb_ep_stats *stats, uint8_t max, bool clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USB_EP_STATS_H__ */
@@ -0,0 +1,113 @@
+/**
+ * @file usbd_mux.h
+ * @brief Multiplexed vendor bulk interface for the uart bridges
+ *
+ * All bridge channels share one vendor class interface with one bulk OUT and one bulk IN
+ * endpoint. Every transfer carries a sequence of frames, a frame never crosses a transfer:
+ *
+ *   +---------+---------+------------------+
+ *   | channel |   len   | payload[len]     |
+ *   +---------+---------+------------------+
+ *
+ * Bit 7 of the channel byte marks a control frame for the channel in bits 0..6, the first
+ * payload byte of a control frame is one of MUX_CTRL_*.
+ *
+ * Flow control is credit based in both directions: a sender may only send as many data bytes
+ * on a channel as the receiver granted with MUX_CTRL_CREDIT frames. The device grants the host
+ * the free space of its channel buffer, the host grants the device whatever it is willing to
+ * buffer. A transfer whose length is a non-zero multiple of the endpoint packet size and shorter
+ * than MUX_TRANSFER_SIZE is padded with a MUX_CTRL_NOP frame, so neither side needs ZLPs.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __USBD_MUX_H__
+#define __USBD_MUX_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+/* clang-format off */
+#define MUX_TRANSFER_SIZE       512
+#define MUX_FRAME_HDR_SIZE      2
+#define MUX_FRAME_MAX_PAYLOAD   255
+#define MUX_CTRL_FLAG           0x80
+#define MUX_CHANNEL_MASK        0x7F
+
+/**
+ * @brief Padding, no arguments
+ */
+#define MUX_CTRL_NOP            0x00
+/**
+ * @brief Grant the receiver more data bytes
+ * @param uint16_t number of bytes granted (little endian)
+ */
+#define MUX_CTRL_CREDIT         0x01
+/**
+ * @brief Host to device: set the channel line coding
+ * @param uint32_t baud rate (little endian)
+ * @param uint8_t parity, enum uart_config_parity
+ * @param uint8_t stop bits, enum uart_config_stop_bits
+ * @param uint8_t data bits, enum uart_config_data_bits
+ * @param uint8_t flow control, enum uart_config_flow_control
+ */
+#define MUX_CTRL_LINE_CODING    0x02
+/**
+ * @brief Host to device: (re)open the channel
+ * Drops queued data, forgets the host credits and makes the device grant its full buffer again.
+ */
+#define MUX_CTRL_OPEN           0x03
+/* clang-format on */
+
+enum usbd_mux_ep {
+	USBD_MUX_EP_OUT = 0,
+	USBD_MUX_EP_IN,
+	USBD_MUX_EP_COUNT,
+};
+
+struct usbd_mux_ep_stats {
+	/** Completed transfers */
+	uint32_t transfers;
+	/** Times the last queued transfer completed while there was more data to move, the
+	 * controller NAKs the host until the endpoint is re-armed. OUT has more data after a full
+	 * transfer, IN while a channel has data and credit or a credit grant is due.
+	 */
+	uint32_t nak_windows;
+	/** Time from a completed transfer with more data to move to queueing the next one */
+	uint32_t rearm_avg_us;
+	uint32_t rearm_max_us;
+};
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Number of transfers kept queued on each endpoint, see CONFIG_APP_USBD_MUX_EP_QUEUE_DEPTH
+ */
+uint8_t usbd_mux_ep_depth(void);
+
+/**
+ * @brief Read the counters of the bulk endpoints
+ *
+ * @param stats Indexed by enum usbd_mux_ep
+ * @param clear Reset the counters after reading them
+ */
+void usbd_mux_ep_stats_get(struct usbd_mux_ep_stats stats[USBD_MUX_EP_COUNT], bool clear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USBD_MUX_H__ */
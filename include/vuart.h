@@ -0,0 +1,153 @@
+/**
+ * @file vuart.h
+ * @brief Virtual UART devices backed by firmware instead of hardware
+ *
+ * A virtual UART implements the interrupt driven UART API on top of two ring buffers so that
+ * it can be a peer of a uart bridge. The backend (USB mux channel, RTT channel, ...) moves data
+ * in and out of the rings and the irq callback is run from the system work queue.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+#ifndef __VUART_H__
+#define __VUART_H__
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**************************************************************************************************/
+/* Global Constants, Macros and Type Definitions                                                  */
+/**************************************************************************************************/
+struct vuart_backend_api {
+	/** The bridge queued data in the tx ring, the backend should call vuart_tx_get() */
+	void (*tx_ready)(const struct device *dev);
+	/** The bridge read len bytes from the rx ring */
+	void (*rx_consumed)(const struct device *dev, size_t len);
+	/** Optional, the host opened (DTR raised) or closed the bridged USB port */
+	void (*host_attach)(const struct device *dev, bool attached);
+};
+
+struct vuart_config {
+	uint8_t *rx_buf;
+	uint8_t *tx_buf;
+	size_t rx_size;
+	size_t tx_size;
+	const struct vuart_backend_api *backend;
+	/** Backend specific index, for example the mux or RTT channel number */
+	uint8_t channel;
+};
+
+struct vuart_data {
+	const struct device *dev;
+	struct ring_buf rx_rb;
+	struct ring_buf tx_rb;
+	struct k_spinlock lock;
+	struct k_work cb_work;
+	uart_irq_callback_user_data_t cb;
+	void *cb_data;
+	struct uart_config uart_cfg;
+	bool rx_irq_enabled;
+	bool tx_irq_enabled;
+};
+
+/**
+ * @brief Define a virtual UART device for a devicetree instance
+ *
+ * @param n Instance number of the current DT_DRV_COMPAT
+ * @param rx_sz Size of the rx ring (backend to bridge)
+ * @param tx_sz Size of the tx ring (bridge to backend)
+ * @param backend_api Pointer to the struct vuart_backend_api of the backend
+ * @param init_fn Device init function, must call vuart_init()
+ * @param level Init level
+ * @param prio Init priority
+ */
+#define VUART_DT_INST_DEFINE(n, rx_sz, tx_sz, backend_api, init_fn, level, prio)                  \
+	static uint8_t vuart_rx_buf_##n[rx_sz];                                                    \
+	static uint8_t vuart_tx_buf_##n[tx_sz];                                                    \
+	static const struct vuart_config vuart_cfg_##n = {                                         \
+		.rx_buf = vuart_rx_buf_##n,                                                        \
+		.tx_buf = vuart_tx_buf_##n,                                                        \
+		.rx_size = rx_sz,                                                                  \
+		.tx_size = tx_sz,                                                                  \
+		.backend = backend_api,                                                            \
+		.channel = DT_INST_PROP(n, channel),                                               \
+	};                                                                                         \
+	static struct vuart_data vuart_data_##n;                                                   \
+	DEVICE_DT_INST_DEFINE(n, init_fn, NULL, &vuart_data_##n, &vuart_cfg_##n, level, prio,      \
+			      &vuart_api);
+
+/**************************************************************************************************/
+/* Global Data Definitions                                                                        */
+/**************************************************************************************************/
+extern const struct uart_driver_api vuart_api;
+
+/**************************************************************************************************/
+/* Global Function Prototypes                                                                     */
+/**************************************************************************************************/
+/**
+ * @brief Initialize the rings and work item of a virtual UART
+ *
+ * @param dev Virtual UART device
+ * @return int 0 on success
+ */
+int vuart_init(const struct device *dev);
+
+/**
+ * @brief Deliver data from the backend to the bridge
+ *
+ * @param dev Virtual UART device
+ * @param data Data to queue
+ * @param len Number of bytes to queue
+ * @return size_t number of bytes queued, less than len if the rx ring is full
+ */
+size_t vuart_rx_put(const struct device *dev, const uint8_t *data, size_t len);
+
+/**
+ * @brief Free space in the rx ring
+ */
+size_t vuart_rx_space(const struct device *dev);
+
+/**
+ * @brief Take data the bridge queued for the backend
+ *
+ * @param dev Virtual UART device
+ * @param data Destination buffer
+ * @param len Maximum number of bytes to take
+ * @return size_t number of bytes copied
+ */
+size_t vuart_tx_get(const struct device *dev, uint8_t *data, size_t len);
+
+/**
+ * @brief Number of bytes the bridge queued for the backend
+ */
+size_t vuart_tx_pending(const struct device *dev);
+
+/**
+ * @brief Drop all queued data in both directions
+ */
+void vuart_reset(const struct device *dev);
+
+/**
+ * @brief Set the line configuration reported by uart_config_get()
+ *
+ * Backends call this when the host changes the line coding, followed by
+ * uart_bridge_peer_configure() to apply it to the bridged hardware UART.
+ */
+void vuart_set_config(const struct device *dev, const struct uart_config *cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VUART_H__ */
@@ -0,0 +1,54 @@
+/**
+ * @file boot_profile.c
+ * @brief Timestamps of the boot phases
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "boot_profile.h"
+
+LOG_MODULE_REGISTER(boot_profile, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static struct k_spinlock boot_lock;
+static uint32_t boot_us[BOOT_PHASE_COUNT];
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void boot_profile_mark(enum boot_phase phase)
+{
+	/* Never 0, that means not reached */
+	uint32_t now = MAX(k_ticks_to_us_floor32(k_uptime_ticks()), 1);
+	k_spinlock_key_t key;
+	bool first;
+
+	if (phase >= BOOT_PHASE_COUNT) {
+		return;
+	}
+
+	key = k_spin_lock(&boot_lock);
+	first = boot_us[phase] == 0;
+	if (first) {
+		boot_us[phase] = now;
+	}
+	k_spin_unlock(&boot_lock, key);
+
+	if (first) {
+		LOG_DBG("phase %d at %u us", phase, now);
+	}
+}
+
+uint32_t boot_profile_get(enum boot_phase phase)
+{
+	return phase < BOOT_PHASE_COUNT ? boot_us[phase] : 0;
+}
@@ -12,6 +12,7 @@
 /**************************************************************************************************/
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/reboot.h>
 #include <zephyr/logging/log.h>
 #include <pico/bootrom.h>
@@ -19,6 +20,20 @@
 #include "dap_vendor.h"
 #include "probe_settings.h"
 #include "led.h"
+#include "uart_bridge.h"
+#include "mem_hash.h"
+#include "offline_prog.h"
+#include "target_monitor.h"
+#include "pc_sampler.h"
+#include "rtt.h"
+#include "swd_target.h"
+#include "jtag_chain.h"
+#include "io_bus.h"
+#include "adc_capture.h"
+#include "boot_profile.h"
+#include "pin_claim.h"
+#include "usbd_mux.h"
+#include "usb_ep_stats.h"
 
 LOG_MODULE_REGISTER(dap_vendor, LOG_LEVEL_INF);
 
@@ -27,6 +42,48 @@ LOG_MODULE_REGISTER(dap_vendor, LOG_LEVEL_INF);
 /**************************************************************************************************/
 #define REBOOT_DELAY_MS 100
 
+#define BRIDGE_STATS_FLAG_CLEAR BIT(0)
+
+#define BRIDGE_PRBS_FLAG_QUERY BIT(7)
+
+#define BRIDGE_AUTOBAUD_FLAG_APPLY BIT(0)
+#define BRIDGE_SAVE_FLAG_CLEAR     BIT(0)
+
+#define USB_EP_STATS_FLAG_CLEAR BIT(0)
+#define USB_EP_STATS_MUX_SIZE   16
+#define USB_EP_STATS_EP_SIZE    17
+/* Endpoint entries after the status, mux depth, mux counters and count */
+#define USB_EP_STATS_RESP_MAX                                                                      \
+	MIN(USB_EP_STATS_MAX, (CONFIG_DAP_BACKEND_USB_MAX_PACKET_SIZE - 4 -                        \
+			       USBD_MUX_EP_COUNT * USB_EP_STATS_MUX_SIZE) /                        \
+				      USB_EP_STATS_EP_SIZE)
+
+#define IMAGE_PROGRAM_START 1
+
+#define PC_SAMPLER_FLAG_QUERY BIT(7)
+
+#define RTT_CONTROL_FLAG_RUN   BIT(0)
+#define RTT_CONTROL_FLAG_QUERY BIT(7)
+
+enum {
+	SWD_CLOCK_READ = 0,
+	SWD_CLOCK_READ_CLEAR,
+	SWD_CLOCK_CALIBRATE,
+	SWD_CLOCK_FORGET,
+};
+
+#define JTAG_SEQUENCE_CYCLES_MASK 0x3F
+#define JTAG_SEQUENCE_TMS         BIT(6)
+#define JTAG_SEQUENCE_TDO_CAPTURE BIT(7)
+
+#define SWD_TARGETS_FLAG_INSTANCES BIT(0)
+
+/* Command ID and operation count in, command ID, status and count out */
+#define IO_BUS_OPS_MAX (CONFIG_DAP_BACKEND_USB_MAX_PACKET_SIZE - 2)
+#define IO_BUS_RX_MAX  (CONFIG_DAP_BACKEND_USB_MAX_PACKET_SIZE - 3)
+
+#define ADC_CAPTURE_FLAG_QUERY BIT(7)
+
 // Get the node ID of gpio_dynamic
 #define GPIO_DYNAMIC_NODE DT_PATH(gpio_dynamic)
 
@@ -43,9 +100,20 @@ static const struct gpio_dt_spec gpios[] = {
 static struct k_work_delayable reboot_work;
 static struct k_work_delayable reboot_bootloader_work;
 
+/* Registered commands by ID, filled from the dap_vendor_cmd section at boot */
+static const struct dap_vendor_cmd *cmd_table[ID_DAP_VENDOR31 - ID_DAP_VENDOR0 + 1];
+
 /**************************************************************************************************/
 /* Local Function Definitions                                                                     */
 /**************************************************************************************************/
+/* For commands that are polled or sent in bulk */
+static bool led_never(const uint8_t *request)
+{
+	ARG_UNUSED(request);
+
+	return false;
+}
+
 static void reboot_work_handler(struct k_work *work)
 {
 	/* Reboot the system */
@@ -117,11 +185,21 @@ static int set_io_dir(uint8_t gpio, uint8_t dir, uint8_t option)
 	}
 
 	if (option == IO_OPTION_DISCONNECT) {
-		/* Disconnect the pin */
+		/* Disconnect the pin, unless another function is using it */
+		if (pin_claim(BIT(gpios[io].pin), PIN_OWNER_IO) != 0) {
+			return -DAP_VENDOR_ERR_BUSY;
+		}
+
 		ret = gpio_pin_configure_dt(&gpios[io], GPIO_DISCONNECTED);
+		pin_release(BIT(gpios[io].pin), PIN_OWNER_IO);
 		return ret;
 	}
 
+	/* The pin stays with the vendor IO commands until it is disconnected */
+	if (pin_claim(BIT(gpios[io].pin), PIN_OWNER_IO) != 0) {
+		return -DAP_VENDOR_ERR_BUSY;
+	}
+
 	/* Set direction: input or output */
 	if (dir) {
 		flags = GPIO_OUTPUT;
@@ -152,6 +230,12 @@ static int set_io(uint8_t gpio, uint8_t level)
 
 	io = convert_io(gpio);
 
+	/* Would fight the bus or JTAG signal on the pin */
+	if (pin_owner_get(gpios[io].pin) != PIN_OWNER_NONE &&
+	    pin_owner_get(gpios[io].pin) != PIN_OWNER_IO) {
+		return -DAP_VENDOR_ERR_BUSY;
+	}
+
 	ret = gpio_pin_set_raw(gpios[io].port, gpios[io].pin, level);
 	return ret;
 }
@@ -172,81 +256,881 @@ static int read_io(uint8_t gpio)
 	return ret;
 }
 
-/**************************************************************************************************/
-/* Global Function Definitions                                                                    */
-/**************************************************************************************************/
-uint16_t dap_vendor_cmd_handler(uint8_t cmd_id, const uint8_t *request, uint8_t *response)
+static uint16_t set_io_dir_cmd(const uint8_t *request, uint8_t *response)
+{
+	response[1] = set_io_dir(request[0], request[1], request[2]);
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(set_io_dir, ID_DAP_VENDOR_SET_IO_DIR, set_io_dir_cmd, NULL, 0);
+
+static uint16_t set_io_cmd(const uint8_t *request, uint8_t *response)
 {
+	response[1] = set_io(request[0], request[1]);
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(set_io, ID_DAP_VENDOR_SET_IO, set_io_cmd, NULL, 0);
+
+static uint16_t read_io_cmd(const uint8_t *request, uint8_t *response)
+{
+	response[1] = read_io(request[0]);
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(read_io, ID_DAP_VENDOR_READ_IO, read_io_cmd, NULL, 0);
+
+static uint16_t reboot_cmd(const uint8_t *request, uint8_t *response)
+{
+	if (request[0]) {
+		k_work_init_delayable(&reboot_bootloader_work, reboot_bootloader_work_handler);
+		k_work_schedule(&reboot_bootloader_work, K_MSEC(REBOOT_DELAY_MS));
+	} else {
+		/* Schedule a delayed reboot so the USB response can be sent */
+		k_work_init_delayable(&reboot_work, reboot_work_handler);
+		k_work_schedule(&reboot_work, K_MSEC(REBOOT_DELAY_MS));
+	}
+
+	response[1] = 0;
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(reboot, ID_DAP_VENDOR_REBOOT, reboot_cmd, NULL, 0);
+
+static uint16_t read_settings_cmd(const uint8_t *request, uint8_t *response)
+{
+	ARG_UNUSED(request);
+
+	if (probe_settings == NULL) {
+		response[1] = -1;
+		return 1;
+	}
+
+	memcpy(&response[1], probe_settings, PROBE_SETTINGS_MAX_SIZE);
+
+	return PROBE_SETTINGS_MAX_SIZE + 1;
+}
+
+DAP_VENDOR_CMD_DEFINE(read_settings, ID_DAP_VENDOR_READ_SETTINGS, read_settings_cmd, NULL,
+		      PROBE_SETTINGS_MAX_SIZE);
+
+static uint16_t write_settings_cmd(const uint8_t *request, uint8_t *response)
+{
+	if (request[0] > PROBE_SETTINGS_MAX_SIZE) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_SIZE;
+	} else {
+		response[1] = write_internal_settings((const probe_settings_ut *)(request + 1),
+						      request[0]);
+	}
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(write_settings, ID_DAP_VENDOR_WRITE_SETTINGS, write_settings_cmd, NULL,
+		      PROBE_SETTINGS_MAX_SIZE);
+
+static uint16_t bridge_stats(const uint8_t *request, uint8_t *response)
+{
+	struct uart_bridge_port_stats stats[2];
+	struct uart_bridge_suspend_stats suspend;
+	uint8_t priority;
+	uint8_t *p = &response[4];
 	int ret;
-	int temp;
-	uint16_t response_len = 2;
-	bool flash_led = true;
 
-	/* First byte is always the command ID */
-	response[0] = cmd_id;
+	ret = uart_bridge_stats_get(request[0], &priority, stats,
+				    request[1] & BRIDGE_STATS_FLAG_CLEAR);
+	response[2] = uart_bridge_count_get();
+	if (ret != 0) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_INDEX;
+		return 3;
+	}
 
-	switch (cmd_id) {
-	case ID_DAP_VENDOR_SET_IO_DIR:
-		ret = set_io_dir(request[0], request[1], request[2]);
-		response[1] = ret;
-		break;
+	response[1] = 0;
+	response[3] = priority;
+	for (int i = 0; i < ARRAY_SIZE(stats); i++) {
+		sys_put_le32(stats[i].bytes, p);
+		sys_put_le32(stats[i].delay_avg_us, p + 4);
+		sys_put_le32(stats[i].delay_max_us, p + 8);
+		sys_put_le32(stats[i].throttled, p + 12);
+		p += 16;
+	}
 
-	case ID_DAP_VENDOR_SET_IO:
-		ret = set_io(request[0], request[1]);
-		response[1] = ret;
-		break;
+	/* Appended so that hosts reading the first blocks only are not affected */
+	for (int i = 0; i < ARRAY_SIZE(stats); i++) {
+		sys_put_le32(stats[i].rx_irqs, p);
+		sys_put_le32(stats[i].rx_irqs_per_kb, p + 4);
+		p += 8;
+	}
+
+	(void)uart_bridge_suspend_stats_get(request[0], &suspend,
+					    request[1] & BRIDGE_STATS_FLAG_CLEAR);
+	sys_put_le32(suspend.suspends, p);
+	sys_put_le32(suspend.held_bytes, p + 4);
+	sys_put_le32(suspend.resume_latency_us, p + 8);
+	sys_put_le32(suspend.resume_latency_max_us, p + 12);
+	p += 16;
+
+	for (int i = 0; i < ARRAY_SIZE(stats); i++) {
+		sys_put_le32(stats[i].isr_calls, p);
+		sys_put_le32(stats[i].isr_avg_cyc, p + 4);
+		sys_put_le32(stats[i].isr_max_cyc, p + 8);
+		p += 12;
+	}
+
+	sys_put_le32(sys_clock_hw_cycles_per_sec(), p);
+	p += 4;
+
+	return p - response;
+}
+
+/* Polled by monitoring tools, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(bridge_stats, ID_DAP_VENDOR_BRIDGE_STATS, bridge_stats, led_never, 0);
+
+static uint16_t bridge_prbs(const uint8_t *request, uint8_t *response)
+{
+	struct uart_bridge_prbs_stats stats;
+	uint8_t *p = &response[4];
+	int ret = 0;
+
+	if (!(request[1] & BRIDGE_PRBS_FLAG_QUERY)) {
+		ret = uart_bridge_prbs_set(request[0], request[1], request[2]);
+	}
+
+	if (ret == 0) {
+		ret = uart_bridge_prbs_stats_get(request[0], &stats);
+	}
+
+	if (ret == -ENOTSUP) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_IO_OPTION;
+		return 2;
+	} else if (ret != 0) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_ARG;
+		return 2;
+	}
+
+	response[1] = 0;
+	response[2] = stats.mode;
+	response[3] = stats.locked;
+	sys_put_le32(stats.elapsed_ms, p);
+	sys_put_le32(stats.tx_bytes, p + 4);
+	sys_put_le32(stats.rx_bytes, p + 8);
+	sys_put_le32(stats.bits, p + 12);
+	sys_put_le32(stats.bit_errors, p + 16);
+	sys_put_le32(stats.resyncs, p + 20);
+	sys_put_le32(stats.latency_min_us, p + 24);
+	sys_put_le32(stats.latency_avg_us, p + 28);
+	sys_put_le32(stats.latency_max_us, p + 32);
+	p += 36;
+
+	return p - response;
+}
+
+/* Counters are polled during a test, only flash the LED when switching */
+static bool bridge_prbs_led(const uint8_t *request)
+{
+	return !(request[1] & BRIDGE_PRBS_FLAG_QUERY);
+}
+
+DAP_VENDOR_CMD_DEFINE(bridge_prbs, ID_DAP_VENDOR_BRIDGE_PRBS, bridge_prbs, bridge_prbs_led, 0);
+
+static uint16_t bridge_autobaud(const uint8_t *request, uint8_t *response)
+{
+	struct uart_bridge_autobaud_result result;
+	uint32_t timeout_ms = MIN(sys_get_le16(&request[2]), DAP_VENDOR_AUTOBAUD_TIMEOUT_MAX);
+	int ret;
+
+	/* Blocks the DAP thread until the target has sent enough edges */
+	ret = uart_bridge_autobaud(request[0], timeout_ms, request[1] & BRIDGE_AUTOBAUD_FLAG_APPLY,
+				   &result);
+	if (ret == -ENOTSUP) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_IO_OPTION;
+		return 2;
+	} else if (ret == -EAGAIN || ret == -EIO) {
+		response[1] = -DAP_VENDOR_ERR_TARGET;
+		return 2;
+	} else if (ret == -ERANGE) {
+		response[1] = -DAP_VENDOR_ERR_RANGE;
+		return 2;
+	} else if (ret != 0) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_ARG;
+		return 2;
+	}
+
+	response[1] = 0;
+	sys_put_le32(result.baudrate, &response[2]);
+	sys_put_le32(result.measured, &response[6]);
+	sys_put_le16(result.intervals, &response[10]);
+
+	return 12;
+}
+
+DAP_VENDOR_CMD_DEFINE(bridge_autobaud, ID_DAP_VENDOR_BRIDGE_AUTOBAUD, bridge_autobaud, NULL,
+		      DAP_VENDOR_AUTOBAUD_TIMEOUT_MAX);
+
+static uint16_t bridge_save(const uint8_t *request, uint8_t *response)
+{
+	struct uart_config line;
+	int ret;
+
+	ret = uart_bridge_line_save(request[0], request[1] & BRIDGE_SAVE_FLAG_CLEAR, &line);
+	if (ret == -EINVAL) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_INDEX;
+		return 2;
+	} else if (ret != 0) {
+		response[1] = -DAP_VENDOR_ERR_STORAGE;
+		return 2;
+	}
+
+	response[1] = 0;
+	sys_put_le16(uart_bridge_id_get(request[0]), &response[2]);
+	sys_put_le32(line.baudrate, &response[4]);
+	response[8] = line.data_bits + 5;
+	response[9] = line.parity;
+	response[10] = line.stop_bits;
+
+	return 11;
+}
+
+DAP_VENDOR_CMD_DEFINE(bridge_save, ID_DAP_VENDOR_BRIDGE_SAVE, bridge_save, NULL, 0);
+
+#if defined(CONFIG_APP_USBD_MUX) || defined(CONFIG_APP_USB_EP_STATS)
+static uint16_t usb_ep_stats(const uint8_t *request, uint8_t *response)
+{
+	bool clear = request[0] & USB_EP_STATS_FLAG_CLEAR;
+	uint8_t *p = &response[3];
+#if defined(CONFIG_APP_USBD_MUX)
+	struct usbd_mux_ep_stats mux[USBD_MUX_EP_COUNT];
+#endif
+#if defined(CONFIG_APP_USB_EP_STATS)
+	struct usb_ep_stats eps[USB_EP_STATS_RESP_MAX];
+	uint8_t n;
+#endif
+
+	response[1] = 0;
+	response[2] = 0;
+	memset(p, 0, USBD_MUX_EP_COUNT * USB_EP_STATS_MUX_SIZE);
+
+#if defined(CONFIG_APP_USBD_MUX)
+	usbd_mux_ep_stats_get(mux, clear);
+	response[2] = usbd_mux_ep_depth();
+	for (int i = 0; i < ARRAY_SIZE(mux); i++) {
+		sys_put_le32(mux[i].transfers, p);
+		sys_put_le32(mux[i].nak_windows, p + 4);
+		sys_put_le32(mux[i].rearm_avg_us, p + 8);
+		sys_put_le32(mux[i].rearm_max_us, p + 12);
+		p += USB_EP_STATS_MUX_SIZE;
+	}
+#else
+	p += USBD_MUX_EP_COUNT * USB_EP_STATS_MUX_SIZE;
+#endif
+
+#if defined(CONFIG_APP_USB_EP_STATS)
+	n = usb_ep_stats_get(eps, ARRAY_SIZE(eps), clear);
+	*p++ = n;
+	for (uint8_t i = 0; i < n; i++) {
+		*p = eps[i].ep;
+		sys_put_le32(eps[i].transfers, p + 1);
+		sys_put_le32(eps[i].empty_windows, p + 5);
+		sys_put_le32(eps[i].rearm_avg_us, p + 9);
+		sys_put_le32(eps[i].rearm_max_us, p + 13);
+		p += USB_EP_STATS_EP_SIZE;
+	}
+#else
+	*p++ = 0;
+#endif
+
+	return p - response;
+}
+
+/* Polled by monitoring tools, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(usb_ep_stats, ID_DAP_VENDOR_USB_EP_STATS, usb_ep_stats, led_never, 0);
+#endif
+
+static uint16_t mem_hash_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct mem_region regions[DAP_VENDOR_MEM_HASH_MAX_REGIONS];
+	uint8_t count = request[1];
+	int ret;
+
+	if (count == 0 || count > ARRAY_SIZE(regions)) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_SIZE;
+		return 2;
+	}
+
+	for (int i = 0; i < count; i++) {
+		regions[i].addr = sys_get_le32(&request[2 + i * 8]);
+		regions[i].len = sys_get_le32(&request[6 + i * 8]);
+	}
+
+	ret = mem_hash(request[0], regions, count, &response[2]);
+	if (ret < 0) {
+		response[1] = ret == -EINVAL ? -DAP_VENDOR_ERR_INVALID_ARG : -DAP_VENDOR_ERR_TARGET;
+		return 2;
+	}
+
+	response[1] = 0;
+
+	return 2 + ret;
+}
+
+DAP_VENDOR_CMD_DEFINE(mem_hash, ID_DAP_VENDOR_MEM_HASH, mem_hash_cmd, NULL,
+		      DAP_VENDOR_MEM_HASH_MAX_REGIONS);
+
+static int8_t offline_prog_err(int ret)
+{
+	switch (ret) {
+	case 0:
+		return 0;
+	case -EINVAL:
+		return -DAP_VENDOR_ERR_INVALID_ARG;
+	case -EFBIG:
+		return -DAP_VENDOR_ERR_INVALID_SIZE;
+	case -EBUSY:
+		return -DAP_VENDOR_ERR_BUSY;
+	case -EBADMSG:
+		return -DAP_VENDOR_ERR_CHECKSUM;
+	case -ENOENT:
+		return -DAP_VENDOR_ERR_NO_IMAGE;
+	default:
+		return -DAP_VENDOR_ERR_STORAGE;
+	}
+}
+
+static uint16_t image_write(const uint8_t *request, uint8_t *response)
+{
+	uint16_t len = sys_get_le16(&request[4]);
+
+	if (len > DAP_VENDOR_IMAGE_CHUNK_MAX) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_SIZE;
+		return 2;
+	}
+
+	response[1] = offline_prog_err(offline_prog_write(sys_get_le32(request), &request[6], len));
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(image_write, ID_DAP_VENDOR_IMAGE_WRITE, image_write, NULL,
+		      DAP_VENDOR_IMAGE_CHUNK_MAX);
+
+static uint16_t image_commit(const uint8_t *request, uint8_t *response)
+{
+	struct offline_prog_header header;
+
+	memcpy(&header, request, sizeof(header));
+	response[1] = offline_prog_err(offline_prog_commit(&header));
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(image_commit, ID_DAP_VENDOR_IMAGE_COMMIT, image_commit, NULL, 0);
+
+static uint16_t image_program(const uint8_t *request, uint8_t *response)
+{
+	struct offline_prog_status status;
+	int ret = 0;
+
+	if (request[0] == IMAGE_PROGRAM_START) {
+		ret = offline_prog_start();
+	}
+
+	offline_prog_status_get(&status);
+	response[1] = offline_prog_err(ret);
+	response[2] = status.state;
+	response[3] = status.error;
+	sys_put_le32(status.done, &response[4]);
+	sys_put_le32(status.total, &response[8]);
+
+	return 12;
+}
+
+/* Progress is polled, only flash the LED when starting */
+static bool image_program_led(const uint8_t *request)
+{
+	return request[0] == IMAGE_PROGRAM_START;
+}
+
+DAP_VENDOR_CMD_DEFINE(image_program, ID_DAP_VENDOR_IMAGE_PROGRAM, image_program,
+		      image_program_led, 0);
 
-	case ID_DAP_VENDOR_READ_IO:
-		ret = read_io(request[0]);
-		response[1] = ret;
+static uint16_t target_monitor_cmd(const uint8_t *request, uint8_t *response)
+{
+	target_monitor_configure(request[0], sys_get_le16(&request[1]));
+	response[1] = 0;
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(target_monitor, ID_DAP_VENDOR_TARGET_MONITOR, target_monitor_cmd, NULL, 0);
+
+static uint16_t target_event(const uint8_t *request, uint8_t *response)
+{
+	struct target_monitor_event event;
+	uint32_t timeout_ms = MIN(sys_get_le16(request), DAP_VENDOR_TARGET_EVENT_TIMEOUT_MAX);
+	uint8_t *p = &response[15];
+	int ret;
+
+	/* Blocks the DAP thread, the short cap keeps the other DAP commands responsive */
+	ret = target_monitor_wait(timeout_ms, &event);
+	if (ret == -ENODEV) {
+		response[1] = -DAP_VENDOR_ERR_TARGET;
+		return 2;
+	}
+
+	response[1] = 0;
+	response[2] = event.events;
+	response[3] = event.state;
+	sys_put_le32(event.timestamp_ms, &response[4]);
+	sys_put_le32(event.dhcsr, &response[8]);
+	sys_put_le32(event.dfsr, &response[12]);
+	response[14] = event.regs_valid ? TARGET_MONITOR_REG_COUNT : 0;
+	for (int i = 0; i < response[14]; i++) {
+		sys_put_le32(event.regs[i], p);
+		p += 4;
+	}
+
+	return p - response;
+}
+
+/* Long-polled while the target runs, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(target_event, ID_DAP_VENDOR_TARGET_EVENT, target_event, led_never,
+		      DAP_VENDOR_TARGET_EVENT_TIMEOUT_MAX);
+
+#if defined(CONFIG_APP_PC_SAMPLER)
+static uint16_t pc_sampler_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct pc_sampler_stats stats;
+	int ret = 0;
+
+	if (!(request[0] & PC_SAMPLER_FLAG_QUERY)) {
+		ret = pc_sampler_configure(request[0], request[1], sys_get_le32(&request[2]));
+	}
+
+	pc_sampler_stats_get(&stats);
+	response[1] = ret ? -DAP_VENDOR_ERR_INVALID_ARG : 0;
+	response[2] = stats.mode;
+	response[3] = stats.error;
+	sys_put_le32(stats.samples, &response[4]);
+	sys_put_le32(stats.idle, &response[8]);
+	sys_put_le32(stats.lost, &response[12]);
+	sys_put_le32(stats.skipped, &response[16]);
+
+	return 20;
+}
+
+static bool pc_sampler_led(const uint8_t *request)
+{
+	return !(request[0] & PC_SAMPLER_FLAG_QUERY);
+}
+
+DAP_VENDOR_CMD_DEFINE(pc_sampler, ID_DAP_VENDOR_PC_SAMPLER, pc_sampler_cmd, pc_sampler_led, 0);
+#endif
+
+#if defined(CONFIG_APP_RTT)
+static uint16_t rtt_control_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct rtt_status status;
+
+	if (!(request[0] & RTT_CONTROL_FLAG_QUERY)) {
+		rtt_run(request[0] & RTT_CONTROL_FLAG_RUN);
+	}
+
+	rtt_status_get(&status);
+	response[1] = 0;
+	response[2] = (status.running ? BIT(0) : 0) | (status.requested ? BIT(1) : 0);
+	sys_put_le32(status.cb_addr, &response[3]);
+
+	return 7;
+}
+
+/* Polled by hosts that read RTT over the mux, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(rtt_control, ID_DAP_VENDOR_RTT_CONTROL, rtt_control_cmd, led_never, 0);
+#endif
+
+static uint16_t swd_clock_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct swd_target_stats stats;
+	const uint32_t values[] = {0};
+	int ret = 0;
+
+	switch (request[0]) {
+	case SWD_CLOCK_READ:
+	case SWD_CLOCK_READ_CLEAR:
+		break;
+	case SWD_CLOCK_CALIBRATE:
+		ret = swd_target_calibrate(sys_get_le32(&request[1]), NULL);
+		break;
+	case SWD_CLOCK_FORGET:
+		ret = swd_target_clock_forget();
 		break;
+	default:
+		response[1] = -DAP_VENDOR_ERR_INVALID_ARG;
+		return 2;
+	}
 
-	case ID_DAP_VENDOR_REBOOT:
-		if (request[0]) {
-			k_work_init_delayable(&reboot_bootloader_work,
-					      reboot_bootloader_work_handler);
-			k_work_schedule(&reboot_bootloader_work, K_MSEC(REBOOT_DELAY_MS));
-			response[1] = 0;
-		} else {
-			/* Schedule a delayed reboot so the USB response can be sent */
-			k_work_init_delayable(&reboot_work, reboot_work_handler);
-			k_work_schedule(&reboot_work, K_MSEC(REBOOT_DELAY_MS));
-			response[1] = 0;
+	if (ret == -EIO || ret == -ENODEV) {
+		response[1] = -DAP_VENDOR_ERR_TARGET;
+	} else if (ret == -EBUSY) {
+		response[1] = -DAP_VENDOR_ERR_BUSY;
+	} else if (ret) {
+		response[1] = -DAP_VENDOR_ERR_STORAGE;
+	} else {
+		response[1] = 0;
+	}
+
+	swd_target_stats_get(&stats, request[0] == SWD_CLOCK_READ_CLEAR);
+	sys_put_le32(stats.idcode, &response[2]);
+	sys_put_le32(stats.host_clock, &response[6]);
+	sys_put_le32(stats.clock, &response[10]);
+	sys_put_le32(stats.clock_limit, &response[14]);
+	sys_put_le32(stats.transfers, &response[18]);
+	sys_put_le32(stats.waits, &response[22]);
+	sys_put_le32(stats.faults, &response[26]);
+	sys_put_le32(stats.errors, &response[30]);
+	sys_put_le32(stats.clamps, &response[34]);
+	sys_put_le32(stats.calibrations, &response[38]);
+	sys_put_le32(stats.calib_failures, &response[42]);
+	sys_put_le32(stats.calib_max_hz, &response[46]);
+	sys_put_le32(stats.calib_effective_hz, &response[50]);
+
+	return 54;
+}
+
+/* Statistics are polled, only flash the LED when calibrating */
+static bool swd_clock_led(const uint8_t *request)
+{
+	return request[0] == SWD_CLOCK_CALIBRATE;
+}
+
+DAP_VENDOR_CMD_DEFINE(swd_clock, ID_DAP_VENDOR_SWD_CLOCK, swd_clock_cmd, swd_clock_led, 0);
+
+static int8_t jtag_err(int ret)
+{
+	switch (ret) {
+	case 0:
+		return 0;
+	case -EINVAL:
+		return -DAP_VENDOR_ERR_INVALID_ARG;
+	case -EBUSY:
+		return -DAP_VENDOR_ERR_BUSY;
+	default:
+		return -DAP_VENDOR_ERR_TARGET;
+	}
+}
+
+static uint16_t jtag_connect(const uint8_t *request, uint8_t *response)
+{
+	int ret = jtag_chain_connect(sys_get_le32(&request[0]), request[4], &request[5]);
+
+	response[1] = jtag_err(ret);
+
+	return 2;
+}
+
+DAP_VENDOR_CMD_DEFINE(jtag_connect, ID_DAP_VENDOR_JTAG_CONNECT, jtag_connect, NULL, 0);
+
+static uint16_t jtag_sequence(const uint8_t *request, uint8_t *response)
+{
+	const uint8_t *req = &request[1];
+	uint8_t *resp = &response[2];
+	uint8_t info;
+	uint32_t bits;
+	int ret = 0;
+
+	for (uint8_t i = 0; i < request[0] && ret == 0; i++) {
+		info = *req++;
+		bits = info & JTAG_SEQUENCE_CYCLES_MASK;
+		bits = bits ? bits : 64;
+
+		ret = jtag_chain_shift(info & JTAG_SEQUENCE_TMS, req,
+				       (info & JTAG_SEQUENCE_TDO_CAPTURE) ? resp : NULL, bits);
+		req += DIV_ROUND_UP(bits, 8);
+		if (info & JTAG_SEQUENCE_TDO_CAPTURE) {
+			resp += DIV_ROUND_UP(bits, 8);
 		}
-		break;
+	}
+
+	response[1] = jtag_err(ret);
+
+	return ret ? 2 : resp - response;
+}
+
+/* Sent in bulk during scans, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(jtag_sequence, ID_DAP_VENDOR_JTAG_SEQUENCE, jtag_sequence, led_never, 0);
+
+static uint16_t jtag_idcode(const uint8_t *request, uint8_t *response)
+{
+	uint32_t idcode = 0;
+	int ret = jtag_chain_idcode(request[0], &idcode);
+
+	response[1] = jtag_err(ret);
+	sys_put_le32(idcode, &response[2]);
+
+	return 6;
+}
+
+DAP_VENDOR_CMD_DEFINE(jtag_idcode, ID_DAP_VENDOR_JTAG_IDCODE, jtag_idcode, NULL, 0);
+
+static uint16_t swd_targets(const uint8_t *request, uint8_t *response)
+{
+	uint32_t candidates[DAP_VENDOR_SWD_TARGETS_MAX];
+	struct swd_target_drop found[DAP_VENDOR_SWD_TARGETS_MAX];
+	struct swd_target_stats stats;
+	uint8_t count = request[1];
+	uint8_t *resp = &response[15];
+	int ret = 0;
 
-	case ID_DAP_VENDOR_READ_SETTINGS:
-		if (probe_settings != NULL) {
-			memcpy(&response[1], probe_settings, PROBE_SETTINGS_MAX_SIZE);
-			response_len = PROBE_SETTINGS_MAX_SIZE + 1;
-		} else {
-			response[1] = -1;
-			response_len = 1;
+	if (count > DAP_VENDOR_SWD_TARGETS_MAX) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_SIZE;
+		return 2;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		candidates[i] = sys_get_le32(&request[2 + i * 4]);
+	}
+
+	if (count > 0) {
+		ret = swd_target_enumerate(candidates, count,
+					   request[0] & SWD_TARGETS_FLAG_INSTANCES, found,
+					   ARRAY_SIZE(found));
+	}
+
+	if (ret < 0) {
+		response[1] = ret == -EBUSY ? -DAP_VENDOR_ERR_BUSY : -DAP_VENDOR_ERR_TARGET;
+		return 2;
+	}
+
+	swd_target_stats_get(&stats, false);
+	response[1] = 0;
+	sys_put_le32(stats.targetsel, &response[2]);
+	sys_put_le32(stats.reselects, &response[6]);
+	sys_put_le32(stats.reselects_skipped, &response[10]);
+	response[14] = ret;
+	for (int i = 0; i < ret; i++) {
+		sys_put_le32(found[i].targetsel, &resp[0]);
+		sys_put_le32(found[i].idcode, &resp[4]);
+		sys_put_le32(found[i].targetid, &resp[8]);
+		resp += 12;
+	}
+
+	return resp - response;
+}
+
+/* Counters are polled, only flash the LED when enumerating */
+static bool swd_targets_led(const uint8_t *request)
+{
+	return request[1] > 0;
+}
+
+DAP_VENDOR_CMD_DEFINE(swd_targets, ID_DAP_VENDOR_SWD_TARGETS, swd_targets, swd_targets_led,
+		      DAP_VENDOR_SWD_TARGETS_MAX);
+
+#if defined(CONFIG_APP_IO_BUS)
+static int8_t io_bus_err(int ret)
+{
+	switch (ret) {
+	case 0:
+		return 0;
+	case -EINVAL:
+	case -ENOTCONN:
+		return -DAP_VENDOR_ERR_INVALID_ARG;
+	case -EMSGSIZE:
+		return -DAP_VENDOR_ERR_INVALID_SIZE;
+	case -EBUSY:
+		return -DAP_VENDOR_ERR_BUSY;
+	default:
+		return -DAP_VENDOR_ERR_TARGET;
+	}
+}
+
+static uint16_t io_bus_config_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct io_bus_config config = {
+		.mode = request[0],
+		.spi_mode = request[1],
+		.frequency = sys_get_le32(&request[2]),
+	};
+	uint32_t frequency = 0;
+
+	memcpy(config.pins, &request[6], sizeof(config.pins));
+	response[1] = io_bus_err(io_bus_configure(&config, &frequency));
+	sys_put_le32(frequency, &response[2]);
+
+	return 6;
+}
+
+DAP_VENDOR_CMD_DEFINE(io_bus_config, ID_DAP_VENDOR_IO_BUS_CONFIG, io_bus_config_cmd, NULL, 0);
+
+static uint16_t io_bus_batch_cmd(const uint8_t *request, uint8_t *response)
+{
+	size_t rx_len;
+	int ret;
+
+	ret = io_bus_batch(&request[1], IO_BUS_OPS_MAX, request[0], &response[3], IO_BUS_RX_MAX,
+			   &rx_len, &response[2]);
+	response[1] = io_bus_err(ret);
+
+	return 3 + rx_len;
+}
+
+/* Sent in bulk by fixtures, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(io_bus_batch, ID_DAP_VENDOR_IO_BUS_BATCH, io_bus_batch_cmd, led_never,
+		      IO_BUS_OPS_MAX);
+#endif
+
+static uint16_t boot_profile_cmd(const uint8_t *request, uint8_t *response)
+{
+	uint8_t *p = &response[3];
+
+	ARG_UNUSED(request);
+
+	response[1] = 0;
+	response[2] = BOOT_PHASE_COUNT;
+	for (int i = 0; i < BOOT_PHASE_COUNT; i++, p += 4) {
+		sys_put_le32(boot_profile_get(i), p);
+	}
+
+	return p - response;
+}
+
+DAP_VENDOR_CMD_DEFINE(boot_profile, ID_DAP_VENDOR_BOOT_PROFILE, boot_profile_cmd, led_never, 0);
+
+#if defined(CONFIG_APP_ADC_CAPTURE)
+static uint16_t adc_capture_cmd(const uint8_t *request, uint8_t *response)
+{
+	struct adc_capture_reduction reduction[ADC_CAPTURE_CHANNELS_MAX];
+	struct adc_capture_stats stats;
+	uint8_t *p = &response[4];
+	int ret = 0;
+
+	if (!(request[0] & ADC_CAPTURE_FLAG_QUERY)) {
+		struct adc_capture_config config = {
+			.flags = request[0],
+			.channels = request[1],
+			.rate_hz = sys_get_le32(&request[2]),
+			.trigger_channel = request[6],
+			.trigger_level = sys_get_le16(&request[7]),
+			.post_rounds = sys_get_le32(&request[9]),
+		};
+
+		ret = adc_capture_configure(&config);
+	}
+
+	adc_capture_stats_get(&stats);
+	adc_capture_reduction_get(reduction);
+	if (ret == -ENODEV) {
+		response[1] = -DAP_VENDOR_ERR_INVALID_IO;
+	} else if (ret == -EBUSY) {
+		response[1] = -DAP_VENDOR_ERR_BUSY;
+	} else {
+		response[1] = ret ? -DAP_VENDOR_ERR_INVALID_ARG : 0;
+	}
+
+	response[2] = stats.state;
+	response[3] = stats.error;
+	sys_put_le32(stats.rounds, p);
+	sys_put_le32(stats.overruns, p + 4);
+	sys_put_le32(stats.trigger_round, p + 8);
+	sys_put_le32(stats.rate_hz, p + 12);
+	p += 16;
+
+	for (int i = 0; i < ADC_CAPTURE_CHANNELS_MAX; i++, p += 10) {
+		sys_put_le16(reduction[i].min_mv, p);
+		sys_put_le16(reduction[i].max_mv, p + 2);
+		sys_put_le16(reduction[i].mean_mv, p + 4);
+		sys_put_le32(reduction[i].samples, p + 6);
+	}
+
+	return p - response;
+}
+
+static bool adc_capture_led(const uint8_t *request)
+{
+	return !(request[0] & ADC_CAPTURE_FLAG_QUERY);
+}
+
+DAP_VENDOR_CMD_DEFINE(adc_capture, ID_DAP_VENDOR_ADC_CAPTURE, adc_capture_cmd, adc_capture_led,
+		      0);
+#endif
+
+static uint16_t capabilities_cmd(const uint8_t *request, uint8_t *response)
+{
+	uint32_t supported = 0;
+	uint8_t *p = &response[11];
+
+	ARG_UNUSED(request);
+
+	response[10] = 0;
+	STRUCT_SECTION_FOREACH(dap_vendor_cmd, cmd) {
+		supported |= BIT(cmd->id - ID_DAP_VENDOR0);
+		if (cmd->limit != 0) {
+			p[0] = cmd->id;
+			sys_put_le16(cmd->limit, &p[1]);
+			p += 3;
+			response[10]++;
 		}
-		break;
+	}
+
+	response[1] = 0;
+	sys_put_le32(supported, &response[2]);
+	sys_put_le16(CONFIG_DAP_BACKEND_USB_MAX_PACKET_SIZE, &response[6]);
+	sys_put_le16(uart_bridge_buf_size_min(), &response[8]);
 
-	case ID_DAP_VENDOR_WRITE_SETTINGS:
-		temp = request[0];
-		if (temp > PROBE_SETTINGS_MAX_SIZE) {
-			ret = -DAP_VENDOR_ERR_INVALID_SIZE;
-			response[1] = ret;
-		} else {
-			ret = write_internal_settings((const probe_settings_ut *)(request + 1),
-						      (uint16_t)temp);
-			response[1] = ret;
+	return p - response;
+}
+
+/* Polled on every connect, do not flash the LED */
+DAP_VENDOR_CMD_DEFINE(capabilities, ID_DAP_VENDOR_CAPABILITIES, capabilities_cmd, led_never, 0);
+
+static int dap_vendor_init(void)
+{
+	STRUCT_SECTION_FOREACH(dap_vendor_cmd, cmd) {
+		if (cmd->id < ID_DAP_VENDOR0 || cmd->id > ID_DAP_VENDOR31) {
+			LOG_ERR("Vendor command 0x%02X out of range", cmd->id);
+			continue;
 		}
-		break;
 
-	default:
-		flash_led = false;
+		if (cmd_table[cmd->id - ID_DAP_VENDOR0] != NULL) {
+			LOG_ERR("Vendor command 0x%02X registered twice", cmd->id);
+			continue;
+		}
+
+		cmd_table[cmd->id - ID_DAP_VENDOR0] = cmd;
+	}
+
+	return 0;
+}
+
+SYS_INIT(dap_vendor_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+uint16_t dap_vendor_cmd_handler(uint8_t cmd_id, const uint8_t *request, uint8_t *response)
+{
+	const struct dap_vendor_cmd *cmd = NULL;
+	uint16_t response_len;
+
+	/* First byte is always the command ID */
+	response[0] = cmd_id;
+
+	if (cmd_id >= ID_DAP_VENDOR0 && cmd_id <= ID_DAP_VENDOR31) {
+		cmd = cmd_table[cmd_id - ID_DAP_VENDOR0];
+	}
+
+	if (cmd == NULL) {
 		LOG_WRN("Unknown vendor command: 0x%02X", cmd_id);
 		/* Unknown vendor command */
 		response[0] = ID_DAP_INVALID;
-		response_len = 1;
-		break;
+		return 1;
 	}
 
-	if (flash_led) {
+	response_len = cmd->handler(request, response);
+	if (cmd->flash_led == NULL || cmd->flash_led(request)) {
 		led_send_action((led_action_t *)&LED_GREEN_FLASH);
 	}
 
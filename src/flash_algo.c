@@ -0,0 +1,110 @@
+/**
+ * @file flash_algo.c
+ * @brief Runner for CMSIS-Pack flash algorithms on the target
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "flash_algo.h"
+#include "swd_target.h"
+#include "target_cortexm.h"
+
+LOG_MODULE_REGISTER(flash_algo, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define POLL_INTERVAL_US 200
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int flash_algo_start(const struct flash_algo *algo, uint32_t pc, uint32_t r0, uint32_t r1,
+		     uint32_t r2)
+{
+	int ret;
+
+	ret = swd_target_begin(0);
+	if (ret) {
+		return ret;
+	}
+
+	ret = cortexm_reg_write(CORTEXM_REG_R0, r0);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_R1, r1);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_R2, r2);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_R9, algo->static_base);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_SP, algo->begin_stack);
+	/* Return to the breakpoint at the start of the blob */
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_LR, algo->load_address + 1);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_PC, pc);
+	ret = ret ? ret : cortexm_reg_write(CORTEXM_REG_XPSR, XPSR_T);
+	ret = ret ? ret : cortexm_resume();
+	swd_target_end();
+
+	return ret ? -EIO : 0;
+}
+
+int flash_algo_wait(const struct flash_algo *algo, uint32_t timeout_ms)
+{
+	int64_t deadline = k_uptime_get() + timeout_ms;
+	uint32_t dhcsr;
+	uint32_t pc;
+	uint32_t r0;
+	int ret;
+
+	do {
+		ret = swd_target_begin(0);
+		if (ret) {
+			return ret;
+		}
+
+		ret = cortexm_status(&dhcsr);
+		if (ret == 0 && (dhcsr & DHCSR_S_HALT)) {
+			ret = cortexm_reg_read(CORTEXM_REG_PC, &pc);
+			ret = ret ? ret : cortexm_reg_read(CORTEXM_REG_R0, &r0);
+			swd_target_end();
+			if (ret) {
+				return -EIO;
+			}
+
+			if (pc != algo->load_address || r0 != 0) {
+				LOG_ERR("algorithm failed, pc 0x%08x r0 0x%08x", pc, r0);
+				return -EFAULT;
+			}
+
+			return 0;
+		}
+
+		swd_target_end();
+		if (ret) {
+			return -EIO;
+		}
+
+		k_usleep(POLL_INTERVAL_US);
+	} while (k_uptime_get() < deadline);
+
+	/* Do not leave the algorithm running */
+	if (swd_target_begin(0) == 0) {
+		(void)cortexm_halt();
+		swd_target_end();
+	}
+
+	return -ETIMEDOUT;
+}
+
+int flash_algo_call(const struct flash_algo *algo, uint32_t pc, uint32_t r0, uint32_t r1,
+		    uint32_t r2, uint32_t timeout_ms)
+{
+	int ret;
+
+	ret = flash_algo_start(algo, pc, r0, r1, r2);
+
+	return ret ? ret : flash_algo_wait(algo, timeout_ms);
+}
@@ -0,0 +1,193 @@
+/**
+ * @file jtag_chain.c
+ * @brief JTAG scan chain access for the CMSIS-DAP JTAG vendor commands
+ *
+ * Only used from the CMSIS-DAP thread, so there is no locking.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "jtag.h"
+#include "jtag_chain.h"
+#include "swd_target.h"
+
+LOG_MODULE_REGISTER(jtag_chain, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define IR_LENGTH_MAX 32
+#define IR_SCAN_BYTES DIV_ROUND_UP(JTAG_CHAIN_TAPS_MAX * IR_LENGTH_MAX, 8)
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct device *const jtag_dev = DEVICE_DT_GET_OR_NULL(DT_CHOSEN(rfpros_jtag));
+
+static bool connected;
+static uint8_t tap_count;
+static uint8_t ir_length[JTAG_CHAIN_TAPS_MAX];
+/* Sum of the IR lengths of the TAPs closer to TDO */
+static uint16_t ir_before[JTAG_CHAIN_TAPS_MAX];
+static uint16_t ir_total;
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static void set_bits(uint8_t *buf, uint32_t pos, uint32_t val, uint32_t len)
+{
+	for (uint32_t i = 0; i < len; i++, pos++) {
+		WRITE_BIT(buf[pos / 8], pos % 8, (val >> i) & 1);
+	}
+}
+
+static uint32_t get_bits(const uint8_t *buf, uint32_t pos, uint32_t len)
+{
+	uint32_t val = 0;
+
+	for (uint32_t i = 0; i < len; i++, pos++) {
+		val |= (uint32_t)((buf[pos / 8] >> (pos % 8)) & 1) << i;
+	}
+
+	return val;
+}
+
+static int tms_path(uint8_t path, uint8_t len)
+{
+	int ret = 0;
+
+	/* One TCK per TMS bit, LSB first */
+	for (uint8_t i = 0; i < len && ret == 0; i++) {
+		ret = jtag_shift(jtag_dev, (path >> i) & 1, NULL, NULL, 1);
+	}
+
+	return ret;
+}
+
+static int scan(const uint8_t *tdi, uint8_t *tdo, uint32_t bits)
+{
+	uint8_t last_in = tdi != NULL ? (tdi[(bits - 1) / 8] >> ((bits - 1) % 8)) & 1 : 1;
+	uint8_t last_out = 0;
+	int ret;
+
+	/* All bits but the last in Shift, the last one moves to Exit1 */
+	ret = bits > 1 ? jtag_shift(jtag_dev, false, tdi, tdo, bits - 1) : 0;
+	ret = ret ? ret : jtag_shift(jtag_dev, true, &last_in, &last_out, 1);
+	if (ret == 0 && tdo != NULL) {
+		WRITE_BIT(tdo[(bits - 1) / 8], (bits - 1) % 8, last_out);
+	}
+
+	return ret;
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int jtag_chain_connect(uint32_t clock, uint8_t count, const uint8_t *ir_lengths)
+{
+	uint16_t total = 0;
+	int ret;
+
+	if (jtag_dev == NULL || !device_is_ready(jtag_dev)) {
+		return -ENODEV;
+	}
+
+	if (clock == 0) {
+		if (connected) {
+			(void)jtag_port_off(jtag_dev);
+			swd_target_lend(false);
+			connected = false;
+		}
+
+		return 0;
+	}
+
+	if (count > JTAG_CHAIN_TAPS_MAX) {
+		return -EINVAL;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		if (ir_lengths[i] == 0 || ir_lengths[i] > IR_LENGTH_MAX) {
+			return -EINVAL;
+		}
+
+		ir_before[i] = total;
+		ir_length[i] = ir_lengths[i];
+		total += ir_lengths[i];
+	}
+
+	tap_count = count;
+	ir_total = total;
+
+	if (!connected) {
+		swd_target_lend(true);
+		ret = jtag_port_on(jtag_dev);
+		if (ret) {
+			swd_target_lend(false);
+			return ret;
+		}
+
+		connected = true;
+	}
+
+	ret = jtag_set_clock(jtag_dev, clock);
+	LOG_DBG("connected, %u TAPs, %u IR bits", tap_count, ir_total);
+
+	return ret;
+}
+
+int jtag_chain_shift(bool tms, const uint8_t *tdi, uint8_t *tdo, uint32_t bits)
+{
+	if (!connected) {
+		return -ENOTCONN;
+	}
+
+	return jtag_shift(jtag_dev, tms, tdi, tdo, bits);
+}
+
+int jtag_chain_idcode(uint8_t index, uint32_t *idcode)
+{
+	uint8_t buf[IR_SCAN_BYTES];
+	int ret;
+
+	if (!connected) {
+		return -ENOTCONN;
+	}
+
+	if (index >= tap_count) {
+		return -EINVAL;
+	}
+
+	/* IR scan: IDCODE for the TAP, all ones (BYPASS) for the others */
+	memset(buf, 0xFF, sizeof(buf));
+	set_bits(buf, ir_before[index], JTAG_CHAIN_IDCODE_INSTR, ir_length[index]);
+
+	/* Idle -> Select-DR -> Select-IR -> Capture-IR -> Shift-IR */
+	ret = tms_path(0x03, 4);
+	ret = ret ? ret : scan(buf, NULL, ir_total);
+	/* Exit1-IR -> Update-IR -> Idle */
+	ret = ret ? ret : tms_path(0x01, 2);
+
+	/* DR scan: one BYPASS bit per TAP closer to TDO, then the IDCODE */
+	/* Idle -> Select-DR -> Capture-DR -> Shift-DR */
+	ret = ret ? ret : tms_path(0x01, 3);
+	ret = ret ? ret : scan(NULL, buf, index + 32);
+	/* Exit1-DR -> Update-DR -> Idle */
+	ret = ret ? ret : tms_path(0x01, 2);
+	if (ret) {
+		return ret;
+	}
+
+	*idcode = get_bits(buf, index, 32);
+
+	return 0;
+}
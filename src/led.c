@@ -14,9 +14,12 @@ const struct device *const led_strip = DEVICE_DT_GET(DT_ALIAS(ledstrip0));
 static struct led_rgb led_status;
 /* New LED status to be applied */
 static struct led_rgb new_led_status;
-static struct k_work led_update_work;
 static struct k_spinlock led_status_lock;
 
+static void led_update_work_handler(struct k_work *work);
+/* Statically initialised, LED updates can be submitted before led_init() */
+static K_WORK_DEFINE(led_update_work, led_update_work_handler);
+
 ZBUS_CHAN_DEFINE(led_chan,                /* Name */
 		 led_action_t,            /* Message type */
 		 NULL,                    /* Validator */
@@ -183,8 +186,6 @@ int led_init(void)
 		return -ENODEV;
 	}
 
-	k_work_init(&led_update_work, led_update_work_handler);
-
 	/* Initialize LED strip to off */
 	set_led_color(led_strip, &led_status);
 	return 0;
@@ -23,17 +23,16 @@ LOG_MODULE_REGISTER(dvk_probe, CONFIG_DVK_PROBE_LOG_LEVEL);
 #include "led.h"
 #include "probe_settings.h"
 #include "dap_vendor.h"
+#include "swd_target.h"
+#include "offline_prog.h"
+#include "boot_profile.h"
 
 #define TARGET_RESET_PULSE_MS 50
 
 static struct usbd_context *app_usbd;
 
-#define DEVICE_DT_GET_COMMA(node_id) DEVICE_DT_GET(node_id),
-
-static const struct device *const swd_dev = DEVICE_DT_GET_ONE(zephyr_swdp_gpio);
-
-static const struct device *uart_bridges[] = {
-	DT_FOREACH_STATUS_OKAY(rfpros_uart_bridge, DEVICE_DT_GET_COMMA)};
+/* Proxy of the swdp-gpio port shared with the background engines, see swd_target.h */
+static const struct device *const swd_dev = DEVICE_GET(swd_target);
 
 /* Get the node ID of gpio_dynamic */
 #define GPIO_DYNAMIC_NODE DT_PATH(gpio_dynamic)
@@ -50,19 +49,52 @@ static const struct gpio_dt_spec gpios[] = {
 static const struct gpio_dt_spec target_reset_gpio =
 	GPIO_DT_SPEC_GET(SWDP_NODE, reset_gpios);
 
+/* Releases the target reset while the rest of the boot goes on */
+static void target_reset_release(struct k_timer *timer);
+static K_TIMER_DEFINE(target_reset_timer, target_reset_release, NULL);
+
 ZBUS_CHAN_DECLARE(led_chan);
 ZBUS_SUBSCRIBER_DEFINE(led_sub, 8);
 
+/* Target data arrived while the bus is suspended, needs the host to have enabled remote wakeup */
+static void usb_remote_wakeup(void)
+{
+	int err;
+
+	if (!usbd_is_suspended(app_usbd)) {
+		return;
+	}
+
+	err = usbd_wakeup_request(app_usbd);
+	if (err) {
+		LOG_DBG("Remote wakeup not possible: %d", err);
+	}
+}
+
 static void usbd_msg_cb(struct usbd_context *const ctx, const struct usbd_msg *msg)
 {
 	uint32_t line_ctrl_status;
-	uint8_t dev_idx;
+	const struct device *bridge_dev;
 	const struct device *uart_dev = NULL;
 	int ret;
 	struct uart_config peer_cfg;
 
 	LOG_DBG("USBD message: %s", usbd_msg_type_string(msg->type));
 
+	if (msg->type == USBD_MSG_CONFIGURATION) {
+		boot_profile_mark(BOOT_PHASE_USB_CONFIGURED);
+	}
+
+	/* The bridges keep their host port state, no DTR toggle is needed after a resume */
+	if (msg->type == USBD_MSG_SUSPEND) {
+		uart_bridge_usb_suspend(
+			IS_ENABLED(CONFIG_APP_USBD_REMOTE_WAKEUP) ? usb_remote_wakeup : NULL);
+	}
+
+	if (msg->type == USBD_MSG_RESUME) {
+		uart_bridge_usb_resume();
+	}
+
 	if (usbd_can_detect_vbus(ctx)) {
 		if (msg->type == USBD_MSG_VBUS_READY) {
 			if (usbd_enable(ctx)) {
@@ -79,12 +111,9 @@ static void usbd_msg_cb(struct usbd_context *const ctx, const struct usbd_msg *m
 
 	if (msg->type == USBD_MSG_CDC_ACM_LINE_CODING ||
 	    msg->type == USBD_MSG_CDC_ACM_CONTROL_LINE_STATE) {
-		for (dev_idx = 0; dev_idx < ARRAY_SIZE(uart_bridges); dev_idx++) {
-			/* Find the matching device */
-			uart_dev = uart_bridge_get_peer(msg->dev, uart_bridges[dev_idx]);
-			if (uart_dev != NULL) {
-				break;
-			}
+		bridge_dev = uart_bridge_find(msg->dev);
+		if (bridge_dev != NULL) {
+			uart_dev = uart_bridge_get_peer(msg->dev, bridge_dev);
 		}
 
 		if (uart_dev == NULL) {
@@ -92,6 +121,11 @@ static void usbd_msg_cb(struct usbd_context *const ctx, const struct usbd_msg *m
 			return;
 		}
 
+		/* Apply target reset/boot pins before anything else, scripts rely on the timing */
+		if (msg->type == USBD_MSG_CDC_ACM_CONTROL_LINE_STATE) {
+			uart_bridge_modem_update(msg->dev, bridge_dev);
+		}
+
 		/* Get the current UART configuration of the USB CDC ACM device */
 		ret = uart_config_get(msg->dev, &peer_cfg);
 		if (ret != 0) {
@@ -104,10 +138,15 @@ static void usbd_msg_cb(struct usbd_context *const ctx, const struct usbd_msg *m
 		if (ret == 0) {
 			if (line_ctrl_status) {
 				LOG_INF("DTR set: enable UART bridge %s", uart_dev->name);
-				uart_bridge_settings_update(msg->dev, uart_bridges[dev_idx]);
-				peer_cfg.flow_ctrl = UART_CFG_FLOW_CTRL_RTS_CTS;
+				uart_bridge_settings_update(msg->dev, bridge_dev);
+				uart_bridge_attach(msg->dev, bridge_dev, true);
+				/* RS-485 transceivers have no handshake lines */
+				peer_cfg.flow_ctrl = uart_bridge_is_half_duplex(bridge_dev)
+							     ? UART_CFG_FLOW_CTRL_NONE
+							     : UART_CFG_FLOW_CTRL_RTS_CTS;
 			} else {
 				LOG_INF("DTR cleared: disable UART bridge %s", uart_dev->name);
+				uart_bridge_attach(msg->dev, bridge_dev, false);
 				/* This sets RTS back high when the USB UART is closed */
 				peer_cfg.flow_ctrl = UART_CFG_FLOW_CTRL_NONE;
 			}
@@ -118,12 +157,45 @@ static void usbd_msg_cb(struct usbd_context *const ctx, const struct usbd_msg *m
 					ret);
 				return;
 			}
+
+			uart_bridge_rx_tune(bridge_dev);
 		} else {
 			LOG_ERR("Failed to get DTR status: %d", ret);
 		}
 	}
 }
 
+static void target_reset_release(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	gpio_pin_set_dt(&target_reset_gpio, 0);
+	/* Set back to disconnected so DAP can control it */
+	gpio_pin_configure_dt(&target_reset_gpio, GPIO_DISCONNECTED);
+	boot_profile_mark(BOOT_PHASE_TARGET_RESET_RELEASED);
+}
+
+static bool target_reset_start(void)
+{
+	int err;
+
+	if (!gpio_is_ready_dt(&target_reset_gpio)) {
+		LOG_ERR("Target reset GPIO is not ready");
+		return false;
+	}
+
+	err = gpio_pin_configure_dt(&target_reset_gpio, GPIO_OUTPUT_ACTIVE);
+	if (err) {
+		LOG_ERR("Failed to configure target reset GPIO: %d", err);
+		return false;
+	}
+
+	LOG_DBG("Asserting target reset");
+	k_timer_start(&target_reset_timer, K_MSEC(TARGET_RESET_PULSE_MS), K_NO_WAIT);
+
+	return true;
+}
+
 int main(void)
 {
 	int err;
@@ -136,6 +208,9 @@ int main(void)
 	};
 	led_action_t msg_led_action;
 	const struct zbus_channel *chan;
+	bool target_reset;
+
+	boot_profile_mark(BOOT_PHASE_MAIN);
 
 	for (size_t i = 0; i < ARRAY_SIZE(gpios); i++) {
 		if (gpio_pin_configure_dt(&gpios[i], GPIO_DISCONNECTED) != 0) {
@@ -143,6 +218,7 @@ int main(void)
 		}
 	}
 
+	/* Before USB, the bridges drive the activity LEDs as soon as a port opens */
 	if (led_init() != 0) {
 		LOG_ERR("LED strip device %s is not ready", led_strip->name);
 		return -ENODEV;
@@ -161,6 +237,11 @@ int main(void)
 		LOG_ERR("Failed to register vendor command callback: %d", err);
 	}
 
+	boot_profile_mark(BOOT_PHASE_DAP_READY);
+
+	/* Reset target device on boot, the pulse runs while USB comes up */
+	target_reset = target_reset_start();
+
 	/* Initialize probe settings */
 	probe_settings_init();
 
@@ -177,6 +258,11 @@ int main(void)
 		}
 	}
 
+	/* Target UARTs run at their saved baud rate before a host attaches */
+	uart_bridge_defaults_apply();
+
+	boot_profile_mark(BOOT_PHASE_SETTINGS_LOADED);
+
 	app_usbd = app_usbd_setup_device(usbd_msg_cb);
 	if (app_usbd == NULL) {
 		LOG_ERR("Failed to setup USB device");
@@ -197,23 +283,6 @@ int main(void)
 			probe_settings->v2.usb_pid);
 	}
 
-	/* Reset target device on boot */
-	if (!gpio_is_ready_dt(&target_reset_gpio)) {
-		LOG_ERR("Target reset GPIO is not ready");
-	} else {
-		err = gpio_pin_configure_dt(&target_reset_gpio, GPIO_OUTPUT_ACTIVE);
-		if (err) {
-			LOG_ERR("Failed to configure target reset GPIO: %d", err);
-		} else {
-			LOG_DBG("Asserting target reset");
-			k_msleep(TARGET_RESET_PULSE_MS);
-			gpio_pin_set_dt(&target_reset_gpio, 0);
-			LOG_DBG("Released target reset");
-			/* Set back to disconnected so DAP can control it */
-			gpio_pin_configure_dt(&target_reset_gpio, GPIO_DISCONNECTED);
-		}
-	}
-
 	/* Initialize USB device */
 	err = usbd_init(app_usbd);
 	if (err) {
@@ -221,6 +290,8 @@ int main(void)
 		return err;
 	}
 
+	boot_profile_mark(BOOT_PHASE_USB_INIT);
+
 	if (!usbd_can_detect_vbus(app_usbd)) {
 		err = usbd_enable(app_usbd);
 		if (err) {
@@ -229,9 +300,20 @@ int main(void)
 		}
 	}
 
+	boot_profile_mark(BOOT_PHASE_USB_ENABLED);
 	LOG_INF("USB device support enabled");
 
-	/* Flash LED to indicate boot */
+	/* The target must be out of reset before offline programming can start */
+	if (target_reset) {
+		(void)k_timer_status_sync(&target_reset_timer);
+		LOG_DBG("Released target reset");
+	}
+
+	/* Offline programming may start here if the stored image asks for it */
+	offline_prog_init();
+	boot_profile_mark(BOOT_PHASE_OFFLINE_PROG_READY);
+
+	/* Flash LED to indicate boot, after enumeration so it does not delay it */
 	led_send_action(&led_boot_action);
 
 	/* Main loop to process LED actions */
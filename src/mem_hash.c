@@ -0,0 +1,91 @@
+/**
+ * @file mem_hash.c
+ * @brief Digest of target memory computed on the probe
+ *
+ * Target memory is streamed through MEM-AP block reads in chunks, each chunk is its own
+ * swd_target batch so that the RTT engine can still run during a long verify.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/logging/log.h>
+#include "mem_hash.h"
+#include "sha256.h"
+#include "swd_target.h"
+
+LOG_MODULE_REGISTER(mem_hash, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define MEM_HASH_CHUNK 1024
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static uint8_t chunk_buf[MEM_HASH_CHUNK];
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int mem_hash(enum mem_hash_algo algo, const struct mem_region *regions, size_t count,
+	     uint8_t *digest)
+{
+	struct sha256_ctx sha;
+	uint32_t crc = 0;
+	uint32_t addr;
+	uint32_t left;
+	uint32_t n;
+	int ret;
+
+	if (algo == MEM_HASH_SHA256) {
+		sha256_init(&sha);
+	} else if (algo != MEM_HASH_CRC32) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		addr = regions[i].addr;
+		left = regions[i].len;
+		while (left > 0) {
+			n = MIN(left, sizeof(chunk_buf));
+			/* Called on behalf of the host, no need to wait for it to go idle */
+			ret = swd_target_begin(0);
+			if (ret == 0) {
+				ret = swd_target_mem_read(addr, chunk_buf, n);
+				swd_target_end();
+			}
+
+			if (ret) {
+				LOG_WRN("read failed at 0x%08x: %d", addr, ret);
+				return -EIO;
+			}
+
+			if (algo == MEM_HASH_SHA256) {
+				sha256_update(&sha, chunk_buf, n);
+			} else {
+				crc = crc32_ieee_update(crc, chunk_buf, n);
+			}
+
+			addr += n;
+			left -= n;
+		}
+	}
+
+	if (algo == MEM_HASH_SHA256) {
+		sha256_final(&sha, digest);
+		return SHA256_DIGEST_SIZE;
+	}
+
+	sys_put_le32(crc, digest);
+
+	return sizeof(crc);
+}
@@ -0,0 +1,567 @@
+/**
+ * @file offline_prog.c
+ * @brief Standalone target programming from an image stored on the probe
+ *
+ * The image partition holds the image description in its first sector, followed by the
+ * uploaded data. Programming halts the target through a reset, loads the flash algorithm,
+ * erases the sectors covered by the image and programs it page by page. With two page buffers
+ * the next page is written to target RAM while the algorithm programs the current one. The
+ * result is checked with a CRC32 of the target flash computed on the probe.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "offline_prog.h"
+#include "flash_algo.h"
+#include "led.h"
+#include "mem_hash.h"
+#include "swd_target.h"
+#include "target_cortexm.h"
+
+LOG_MODULE_REGISTER(offline_prog, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define IMAGE_PARTITION_ID FIXED_PARTITION_ID(image_partition)
+#define IMAGE_SECTOR_SIZE  4096
+#define IMAGE_DATA_OFFSET  IMAGE_SECTOR_SIZE
+
+#define OFFLINE_PROG_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(rfpros_offline_prog)
+#define HAS_TRIGGER_GPIO  DT_NODE_HAS_PROP(OFFLINE_PROG_NODE, trigger_gpios)
+
+#define RESET_TIMEOUT_MS   500
+#define INIT_TIMEOUT_MS    1000
+#define ERASE_TIMEOUT_MS   3000
+#define PROGRAM_TIMEOUT_MS 1000
+
+/* Flash the LED every 1/PROGRESS_STEPS of the image */
+#define PROGRESS_STEPS 10
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct flash_area *image_area;
+
+/* Held during an upload command and for a whole programming run */
+static K_MUTEX_DEFINE(image_lock);
+static K_SEM_DEFINE(prog_sem, 0, 1);
+static atomic_t prog_busy;
+
+static struct offline_prog_header header;
+static bool header_valid;
+static uint32_t upload_size;
+static uint32_t erased_end;
+
+static struct k_spinlock status_lock;
+static struct offline_prog_status status;
+
+static uint8_t page_buf[CONFIG_APP_OFFLINE_PROG_PAGE_SIZE_MAX];
+
+#if HAS_TRIGGER_GPIO
+static const struct gpio_dt_spec trigger_gpio = GPIO_DT_SPEC_GET(OFFLINE_PROG_NODE, trigger_gpios);
+static struct gpio_callback trigger_cb;
+#endif
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static void status_set(enum offline_prog_state state, uint32_t done, uint32_t total)
+{
+	k_spinlock_key_t key = k_spin_lock(&status_lock);
+
+	status.state = state;
+	status.error = 0;
+	status.done = done;
+	status.total = total;
+	k_spin_unlock(&status_lock, key);
+}
+
+static void status_end(int error)
+{
+	k_spinlock_key_t key = k_spin_lock(&status_lock);
+
+	status.state = error ? OFFLINE_PROG_FAILED : OFFLINE_PROG_DONE;
+	status.error = error;
+	k_spin_unlock(&status_lock, key);
+}
+
+static void status_done_set(uint32_t done)
+{
+	k_spinlock_key_t key = k_spin_lock(&status_lock);
+
+	status.done = done;
+	k_spin_unlock(&status_lock, key);
+}
+
+static bool header_check(const struct offline_prog_header *h)
+{
+	const struct flash_algo *algo = &h->algo;
+
+	return h->magic == OFFLINE_PROG_MAGIC && h->version == OFFLINE_PROG_VERSION &&
+	       h->data_size <= image_area->fa_size - IMAGE_DATA_OFFSET &&
+	       h->image_offset < h->data_size && (h->image_offset % 4) == 0 &&
+	       algo->page_size > 0 && algo->page_size <= sizeof(page_buf) &&
+	       (algo->page_size % 4) == 0 && algo->sector_size >= algo->page_size &&
+	       (algo->sector_size % algo->page_size) == 0 &&
+	       (h->image_address % algo->page_size) == 0 && algo->page_buffers[0] != 0;
+}
+
+static int data_crc(uint32_t size, uint32_t *crc)
+{
+	uint32_t n;
+	int ret;
+
+	*crc = 0;
+	for (uint32_t off = 0; off < size; off += n) {
+		n = MIN(size - off, sizeof(page_buf));
+		ret = flash_area_read(image_area, IMAGE_DATA_OFFSET + off, page_buf, n);
+		if (ret) {
+			return ret;
+		}
+
+		*crc = crc32_ieee_update(*crc, page_buf, n);
+	}
+
+	return 0;
+}
+
+static int reset_halt(void)
+{
+	int64_t deadline;
+	uint32_t dhcsr = 0;
+	uint32_t demcr;
+	int ret;
+
+	ret = swd_target_begin(0);
+	if (ret) {
+		return ret;
+	}
+
+	ret = cortexm_reset(true);
+	swd_target_end();
+	if (ret) {
+		return ret;
+	}
+
+	deadline = k_uptime_get() + RESET_TIMEOUT_MS;
+	do {
+		k_msleep(1);
+		if (swd_target_begin(0) == 0) {
+			ret = cortexm_status(&dhcsr);
+			swd_target_end();
+		}
+	} while (!(dhcsr & DHCSR_S_HALT) && k_uptime_get() < deadline);
+
+	ret = swd_target_begin(0);
+	if (ret) {
+		return ret;
+	}
+
+	/* Some targets do not stop on the reset vector, halt them wherever they are */
+	ret = (dhcsr & DHCSR_S_HALT) ? 0 : cortexm_halt();
+	ret = ret ? ret : swd_target_mem_read32(CORTEXM_DEMCR, &demcr);
+	ret = ret ? ret : swd_target_mem_write32(CORTEXM_DEMCR, demcr & ~DEMCR_VC_CORERESET);
+	swd_target_end();
+
+	return ret;
+}
+
+static int load_algo(void)
+{
+	uint32_t n;
+	int ret;
+
+	for (uint32_t off = 0; off < header.image_offset; off += n) {
+		n = MIN(header.image_offset - off, sizeof(page_buf));
+		ret = flash_area_read(image_area, IMAGE_DATA_OFFSET + off, page_buf, n);
+		if (ret) {
+			return ret;
+		}
+
+		ret = swd_target_begin(0);
+		if (ret) {
+			return ret;
+		}
+
+		ret = swd_target_mem_write(header.algo.load_address + off, page_buf, n);
+		swd_target_end();
+		if (ret) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int load_page(uint32_t offset, uint32_t target_buf, uint32_t *crc)
+{
+	uint32_t image_size = header.data_size - header.image_offset;
+	uint32_t page_size = header.algo.page_size;
+	uint32_t n = MIN(page_size, image_size - offset);
+	int ret;
+
+	ret = flash_area_read(image_area, IMAGE_DATA_OFFSET + header.image_offset + offset,
+			      page_buf, n);
+	if (ret) {
+		return ret;
+	}
+
+	/* Pad the last page with the erased value */
+	memset(&page_buf[n], 0xff, page_size - n);
+	*crc = crc32_ieee_update(*crc, page_buf, n);
+
+	ret = swd_target_begin(0);
+	if (ret) {
+		return ret;
+	}
+
+	ret = swd_target_mem_write(target_buf, page_buf, page_size);
+	swd_target_end();
+
+	return ret;
+}
+
+static int erase_sectors(void)
+{
+	const struct flash_algo *algo = &header.algo;
+	uint32_t image_end = header.image_address + header.data_size - header.image_offset;
+	uint32_t start = ROUND_DOWN(header.image_address, algo->sector_size);
+	int ret;
+
+	status_set(OFFLINE_PROG_ERASE, 0, image_end - start);
+	ret = flash_algo_call(algo, algo->pc_init, header.image_address, 0, FLASH_ALGO_FNC_ERASE,
+			      INIT_TIMEOUT_MS);
+	for (uint32_t addr = start; addr < image_end && ret == 0; addr += algo->sector_size) {
+		ret = flash_algo_call(algo, algo->pc_erase_sector, addr, 0, 0, ERASE_TIMEOUT_MS);
+		status_done_set(MIN(addr + algo->sector_size, image_end) - start);
+	}
+
+	ret = ret ? ret
+		  : flash_algo_call(algo, algo->pc_uninit, FLASH_ALGO_FNC_ERASE, 0, 0,
+				    INIT_TIMEOUT_MS);
+
+	return ret;
+}
+
+static int program_pages(uint32_t *crc)
+{
+	const struct flash_algo *algo = &header.algo;
+	uint32_t image_size = header.data_size - header.image_offset;
+	uint32_t page_size = algo->page_size;
+	int buffers = algo->page_buffers[1] != 0 ? 2 : 1;
+	uint32_t progress_step = MAX(image_size / PROGRESS_STEPS, 1);
+	uint32_t next_progress = progress_step;
+	uint32_t offset = 0;
+	int buf = 0;
+	int ret;
+
+	status_set(OFFLINE_PROG_PROGRAM, 0, image_size);
+	ret = flash_algo_call(algo, algo->pc_init, header.image_address, 0,
+			      FLASH_ALGO_FNC_PROGRAM, INIT_TIMEOUT_MS);
+	ret = ret ? ret : load_page(0, algo->page_buffers[0], crc);
+	while (ret == 0 && offset < image_size) {
+		ret = flash_algo_start(algo, algo->pc_program_page, header.image_address + offset,
+				       page_size, algo->page_buffers[buf]);
+		if (ret) {
+			break;
+		}
+
+		/* Fill the other buffer while the target is busy with this one */
+		if (buffers == 2 && offset + page_size < image_size) {
+			ret = load_page(offset + page_size, algo->page_buffers[buf ^ 1], crc);
+		}
+
+		ret = ret ? ret : flash_algo_wait(algo, PROGRAM_TIMEOUT_MS);
+		offset += page_size;
+		if (buffers == 2) {
+			buf ^= 1;
+		} else if (ret == 0 && offset < image_size) {
+			ret = load_page(offset, algo->page_buffers[0], crc);
+		}
+
+		status_done_set(MIN(offset, image_size));
+		if (offset >= next_progress) {
+			next_progress += progress_step;
+			led_send_action((led_action_t *)&LED_BLUE_FLASH);
+		}
+	}
+
+	ret = ret ? ret
+		  : flash_algo_call(algo, algo->pc_uninit, FLASH_ALGO_FNC_PROGRAM, 0, 0,
+				    INIT_TIMEOUT_MS);
+
+	return ret;
+}
+
+static int verify_image(uint32_t crc)
+{
+	struct mem_region region = {
+		.addr = header.image_address,
+		.len = header.data_size - header.image_offset,
+	};
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+	int ret;
+
+	status_set(OFFLINE_PROG_VERIFY, 0, region.len);
+	ret = mem_hash(MEM_HASH_CRC32, &region, 1, digest);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (sys_get_le32(digest) != crc) {
+		LOG_ERR("verify failed, crc 0x%08x expected 0x%08x", sys_get_le32(digest), crc);
+		return -EBADMSG;
+	}
+
+	status_done_set(region.len);
+
+	return 0;
+}
+
+static int program_target(void)
+{
+	uint32_t crc;
+	int ret;
+
+	/* Catch a corrupted partition before touching the target */
+	ret = data_crc(header.data_size, &crc);
+	if (ret == 0 && crc != header.data_crc) {
+		ret = -EBADMSG;
+	}
+
+	ret = ret ? ret : reset_halt();
+	ret = ret ? ret : load_algo();
+	ret = ret ? ret : erase_sectors();
+	crc = 0;
+	ret = ret ? ret : program_pages(&crc);
+	ret = ret ? ret : verify_image(crc);
+	if (ret == 0 && swd_target_begin(0) == 0) {
+		/* Run the new image */
+		(void)cortexm_reset(false);
+		swd_target_end();
+	}
+
+	swd_target_release();
+
+	return ret;
+}
+
+static void offline_prog_thread_fn(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	int64_t start;
+	int ret;
+
+	while (1) {
+		k_sem_take(&prog_sem, K_FOREVER);
+		k_mutex_lock(&image_lock, K_FOREVER);
+		LOG_INF("programming %u bytes at 0x%08x", header.data_size - header.image_offset,
+			header.image_address);
+		start = k_uptime_get();
+		ret = program_target();
+		status_end(ret);
+		if (ret) {
+			LOG_ERR("programming failed: %d", ret);
+			led_send_action((led_action_t *)&LED_RED_FLASH);
+		} else {
+			LOG_INF("programming done in %lld ms", k_uptime_get() - start);
+			led_send_action((led_action_t *)&LED_GREEN_FLASH);
+		}
+
+		k_mutex_unlock(&image_lock);
+		/* Drop button presses made while busy */
+		k_sem_reset(&prog_sem);
+		atomic_clear(&prog_busy);
+	}
+}
+
+#if HAS_TRIGGER_GPIO
+static void trigger_handler(const struct device *port, struct gpio_callback *cb,
+			    gpio_port_pins_t pins)
+{
+	ARG_UNUSED(port);
+	ARG_UNUSED(cb);
+	ARG_UNUSED(pins);
+
+	(void)offline_prog_start();
+}
+
+static void trigger_init(void)
+{
+	int ret;
+
+	if (!gpio_is_ready_dt(&trigger_gpio)) {
+		LOG_ERR("Trigger GPIO is not ready");
+		return;
+	}
+
+	ret = gpio_pin_configure_dt(&trigger_gpio, GPIO_INPUT);
+	ret = ret ? ret : gpio_pin_interrupt_configure_dt(&trigger_gpio, GPIO_INT_EDGE_TO_ACTIVE);
+	if (ret) {
+		LOG_ERR("Failed to configure trigger GPIO: %d", ret);
+		return;
+	}
+
+	gpio_init_callback(&trigger_cb, trigger_handler, BIT(trigger_gpio.pin));
+	gpio_add_callback(trigger_gpio.port, &trigger_cb);
+}
+#endif
+
+K_THREAD_DEFINE(offline_prog_thread, CONFIG_APP_OFFLINE_PROG_STACK_SIZE, offline_prog_thread_fn,
+		NULL, NULL, NULL, CONFIG_APP_OFFLINE_PROG_THREAD_PRIORITY, 0, 0);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void offline_prog_init(void)
+{
+	int ret;
+
+	ret = flash_area_open(IMAGE_PARTITION_ID, &image_area);
+	if (ret < 0) {
+		LOG_ERR("Failed to open image partition: %d", ret);
+		image_area = NULL;
+		return;
+	}
+
+	ret = flash_area_read(image_area, 0, &header, sizeof(header));
+	header_valid = ret == 0 && header_check(&header);
+	if (header_valid) {
+		LOG_INF("Stored image: %u bytes at 0x%08x", header.data_size - header.image_offset,
+			header.image_address);
+	}
+
+#if HAS_TRIGGER_GPIO
+	trigger_init();
+#endif
+
+	if (header_valid && (header.flags & OFFLINE_PROG_FLAG_AT_BOOT)) {
+		(void)offline_prog_start();
+	}
+}
+
+int offline_prog_write(uint32_t offset, const uint8_t *data, size_t len)
+{
+	int ret = 0;
+
+	if (image_area == NULL) {
+		return -EIO;
+	}
+
+	if (k_mutex_lock(&image_lock, K_NO_WAIT) != 0) {
+		return -EBUSY;
+	}
+
+	if (offset == 0) {
+		/* New upload, the stored image is gone from here on */
+		header_valid = false;
+		upload_size = 0;
+		erased_end = IMAGE_DATA_OFFSET;
+		ret = flash_area_erase(image_area, 0, IMAGE_SECTOR_SIZE) ? -EIO : 0;
+	}
+
+	if (ret == 0 && offset != upload_size) {
+		ret = -EINVAL;
+	} else if (ret == 0 && IMAGE_DATA_OFFSET + offset + len > image_area->fa_size) {
+		ret = -EFBIG;
+	}
+
+	/* Erase ahead of the data so the upload itself stays a plain sequence of writes */
+	while (ret == 0 && IMAGE_DATA_OFFSET + offset + len > erased_end) {
+		ret = flash_area_erase(image_area, erased_end, IMAGE_SECTOR_SIZE) ? -EIO : 0;
+		erased_end += IMAGE_SECTOR_SIZE;
+	}
+
+	if (ret == 0 && flash_area_write(image_area, IMAGE_DATA_OFFSET + offset, data, len) != 0) {
+		ret = -EIO;
+	}
+
+	if (ret == 0) {
+		upload_size += len;
+	}
+
+	k_mutex_unlock(&image_lock);
+
+	return ret;
+}
+
+int offline_prog_commit(const struct offline_prog_header *h)
+{
+	uint32_t crc;
+	int ret;
+
+	if (image_area == NULL) {
+		return -EIO;
+	}
+
+	if (k_mutex_lock(&image_lock, K_NO_WAIT) != 0) {
+		return -EBUSY;
+	}
+
+	if (!header_check(h) || h->data_size != upload_size) {
+		ret = -EINVAL;
+	} else {
+		ret = data_crc(h->data_size, &crc) ? -EIO : 0;
+		if (ret == 0 && crc != h->data_crc) {
+			LOG_WRN("upload crc 0x%08x expected 0x%08x", crc, h->data_crc);
+			ret = -EBADMSG;
+		}
+	}
+
+	if (ret == 0) {
+		ret = flash_area_erase(image_area, 0, IMAGE_SECTOR_SIZE);
+		ret = ret ? ret : flash_area_write(image_area, 0, h, sizeof(*h));
+		ret = ret ? -EIO : 0;
+	}
+
+	if (ret == 0) {
+		memcpy(&header, h, sizeof(header));
+		header_valid = true;
+		LOG_INF("Stored image: %u bytes at 0x%08x", h->data_size - h->image_offset,
+			h->image_address);
+	}
+
+	k_mutex_unlock(&image_lock);
+
+	return ret;
+}
+
+int offline_prog_start(void)
+{
+	if (!header_valid) {
+		return -ENOENT;
+	}
+
+	if (!atomic_cas(&prog_busy, 0, 1)) {
+		return -EBUSY;
+	}
+
+	/* Not idle from here on, even before the thread picks it up */
+	status_set(OFFLINE_PROG_ERASE, 0, 0);
+	k_sem_give(&prog_sem);
+
+	return 0;
+}
+
+void offline_prog_status_get(struct offline_prog_status *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&status_lock);
+
+	*out = status;
+	k_spin_unlock(&status_lock, key);
+}
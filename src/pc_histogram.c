@@ -0,0 +1,243 @@
+/**
+ * @file pc_histogram.c
+ * @brief Sparse histogram of sampled program counters and its stream encoding
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include "pc_histogram.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define VARINT_MAX_SIZE 5
+/* Golden ratio multiplier, spreads neighbouring buckets over the table */
+#define HASH_MULT       0x9E3779B1U
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static size_t varint_put(uint8_t *buf, uint32_t val)
+{
+	size_t n = 0;
+
+	while (val >= 0x80) {
+		buf[n++] = (val & 0x7F) | 0x80;
+		val >>= 7;
+	}
+
+	buf[n++] = val;
+
+	return n;
+}
+
+static size_t varint_size(uint32_t val)
+{
+	size_t n = 1;
+
+	while (val >= 0x80) {
+		val >>= 7;
+		n++;
+	}
+
+	return n;
+}
+
+static size_t frame_start(uint8_t *buf, uint8_t type)
+{
+	buf[0] = PC_FRAME_SYNC;
+	buf[1] = type;
+
+	return PC_FRAME_HDR_SIZE;
+}
+
+static size_t frame_end(uint8_t *buf, size_t len)
+{
+	sys_put_le16(len - PC_FRAME_HDR_SIZE, &buf[2]);
+
+	return len;
+}
+
+static void table_clear(struct pc_histogram *h)
+{
+	memset(h->keys, 0, h->size * sizeof(h->keys[0]));
+	memset(h->counts, 0, h->size * sizeof(h->counts[0]));
+	h->used = 0;
+}
+
+/* Shell sort of the used slots by bucket, no allocation and no recursion */
+static size_t sort_used(struct pc_histogram *h)
+{
+	size_t n = 0;
+	uint16_t tmp;
+	size_t gap;
+	size_t j;
+
+	for (size_t i = 0; i < h->size; i++) {
+		if (h->counts[i] != 0) {
+			h->order[n++] = i;
+		}
+	}
+
+	for (gap = n / 2; gap > 0; gap /= 2) {
+		for (size_t i = gap; i < n; i++) {
+			tmp = h->order[i];
+			for (j = i; j >= gap && h->keys[h->order[j - gap]] > h->keys[tmp];
+			     j -= gap) {
+				h->order[j] = h->order[j - gap];
+			}
+
+			h->order[j] = tmp;
+		}
+	}
+
+	return n;
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void pc_histogram_reset(struct pc_histogram *h, uint8_t shift)
+{
+	table_clear(h);
+	h->shift = MIN(shift, 31);
+	h->samples = 0;
+	h->idle = 0;
+	h->lost = 0;
+}
+
+void pc_histogram_add(struct pc_histogram *h, uint32_t pc)
+{
+	uint32_t key;
+	size_t slot;
+
+	h->samples++;
+	if (pc == PC_SAMPLE_IDLE) {
+		h->idle++;
+		return;
+	}
+
+	key = (pc >> h->shift) + 1;
+	slot = (key * HASH_MULT) >> 16;
+	for (size_t i = 0; i < h->size; i++) {
+		slot &= h->size - 1;
+		if (h->keys[slot] == key) {
+			h->counts[slot]++;
+			return;
+		}
+
+		if (h->keys[slot] == 0) {
+			/* Keep a free slot so lookups of new buckets terminate early */
+			if (h->used >= h->size - 1) {
+				break;
+			}
+
+			h->keys[slot] = key;
+			h->counts[slot] = 1;
+			h->used++;
+			return;
+		}
+
+		slot++;
+	}
+
+	h->lost++;
+}
+
+size_t pc_histogram_encode(struct pc_histogram *h, uint8_t *buf, size_t size)
+{
+	uint32_t prev = 0;
+	size_t count_pos;
+	size_t entries;
+	size_t len;
+	size_t n;
+	size_t i;
+
+	n = sort_used(h);
+	if (n == 0 && h->samples == 0 && h->lost == 0) {
+		return 0;
+	}
+
+	len = frame_start(buf, PC_FRAME_HISTOGRAM);
+	buf[len++] = h->shift;
+	len += varint_put(&buf[len], h->samples);
+	len += varint_put(&buf[len], h->idle);
+	len += varint_put(&buf[len], h->lost);
+	h->samples = 0;
+	h->idle = 0;
+	h->lost = 0;
+
+	/* Reserve room for the largest entry count, moved down once it is known */
+	count_pos = len;
+	len += VARINT_MAX_SIZE;
+	for (i = 0; i < n; i++) {
+		uint16_t slot = h->order[i];
+		uint32_t bucket = h->keys[slot] - 1;
+
+		if (len + varint_size(bucket - prev) + varint_size(h->counts[slot]) > size) {
+			break;
+		}
+
+		len += varint_put(&buf[len], bucket - prev);
+		len += varint_put(&buf[len], h->counts[slot]);
+		h->counts[slot] = 0;
+		prev = bucket;
+	}
+
+	entries = varint_put(&buf[count_pos], i);
+	memmove(&buf[count_pos + entries], &buf[count_pos + VARINT_MAX_SIZE],
+		len - count_pos - VARINT_MAX_SIZE);
+	len -= VARINT_MAX_SIZE - entries;
+
+	if (i == n) {
+		/* Report complete, drop the keys of the buckets sent so new buckets find a slot */
+		table_clear(h);
+	}
+
+	return frame_end(buf, len);
+}
+
+size_t pc_raw_encode(const uint32_t *pcs, size_t count, uint8_t *buf, size_t size, size_t *used)
+{
+	uint32_t prev = 0;
+	size_t count_pos;
+	size_t entries;
+	size_t len;
+	size_t i;
+
+	*used = 0;
+	if (count == 0) {
+		return 0;
+	}
+
+	len = frame_start(buf, PC_FRAME_RAW);
+	count_pos = len;
+	len += VARINT_MAX_SIZE;
+	for (i = 0; i < count; i++) {
+		int32_t delta = (int32_t)(pcs[i] - prev);
+		uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+
+		if (len + varint_size(zigzag) > size) {
+			break;
+		}
+
+		len += varint_put(&buf[len], zigzag);
+		prev = pcs[i];
+	}
+
+	entries = varint_put(&buf[count_pos], i);
+	memmove(&buf[count_pos + entries], &buf[count_pos + VARINT_MAX_SIZE],
+		len - count_pos - VARINT_MAX_SIZE);
+	len -= VARINT_MAX_SIZE - entries;
+	*used = i;
+
+	return frame_end(buf, len);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file pin_claim.c
+ * @brief Ownership of the GPIO pins shared by the vendor functions
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "pin_claim.h"
+
+LOG_MODULE_REGISTER(pin_claim, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define PIN_COUNT 32
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static struct k_spinlock pin_lock;
+static uint8_t pin_owner[PIN_COUNT];
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int pin_claim(uint32_t mask, enum pin_owner owner)
+{
+	k_spinlock_key_t key = k_spin_lock(&pin_lock);
+
+	for (uint8_t pin = 0; pin < PIN_COUNT; pin++) {
+		if ((mask & BIT(pin)) && pin_owner[pin] != PIN_OWNER_NONE &&
+		    pin_owner[pin] != owner) {
+			k_spin_unlock(&pin_lock, key);
+			LOG_DBG("pin %u held by %u, wanted by %u", pin, pin_owner[pin], owner);
+			return -EBUSY;
+		}
+	}
+
+	for (uint8_t pin = 0; pin < PIN_COUNT; pin++) {
+		if (mask & BIT(pin)) {
+			pin_owner[pin] = owner;
+		}
+	}
+	k_spin_unlock(&pin_lock, key);
+
+	return 0;
+}
+
+void pin_release(uint32_t mask, enum pin_owner owner)
+{
+	k_spinlock_key_t key = k_spin_lock(&pin_lock);
+
+	for (uint8_t pin = 0; pin < PIN_COUNT; pin++) {
+		if ((mask & BIT(pin)) && pin_owner[pin] == owner) {
+			pin_owner[pin] = PIN_OWNER_NONE;
+		}
+	}
+	k_spin_unlock(&pin_lock, key);
+}
+
+enum pin_owner pin_owner_get(uint8_t pin)
+{
+	return pin < PIN_COUNT ? pin_owner[pin] : PIN_OWNER_NONE;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file prbs.c
+ * @brief PRBS-7/15/31 pattern generator and bit error checker
+ *
+ * The shift register holds the last order bits of the sequence, oldest in bit 0. With the
+ * feedback taps order and m apart, the next m bits only depend on bits already in the register,
+ * so up to m bits are generated per step instead of one.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+#include "prbs.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+/* Leaves room for 7 bits not packed yet in the 32 bit accumulator */
+#define PRBS_CHUNK_MAX 24
+
+/* Errors are counted per window, a window with more errors than PRBS_SLIP_BITS means the checker
+ * is out of step with the data: random data gets half of its bits wrong
+ */
+#define PRBS_WINDOW    8
+#define PRBS_SLIP_BITS 8
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static uint32_t prbs_step(struct prbs_gen *gen, uint8_t bits)
+{
+	uint32_t next = (gen->state ^ (gen->state >> gen->tap_shift)) & BIT_MASK(bits);
+
+	gen->state = (gen->state >> bits) | (next << (gen->order - bits));
+
+	return next;
+}
+
+static void prbs_check_sync(struct prbs_check *check, uint8_t byte)
+{
+	struct prbs_gen *gen = &check->gen;
+	uint32_t bit;
+
+	for (int i = 0; i < 8; i++) {
+		bit = (byte >> i) & 1;
+		if (check->sync_bits < gen->order) {
+			gen->state = (gen->state >> 1) | (bit << (gen->order - 1));
+			check->sync_bits++;
+		} else if (prbs_step(gen, 1) == bit) {
+			check->sync_bits++;
+		} else {
+			check->sync_bits = 0;
+		}
+	}
+
+	/* Lock on a byte boundary after at least a byte of predicted bits matched */
+	if (check->sync_bits >= gen->order + 8) {
+		check->locked = true;
+		gen->acc = 0;
+		gen->acc_bits = 0;
+	}
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int prbs_init(struct prbs_gen *gen, uint8_t order)
+{
+	uint8_t m;
+
+	switch (order) {
+	case 7:
+		m = 6;
+		break;
+	case 15:
+		m = 14;
+		break;
+	case 31:
+		m = 28;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	gen->order = order;
+	gen->tap_shift = order - m;
+	gen->chunk = MIN(m, PRBS_CHUNK_MAX);
+	gen->state = BIT_MASK(order);
+	gen->acc = 0;
+	gen->acc_bits = 0;
+
+	return 0;
+}
+
+void prbs_fill(struct prbs_gen *gen, uint8_t *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		while (gen->acc_bits < 8) {
+			gen->acc |= prbs_step(gen, gen->chunk) << gen->acc_bits;
+			gen->acc_bits += gen->chunk;
+		}
+
+		buf[i] = gen->acc & 0xFF;
+		gen->acc >>= 8;
+		gen->acc_bits -= 8;
+	}
+}
+
+int prbs_check_init(struct prbs_check *check, uint8_t order)
+{
+	memset(check, 0, sizeof(*check));
+
+	return prbs_init(&check->gen, order);
+}
+
+void prbs_check(struct prbs_check *check, const uint8_t *buf, size_t len)
+{
+	uint8_t expected;
+
+	for (size_t i = 0; i < len; i++) {
+		if (!check->locked) {
+			prbs_check_sync(check, buf[i]);
+			continue;
+		}
+
+		prbs_fill(&check->gen, &expected, 1);
+		check->win_errors += __builtin_popcount(expected ^ buf[i]);
+		if (++check->win_bytes < PRBS_WINDOW) {
+			continue;
+		}
+
+		if (check->win_errors <= PRBS_SLIP_BITS) {
+			check->bits += check->win_bytes * 8;
+			check->errors += check->win_errors;
+		} else {
+			/* Lost or inserted bytes, not bit errors: forget the window and
+			 * resynchronize
+			 */
+			check->sync_bits = 0;
+			check->locked = false;
+			check->resyncs++;
+		}
+
+		check->win_bytes = 0;
+		check->win_errors = 0;
+	}
+}
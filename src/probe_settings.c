@@ -35,8 +35,8 @@ LOG_MODULE_REGISTER(probe_settings, LOG_LEVEL_INF);
 static probe_settings_ut probe_settings_data;
 
 static const probe_settings_ut probe_settings_default = {
-	.v2 = {
-		.version = PROBE_SETTINGS_V2,
+	.v4 = {
+		.version = PROBE_SETTINGS_V4,
 		.target_board_name = CONFIG_CMSIS_DAP_BOARD_NAME,
 		.target_board_vendor = CONFIG_CMSIS_DAP_BOARD_VENDOR,
 		.target_device_name = CONFIG_CMSIS_DAP_DEVICE_NAME,
@@ -46,6 +46,9 @@ static const probe_settings_ut probe_settings_default = {
 	}
 };
 
+BUILD_ASSERT(sizeof(probe_settings_v4_t) <= PROBE_SETTINGS_MAX_SIZE,
+	     "probe settings must fit in one flash page");
+
 static const struct flash_area *settings_area;
 static const struct device *flash_dev;
 static uint32_t current_settings_offset;
@@ -57,22 +60,21 @@ static uint32_t next_settings_offset;
 static void find_internal_settings(void)
 {
 	uint32_t page_size = SETTINGS_PAGE_SIZE;
-	probe_settings_ut settings;
+	uint8_t version;
 	int ret;
 
 	/* Initialize to start of partition */
 	current_settings_offset = 0;
 	next_settings_offset = 0;
 
-	/* Search through the sector for valid settings */
+	/* Search through the sector for valid settings, only the version byte is needed */
 	for (uint32_t offset = 0; offset < SETTINGS_SECTOR_SIZE; offset += page_size) {
-		ret = flash_area_read(settings_area, offset, &settings, sizeof(probe_settings_ut));
+		ret = flash_area_read(settings_area, offset, &version, sizeof(version));
 		if (ret < 0) {
 			continue;
 		}
 
-		if (settings.base.version != PROBE_SETTINGS_INVALID_FF &&
-		    settings.base.version != PROBE_SETTINGS_INVALID_00) {
+		if (version != PROBE_SETTINGS_INVALID_FF && version != PROBE_SETTINGS_INVALID_00) {
 			/* Found valid settings */
 			current_settings_offset = offset;
 			/* Next write location is the following page, wrapping around */
@@ -107,6 +109,18 @@ static void settings_v1_to_v2(probe_settings_ut *settings)
 	settings->v2.usb_pid = DEFAULT_USB_PID;
 }
 
+static void settings_v2_to_v3(probe_settings_ut *settings)
+{
+	settings->v3.version = PROBE_SETTINGS_V3;
+	memset(settings->v3.swd_clock, 0, sizeof(settings->v3.swd_clock));
+}
+
+static void settings_v3_to_v4(probe_settings_ut *settings)
+{
+	settings->v4.version = PROBE_SETTINGS_V4;
+	memset(settings->v4.uart, 0, sizeof(settings->v4.uart));
+}
+
 /**************************************************************************************************/
 /* Global Data Definitions                                                                        */
 /**************************************************************************************************/
@@ -157,10 +171,22 @@ void probe_settings_init(void)
 		LOG_INF("No valid settings found, writing defaults");
 		write_internal_settings(&probe_settings_default, PROBE_SETTINGS_MAX_SIZE);
 		memcpy(&probe_settings_data, &probe_settings_default, sizeof(probe_settings_ut));
-	} else if (temp_settings.base.version == PROBE_SETTINGS_V1) {
-		/* Upgrade from V1 to V2 */
-		LOG_INF("Upgrading settings from V1 to V2");
-		settings_v1_to_v2(&temp_settings);
+	} else if (temp_settings.base.version < PROBE_SETTINGS_V4) {
+		if (temp_settings.base.version == PROBE_SETTINGS_V1) {
+			/* Upgrade from V1 to V2 */
+			LOG_INF("Upgrading settings from V1 to V2");
+			settings_v1_to_v2(&temp_settings);
+		}
+
+		if (temp_settings.base.version == PROBE_SETTINGS_V2) {
+			/* Upgrade from V2 to V3 */
+			LOG_INF("Upgrading settings from V2 to V3");
+			settings_v2_to_v3(&temp_settings);
+		}
+
+		/* Upgrade from V3 to V4 */
+		LOG_INF("Upgrading settings from V3 to V4");
+		settings_v3_to_v4(&temp_settings);
 		write_internal_settings(&temp_settings, PROBE_SETTINGS_MAX_SIZE);
 		memcpy(&probe_settings_data, &temp_settings, sizeof(probe_settings_ut));
 	} else {
@@ -222,3 +248,114 @@ int write_internal_settings(const probe_settings_ut *settings, uint16_t size)
 	memcpy(&probe_settings_data, settings, sizeof(probe_settings_ut));
 	return 0;
 }
+
+uint32_t probe_settings_swd_clock_get(uint32_t idcode)
+{
+	if (probe_settings_data.base.version < PROBE_SETTINGS_V3) {
+		return 0;
+	}
+
+	for (int i = 0; i < PROBE_SETTINGS_SWD_CLOCKS; i++) {
+		if (probe_settings_data.v3.swd_clock[i].max_clock_hz != 0 &&
+		    probe_settings_data.v3.swd_clock[i].idcode == idcode) {
+			return probe_settings_data.v3.swd_clock[i].max_clock_hz;
+		}
+	}
+
+	return 0;
+}
+
+int probe_settings_swd_clock_set(uint32_t idcode, uint32_t max_clock_hz)
+{
+	probe_settings_ut settings;
+	probe_settings_swd_clock_t *table = settings.v3.swd_clock;
+	int n = 0;
+
+	if (probe_settings_data.base.version < PROBE_SETTINGS_V3) {
+		return -ENOTSUP;
+	}
+
+	if (probe_settings_swd_clock_get(idcode) == max_clock_hz) {
+		return 0;
+	}
+
+	memcpy(&settings, &probe_settings_data, sizeof(probe_settings_ut));
+
+	/* Rebuild the table without the target, then put it in front */
+	for (int i = 0; i < PROBE_SETTINGS_SWD_CLOCKS; i++) {
+		if (table[i].max_clock_hz != 0 && table[i].idcode != idcode) {
+			table[n++] = table[i];
+		}
+	}
+
+	if (max_clock_hz != 0) {
+		n = MIN(n, PROBE_SETTINGS_SWD_CLOCKS - 1);
+		memmove(&table[1], &table[0], n * sizeof(table[0]));
+		table[0].idcode = idcode;
+		table[0].max_clock_hz = max_clock_hz;
+		n++;
+	}
+
+	memset(&table[n], 0, (PROBE_SETTINGS_SWD_CLOCKS - n) * sizeof(table[0]));
+
+	return write_internal_settings(&settings, PROBE_SETTINGS_MAX_SIZE);
+}
+
+int probe_settings_uart_get(uint16_t bridge_id, probe_settings_uart_t *uart)
+{
+	if (probe_settings_data.base.version < PROBE_SETTINGS_V4) {
+		return -ENOENT;
+	}
+
+	for (int i = 0; i < PROBE_SETTINGS_UARTS; i++) {
+		if (probe_settings_data.v4.uart[i].baudrate != 0 &&
+		    probe_settings_data.v4.uart[i].bridge_id == bridge_id) {
+			*uart = probe_settings_data.v4.uart[i];
+			return 0;
+		}
+	}
+
+	return -ENOENT;
+}
+
+int probe_settings_uart_set(uint16_t bridge_id, uint32_t baudrate, uint8_t format)
+{
+	probe_settings_ut settings;
+	probe_settings_uart_t *table = settings.v4.uart;
+	probe_settings_uart_t saved;
+	int n = 0;
+
+	if (probe_settings_data.base.version < PROBE_SETTINGS_V4) {
+		return -ENOTSUP;
+	}
+
+	if (probe_settings_uart_get(bridge_id, &saved) == 0) {
+		if (saved.baudrate == baudrate && saved.format == format) {
+			return 0;
+		}
+	} else if (baudrate == 0) {
+		return 0;
+	}
+
+	memcpy(&settings, &probe_settings_data, sizeof(probe_settings_ut));
+
+	/* Rebuild the table without the bridge, then put it in front */
+	for (int i = 0; i < PROBE_SETTINGS_UARTS; i++) {
+		if (table[i].baudrate != 0 && table[i].bridge_id != bridge_id) {
+			table[n++] = table[i];
+		}
+	}
+
+	if (baudrate != 0) {
+		n = MIN(n, PROBE_SETTINGS_UARTS - 1);
+		memmove(&table[1], &table[0], n * sizeof(table[0]));
+		table[0].bridge_id = bridge_id;
+		table[0].baudrate = baudrate;
+		table[0].format = format;
+		n++;
+	}
+
+	memset(&table[n], 0, (PROBE_SETTINGS_UARTS - n) * sizeof(table[0]));
+
+	return write_internal_settings(&settings, PROBE_SETTINGS_MAX_SIZE);
+}
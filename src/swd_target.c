@@ -0,0 +1,1358 @@
+/**
+ * @file swd_target.c
+ * @brief Shared access to the target debug port
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/swdp.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "probe_settings.h"
+#include "swd_target.h"
+#include "target_cortexm.h"
+
+LOG_MODULE_REGISTER(swd_target, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+/* The pins unless rfpros,swdp selects another port, such as the emulator */
+#if DT_HAS_CHOSEN(rfpros_swdp)
+#define SWDP_NODE DT_CHOSEN(rfpros_swdp)
+#else
+#define SWDP_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(zephyr_swdp_gpio)
+#endif
+
+#define SWD_REQUEST_ADDR_MASK (SWDP_REQUEST_A2 | SWDP_REQUEST_A3)
+#define SWD_REQUEST_TYPE_MASK (SWDP_REQUEST_APnDP | SWDP_REQUEST_RnW | SWD_REQUEST_ADDR_MASK)
+#define SWD_WAIT_RETRIES      100
+#define SWD_POWERUP_RETRIES   100
+
+#define ABORT_CLEAR_ALL       0x1E
+#define CTRL_STAT_CSYSPWRUPACK BIT(31)
+#define CTRL_STAT_CSYSPWRUPREQ BIT(30)
+#define CTRL_STAT_CDBGPWRUPACK BIT(29)
+#define CTRL_STAT_CDBGPWRUPREQ BIT(28)
+
+#define CSW_SIZE_MASK      0x07
+#define CSW_SIZE8          0x00
+#define CSW_SIZE32         0x02
+#define CSW_ADDRINC_MASK   0x30
+#define CSW_ADDRINC_SINGLE 0x10
+
+/* AP and AP register bank of DP SELECT, bank 1 holds the banked data registers BD0 to BD3 */
+#define SELECT_APSEL_MASK     0xFF000000
+#define SELECT_APBANKSEL_MASK 0xF0
+#define SELECT_APBANK_BD      0x10
+
+/* DHCSR bits cleared by every read */
+#define DHCSR_STICKY (DHCSR_S_RESET_ST | DHCSR_S_RETIRE_ST)
+
+/* Request, turnaround, acknowledge, data, parity and turnaround of a read */
+#define SWD_READ_BITS 46
+
+/* Clock steps of the calibration grow by a quarter */
+#define CALIB_STEP_DIV   4
+#define CALIB_RATE_READS 64
+/* A step must raise the measured bit rate by more than 1/50th to count */
+#define CALIB_RATE_DIV   50
+
+/* TAR auto-increment is only guaranteed within a 1 KiB block */
+#define TAR_AUTOINC_BLOCK 1024
+#define BLOCK_WORDS       64
+
+/* TARGETSEL is a DP write packet whose acknowledge nobody drives */
+#define TARGETSEL_REQUEST        SWD_DP_TARGETSEL
+#define TARGETSEL_HEADER         0x99
+#define TARGETSEL_ACK_BITS       5
+#define TARGETSEL_DATA_BITS      33
+#define TARGETSEL_INSTANCES      16
+#define TARGETSEL_INSTANCE_SHIFT 28
+
+/* At least 50 cycles with SWDIO high */
+#define LINE_RESET_BITS      50
+#define LINE_RESET_MAX_BYTES 16
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct device *const swdp_dev = DEVICE_DT_GET(SWDP_NODE);
+
+/*
+ * JTAG-to-SWD switch: line reset, 0xE79E, line reset, idle.
+ * Sent LSB first, which is also what a host sends with DAP_SWJ_Sequence.
+ */
+static const uint8_t swd_connect_seq[] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x9e, 0xe7,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00,
+};
+
+/*
+ * Line reset, SWD-to-dormant, selection alert and SWD activation code, line reset, idle.
+ * Multi-drop DPs may start in the dormant state and ignore the JTAG-to-SWD switch.
+ */
+static const uint8_t swd_dormant_connect_seq[] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xbc, 0xe3, 0xff,
+	0x92, 0xf3, 0x09, 0x62, 0x95, 0x2d, 0x85, 0x86,
+	0xe9, 0xaf, 0xdd, 0xe3, 0xa2, 0x0e, 0xbc, 0x19,
+	0xa0, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00,
+};
+
+static const uint8_t swd_idle_seq[8];
+
+enum select_state {
+	SELECT_NONE,
+	/* Line reset held back */
+	SELECT_RESET,
+	/* TARGETSEL header held back */
+	SELECT_HEADER,
+	/* TARGETSEL header and acknowledge held back */
+	SELECT_ACK,
+};
+
+static K_MUTEX_DEFINE(swd_lock);
+
+/* Host state, only changed with swd_lock held */
+static uint32_t host_last_cycles;
+static uint32_t host_select;
+static bool host_select_valid;
+static bool host_port_on;
+/* MEM-AP state of AP 0 as set by the host, to find its DHCSR reads */
+static uint32_t host_csw;
+static bool host_csw_valid;
+static uint32_t host_tar;
+static bool host_tar_valid;
+/* The last host AP read was of DHCSR, its data comes with the next AP or RDBUFF read */
+static bool host_dhcsr_posted;
+/* Sticky DHCSR bits cleared by background reads, handed to the next host DHCSR read */
+static uint32_t dhcsr_sticky;
+
+/* Multi-drop selection state, only changed with swd_lock held */
+static enum select_state select_state;
+static uint8_t held_reset[LINE_RESET_MAX_BYTES];
+static uint32_t held_reset_bits;
+static uint32_t held_idle_bits;
+/* The selected target is known and the wire was in sync at the held line reset */
+static bool reselect_ok;
+/* The last transfer got a valid acknowledge */
+static bool wire_ok;
+static int targetsel_ret;
+static uint8_t targetsel_ack;
+static bool targetsel_ack_valid;
+
+/* Background state, only changed with swd_lock held */
+static bool port_on;
+static bool bg_connected;
+static bool bg_error;
+static bool bg_select_valid;
+static uint32_t bg_select;
+static bool ap_saved;
+static uint32_t saved_csw;
+static uint32_t saved_tar;
+static uint32_t bg_csw;
+static uint32_t block[BLOCK_WORDS];
+
+/* Clock state and counters, only changed with swd_lock held */
+static struct swd_target_stats stats;
+static bool calibrating;
+/* The pins are lent to the JTAG port */
+static bool lent;
+
+/* Word aligned TAR readback patterns, toggling every data bit */
+static const uint32_t calib_patterns[] = {
+	0xAAAAAAA8, 0x55555554, 0xFFFFFFFC, 0x00000000, 0xF0F0F0F0, 0x0F0F0F0C,
+};
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static void host_enter(void)
+{
+	k_mutex_lock(&swd_lock, K_FOREVER);
+}
+
+static void host_exit(void)
+{
+	host_last_cycles = k_cycle_get_32();
+	k_mutex_unlock(&swd_lock);
+}
+
+static void count_ack(uint8_t ack)
+{
+	stats.transfers++;
+	wire_ok = true;
+	switch (ack) {
+	case SWDP_ACK_OK:
+		break;
+	case SWDP_ACK_WAIT:
+		stats.waits++;
+		break;
+	case SWDP_ACK_FAULT:
+		stats.faults++;
+		break;
+	default:
+		stats.errors++;
+		wire_ok = false;
+		break;
+	}
+}
+
+static bool seq_bit(const uint8_t *data, uint32_t i)
+{
+	return (data[i / 8] >> (i % 8)) & 1;
+}
+
+static bool is_line_reset(uint32_t count, const uint8_t *data)
+{
+	uint32_t i = 0;
+
+	/* Ones, optionally followed by idle cycles */
+	while (i < count && seq_bit(data, i)) {
+		i++;
+	}
+
+	if (i < LINE_RESET_BITS) {
+		return false;
+	}
+
+	while (i < count && !seq_bit(data, i)) {
+		i++;
+	}
+
+	return i == count;
+}
+
+static bool is_idle(uint32_t count, const uint8_t *data)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		if (seq_bit(data, i)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static int targetsel_write(uint32_t targetsel)
+{
+	uint8_t header = TARGETSEL_HEADER;
+	uint8_t data[5];
+	uint8_t ack;
+	int ret;
+
+	sys_put_le32(targetsel, data);
+	data[4] = POPCOUNT(targetsel) & 1;
+
+	ret = swdp_output_sequence(swdp_dev, 8, &header);
+	ret = ret ? ret : swdp_input_sequence(swdp_dev, TARGETSEL_ACK_BITS, &ack);
+	ret = ret ? ret : swdp_output_sequence(swdp_dev, TARGETSEL_DATA_BITS, data);
+
+	return ret;
+}
+
+static void target_selected(uint32_t targetsel)
+{
+	if (targetsel != stats.targetsel) {
+		LOG_DBG("TARGETSEL 0x%08x", targetsel);
+	}
+
+	stats.targetsel = targetsel;
+	stats.reselects++;
+}
+
+/*
+ * Send what was held back of a host line reset and TARGETSEL write. multidrop is false when the
+ * host went on without a TARGETSEL write, so the bus is not treated as multi-drop any more.
+ */
+static void select_flush(bool multidrop)
+{
+	uint8_t header = TARGETSEL_HEADER;
+	uint32_t n;
+	uint8_t ack;
+
+	if (select_state == SELECT_NONE) {
+		return;
+	}
+
+	(void)swdp_output_sequence(swdp_dev, held_reset_bits, held_reset);
+	for (uint32_t left = held_idle_bits; left > 0; left -= n) {
+		n = MIN(left, sizeof(swd_idle_seq) * 8);
+		(void)swdp_output_sequence(swdp_dev, n, swd_idle_seq);
+	}
+
+	if (select_state >= SELECT_HEADER) {
+		(void)swdp_output_sequence(swdp_dev, 8, &header);
+	}
+
+	if (select_state == SELECT_ACK) {
+		(void)swdp_input_sequence(swdp_dev, TARGETSEL_ACK_BITS, &ack);
+	}
+
+	if (!multidrop) {
+		stats.targetsel = 0;
+	}
+
+	select_state = SELECT_NONE;
+	bg_connected = false;
+	wire_ok = false;
+}
+
+/* Returns true if the host sequence was held back or dropped */
+static bool select_output(uint32_t count, const uint8_t *data)
+{
+	bool targetsel = select_state == SELECT_ACK && count == TARGETSEL_DATA_BITS;
+	uint32_t val = targetsel ? sys_get_le32(data) : 0;
+
+	if (select_state == SELECT_RESET && is_idle(count, data)) {
+		held_idle_bits += count;
+		return true;
+	}
+
+	if (select_state == SELECT_RESET && count == 8 && data[0] == TARGETSEL_HEADER) {
+		select_state = SELECT_HEADER;
+		return true;
+	}
+
+	if (targetsel && reselect_ok && val == stats.targetsel) {
+		select_state = SELECT_NONE;
+		stats.reselects_skipped++;
+		return true;
+	}
+
+	select_flush(targetsel);
+	if (targetsel) {
+		target_selected(val);
+		return false;
+	}
+
+	if (count <= sizeof(held_reset) * 8 && is_line_reset(count, data)) {
+		memcpy(held_reset, data, DIV_ROUND_UP(count, 8));
+		held_reset_bits = count;
+		held_idle_bits = 0;
+		reselect_ok = wire_ok && stats.targetsel != 0;
+		select_state = SELECT_RESET;
+		return true;
+	}
+
+	return false;
+}
+
+static int clock_apply(bool force)
+{
+	uint32_t clock = stats.host_clock ? stats.host_clock : CONFIG_APP_SWD_DEFAULT_CLOCK_HZ;
+	int ret;
+
+	/* Leave the driver's own clock alone until there is a reason to change it */
+	if (calibrating || (!force && stats.clock == 0 && stats.clock_limit == 0)) {
+		return 0;
+	}
+
+	if (stats.clock_limit != 0 && clock > stats.clock_limit) {
+		clock = stats.clock_limit;
+	}
+
+	if (!force && clock == stats.clock) {
+		return 0;
+	}
+
+	ret = swdp_set_clock(swdp_dev, clock);
+	stats.clock = clock;
+
+	return ret;
+}
+
+static void target_identified(uint32_t idcode)
+{
+	if (idcode == stats.idcode) {
+		return;
+	}
+
+	stats.idcode = idcode;
+	stats.clock_limit = probe_settings_swd_clock_get(idcode);
+	if (stats.clock_limit != 0) {
+		LOG_INF("IDCODE 0x%08x, SWD clock limit %u Hz", idcode, stats.clock_limit);
+	}
+
+	(void)clock_apply(false);
+}
+
+/* Address of a host access to the data registers of AP 0, false if it is not one */
+static bool host_mem_addr(uint8_t reg, uint32_t *addr)
+{
+	uint32_t bank = host_select & SELECT_APBANKSEL_MASK;
+
+	if (!host_select_valid || !host_tar_valid || (host_select & SELECT_APSEL_MASK) != 0) {
+		return false;
+	}
+
+	if (bank == 0 && reg == SWD_AP_DRW) {
+		*addr = host_tar;
+		return true;
+	}
+
+	if (bank == SELECT_APBANK_BD) {
+		*addr = (host_tar & ~0xF) | reg;
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Follows the host's accesses to AP 0 after an acknowledged transfer. Background reads of DHCSR
+ * clear its sticky bits, they are added to the data of the host's next DHCSR read instead.
+ */
+static void host_ap_track(uint8_t request, uint32_t *data)
+{
+	uint8_t reg = request & SWD_REQUEST_ADDR_MASK;
+	bool read = (request & SWDP_REQUEST_RnW) != 0;
+	bool posted = host_dhcsr_posted;
+	bool bank0 = host_select_valid &&
+		     (host_select & (SELECT_APSEL_MASK | SELECT_APBANKSEL_MASK)) == 0;
+	bool mem;
+	uint32_t addr;
+
+	if (!(request & SWDP_REQUEST_APnDP)) {
+		if (read && reg == SWD_DP_RDBUFF) {
+			host_dhcsr_posted = false;
+			if (posted) {
+				*data |= dhcsr_sticky;
+				dhcsr_sticky = 0;
+			}
+		}
+
+		return;
+	}
+
+	mem = host_mem_addr(reg, &addr);
+	if (read) {
+		/* Posted, the data is the result of the previous AP read */
+		host_dhcsr_posted = mem && addr == CORTEXM_DHCSR;
+		if (posted) {
+			*data |= dhcsr_sticky;
+			dhcsr_sticky = 0;
+		}
+	} else if (bank0 && reg == SWD_AP_CSW) {
+		host_csw = *data;
+		host_csw_valid = true;
+	} else if (bank0 && reg == SWD_AP_TAR) {
+		host_tar = *data;
+		host_tar_valid = true;
+	}
+
+	/* DRW accesses move TAR, the banked registers do not */
+	if (mem && bank0) {
+		if (host_csw_valid && (host_csw & CSW_ADDRINC_MASK) == CSW_ADDRINC_SINGLE) {
+			host_tar += BIT(host_csw & CSW_SIZE_MASK);
+		} else if (!host_csw_valid || (host_csw & CSW_ADDRINC_MASK) != 0) {
+			host_tar_valid = false;
+		}
+	}
+}
+
+static int proxy_output_sequence(const struct device *dev, uint32_t count, const uint8_t *data)
+{
+	int ret;
+
+	host_enter();
+	if (select_output(count, data)) {
+		host_exit();
+		return 0;
+	}
+
+	ret = swdp_output_sequence(swdp_dev, count, data);
+	/* Line reset or protocol switch, the target needs an IDCODE read before anything else */
+	bg_connected = false;
+	wire_ok = false;
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_input_sequence(const struct device *dev, uint32_t count, uint8_t *data)
+{
+	int ret;
+
+	host_enter();
+	if (select_state == SELECT_HEADER && count == TARGETSEL_ACK_BITS) {
+		/* Nothing drives the acknowledge, the pull-up reads as ones */
+		data[0] = BIT_MASK(TARGETSEL_ACK_BITS);
+		select_state = SELECT_ACK;
+		host_exit();
+		return 0;
+	}
+
+	select_flush(false);
+	ret = swdp_input_sequence(swdp_dev, count, data);
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_transfer(const struct device *dev, uint8_t request, uint32_t *data,
+			  uint8_t idle_cycles, uint8_t *response)
+{
+	int ret;
+
+	host_enter();
+	if ((request & SWD_REQUEST_TYPE_MASK) == TARGETSEL_REQUEST) {
+		if (select_state == SELECT_RESET && reselect_ok && targetsel_ack_valid &&
+		    *data == stats.targetsel) {
+			/* Same answer as the last TARGETSEL write on the wire */
+			select_state = SELECT_NONE;
+			stats.reselects_skipped++;
+			*response = targetsel_ack;
+			host_exit();
+			return targetsel_ret;
+		}
+
+		select_flush(true);
+		target_selected(*data);
+		targetsel_ret = swdp_transfer(swdp_dev, request, data, idle_cycles, response);
+		targetsel_ack = *response;
+		targetsel_ack_valid = true;
+		host_exit();
+		return targetsel_ret;
+	}
+
+	select_flush(false);
+	if ((request & (SWDP_REQUEST_APnDP | SWDP_REQUEST_RnW)) == 0 &&
+	    (request & SWD_REQUEST_ADDR_MASK) == SWD_DP_SELECT) {
+		host_select = *data;
+		host_select_valid = true;
+	}
+
+	ret = swdp_transfer(swdp_dev, request, data, idle_cycles, response);
+	count_ack(*response);
+	if ((request & SWD_REQUEST_TYPE_MASK) == (SWDP_REQUEST_RnW | SWD_DP_IDCODE) &&
+	    *response == SWDP_ACK_OK) {
+		target_identified(*data);
+	}
+
+	if (ret == 0 && *response == SWDP_ACK_OK) {
+		host_ap_track(request, data);
+	}
+
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_set_pins(const struct device *dev, uint8_t pins, uint8_t value)
+{
+	int ret;
+
+	host_enter();
+	select_flush(false);
+	ret = swdp_set_pins(swdp_dev, pins, value);
+	bg_connected = false;
+	wire_ok = false;
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_get_pins(const struct device *dev, uint8_t *state)
+{
+	int ret;
+
+	host_enter();
+	ret = swdp_get_pins(swdp_dev, state);
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_set_clock(const struct device *dev, uint32_t clock)
+{
+	int ret;
+
+	host_enter();
+	stats.host_clock = clock;
+	if (stats.clock_limit != 0 && clock > stats.clock_limit) {
+		LOG_DBG("clock %u Hz clamped to %u Hz", clock, stats.clock_limit);
+		stats.clamps++;
+	}
+
+	ret = clock_apply(true);
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_configure(const struct device *dev, uint8_t turnaround, bool data_phase)
+{
+	int ret;
+
+	host_enter();
+	ret = swdp_configure(swdp_dev, turnaround, data_phase);
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_port_on(const struct device *dev)
+{
+	int ret = 0;
+
+	host_enter();
+	host_port_on = true;
+	host_select_valid = false;
+	host_csw_valid = false;
+	host_tar_valid = false;
+	host_dhcsr_posted = false;
+	select_state = SELECT_NONE;
+	wire_ok = false;
+	if (!port_on) {
+		ret = swdp_port_on(swdp_dev);
+		port_on = ret == 0;
+		bg_connected = false;
+	}
+	host_exit();
+
+	return ret;
+}
+
+static int proxy_port_off(const struct device *dev)
+{
+	int ret = 0;
+
+	host_enter();
+	host_port_on = false;
+	host_select_valid = false;
+	select_state = SELECT_NONE;
+	wire_ok = false;
+	/* Keep driving the port while a background user is connected */
+	if (port_on && !bg_connected) {
+		ret = swdp_port_off(swdp_dev);
+		port_on = false;
+	}
+	host_exit();
+
+	return ret;
+}
+
+static int bg_xfer(uint8_t request, uint32_t *data)
+{
+	uint8_t ack = 0;
+
+	for (int i = 0; i < SWD_WAIT_RETRIES; i++) {
+		(void)swdp_transfer(swdp_dev, request, data, 0, &ack);
+		count_ack(ack);
+		if (ack == SWDP_ACK_OK) {
+			return 0;
+		}
+
+		if (ack != SWDP_ACK_WAIT) {
+			break;
+		}
+	}
+
+	LOG_DBG("transfer 0x%02x failed, ack 0x%02x", request, ack);
+	bg_error = true;
+
+	return -EIO;
+}
+
+static int bg_ap_select(uint8_t addr)
+{
+	/* AP 0, register bank from the address */
+	uint32_t select = addr & 0xF0;
+	int ret;
+
+	if (bg_select_valid && bg_select == select) {
+		return 0;
+	}
+
+	ret = bg_xfer(SWD_DP_SELECT, &select);
+	bg_select_valid = ret == 0;
+	bg_select = select;
+
+	return ret;
+}
+
+static int bg_set_csw(uint32_t csw)
+{
+	int ret;
+
+	if (csw == bg_csw) {
+		return 0;
+	}
+
+	ret = swd_target_ap_write(SWD_AP_CSW, csw);
+	if (ret == 0) {
+		bg_csw = csw;
+	}
+
+	return ret;
+}
+
+static int bg_connect(void)
+{
+	uint32_t val;
+	int ret;
+
+	if (stats.targetsel != 0) {
+		/* Multi-drop bus, connect to the target the host selected */
+		ret = swdp_output_sequence(swdp_dev, sizeof(swd_dormant_connect_seq) * 8,
+					   swd_dormant_connect_seq);
+		ret = ret ? ret : targetsel_write(stats.targetsel);
+	} else {
+		ret = swdp_output_sequence(swdp_dev, sizeof(swd_connect_seq) * 8, swd_connect_seq);
+	}
+
+	wire_ok = false;
+	if (ret) {
+		return ret;
+	}
+
+	ret = swd_target_dp_read(SWD_DP_IDCODE, &val);
+	if (ret) {
+		return ret;
+	}
+
+	LOG_DBG("IDCODE 0x%08x", val);
+	target_identified(val);
+	ret = swd_target_dp_write(SWD_DP_ABORT, ABORT_CLEAR_ALL);
+	ret = ret ? ret
+		  : swd_target_dp_write(SWD_DP_CTRL_STAT,
+					CTRL_STAT_CSYSPWRUPREQ | CTRL_STAT_CDBGPWRUPREQ);
+	if (ret) {
+		return ret;
+	}
+
+	for (int i = 0; i < SWD_POWERUP_RETRIES; i++) {
+		ret = swd_target_dp_read(SWD_DP_CTRL_STAT, &val);
+		if (ret) {
+			return ret;
+		}
+
+		if ((val & (CTRL_STAT_CSYSPWRUPACK | CTRL_STAT_CDBGPWRUPACK)) ==
+		    (CTRL_STAT_CSYSPWRUPACK | CTRL_STAT_CDBGPWRUPACK)) {
+			bg_connected = true;
+			return 0;
+		}
+	}
+
+	LOG_DBG("debug power up timeout, CTRL/STAT 0x%08x", val);
+
+	return -ETIMEDOUT;
+}
+
+static int bg_read_words(uint32_t addr, uint32_t *words, size_t count)
+{
+	uint32_t dummy;
+	size_t n;
+	int ret;
+
+	while (count > 0) {
+		n = MIN(count, (TAR_AUTOINC_BLOCK - (addr % TAR_AUTOINC_BLOCK)) / 4);
+		ret = swd_target_ap_write(SWD_AP_TAR, addr);
+		/* AP reads are posted: each read returns the previous result, RDBUFF the last */
+		ret = ret ? ret
+			  : bg_xfer(SWDP_REQUEST_APnDP | SWDP_REQUEST_RnW | SWD_AP_DRW, &dummy);
+		for (size_t i = 1; i < n && ret == 0; i++) {
+			ret = bg_xfer(SWDP_REQUEST_APnDP | SWDP_REQUEST_RnW | SWD_AP_DRW,
+				      &words[i - 1]);
+		}
+
+		ret = ret ? ret : bg_xfer(SWDP_REQUEST_RnW | SWD_DP_RDBUFF, &words[n - 1]);
+		if (ret) {
+			return ret;
+		}
+
+		addr += n * 4;
+		words += n;
+		count -= n;
+	}
+
+	return 0;
+}
+
+static int bg_write_byte(uint32_t addr, uint8_t val)
+{
+	uint32_t csw = bg_csw;
+	int ret;
+
+	ret = bg_set_csw((csw & ~CSW_SIZE_MASK) | CSW_SIZE8);
+	ret = ret ? ret : swd_target_ap_write(SWD_AP_TAR, addr);
+	/* Byte lane of the address */
+	ret = ret ? ret : swd_target_ap_write(SWD_AP_DRW, (uint32_t)val << ((addr & 3) * 8));
+	ret = ret ? ret : bg_set_csw(csw);
+
+	return ret;
+}
+
+static int bg_setup(void)
+{
+	int ret;
+
+	if (!bg_connected) {
+		ret = bg_connect();
+		if (ret) {
+			return ret;
+		}
+	}
+
+	ret = swd_target_ap_read(SWD_AP_CSW, &saved_csw);
+	ret = ret ? ret : swd_target_ap_read(SWD_AP_TAR, &saved_tar);
+	if (ret) {
+		return ret;
+	}
+
+	ap_saved = true;
+	/* Force the first bg_set_csw() to write */
+	bg_csw = ~saved_csw;
+
+	return bg_set_csw((saved_csw & ~(CSW_SIZE_MASK | CSW_ADDRINC_MASK)) | CSW_SIZE32 |
+			  CSW_ADDRINC_SINGLE);
+}
+
+static int calib_step(uint32_t idcode, uint32_t cpuid)
+{
+	uint32_t csw = bg_csw;
+	uint32_t pattern;
+	uint32_t val;
+	int ret;
+
+	/* A failed step may have left the wire out of sync, start from a line reset */
+	bg_select_valid = false;
+	bg_csw = ~csw;
+	ret = bg_connect();
+	ret = ret ? ret : bg_set_csw(csw);
+
+	for (int i = 0; i < CONFIG_APP_SWD_CALIB_ITERATIONS && ret == 0; i++) {
+		pattern = calib_patterns[i % ARRAY_SIZE(calib_patterns)];
+		ret = swd_target_dp_read(SWD_DP_IDCODE, &val);
+		ret = ret ? ret : (val == idcode ? 0 : -EIO);
+		ret = ret ? ret : swd_target_ap_write(SWD_AP_TAR, pattern);
+		ret = ret ? ret : swd_target_ap_read(SWD_AP_TAR, &val);
+		ret = ret ? ret : (val == pattern ? 0 : -EIO);
+		ret = ret ? ret : swd_target_mem_read32(CORTEXM_CPUID, &val);
+		ret = ret ? ret : (val == cpuid ? 0 : -EIO);
+	}
+
+	return ret;
+}
+
+static uint32_t calib_rate(void)
+{
+	uint32_t start;
+	uint32_t cycles;
+	uint32_t val;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < CALIB_RATE_READS; i++) {
+		if (swd_target_dp_read(SWD_DP_IDCODE, &val)) {
+			return 0;
+		}
+	}
+
+	cycles = MAX(k_cycle_get_32() - start, 1);
+
+	return (uint64_t)CALIB_RATE_READS * SWD_READ_BITS * sys_clock_hw_cycles_per_sec() / cycles;
+}
+
+/* Single attempt without counting, most candidates of an enumeration do not answer */
+static int drop_xfer(uint8_t request, uint32_t *data)
+{
+	uint8_t ack = 0;
+
+	(void)swdp_transfer(swdp_dev, request, data, 0, &ack);
+
+	return ack == SWDP_ACK_OK ? 0 : -EIO;
+}
+
+static int drop_probe(uint32_t targetsel, struct swd_target_drop *drop)
+{
+	uint32_t select;
+	uint32_t dlpidr;
+	int ret;
+
+	ret = swdp_output_sequence(swdp_dev, sizeof(swd_dormant_connect_seq) * 8,
+				   swd_dormant_connect_seq);
+	ret = ret ? ret : targetsel_write(targetsel);
+	ret = ret ? ret : drop_xfer(SWDP_REQUEST_RnW | SWD_DP_IDCODE, &drop->idcode);
+	if (ret) {
+		return ret;
+	}
+
+	select = SWD_DP_BANK_TARGETID;
+	ret = drop_xfer(SWD_DP_SELECT, &select);
+	ret = ret ? ret : drop_xfer(SWDP_REQUEST_RnW | SWD_DP_CTRL_STAT, &drop->targetid);
+	select = SWD_DP_BANK_DLPIDR;
+	ret = ret ? ret : drop_xfer(SWD_DP_SELECT, &select);
+	ret = ret ? ret : drop_xfer(SWDP_REQUEST_RnW | SWD_DP_CTRL_STAT, &dlpidr);
+	select = 0;
+	ret = ret ? ret : drop_xfer(SWD_DP_SELECT, &select);
+	if (ret) {
+		return ret;
+	}
+
+	drop->targetsel = (drop->targetid & ~SWD_TARGETSEL_INSTANCE_MASK) |
+			  (dlpidr & SWD_TARGETSEL_INSTANCE_MASK);
+
+	return 0;
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+bool swd_target_host_idle(uint32_t idle_ms)
+{
+	return (k_cycle_get_32() - host_last_cycles) >= k_ms_to_cyc_ceil32(idle_ms);
+}
+
+int swd_target_begin(uint32_t idle_ms)
+{
+	int ret;
+
+	/* Requests made on behalf of the host wait for the background instead */
+	if (k_mutex_lock(&swd_lock, idle_ms == 0 ? K_FOREVER : K_NO_WAIT) != 0) {
+		return -EBUSY;
+	}
+
+	/* Checked again with the lock held so a host command is never split */
+	if (lent || !swd_target_host_idle(idle_ms)) {
+		k_mutex_unlock(&swd_lock);
+		return -EBUSY;
+	}
+
+	/* A host line reset left hanging, send it before the batch changes the wire */
+	select_flush(stats.targetsel != 0);
+	bg_error = false;
+	bg_select_valid = false;
+	ap_saved = false;
+
+	if (!port_on) {
+		ret = swdp_port_on(swdp_dev);
+		if (ret) {
+			k_mutex_unlock(&swd_lock);
+			return ret;
+		}
+
+		port_on = true;
+		bg_connected = false;
+	}
+
+	if (bg_setup()) {
+		swd_target_end();
+		return -EIO;
+	}
+
+	return 0;
+}
+
+void swd_target_end(void)
+{
+	if (ap_saved) {
+		(void)swd_target_ap_write(SWD_AP_CSW, saved_csw);
+		(void)swd_target_ap_write(SWD_AP_TAR, saved_tar);
+		ap_saved = false;
+	}
+
+	if (bg_error) {
+		/* Do not leave sticky errors behind for the host */
+		(void)swd_target_dp_write(SWD_DP_ABORT, ABORT_CLEAR_ALL);
+		bg_connected = false;
+	}
+
+	if (host_select_valid && (!bg_select_valid || bg_select != host_select)) {
+		(void)bg_xfer(SWD_DP_SELECT, &host_select);
+	}
+
+	k_mutex_unlock(&swd_lock);
+}
+
+void swd_target_release(void)
+{
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	if (port_on && !host_port_on) {
+		(void)swdp_port_off(swdp_dev);
+		port_on = false;
+	}
+
+	bg_connected = false;
+	k_mutex_unlock(&swd_lock);
+}
+
+void swd_target_lend(bool lend)
+{
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	if (lend && port_on) {
+		(void)swdp_port_off(swdp_dev);
+		port_on = false;
+	}
+
+	lent = lend;
+	bg_connected = false;
+	k_mutex_unlock(&swd_lock);
+}
+
+int swd_target_dp_read(uint8_t addr, uint32_t *val)
+{
+	return bg_xfer(SWDP_REQUEST_RnW | (addr & SWD_REQUEST_ADDR_MASK), val);
+}
+
+int swd_target_dp_write(uint8_t addr, uint32_t val)
+{
+	if (addr == SWD_DP_SELECT) {
+		bg_select_valid = false;
+	}
+
+	return bg_xfer(addr & SWD_REQUEST_ADDR_MASK, &val);
+}
+
+int swd_target_ap_read(uint8_t addr, uint32_t *val)
+{
+	uint32_t dummy;
+	int ret;
+
+	ret = bg_ap_select(addr);
+	ret = ret ? ret
+		  : bg_xfer(SWDP_REQUEST_APnDP | SWDP_REQUEST_RnW | (addr & SWD_REQUEST_ADDR_MASK),
+			    &dummy);
+	ret = ret ? ret : bg_xfer(SWDP_REQUEST_RnW | SWD_DP_RDBUFF, val);
+
+	return ret;
+}
+
+int swd_target_ap_write(uint8_t addr, uint32_t val)
+{
+	int ret;
+
+	ret = bg_ap_select(addr);
+	ret = ret ? ret : bg_xfer(SWDP_REQUEST_APnDP | (addr & SWD_REQUEST_ADDR_MASK), &val);
+
+	return ret;
+}
+
+int swd_target_mem_read32(uint32_t addr, uint32_t *val)
+{
+	int ret;
+
+	ret = swd_target_ap_write(SWD_AP_TAR, addr);
+	ret = ret ? ret : swd_target_ap_read(SWD_AP_DRW, val);
+	if (ret == 0 && addr == CORTEXM_DHCSR) {
+		dhcsr_sticky |= *val & DHCSR_STICKY;
+	}
+
+	return ret;
+}
+
+int swd_target_mem_write32(uint32_t addr, uint32_t val)
+{
+	int ret;
+
+	ret = swd_target_ap_write(SWD_AP_TAR, addr);
+	ret = ret ? ret : swd_target_ap_write(SWD_AP_DRW, val);
+
+	return ret;
+}
+
+int swd_target_mem_read(uint32_t addr, uint8_t *buf, size_t len)
+{
+	uint32_t skip;
+	size_t words;
+	size_t chunk;
+	int ret;
+
+	while (len > 0) {
+		skip = addr & 3;
+		words = MIN(BLOCK_WORDS, DIV_ROUND_UP(skip + len, 4));
+		ret = bg_read_words(addr - skip, block, words);
+		if (ret) {
+			return ret;
+		}
+
+		chunk = MIN(len, words * 4 - skip);
+		memcpy(buf, (uint8_t *)block + skip, chunk);
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+int swd_target_mem_write(uint32_t addr, const uint8_t *buf, size_t len)
+{
+	size_t n;
+	int ret;
+
+	while (len > 0) {
+		if ((addr & 3) != 0 || len < 4) {
+			ret = bg_write_byte(addr, *buf);
+			if (ret) {
+				return ret;
+			}
+
+			addr++;
+			buf++;
+			len--;
+			continue;
+		}
+
+		n = MIN(len / 4, (TAR_AUTOINC_BLOCK - (addr % TAR_AUTOINC_BLOCK)) / 4);
+		ret = swd_target_ap_write(SWD_AP_TAR, addr);
+		for (size_t i = 0; i < n && ret == 0; i++) {
+			ret = swd_target_ap_write(SWD_AP_DRW, sys_get_le32(&buf[i * 4]));
+		}
+
+		if (ret) {
+			return ret;
+		}
+
+		addr += n * 4;
+		buf += n * 4;
+		len -= n * 4;
+	}
+
+	return 0;
+}
+
+int swd_target_calibrate(uint32_t max_hz, uint32_t *limit_hz)
+{
+	uint32_t clock = CONFIG_APP_SWD_CALIB_MIN_HZ;
+	uint32_t good = 0;
+	uint32_t effective = 0;
+	uint32_t idcode = 0;
+	uint32_t cpuid = 0;
+	uint32_t limit = 0;
+	uint32_t rate;
+	bool bounded = false;
+	int ret;
+
+	if (max_hz == 0) {
+		max_hz = CONFIG_APP_SWD_CALIB_MAX_HZ;
+	}
+
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	if (lent) {
+		k_mutex_unlock(&swd_lock);
+		return -EBUSY;
+	}
+
+	select_flush(stats.targetsel != 0);
+	stats.calibrations++;
+	calibrating = true;
+	bg_error = false;
+	bg_select_valid = false;
+	ap_saved = false;
+
+	if (!port_on) {
+		ret = swdp_port_on(swdp_dev);
+		if (ret) {
+			calibrating = false;
+			stats.calib_failures++;
+			k_mutex_unlock(&swd_lock);
+			return ret;
+		}
+
+		port_on = true;
+	}
+
+	/* Reference values at the start clock */
+	(void)swdp_set_clock(swdp_dev, clock);
+	bg_connected = false;
+	ret = bg_setup();
+	ret = ret ? ret : swd_target_dp_read(SWD_DP_IDCODE, &idcode);
+	ret = ret ? ret : swd_target_mem_read32(CORTEXM_CPUID, &cpuid);
+
+	while (ret == 0) {
+		(void)swdp_set_clock(swdp_dev, clock);
+		if (calib_step(idcode, cpuid) != 0) {
+			LOG_INF("SWD calibration failed at %u Hz", clock);
+			bounded = true;
+			break;
+		}
+
+		rate = calib_rate();
+		if (good != 0 && rate <= effective + effective / CALIB_RATE_DIV) {
+			LOG_INF("SWD clock saturated at %u Hz", good);
+			break;
+		}
+
+		good = clock;
+		effective = rate;
+		if (clock >= max_hz) {
+			break;
+		}
+
+		clock = MIN(clock + clock / CALIB_STEP_DIV, max_hz);
+	}
+
+	if (good != 0) {
+		limit = bounded ? good / 100 * (100 - CONFIG_APP_SWD_CALIB_MARGIN) : good;
+		stats.idcode = idcode;
+		stats.clock_limit = limit;
+		stats.calib_max_hz = good;
+		stats.calib_effective_hz = effective;
+		LOG_INF("SWD max clock %u Hz (%u bit/s), limit %u Hz", good, effective, limit);
+	} else {
+		stats.calib_failures++;
+	}
+
+	/* Back to the host's clock and a clean wire */
+	calibrating = false;
+	(void)clock_apply(true);
+	bg_error = false;
+	bg_select_valid = false;
+	bg_connected = false;
+	if (bg_connect() != 0) {
+		bg_error = true;
+	}
+
+	swd_target_end();
+
+	if (good == 0) {
+		return -EIO;
+	}
+
+	if (limit_hz != NULL) {
+		*limit_hz = limit;
+	}
+
+	return probe_settings_swd_clock_set(idcode, limit);
+}
+
+int swd_target_clock_forget(void)
+{
+	uint32_t idcode;
+	int ret;
+
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	idcode = stats.idcode;
+	k_mutex_unlock(&swd_lock);
+
+	if (idcode == 0) {
+		return -ENODEV;
+	}
+
+	ret = probe_settings_swd_clock_set(idcode, 0);
+	if (ret) {
+		return ret;
+	}
+
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	if (stats.idcode == idcode) {
+		stats.clock_limit = 0;
+		(void)clock_apply(false);
+	}
+
+	k_mutex_unlock(&swd_lock);
+
+	return 0;
+}
+
+int swd_target_enumerate(const uint32_t *candidates, size_t count, bool instances,
+			 struct swd_target_drop *found, size_t max)
+{
+	uint32_t targetsel;
+	size_t n = 0;
+	int ret;
+
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	if (lent) {
+		k_mutex_unlock(&swd_lock);
+		return -EBUSY;
+	}
+
+	select_flush(stats.targetsel != 0);
+	bg_error = false;
+	ap_saved = false;
+
+	if (!port_on) {
+		ret = swdp_port_on(swdp_dev);
+		if (ret) {
+			k_mutex_unlock(&swd_lock);
+			return ret;
+		}
+
+		port_on = true;
+	}
+
+	for (size_t i = 0; i < count && n < max; i++) {
+		for (uint32_t inst = 0; inst < (instances ? TARGETSEL_INSTANCES : 1) && n < max;
+		     inst++) {
+			targetsel = candidates[i];
+			if (instances) {
+				targetsel = (targetsel & ~SWD_TARGETSEL_INSTANCE_MASK) |
+					    (inst << TARGETSEL_INSTANCE_SHIFT);
+			}
+
+			if (drop_probe(targetsel, &found[n]) == 0) {
+				LOG_DBG("TARGETSEL 0x%08x: IDCODE 0x%08x", targetsel,
+					found[n].idcode);
+				n++;
+			}
+		}
+	}
+
+	/* Back to the host's target, the host must reconnect if it never selected one */
+	bg_select_valid = false;
+	bg_connected = false;
+	wire_ok = false;
+	if (stats.targetsel != 0 && bg_connect() != 0) {
+		bg_error = true;
+	}
+
+	swd_target_end();
+
+	return n;
+}
+
+void swd_target_stats_get(struct swd_target_stats *out, bool clear)
+{
+	k_mutex_lock(&swd_lock, K_FOREVER);
+	*out = stats;
+	if (clear) {
+		stats.transfers = 0;
+		stats.waits = 0;
+		stats.faults = 0;
+		stats.errors = 0;
+		stats.clamps = 0;
+		stats.calibrations = 0;
+		stats.calib_failures = 0;
+		stats.reselects = 0;
+		stats.reselects_skipped = 0;
+	}
+
+	k_mutex_unlock(&swd_lock);
+}
+
+static const struct swdp_api swd_target_api = {
+	.swdp_output_sequence = proxy_output_sequence,
+	.swdp_input_sequence = proxy_input_sequence,
+	.swdp_transfer = proxy_transfer,
+	.swdp_set_pins = proxy_set_pins,
+	.swdp_get_pins = proxy_get_pins,
+	.swdp_set_clock = proxy_set_clock,
+	.swdp_configure = proxy_configure,
+	.swdp_port_on = proxy_port_on,
+	.swdp_port_off = proxy_port_off,
+};
+
+static int swd_target_init(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	if (!device_is_ready(swdp_dev)) {
+		LOG_ERR("SWD port %s is not ready", swdp_dev->name);
+		return -ENODEV;
+	}
+
+	return 0;
+}
+
+DEVICE_DEFINE(swd_target, "swd_target", swd_target_init, NULL, NULL, NULL, POST_KERNEL,
+	      CONFIG_APPLICATION_INIT_PRIORITY, &swd_target_api);
@@ -0,0 +1,127 @@
+/**
+ * @file target_cortexm.c
+ * @brief Cortex-M core control over the shared debug port
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "target_cortexm.h"
+#include "swd_target.h"
+
+LOG_MODULE_REGISTER(target_cortexm, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define HALT_RETRIES   100
+#define REGRDY_RETRIES 100
+
+#define DCRSR_REGWNR BIT(16)
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static int wait_regrdy(void)
+{
+	uint32_t dhcsr;
+	int ret;
+
+	for (int i = 0; i < REGRDY_RETRIES; i++) {
+		ret = swd_target_mem_read32(CORTEXM_DHCSR, &dhcsr);
+		if (ret) {
+			return ret;
+		}
+
+		if (dhcsr & DHCSR_S_REGRDY) {
+			return 0;
+		}
+	}
+
+	return -ETIMEDOUT;
+}
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int cortexm_status(uint32_t *dhcsr)
+{
+	return swd_target_mem_read32(CORTEXM_DHCSR, dhcsr);
+}
+
+int cortexm_halt(void)
+{
+	uint32_t dhcsr;
+	int ret;
+
+	ret = swd_target_mem_write32(CORTEXM_DHCSR, DHCSR_DBGKEY | DHCSR_C_DEBUGEN | DHCSR_C_HALT);
+	for (int i = 0; i < HALT_RETRIES && ret == 0; i++) {
+		ret = swd_target_mem_read32(CORTEXM_DHCSR, &dhcsr);
+		if (ret == 0 && (dhcsr & DHCSR_S_HALT)) {
+			return 0;
+		}
+	}
+
+	return ret ? ret : -ETIMEDOUT;
+}
+
+int cortexm_resume(void)
+{
+	return swd_target_mem_write32(CORTEXM_DHCSR, DHCSR_DBGKEY | DHCSR_C_DEBUGEN);
+}
+
+int cortexm_reset(bool halt)
+{
+	uint32_t demcr;
+	int ret;
+
+	ret = swd_target_mem_read32(CORTEXM_DEMCR, &demcr);
+	if (ret) {
+		return ret;
+	}
+
+	if (halt) {
+		ret = swd_target_mem_write32(CORTEXM_DHCSR, DHCSR_DBGKEY | DHCSR_C_DEBUGEN);
+		ret = ret ? ret
+			  : swd_target_mem_write32(CORTEXM_DEMCR, demcr | DEMCR_VC_CORERESET);
+	} else {
+		ret = swd_target_mem_write32(CORTEXM_DEMCR, demcr & ~DEMCR_VC_CORERESET);
+		ret = ret ? ret : swd_target_mem_write32(CORTEXM_DHCSR, DHCSR_DBGKEY);
+	}
+
+	/* The reset may drop the write response, a failed ack here is expected */
+	if (ret == 0) {
+		(void)swd_target_mem_write32(CORTEXM_AIRCR, AIRCR_VECTKEY | AIRCR_SYSRESETREQ);
+		LOG_DBG("reset%s", halt ? " and halt" : "");
+	}
+
+	return ret;
+}
+
+int cortexm_reg_read(enum cortexm_reg reg, uint32_t *val)
+{
+	int ret;
+
+	ret = swd_target_mem_write32(CORTEXM_DCRSR, reg);
+	ret = ret ? ret : wait_regrdy();
+	ret = ret ? ret : swd_target_mem_read32(CORTEXM_DCRDR, val);
+
+	return ret;
+}
+
+int cortexm_reg_write(enum cortexm_reg reg, uint32_t val)
+{
+	int ret;
+
+	ret = swd_target_mem_write32(CORTEXM_DCRDR, val);
+	ret = ret ? ret : swd_target_mem_write32(CORTEXM_DCRSR, reg | DCRSR_REGWNR);
+	ret = ret ? ret : wait_regrdy();
+
+	return ret;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file target_monitor.c
+ * @brief Background target state monitor
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "target_monitor.h"
+#include "swd_target.h"
+#include "target_cortexm.h"
+
+LOG_MODULE_REGISTER(target_monitor, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define MONITOR_HOST_IDLE_MS 2
+/* Poll interval while no target answers */
+#define MONITOR_RESCAN_MS    500
+
+#define DFSR_VCATCH   BIT(3)
+#define IPSR_MASK     0x1FF
+#define EXC_HARDFAULT 3
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static K_SEM_DEFINE(monitor_wake, 0, 1);
+static K_SEM_DEFINE(event_sem, 0, 1);
+
+/* Protects the configuration and the current state */
+static struct k_spinlock monitor_lock;
+static uint8_t monitor_flags;
+static uint32_t monitor_interval_ms = CONFIG_APP_TARGET_MONITOR_INTERVAL_MS;
+static bool catch_pending;
+static struct target_monitor_event current;
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static enum target_state state_from_dhcsr(uint32_t dhcsr)
+{
+	if (dhcsr & DHCSR_S_LOCKUP) {
+		return TARGET_STATE_LOCKUP;
+	} else if (dhcsr & DHCSR_S_HALT) {
+		return TARGET_STATE_HALTED;
+	} else if (dhcsr & DHCSR_S_SLEEP) {
+		return TARGET_STATE_SLEEPING;
+	}
+
+	return TARGET_STATE_RUNNING;
+}
+
+static bool state_is_stopped(enum target_state state)
+{
+	return state == TARGET_STATE_HALTED || state == TARGET_STATE_LOCKUP;
+}
+
+static int vector_catch_set(bool catch)
+{
+	uint32_t demcr;
+	int ret;
+
+	ret = swd_target_mem_read32(CORTEXM_DEMCR, &demcr);
+	if (ret) {
+		return ret;
+	}
+
+	demcr = catch ? (demcr | DEMCR_VC_HARDERR) : (demcr & ~DEMCR_VC_HARDERR);
+
+	return swd_target_mem_write32(CORTEXM_DEMCR, demcr);
+}
+
+static void vector_catch_update(bool catch)
+{
+	int ret;
+
+	/* Requested by the host, do not wait for it to go idle */
+	ret = swd_target_begin(0);
+	if (ret == 0) {
+		ret = vector_catch_set(catch);
+		swd_target_end();
+	}
+
+	if (ret) {
+		LOG_DBG("vector catch update failed: %d", ret);
+		/* Try again with the next poll */
+		catch_pending = true;
+	}
+}
+
+/* Reads the halt details when the core just stopped */
+static int halt_info_read(struct target_monitor_event *snap, bool capture, bool *hardfault)
+{
+	uint32_t xpsr;
+	int ret;
+
+	ret = swd_target_mem_read32(CORTEXM_DFSR, &snap->dfsr);
+	ret = ret ? ret : cortexm_reg_read(CORTEXM_REG_XPSR, &xpsr);
+	if (ret) {
+		return ret;
+	}
+
+	*hardfault = (snap->dfsr & DFSR_VCATCH) && (xpsr & IPSR_MASK) == EXC_HARDFAULT;
+	snap->regs_valid = false;
+	for (int i = 0; capture && i < TARGET_MONITOR_REG_COUNT; i++) {
+		ret = cortexm_reg_read((enum cortexm_reg)i, &snap->regs[i]);
+		if (ret) {
+			return ret;
+		}
+	}
+
+	snap->regs_valid = capture;
+
+	return 0;
+}
+
+static void monitor_update(const struct target_monitor_event *snap, bool halt_read,
+			   bool hardfault)
+{
+	k_spinlock_key_t key = k_spin_lock(&monitor_lock);
+	uint8_t events = 0;
+
+	if (snap->state != current.state) {
+		if (snap->state == TARGET_STATE_HALTED) {
+			events |= TARGET_EVT_HALT;
+		} else if (snap->state == TARGET_STATE_LOCKUP) {
+			events |= TARGET_EVT_LOCKUP;
+		} else if (snap->state == TARGET_STATE_UNKNOWN) {
+			events |= TARGET_EVT_LOST;
+		} else if (state_is_stopped(current.state)) {
+			events |= TARGET_EVT_RUN;
+		}
+	}
+
+	if (snap->dhcsr & DHCSR_S_RESET_ST) {
+		events |= TARGET_EVT_RESET;
+	}
+
+	if (hardfault) {
+		events |= TARGET_EVT_HARDFAULT;
+	}
+
+	current.state = snap->state;
+	current.dhcsr = snap->dhcsr;
+	if (halt_read) {
+		current.dfsr = snap->dfsr;
+		current.regs_valid = snap->regs_valid;
+		memcpy(current.regs, snap->regs, sizeof(current.regs));
+	}
+
+	if (events != 0) {
+		current.events |= events;
+		current.timestamp_ms = k_uptime_get_32();
+	}
+
+	k_spin_unlock(&monitor_lock, key);
+
+	if (events != 0) {
+		LOG_DBG("state %d events 0x%02x", snap->state, events);
+		k_sem_give(&event_sem);
+	}
+}
+
+static void monitor_thread_fn(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	struct target_monitor_event snap;
+	k_spinlock_key_t key;
+	uint32_t interval_ms = 0;
+	enum target_state last_state;
+	bool update_catch;
+	bool hardfault;
+	bool halt_read;
+	uint8_t flags;
+	int ret;
+
+	while (true) {
+		(void)k_sem_take(&monitor_wake, interval_ms ? K_MSEC(interval_ms) : K_FOREVER);
+
+		key = k_spin_lock(&monitor_lock);
+		flags = monitor_flags;
+		interval_ms = (flags & TARGET_MONITOR_ENABLE) ? monitor_interval_ms : 0;
+		update_catch = catch_pending;
+		catch_pending = false;
+		last_state = current.state;
+		k_spin_unlock(&monitor_lock, key);
+
+		if (update_catch) {
+			vector_catch_update((flags & TARGET_MONITOR_ENABLE) &&
+					    (flags & TARGET_MONITOR_CATCH_HARDFAULT));
+		}
+
+		if (interval_ms == 0) {
+			continue;
+		}
+
+		ret = swd_target_begin(MONITOR_HOST_IDLE_MS);
+		if (ret == -EBUSY) {
+			continue;
+		} else if (ret) {
+			/* No target on the port */
+			snap.state = TARGET_STATE_UNKNOWN;
+			snap.dhcsr = 0;
+			monitor_update(&snap, false, false);
+			swd_target_release();
+			interval_ms = MAX(interval_ms, MONITOR_RESCAN_MS);
+			continue;
+		}
+
+		hardfault = false;
+		halt_read = false;
+		ret = cortexm_status(&snap.dhcsr);
+		if (ret == 0) {
+			snap.state = state_from_dhcsr(snap.dhcsr);
+			if (state_is_stopped(snap.state) && !state_is_stopped(last_state)) {
+				ret = halt_info_read(&snap, flags & TARGET_MONITOR_CAPTURE_REGS,
+						     &hardfault);
+				halt_read = ret == 0;
+			}
+		}
+
+		swd_target_end();
+
+		if (ret) {
+			LOG_DBG("poll failed: %d", ret);
+			continue;
+		}
+
+		monitor_update(&snap, halt_read, hardfault);
+	}
+}
+
+K_THREAD_DEFINE(target_monitor_thread, CONFIG_APP_TARGET_MONITOR_STACK_SIZE, monitor_thread_fn,
+		NULL, NULL, NULL, CONFIG_APP_TARGET_MONITOR_THREAD_PRIORITY, 0, 0);
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+void target_monitor_configure(uint8_t flags, uint16_t interval_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&monitor_lock);
+
+	if ((flags & TARGET_MONITOR_ENABLE) && !(monitor_flags & TARGET_MONITOR_ENABLE)) {
+		/* Start from scratch, the first poll reports the current state */
+		memset(&current, 0, sizeof(current));
+	}
+
+	/* Set or clear the vector catch on the next pass, also when stopping */
+	catch_pending = (flags | monitor_flags) & TARGET_MONITOR_CATCH_HARDFAULT;
+	monitor_flags = flags;
+	monitor_interval_ms = interval_ms ? interval_ms : CONFIG_APP_TARGET_MONITOR_INTERVAL_MS;
+	k_spin_unlock(&monitor_lock, key);
+
+	LOG_INF("flags 0x%02x interval %u ms", flags, monitor_interval_ms);
+	k_sem_give(&monitor_wake);
+	/* Let a waiter see that the monitor stopped */
+	k_sem_give(&event_sem);
+}
+
+int target_monitor_wait(uint32_t timeout_ms, struct target_monitor_event *event)
+{
+	int64_t deadline = k_uptime_get() + timeout_ms;
+	k_spinlock_key_t key;
+	int64_t left;
+	int ret;
+
+	while (true) {
+		key = k_spin_lock(&monitor_lock);
+		*event = current;
+		if (!(monitor_flags & TARGET_MONITOR_ENABLE)) {
+			ret = -ENODEV;
+		} else if (current.events != 0) {
+			current.events = 0;
+			ret = 0;
+		} else {
+			ret = -EAGAIN;
+		}
+
+		k_spin_unlock(&monitor_lock, key);
+
+		left = deadline - k_uptime_get();
+		if (ret != -EAGAIN || left <= 0) {
+			return ret;
+		}
+
+		(void)k_sem_take(&event_sem, K_MSEC(left));
+	}
+}
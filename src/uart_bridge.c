@@ -6,41 +6,247 @@
  */
 
 #include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/sys/ring_buffer.h>
 #include <zephyr/pm/device.h>
 
 #include "uart_bridge.h"
 #include "led.h"
+#include "probe_settings.h"
+#include "prbs.h"
+#if defined(CONFIG_APP_UART_TAP)
+#include "uart_tap.h"
+#endif
+#if defined(CONFIG_RFPROS_UART_PL011_CTRL)
+#include "uart_pl011_ctrl.h"
+#endif
 
 #define DT_DRV_COMPAT rfpros_uart_bridge
 LOG_MODULE_REGISTER(uart_bridge, CONFIG_UART_LOG_LEVEL);
 
-#define RING_BUF_SIZE           CONFIG_RFPROS_UART_BRIDGE_BUF_SIZE
-#define RING_BUF_FULL_THRESHOLD 512
 #define LED_ACTIVITY_TIMER_MS   50
 #define BRIDGE_COUNT            DT_NUM_INST_STATUS_OKAY(DT_DRV_COMPAT)
+#define DE_DRAIN_SPIN_US        50
+/* Longer holds are timed by re-arming the DE timer instead of spinning in its isr */
+#define DE_HOLD_SPIN_US         20
+/* Both are bounded, the setup delay is spun in the tx isr */
+#define DE_SETUP_MAX_US         100
+#define DE_HOLD_MAX_US          10000
+#define DE_ECHO_DISCARD_SIZE    16
+#define DELAY_STAMP_COUNT       8
+#define THROTTLE_QUANTUM        64
+#define THROTTLE_RECHECK_MS     1
+#define THROTTLE_STALL_MS       10
+#define HISTORY_CHUNK           32
+#define PRBS_RX_CHUNK           64
+/* Pattern queued ahead of the tested port, more would only add to the measured latency */
+#define PRBS_TX_CHUNK           512
+/* A port pauses with less space than this left in its ring, a quarter of small rings */
+#define RING_BUF_FULL_THRESHOLD(size) MIN(512, (size) / 4)
+
+/* Edges timed per autobaud measurement */
+#define AUTOBAUD_EDGES         64
+/* Intervals that must agree with the shortest one, single short glitches are not bit times */
+#define AUTOBAUD_MIN_MATCH     3
+/* Longest run of equal bits in a frame: start bit, 8 data bits and parity */
+#define AUTOBAUD_MAX_RUN       10
+/* A measured rate this close to a standard one is rounded to it */
+#define AUTOBAUD_SNAP_PERMILLE 30
+/* The edge ISR takes about 2 us at 125 MHz from the edge to its timestamp, an edge that comes
+ * while it runs is stamped when it returns. Intervals shorter than that are edges it could not
+ * separate, and above 230400 baud a bit is too close to it for the stamps to be usable.
+ */
+#define AUTOBAUD_INTERVAL_MIN_US 3
+#define AUTOBAUD_RATE_MAX        230400
+
+/* Saved line coding format, in uart_config enum values */
+#define LINE_FORMAT(data_bits, parity, stop_bits)                                                  \
+	((data_bits) | ((parity) << 3) | ((stop_bits) << 6))
+#define LINE_FORMAT_DATA_BITS(format) ((format) & 0x07)
+#define LINE_FORMAT_PARITY(format)    (((format) >> 3) & 0x07)
+#define LINE_FORMAT_STOP_BITS(format) (((format) >> 6) & 0x03)
 
 /* Global LED work - shared across all bridges */
 static struct k_work_delayable global_led_work;
 static const struct device *bridge_devices[BRIDGE_COUNT];
 static uint8_t bridge_count = 0;
 
+/* Upper bound of the device handles, every device of this firmware comes from an enabled
+ * devicetree node
+ */
+#define UART_BRIDGE_NODE_COUNT(node) +1
+#define BRIDGE_MAP_SIZE              (1 DT_FOREACH_STATUS_OKAY_NODE(UART_BRIDGE_NODE_COUNT))
+
+/* Bridge of every peer by device handle, set when the bridge initializes */
+static const struct device *bridge_map[BRIDGE_MAP_SIZE];
+
+/* Resumes ports that were throttled in favour of a higher priority bridge */
+static struct k_work_delayable global_throttle_work;
+/* Bit per bridge index, set while the bridge sends and still has data queued */
+static atomic_t bridge_busy;
+BUILD_ASSERT(BRIDGE_COUNT <= 32, "uart-bridge busy mask has one bit per bridge");
+/* Asks the host to resume the bus when a target sends while it is suspended */
+static struct k_work global_wakeup_work;
+static uart_bridge_wakeup_cb_t bridge_wakeup_cb;
+
+struct uart_bridge_port;
+
 struct uart_bridge_config {
 	const struct device *peer_dev[2];
+	/* Isr context of each peer, in peers order */
+	const struct uart_bridge_port *port;
+	struct gpio_dt_spec dtr_gpio;
+	struct gpio_dt_spec rts_gpio;
+	uint32_t reset_pulse_us;
+	bool esp_autoreset;
+	struct gpio_dt_spec de_gpio;
+	uint16_t de_setup_us;
+	uint16_t de_hold_us;
+	/* Index of the hardware UART peer */
+	uint8_t hw_idx;
+	bool echo_suppress;
+	uint8_t priority;
+	/* Ring storage of each direction, in peers order, and its size */
+	uint8_t *buf[2];
+	uint32_t buf_size;
+	uint32_t full_threshold;
+	/* Keeps the hardware UART output while no host is attached */
+	uint8_t *history_buf;
+	uint32_t history_size;
+	/* Receives a timestamped copy of the traffic in both directions */
+	const struct device *tap_dev;
+	/* Receive FIFO interrupt level in bytes, -1 to follow the baud rate */
+	int8_t rx_fifo_threshold;
+	/* Pin the target transmits on, timed to detect its baud rate */
+	struct gpio_dt_spec autobaud_gpio;
+	/* Devicetree path, hashed into the saved settings key */
+	const char *path;
+};
+
+/* Arrival time of the data in a ring, in received byte count order */
+struct uart_bridge_stamp {
+	uint32_t end;
+	uint32_t cycles;
+};
+
+/* PRBS test mode, the generator runs in the tx path and the checker in the rx path of one port */
+struct uart_bridge_prbs {
+	struct k_spinlock lock;
+	enum uart_bridge_prbs_mode mode;
+	/* Index of the port under test */
+	uint8_t idx;
+	struct prbs_gen gen;
+	struct prbs_check check;
+	uint32_t start_ms;
+	uint32_t stop_ms;
+	uint32_t tx_bytes;
+	uint32_t rx_bytes;
+	/* One byte in flight is timed at a time */
+	bool mark;
+	uint32_t mark_end;
+	uint32_t mark_cycles;
+	uint32_t latency_min_cyc;
+	uint32_t latency_max_cyc;
+	uint64_t latency_sum_cyc;
+	uint32_t latency_samples;
+};
+
+/* Edge timestamps of an autobaud measurement, one bridge is measured at a time */
+struct uart_bridge_autobaud {
+	struct k_mutex lock;
+	struct k_sem done;
+	struct gpio_callback cb;
+	/* Cycle counter at each edge, turned into the intervals between them once complete */
+	uint32_t edges[AUTOBAUD_EDGES];
+	volatile uint8_t count;
+};
+
+static struct uart_bridge_autobaud autobaud;
+
+static const uint32_t autobaud_rates[] = {
+	1200, 2400, 4800, 9600, 14400, 19200, 38400, 57600, 74880, 115200, 230400,
 };
 
 struct uart_bridge_peer_data {
-	uint8_t buf[RING_BUF_SIZE];
 	struct ring_buf rb;
 	bool paused;
+	bool throttled;
+	struct k_spinlock stamp_lock;
+	struct uart_bridge_stamp stamp[DELAY_STAMP_COUNT];
+	uint8_t stamp_head;
+	uint8_t stamp_count;
+	uint32_t in_total;
+	uint32_t out_total;
+	uint32_t delay_max_cyc;
+	uint64_t delay_sum_cyc;
+	uint32_t delay_samples;
+	uint32_t throttle_count;
+	uint32_t bytes;
+	uint32_t rx_irqs;
+	/* Cycles spent in the isr of the port, written by the isr only */
+	uint32_t isr_calls;
+	uint32_t isr_max_cyc;
+	uint64_t isr_sum_cyc;
 };
 
 struct uart_bridge_data {
 	struct uart_bridge_peer_data peer[2];
 	bool activity;
+	bool modem_boot;
+	bool modem_reset;
+	struct k_timer modem_pulse;
+	struct k_timer de_timer;
+	struct k_spinlock de_lock;
+	uint32_t char_us;
+	bool de_active;
+	/* The last stop bit is out, DE is released when the timer expires again */
+	bool de_holding;
+	uint32_t last_tx_cycles;
+	/* The hardware UART uses RTS/CTS, cached by uart_bridge_rx_tune() */
+	bool hw_flow_ctrl;
+	/* Written by the hardware UART isr, read by the USB side */
+	struct k_spinlock history_lock;
+	struct ring_buf history;
+	bool attached;
+	uint32_t history_dropped;
+	/* Index in bridge_devices */
+	uint8_t idx;
+	/* Bridges of a higher priority, by index, set as the bridges initialize */
+	uint32_t higher_mask;
+	/* Saved settings key, see uart_bridge_id_get() */
+	uint16_t id;
+	struct uart_bridge_prbs prbs;
+	/* USB bus suspended, the USB side is stopped */
+	bool suspended;
+	bool wakeup_requested;
+	/* Set on resume until the USB side is serviced again */
+	bool resume_pending;
+	uint32_t resume_cycles;
+	uint32_t suspend_count;
+	uint32_t suspend_held;
+	uint32_t resume_latency_cyc;
+	uint32_t resume_latency_max_cyc;
+};
+
+/* One side of a bridge, generated per instance and passed to the isr of the peer so it does not
+ * have to work out which side it is on
+ */
+struct uart_bridge_port {
+	const struct device *bridge_dev;
+	const struct device *peer_dev;
+	/* Ring filled by this side, and the one it sends from */
+	struct uart_bridge_peer_data *own_data;
+	struct uart_bridge_peer_data *peer_data;
+	/* Position in the peers property */
+	uint8_t idx;
+	/* Hardware UART side */
+	bool hw;
+	/* Hardware side of a half-duplex bridge, drives the DE pin */
+	bool de;
 };
 
 const struct device *uart_bridge_get_peer(const struct device *dev, const struct device *bridge_dev)
@@ -56,6 +262,13 @@ const struct device *uart_bridge_get_peer(const struct device *dev, const struct
 	}
 }
 
+bool uart_bridge_is_half_duplex(const struct device *bridge_dev)
+{
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+
+	return cfg->de_gpio.port != NULL;
+}
+
 void uart_bridge_settings_update(const struct device *dev, const struct device *bridge_dev)
 {
 	struct uart_config cfg;
@@ -82,226 +295,1562 @@ void uart_bridge_settings_update(const struct device *dev, const struct device *
 		return;
 	}
 
+	uart_bridge_rx_tune(bridge_dev);
 	LOG_INF("uart settings: baudrate=%d parity=%d dev=%s", cfg.baudrate, cfg.parity,
 		peer_dev->name);
 }
 
-static uint8_t uart_bridge_get_idx(const struct device *dev, const struct device *bridge_dev,
-				   bool own)
+const struct device *uart_bridge_find(const struct device *dev)
+{
+	device_handle_t handle = device_handle_get(dev);
+	const struct device *bridge_dev;
+
+	if (handle <= DEVICE_HANDLE_NULL || handle >= BRIDGE_MAP_SIZE) {
+		return NULL;
+	}
+
+	bridge_dev = bridge_map[handle];
+
+	return bridge_dev != NULL && device_is_ready(bridge_dev) ? bridge_dev : NULL;
+}
+
+void uart_bridge_peer_configure(const struct device *dev)
+{
+	const struct device *bridge_dev = uart_bridge_find(dev);
+
+	if (bridge_dev == NULL) {
+		LOG_DBG("%s: not part of any bridge", dev->name);
+		return;
+	}
+
+	uart_bridge_settings_update(dev, bridge_dev);
+}
+
+static void uart_bridge_modem_set(const struct gpio_dt_spec *spec, bool active)
 {
+	if (spec->port == NULL) {
+		return;
+	}
+
+	/* Release the pin when inactive so the SWD driver or the vendor IO commands can use it */
+	(void)gpio_pin_configure_dt(spec, active ? GPIO_OUTPUT_ACTIVE : GPIO_DISCONNECTED);
+}
+
+static void uart_bridge_modem_pulse_expiry(struct k_timer *timer)
+{
+	const struct device *bridge_dev = k_timer_user_data_get(timer);
 	const struct uart_bridge_config *cfg = bridge_dev->config;
 
-	if (dev == cfg->peer_dev[0]) {
-		return own ? 0 : 1;
+	uart_bridge_modem_set(&cfg->rts_gpio, false);
+}
+
+void uart_bridge_modem_update(const struct device *dev, const struct device *bridge_dev)
+{
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
+	uint32_t dtr = 0;
+	uint32_t rts = 0;
+	bool boot;
+	bool reset;
+
+	if (cfg->dtr_gpio.port == NULL && cfg->rts_gpio.port == NULL) {
+		return;
+	}
+
+	if (uart_bridge_get_peer(dev, bridge_dev) == NULL) {
+		return;
+	}
+
+	(void)uart_line_ctrl_get(dev, UART_LINE_CTRL_DTR, &dtr);
+	(void)uart_line_ctrl_get(dev, UART_LINE_CTRL_RTS, &rts);
+
+	if (cfg->esp_autoreset) {
+		/* Asserting both lines together leaves the target running */
+		reset = rts && !dtr;
+		boot = dtr && !rts;
 	} else {
-		return own ? 1 : 0;
+		reset = rts != 0;
+		boot = dtr != 0;
+	}
+
+	/* Boot pin first so it is already held when reset is released */
+	if (boot != data->modem_boot) {
+		data->modem_boot = boot;
+		uart_bridge_modem_set(&cfg->dtr_gpio, boot);
+	}
+
+	if (reset != data->modem_reset) {
+		data->modem_reset = reset;
+		if (cfg->reset_pulse_us == 0) {
+			uart_bridge_modem_set(&cfg->rts_gpio, reset);
+		} else if (reset && k_timer_remaining_get(&data->modem_pulse) == 0) {
+			uart_bridge_modem_set(&cfg->rts_gpio, true);
+			k_timer_start(&data->modem_pulse, K_USEC(cfg->reset_pulse_us), K_NO_WAIT);
+		}
 	}
+
+	LOG_DBG("%s: modem lines dtr=%u rts=%u boot=%d reset=%d", dev->name, dtr, rts, boot,
+		reset);
 }
 
-static void uart_bridge_handle_rx(const struct device *dev, const struct device *bridge_dev)
+void uart_bridge_attach(const struct device *dev, const struct device *bridge_dev, bool attached)
 {
 	const struct uart_bridge_config *cfg = bridge_dev->config;
 	struct uart_bridge_data *data = bridge_dev->data;
+	const struct device *hw_dev = cfg->peer_dev[cfg->hw_idx];
+	struct uart_bridge_peer_data *hw_data = &data->peer[cfg->hw_idx];
+	k_spinlock_key_t key;
+	uint32_t pending;
 
-	const struct device *peer_dev = cfg->peer_dev[uart_bridge_get_idx(dev, bridge_dev, false)];
-	struct uart_bridge_peer_data *own_data =
-		&data->peer[uart_bridge_get_idx(dev, bridge_dev, true)];
+	if (dev == hw_dev || uart_bridge_get_peer(dev, bridge_dev) == NULL) {
+		return;
+	}
 
-	uint8_t *recv_buf;
-	int rb_len, recv_len;
-	int ret;
+	/* Virtual UARTs use DTR to start and stop their backend, hardware UARTs ignore it */
+	(void)uart_line_ctrl_set(hw_dev, UART_LINE_CTRL_DTR, attached);
 
-	if (ring_buf_space_get(&own_data->rb) < RING_BUF_FULL_THRESHOLD) {
-		LOG_DBG("%s: buffer full: pause", dev->name);
-		uart_irq_rx_disable(dev);
-		own_data->paused = true;
+	if (cfg->history_size == 0) {
 		return;
 	}
 
-	rb_len = ring_buf_put_claim(&own_data->rb, &recv_buf, RING_BUF_SIZE);
-	if (rb_len == 0) {
-		LOG_WRN("%s: ring_buf full", dev->name);
+	key = k_spin_lock(&data->history_lock);
+	if (data->attached == attached) {
+		k_spin_unlock(&data->history_lock, key);
 		return;
 	}
 
-	recv_len = uart_fifo_read(dev, recv_buf, rb_len);
-	if (recv_len < 0) {
-		(void)ring_buf_put_finish(&own_data->rb, 0);
-		LOG_ERR("%s: rx error: %d", dev->name, recv_len);
-		return;
-	} else {
-		LOG_DBG("%s: received %d bytes", dev->name, recv_len);
-		data->activity = true;
-		/* Start LED timer if not already running */
-		if (!k_work_delayable_is_pending(&global_led_work)) {
-			k_work_schedule(&global_led_work, K_MSEC(LED_ACTIVITY_TIMER_MS));
+	data->attached = attached;
+	pending = ring_buf_size_get(&data->history);
+	k_spin_unlock(&data->history_lock, key);
+
+	if (attached) {
+		LOG_INF("%s: replay %u bytes of history, %u dropped", hw_dev->name, pending,
+			data->history_dropped);
+		data->history_dropped = 0;
+		uart_irq_tx_enable(dev);
+	} else if (hw_data->paused && !hw_data->throttled) {
+		/* The host stopped reading, keep receiving into the history instead */
+		hw_data->paused = false;
+		uart_irq_rx_enable(hw_dev);
+	}
+}
+
+static void uart_bridge_tap(const struct uart_bridge_port *port, const uint8_t *buf, int len)
+{
+#if defined(CONFIG_APP_UART_TAP)
+	const struct uart_bridge_config *cfg = port->bridge_dev->config;
+	struct uart_bridge_data *data = port->bridge_dev->data;
+
+	if (cfg->tap_dev != NULL && len > 0) {
+		uart_tap_put(cfg->tap_dev, UART_TAP_SRC(data->idx, port->idx), buf, len);
+	}
+#endif
+}
+
+/* Returns true if the received data went to the history instead of the peer */
+static bool uart_bridge_history_rx(const struct device *dev, const struct uart_bridge_port *port)
+{
+	struct uart_bridge_data *data = port->bridge_dev->data;
+	uint8_t chunk[HISTORY_CHUNK];
+	k_spinlock_key_t key;
+	uint32_t space;
+	bool attached;
+	int len;
+
+	key = k_spin_lock(&data->history_lock);
+	attached = data->attached;
+	/* Once the history is replayed the bridge runs as usual */
+	if (attached && ring_buf_is_empty(&data->history)) {
+		k_spin_unlock(&data->history_lock, key);
+		return false;
+	}
+
+	while ((len = uart_fifo_read(dev, chunk, sizeof(chunk))) > 0) {
+		uart_bridge_tap(port, chunk, len);
+		space = ring_buf_space_get(&data->history);
+		if (space < len) {
+			/* Keep the most recent output */
+			(void)ring_buf_get(&data->history, NULL, len - space);
+			data->history_dropped += len - space;
 		}
+
+		(void)ring_buf_put(&data->history, chunk, len);
+		data->activity = true;
 	}
+	k_spin_unlock(&data->history_lock, key);
 
-	ret = ring_buf_put_finish(&own_data->rb, recv_len);
-	if (ret < 0) {
-		LOG_ERR("%s: ring_buf_put_finish error: %d", dev->name, rb_len);
-		return;
+	if (attached) {
+		uart_irq_tx_enable(port->peer_dev);
 	}
 
-	uart_irq_tx_enable(peer_dev);
+	return true;
 }
 
-static void uart_bridge_handle_tx(const struct device *dev, const struct device *bridge_dev)
+/* Returns true if history data was sent to the host */
+static bool uart_bridge_history_tx(const struct device *dev, const struct device *bridge_dev)
 {
 	const struct uart_bridge_config *cfg = bridge_dev->config;
 	struct uart_bridge_data *data = bridge_dev->data;
+	k_spinlock_key_t key;
+	uint8_t *send_buf;
+	int len;
 
-	const struct device *peer_dev = cfg->peer_dev[uart_bridge_get_idx(dev, bridge_dev, false)];
-	struct uart_bridge_peer_data *peer_data =
-		&data->peer[uart_bridge_get_idx(dev, bridge_dev, false)];
+	key = k_spin_lock(&data->history_lock);
+	len = data->attached ? ring_buf_get_claim(&data->history, &send_buf, cfg->history_size) : 0;
+	if (len > 0) {
+		len = uart_fifo_fill(dev, send_buf, len);
+		(void)ring_buf_get_finish(&data->history, MAX(len, 0));
+	}
+	k_spin_unlock(&data->history_lock, key);
 
-	uint8_t *send_buf;
-	int rb_len, sent_len;
+	if (len > 0) {
+		data->activity = true;
+	}
+
+	return len > 0;
+}
+
+static uint32_t uart_bridge_char_us(const struct uart_config *cfg)
+{
+	uint32_t bits = 1 + 5 + cfg->data_bits;
+
+	bits += cfg->parity == UART_CFG_PARITY_NONE ? 0 : 1;
+	bits += cfg->stop_bits >= UART_CFG_STOP_BITS_1_5 ? 2 : 1;
+
+	return DIV_ROUND_UP(bits * USEC_PER_SEC, MAX(cfg->baudrate, 1));
+}
+
+#if defined(CONFIG_RFPROS_UART_PL011_CTRL)
+/* The FIFOs stay enabled at every rate, with the lowest level a lone byte at a low rate waits
+ * for the receive timeout of 32 bit periods, about 3 characters. Turning the FIFO off would
+ * forward it right away but also turn off the transmit FIFO, and the tx isr would then run for
+ * every byte sent as well.
+ */
+static void uart_bridge_rx_level_set(const struct uart_bridge_config *cfg,
+				     const struct device *hw_dev,
+				     const struct uart_config *uart_cfg)
+{
+	/* Bytes per PL011 receive FIFO level */
+	static const uint8_t rx_fifo_levels[] = {4, 8, 16, 24, 28};
+	int threshold = cfg->rx_fifo_threshold;
+	uint32_t char_us;
 	int ret;
 
-	rb_len = ring_buf_get_claim(&peer_data->rb, &send_buf, RING_BUF_SIZE);
-	if (rb_len == 0) {
-		LOG_DBG("%s: buffer empty, disable tx irq", dev->name);
-		uart_irq_tx_disable(dev);
-		return;
+	if (threshold < 0) {
+		/* The highest level that fills within the latency budget, at least the lowest
+		 * one. 7/8 leaves too little room for the isr latency.
+		 */
+		char_us = uart_bridge_char_us(uart_cfg);
+		threshold = UART_PL011_RX_LEVEL_MIN;
+		for (int i = 1; i < ARRAY_SIZE(rx_fifo_levels) - 1; i++) {
+			if (rx_fifo_levels[i] * char_us <=
+			    CONFIG_RFPROS_UART_BRIDGE_RX_LATENCY_US) {
+				threshold = rx_fifo_levels[i];
+			}
+		}
 	}
 
-	sent_len = uart_fifo_fill(dev, send_buf, rb_len);
-	if (sent_len < 0) {
-		(void)ring_buf_get_finish(&peer_data->rb, 0);
-		LOG_ERR("%s: tx error: %d", dev->name, sent_len);
+	ret = uart_pl011_rx_level_set(hw_dev, threshold);
+	if (ret) {
+		LOG_WRN("%s: failed to set rx fifo threshold %d: %d", hw_dev->name, threshold, ret);
 		return;
-	} else {
-		LOG_DBG("%s: sent %d bytes", dev->name, sent_len);
-		data->activity = true;
 	}
 
-	ret = ring_buf_get_finish(&peer_data->rb, sent_len);
-	if (ret < 0) {
-		LOG_ERR("ring_buf_get_finish error: %d", ret);
+	LOG_DBG("%s: %u baud, rx fifo threshold %d", hw_dev->name, uart_cfg->baudrate, threshold);
+}
+#endif
+
+static bool uart_bridge_has_loopback(const struct uart_bridge_config *cfg)
+{
+#if defined(CONFIG_RFPROS_UART_PL011_CTRL)
+	return uart_pl011_ctrl_supported(cfg->peer_dev[cfg->hw_idx]);
+#else
+	ARG_UNUSED(cfg);
+
+	return false;
+#endif
+}
+
+void uart_bridge_rx_tune(const struct device *bridge_dev)
+{
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	const struct device *hw_dev = cfg->peer_dev[cfg->hw_idx];
+	struct uart_bridge_data *data = bridge_dev->data;
+	struct uart_config uart_cfg;
+
+	if (uart_config_get(hw_dev, &uart_cfg) != 0) {
 		return;
 	}
 
-	if (peer_data->paused && ring_buf_space_get(&peer_data->rb) > RING_BUF_FULL_THRESHOLD) {
-		LOG_DBG("%s: buffer free: resume", dev->name);
-		uart_irq_rx_enable(peer_dev);
-		peer_data->paused = false;
-		return;
+	/* Read by the rx isr, which must not query the driver on every event */
+	data->hw_flow_ctrl = uart_cfg.flow_ctrl == UART_CFG_FLOW_CTRL_RTS_CTS;
+
+#if defined(CONFIG_RFPROS_UART_PL011_CTRL)
+	if (uart_pl011_ctrl_supported(hw_dev)) {
+		uart_bridge_rx_level_set(cfg, hw_dev, &uart_cfg);
 	}
+#endif
 }
 
-static void interrupt_handler(const struct device *dev, void *user_data)
+static void uart_bridge_de_discard_echo(const struct device *dev)
 {
-	const struct device *bridge_dev = user_data;
+	uint8_t discard[DE_ECHO_DISCARD_SIZE];
 
-	while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
-		if (uart_irq_rx_ready(dev)) {
-			uart_bridge_handle_rx(dev, bridge_dev);
-		}
+	while (uart_fifo_read(dev, discard, sizeof(discard)) > 0) {
+	}
+}
 
-		if (uart_irq_tx_ready(dev)) {
-			uart_bridge_handle_tx(dev, bridge_dev);
+/* Drive the transceiver before the first start bit goes out. Called from the tx isr. */
+static void uart_bridge_de_assert(const struct device *dev, const struct device *bridge_dev)
+{
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
+	struct uart_config uart_cfg;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&data->de_lock);
+	k_timer_stop(&data->de_timer);
+	data->de_holding = false;
+	if (!data->de_active) {
+		if (uart_config_get(dev, &uart_cfg) == 0) {
+			data->char_us = uart_bridge_char_us(&uart_cfg);
 		}
+		gpio_pin_set_dt(&cfg->de_gpio, 1);
+		data->de_active = true;
+		k_busy_wait(cfg->de_setup_us);
 	}
+	k_spin_unlock(&data->de_lock, key);
 }
 
-static int uart_bridge_pm_action(const struct device *dev, enum pm_device_action action)
+static void uart_bridge_de_release(const struct device *dev, const struct device *bridge_dev)
 {
-	const struct uart_bridge_config *cfg = dev->config;
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
 
-	switch (action) {
-	case PM_DEVICE_ACTION_SUSPEND:
-		k_work_cancel_delayable(&global_led_work);
-		uart_irq_rx_disable(cfg->peer_dev[0]);
-		uart_irq_rx_disable(cfg->peer_dev[1]);
-		uart_irq_callback_user_data_set(cfg->peer_dev[0], NULL, NULL);
-		uart_irq_callback_user_data_set(cfg->peer_dev[1], NULL, NULL);
-		break;
-	case PM_DEVICE_ACTION_RESUME:
-		uart_irq_callback_user_data_set(cfg->peer_dev[0], interrupt_handler, (void *)dev);
-		uart_irq_callback_user_data_set(cfg->peer_dev[1], interrupt_handler, (void *)dev);
-		uart_irq_rx_enable(cfg->peer_dev[0]);
-		uart_irq_rx_enable(cfg->peer_dev[1]);
-		break;
-	default:
-		return -ENOTSUP;
+	gpio_pin_set_dt(&cfg->de_gpio, 0);
+	data->de_active = false;
+	data->de_holding = false;
+	if (cfg->echo_suppress) {
+		/* Whatever is left in the rx fifo was received while we owned the bus */
+		uart_bridge_de_discard_echo(dev);
 	}
-
-	return 0;
 }
 
-static void global_led_work_handler(struct k_work *work)
+static void uart_bridge_de_timer_expiry(struct k_timer *timer)
 {
-	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
-	bool had_activity = false;
-	bool peer0_activity = false;
-	bool peer1_activity = false;
+	const struct device *bridge_dev = k_timer_user_data_get(timer);
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
+	const struct device *dev = cfg->peer_dev[cfg->hw_idx];
+	uint32_t start = k_cycle_get_32();
+	uint32_t spin = k_us_to_cyc_ceil32(MIN(data->char_us * 2, DE_DRAIN_SPIN_US));
+	k_spinlock_key_t key;
+	int done;
 
-	/* Check activity across all bridges */
-	for (int i = 0; i < bridge_count; i++) {
-		struct uart_bridge_data *data = bridge_devices[i]->data;
+	key = k_spin_lock(&data->de_lock);
+	if (data->de_active && data->de_holding) {
+		uart_bridge_de_release(dev, bridge_dev);
+	}
+	k_spin_unlock(&data->de_lock, key);
+	if (!data->de_active) {
+		return;
+	}
 
-		if (data->activity) {
-			if (i == 0) {
-				peer0_activity = true;
-			} else {
-				peer1_activity = true;
-			}
-			data->activity = false;
-			had_activity = true;
-		}
+	/* The UART has no tx complete interrupt, poll the shift register for a short while */
+	do {
+		done = uart_irq_tx_complete(dev);
+	} while (done == 0 && (k_cycle_get_32() - start) < spin);
+
+	key = k_spin_lock(&data->de_lock);
+	if (!data->de_active) {
+		k_spin_unlock(&data->de_lock, key);
+		return;
 	}
 
-	/* Update LEDs based on aggregated activity */
-	if (peer0_activity) {
-		toggle_led(LED_BLUE);
+	if (done == 0) {
+		k_timer_start(&data->de_timer, K_USEC(data->char_us), K_NO_WAIT);
+	} else if (cfg->de_hold_us > DE_HOLD_SPIN_US) {
+		data->de_holding = true;
+		k_timer_start(&data->de_timer, K_USEC(cfg->de_hold_us), K_NO_WAIT);
 	} else {
-		led_off(LED_BLUE);
+		k_busy_wait(cfg->de_hold_us);
+		uart_bridge_de_release(dev, bridge_dev);
 	}
+	k_spin_unlock(&data->de_lock, key);
+}
 
-	if (peer1_activity) {
-		toggle_led(LED_RED);
-	} else {
-		led_off(LED_RED);
+/* The tx ring ran empty: release the transceiver once the last stop bit is out */
+static void uart_bridge_de_drain(const struct device *dev, const struct device *bridge_dev)
+{
+	struct uart_bridge_data *data = bridge_dev->data;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&data->de_lock);
+	if (data->de_active && k_timer_remaining_get(&data->de_timer) == 0) {
+		/* At most a tx fifo threshold worth of characters is still queued */
+		k_timer_start(&data->de_timer, K_USEC(data->char_us * 8), K_NO_WAIT);
 	}
+	k_spin_unlock(&data->de_lock, key);
+}
 
-	/* Reschedule if there was activity */
-	if (had_activity) {
-		k_work_schedule(dwork, K_MSEC(LED_ACTIVITY_TIMER_MS));
+static void uart_bridge_stamp_in(struct uart_bridge_peer_data *pd, uint32_t len)
+{
+	k_spinlock_key_t key;
+	uint8_t last;
+
+	key = k_spin_lock(&pd->stamp_lock);
+	pd->in_total += len;
+	if (pd->stamp_count < DELAY_STAMP_COUNT) {
+		last = (pd->stamp_head + pd->stamp_count) % DELAY_STAMP_COUNT;
+		pd->stamp[last].cycles = k_cycle_get_32();
+		pd->stamp_count++;
+	} else {
+		/* Out of stamps: the newest bytes inherit an older arrival time, which
+		 * overestimates their delay rather than hiding it
+		 */
+		last = (pd->stamp_head + DELAY_STAMP_COUNT - 1) % DELAY_STAMP_COUNT;
 	}
+	pd->stamp[last].end = pd->in_total;
+	k_spin_unlock(&pd->stamp_lock, key);
 }
 
-static int uart_bridge_init(const struct device *dev)
+static void uart_bridge_stamp_out(struct uart_bridge_peer_data *pd, uint32_t len)
 {
-	struct uart_bridge_data *data = dev->data;
+	k_spinlock_key_t key;
+	uint32_t delay;
 
-	ring_buf_init(&data->peer[0].rb, RING_BUF_SIZE, data->peer[0].buf);
-	ring_buf_init(&data->peer[1].rb, RING_BUF_SIZE, data->peer[1].buf);
+	key = k_spin_lock(&pd->stamp_lock);
+	if (pd->stamp_count > 0) {
+		/* Queueing delay of the oldest byte that just left the ring */
+		delay = k_cycle_get_32() - pd->stamp[pd->stamp_head].cycles;
+		pd->delay_max_cyc = MAX(pd->delay_max_cyc, delay);
+		pd->delay_sum_cyc += delay;
+		pd->delay_samples++;
+	}
 
-	data->activity = false;
+	pd->out_total += len;
+	pd->bytes += len;
+	while (pd->stamp_count > 0 &&
+	       (int32_t)(pd->stamp[pd->stamp_head].end - pd->out_total) <= 0) {
+		pd->stamp_head = (pd->stamp_head + 1) % DELAY_STAMP_COUNT;
+		pd->stamp_count--;
+	}
+	k_spin_unlock(&pd->stamp_lock, key);
+}
 
-	/* Register this bridge and initialize global LED work once */
-	if (bridge_count == 0) {
-		k_work_init_delayable(&global_led_work, global_led_work_handler);
+/* A bridge is busy while it has data queued and is still making progress sending it. Its tx isr
+ * marks it busy each time it sends and leaves data queued, and idle once both rings are empty.
+ */
+static void uart_bridge_busy_update(const struct uart_bridge_data *data)
+{
+	if (ring_buf_is_empty(&data->peer[0].rb) && ring_buf_is_empty(&data->peer[1].rb)) {
+		atomic_clear_bit(&bridge_busy, data->idx);
+	} else {
+		atomic_set_bit(&bridge_busy, data->idx);
 	}
+}
+
+/* Lower priority bridges yield while a higher priority bridge is busy. One mask test when no
+ * higher priority bridge is sending, a busy bridge that stopped making progress is marked idle
+ * by the first check that finds it stalled.
+ */
+static bool uart_bridge_must_yield(const struct device *bridge_dev)
+{
+	const struct uart_bridge_data *data = bridge_dev->data;
+	uint32_t busy = (uint32_t)atomic_get(&bridge_busy) & data->higher_mask;
+	const struct uart_bridge_data *other;
+	uint8_t i;
 
-	if (bridge_count < BRIDGE_COUNT) {
-		bridge_devices[bridge_count++] = dev;
+	while (busy != 0) {
+		i = find_lsb_set(busy) - 1;
+		other = bridge_devices[i]->data;
+		if ((k_cycle_get_32() - other->last_tx_cycles) <
+		    k_ms_to_cyc_ceil32(THROTTLE_STALL_MS)) {
+			return true;
+		}
+
+		atomic_clear_bit(&bridge_busy, i);
+		busy &= busy - 1;
 	}
 
-	return pm_device_driver_init(dev, uart_bridge_pm_action);
+	return false;
 }
 
-#define UART_BRIDGE_INIT(n)                                                                        \
-	BUILD_ASSERT(DT_INST_PROP_LEN(n, peers) == 2,                                              \
-		     "uart-bridge peers property must have exactly 2 members");                    \
-                                                                                                   \
-	static const struct uart_bridge_config uart_bridge_cfg_##n = {                             \
-		.peer_dev = {DT_INST_FOREACH_PROP_ELEM_SEP(n, peers, DEVICE_DT_GET_BY_IDX, (, ))}, \
-	};                                                                                         \
-                                                                                                   \
-	static struct uart_bridge_data uart_bridge_data_##n;                                       \
+/* Only ports that push back on their sender are throttled, anything else would lose data */
+static bool uart_bridge_can_throttle(const struct uart_bridge_port *port)
+{
+	const struct uart_bridge_data *data = port->bridge_dev->data;
+
+	/* The USB side NAKs the host while rx is paused */
+	return !port->hw || data->hw_flow_ctrl;
+}
+
+/* Check what the port under test receives, drop what the other port receives */
+static void uart_bridge_prbs_rx(const struct device *dev, const struct uart_bridge_port *port)
+{
+	struct uart_bridge_data *data = port->bridge_dev->data;
+	struct uart_bridge_prbs *prbs = &data->prbs;
+	uint8_t chunk[PRBS_RX_CHUNK];
+	k_spinlock_key_t key;
+	uint32_t latency;
+	int len;
+
+	while ((len = uart_fifo_read(dev, chunk, sizeof(chunk))) > 0) {
+		if (port->idx != prbs->idx) {
+			continue;
+		}
+
+		key = k_spin_lock(&prbs->lock);
+		prbs_check(&prbs->check, chunk, len);
+		prbs->rx_bytes += len;
+		if (prbs->mark && (int32_t)(prbs->rx_bytes - prbs->mark_end) >= 0) {
+			latency = k_cycle_get_32() - prbs->mark_cycles;
+			prbs->latency_min_cyc = MIN(prbs->latency_min_cyc, latency);
+			prbs->latency_max_cyc = MAX(prbs->latency_max_cyc, latency);
+			prbs->latency_sum_cyc += latency;
+			prbs->latency_samples++;
+			prbs->mark = false;
+		}
+		k_spin_unlock(&prbs->lock, key);
+		data->activity = true;
+	}
+}
+
+/* Keep the ring the port under test sends from topped up with the pattern */
+static void uart_bridge_prbs_fill(struct uart_bridge_prbs *prbs, struct ring_buf *rb)
+{
+	uint8_t *buf;
+	uint32_t len;
+
+	if (ring_buf_size_get(rb) >= PRBS_TX_CHUNK) {
+		return;
+	}
+
+	len = ring_buf_put_claim(rb, &buf, PRBS_TX_CHUNK);
+	prbs_fill(&prbs->gen, buf, len);
+	(void)ring_buf_put_finish(rb, len);
+}
+
+static void uart_bridge_prbs_sent(struct uart_bridge_prbs *prbs, uint32_t len)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&prbs->lock);
+	prbs->tx_bytes += len;
+	if (!prbs->mark) {
+		/* Time the last byte just sent until it comes back */
+		prbs->mark = true;
+		prbs->mark_end = prbs->tx_bytes;
+		prbs->mark_cycles = k_cycle_get_32();
+	}
+	k_spin_unlock(&prbs->lock, key);
+}
+
+/* Once per suspend, the work runs the callback outside of the isr */
+static void uart_bridge_wakeup_request(struct uart_bridge_data *data)
+{
+	if (bridge_wakeup_cb != NULL && !data->wakeup_requested) {
+		data->wakeup_requested = true;
+		k_work_submit(&global_wakeup_work);
+	}
+}
+
+/* First service of the USB side after a resume, ends the resume latency */
+static void uart_bridge_resumed(struct uart_bridge_data *data)
+{
+	data->resume_latency_cyc = k_cycle_get_32() - data->resume_cycles;
+	data->resume_latency_max_cyc = MAX(data->resume_latency_max_cyc, data->resume_latency_cyc);
+	data->resume_pending = false;
+}
+
+static void uart_bridge_handle_rx(const struct device *dev, const struct uart_bridge_port *port)
+{
+	const struct device *bridge_dev = port->bridge_dev;
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
+	struct uart_bridge_peer_data *own_data = port->own_data;
+
+	uint8_t *recv_buf;
+	int rb_len, recv_len;
+	int ret;
+
+	if (data->prbs.mode != UART_BRIDGE_PRBS_OFF) {
+		uart_bridge_prbs_rx(dev, port);
+		return;
+	}
+
+	if (port->de && cfg->echo_suppress && data->de_active) {
+		LOG_DBG("%s: drop echo", dev->name);
+		uart_bridge_de_discard_echo(dev);
+		return;
+	}
+
+	if (cfg->history_size != 0 && port->hw && uart_bridge_history_rx(dev, port)) {
+		return;
+	}
+
+	if (uart_bridge_must_yield(bridge_dev) && uart_bridge_can_throttle(port)) {
+		LOG_DBG("%s: yield to a higher priority bridge", dev->name);
+		uart_irq_rx_disable(dev);
+		own_data->paused = true;
+		own_data->throttled = true;
+		own_data->throttle_count++;
+		k_work_schedule(&global_throttle_work, K_MSEC(THROTTLE_RECHECK_MS));
+		return;
+	}
+
+	if (ring_buf_space_get(&own_data->rb) < cfg->full_threshold) {
+		LOG_DBG("%s: buffer full: pause", dev->name);
+		uart_irq_rx_disable(dev);
+		own_data->paused = true;
+		return;
+	}
+
+	rb_len = ring_buf_put_claim(&own_data->rb, &recv_buf, cfg->buf_size);
+	if (rb_len == 0) {
+		LOG_WRN("%s: ring_buf full", dev->name);
+		return;
+	}
+
+	recv_len = uart_fifo_read(dev, recv_buf, rb_len);
+	if (recv_len < 0) {
+		(void)ring_buf_put_finish(&own_data->rb, 0);
+		LOG_ERR("%s: rx error: %d", dev->name, recv_len);
+		return;
+	} else {
+		LOG_DBG("%s: received %d bytes", dev->name, recv_len);
+		data->activity = true;
+		/* Start LED timer if not already running, the LEDs stay off while suspended */
+		if (!data->suspended && !k_work_delayable_is_pending(&global_led_work)) {
+			k_work_schedule(&global_led_work, K_MSEC(LED_ACTIVITY_TIMER_MS));
+		}
+	}
+
+	ret = ring_buf_put_finish(&own_data->rb, recv_len);
+	if (ret < 0) {
+		LOG_ERR("%s: ring_buf_put_finish error: %d", dev->name, rb_len);
+		return;
+	}
+
+	if (recv_len > 0) {
+		uart_bridge_stamp_in(own_data, recv_len);
+		/* Straight from the ring, only this isr writes to it */
+		uart_bridge_tap(port, recv_buf, recv_len);
+	}
+
+	/* Only the hardware side receives while suspended, the USB side is re-armed on resume */
+	if (data->suspended) {
+		uart_bridge_wakeup_request(data);
+		return;
+	}
+
+	uart_irq_tx_enable(port->peer_dev);
+}
+
+static void uart_bridge_handle_tx(const struct device *dev, const struct uart_bridge_port *port)
+{
+	const struct device *bridge_dev = port->bridge_dev;
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_bridge_data *data = bridge_dev->data;
+	struct uart_bridge_peer_data *peer_data = port->peer_data;
+
+	uint8_t *send_buf;
+	int rb_len, sent_len;
+	int ret;
+	bool prbs_port = data->prbs.mode != UART_BRIDGE_PRBS_OFF && port->idx == data->prbs.idx;
+
+	if (!port->hw && data->resume_pending) {
+		uart_bridge_resumed(data);
+	}
+
+	if (prbs_port) {
+		uart_bridge_prbs_fill(&data->prbs, &peer_data->rb);
+	}
+
+	rb_len = ring_buf_get_claim(&peer_data->rb, &send_buf, cfg->buf_size);
+	if (rb_len == 0 && cfg->history_size != 0 && !port->hw &&
+	    uart_bridge_history_tx(dev, bridge_dev)) {
+		return;
+	}
+
+	if (rb_len == 0) {
+		LOG_DBG("%s: buffer empty, disable tx irq", dev->name);
+		uart_irq_tx_disable(dev);
+		uart_bridge_busy_update(data);
+		if (port->de) {
+			uart_bridge_de_drain(dev, bridge_dev);
+		}
+		return;
+	}
+
+	if (port->de) {
+		uart_bridge_de_assert(dev, bridge_dev);
+	}
+
+	if (uart_bridge_must_yield(bridge_dev)) {
+		/* Keep the tx irq enabled but copy a small chunk per call */
+		rb_len = MIN(rb_len, THROTTLE_QUANTUM);
+	}
+
+	sent_len = uart_fifo_fill(dev, send_buf, rb_len);
+	if (sent_len < 0) {
+		(void)ring_buf_get_finish(&peer_data->rb, 0);
+		LOG_ERR("%s: tx error: %d", dev->name, sent_len);
+		return;
+	} else {
+		LOG_DBG("%s: sent %d bytes", dev->name, sent_len);
+		data->activity = true;
+	}
+
+	ret = ring_buf_get_finish(&peer_data->rb, sent_len);
+	if (ret < 0) {
+		LOG_ERR("ring_buf_get_finish error: %d", ret);
+		return;
+	}
+
+	if (sent_len > 0) {
+		data->last_tx_cycles = k_cycle_get_32();
+		uart_bridge_busy_update(data);
+		uart_bridge_stamp_out(peer_data, sent_len);
+		if (prbs_port) {
+			uart_bridge_prbs_sent(&data->prbs, sent_len);
+		}
+	}
+
+	/* A throttled port is resumed by the throttle work, not when space frees up */
+	if (peer_data->paused && !peer_data->throttled &&
+	    ring_buf_space_get(&peer_data->rb) > cfg->full_threshold) {
+		LOG_DBG("%s: buffer free: resume", dev->name);
+		uart_irq_rx_enable(port->peer_dev);
+		peer_data->paused = false;
+		return;
+	}
+}
+
+static void interrupt_handler(const struct device *dev, void *user_data)
+{
+	const struct uart_bridge_port *port = user_data;
+	struct uart_bridge_peer_data *pd = port->own_data;
+#if defined(CONFIG_RFPROS_UART_BRIDGE_ISR_STATS)
+	uint32_t start = k_cycle_get_32();
+	uint32_t cycles;
+#endif
+
+	while (uart_irq_update(dev) && uart_irq_is_pending(dev)) {
+		if (uart_irq_rx_ready(dev)) {
+			pd->rx_irqs++;
+			uart_bridge_handle_rx(dev, port);
+		}
+
+		if (uart_irq_tx_ready(dev)) {
+			uart_bridge_handle_tx(dev, port);
+		}
+	}
+
+#if defined(CONFIG_RFPROS_UART_BRIDGE_ISR_STATS)
+	cycles = k_cycle_get_32() - start;
+	pd->isr_calls++;
+	pd->isr_max_cyc = MAX(pd->isr_max_cyc, cycles);
+	pd->isr_sum_cyc += cycles;
+#endif
+}
+
+/* The USB side stops. With CONFIG_RFPROS_UART_BRIDGE_SUSPEND_RX the hardware side keeps receiving
+ * until the ring fills up and flow control holds the target off, otherwise it stops too.
+ */
+static void uart_bridge_suspend(const struct device *dev)
+{
+	const struct uart_bridge_config *cfg = dev->config;
+	struct uart_bridge_data *data = dev->data;
+	const struct device *usb_dev = cfg->peer_dev[!cfg->hw_idx];
+
+	if (data->suspended) {
+		return;
+	}
+
+	data->wakeup_requested = false;
+	data->suspended = true;
+	data->suspend_count++;
+	k_work_cancel_delayable(&global_led_work);
+	uart_irq_rx_disable(usb_dev);
+	uart_irq_tx_disable(usb_dev);
+
+	if (!IS_ENABLED(CONFIG_RFPROS_UART_BRIDGE_SUSPEND_RX)) {
+		uart_irq_rx_disable(cfg->peer_dev[cfg->hw_idx]);
+		uart_irq_callback_user_data_set(cfg->peer_dev[0], NULL, NULL);
+		uart_irq_callback_user_data_set(cfg->peer_dev[1], NULL, NULL);
+	}
+}
+
+static void uart_bridge_resume(const struct device *dev)
+{
+	const struct uart_bridge_config *cfg = dev->config;
+	struct uart_bridge_data *data = dev->data;
+	bool was_suspended = data->suspended;
+
+	uart_irq_callback_user_data_set(cfg->peer_dev[0], interrupt_handler,
+					(void *)&cfg->port[0]);
+	uart_irq_callback_user_data_set(cfg->peer_dev[1], interrupt_handler,
+					(void *)&cfg->port[1]);
+	uart_bridge_rx_tune(dev);
+
+	if (was_suspended) {
+		data->suspend_held = ring_buf_size_get(&data->peer[cfg->hw_idx].rb);
+		data->resume_cycles = k_cycle_get_32();
+		data->resume_pending = true;
+		data->suspended = false;
+	}
+
+	uart_irq_rx_enable(cfg->peer_dev[0]);
+	uart_irq_rx_enable(cfg->peer_dev[1]);
+
+	/* Send what was held during the suspend without waiting for more data */
+	if (was_suspended) {
+		uart_irq_tx_enable(cfg->peer_dev[!cfg->hw_idx]);
+	}
+}
+
+static int uart_bridge_pm_action(const struct device *dev, enum pm_device_action action)
+{
+	switch (action) {
+	case PM_DEVICE_ACTION_SUSPEND:
+		uart_bridge_suspend(dev);
+		break;
+	case PM_DEVICE_ACTION_RESUME:
+		uart_bridge_resume(dev);
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static void global_led_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	bool had_activity = false;
+	bool peer0_activity = false;
+	bool peer1_activity = false;
+
+	/* Check activity across all bridges */
+	for (int i = 0; i < bridge_count; i++) {
+		struct uart_bridge_data *data = bridge_devices[i]->data;
+
+		if (data->activity) {
+			if (i == 0) {
+				peer0_activity = true;
+			} else {
+				peer1_activity = true;
+			}
+			data->activity = false;
+			had_activity = true;
+		}
+	}
+
+	/* Update LEDs based on aggregated activity */
+	if (peer0_activity) {
+		toggle_led(LED_BLUE);
+	} else {
+		led_off(LED_BLUE);
+	}
+
+	if (peer1_activity) {
+		toggle_led(LED_RED);
+	} else {
+		led_off(LED_RED);
+	}
+
+	/* Reschedule if there was activity */
+	if (had_activity) {
+		k_work_schedule(dwork, K_MSEC(LED_ACTIVITY_TIMER_MS));
+	}
+}
+
+static void global_throttle_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	bool still_throttled = false;
+
+	for (int i = 0; i < bridge_count; i++) {
+		const struct uart_bridge_config *cfg = bridge_devices[i]->config;
+		struct uart_bridge_data *data = bridge_devices[i]->data;
+		bool yield = uart_bridge_must_yield(bridge_devices[i]);
+
+		for (int p = 0; p < 2; p++) {
+			if (!data->peer[p].throttled) {
+				continue;
+			}
+
+			if (yield) {
+				still_throttled = true;
+				continue;
+			}
+
+			LOG_DBG("%s: resume after throttle", cfg->peer_dev[p]->name);
+			data->peer[p].throttled = false;
+			data->peer[p].paused = false;
+			uart_irq_rx_enable(cfg->peer_dev[p]);
+		}
+	}
+
+	if (still_throttled) {
+		k_work_schedule(dwork, K_MSEC(THROTTLE_RECHECK_MS));
+	}
+}
+
+static void global_wakeup_work_handler(struct k_work *work)
+{
+	uart_bridge_wakeup_cb_t wakeup = bridge_wakeup_cb;
+
+	ARG_UNUSED(work);
+
+	if (wakeup != NULL) {
+		LOG_DBG("target data while suspended: wakeup");
+		wakeup();
+	}
+}
+
+/* Both sides, so the host reads back the line coding the target runs at. Flow control is
+ * wired per peer and kept.
+ */
+static void uart_bridge_line_apply(const struct device *bridge_dev, const struct uart_config *line)
+{
+	const struct uart_bridge_config *cfg = bridge_dev->config;
+	struct uart_config uart_cfg;
+	int ret;
+
+	for (int p = 0; p < 2; p++) {
+		ret = uart_config_get(cfg->peer_dev[p], &uart_cfg);
+		if (ret == 0) {
+			uart_cfg.baudrate = line->baudrate;
+			uart_cfg.parity = line->parity;
+			uart_cfg.stop_bits = line->stop_bits;
+			uart_cfg.data_bits = line->data_bits;
+			ret = uart_configure(cfg->peer_dev[p], &uart_cfg);
+		}
+
+		if (ret) {
+			LOG_WRN("%s: failed to set %u baud: %d", cfg->peer_dev[p]->name,
+				line->baudrate, ret);
+		}
+	}
+
+	uart_bridge_rx_tune(bridge_dev);
+}
+
+void uart_bridge_defaults_apply(void)
+{
+	probe_settings_uart_t saved;
+	struct uart_config line;
+
+	for (uint8_t i = 0; i < bridge_count; i++) {
+		const struct uart_bridge_data *data = bridge_devices[i]->data;
+
+		if (probe_settings_uart_get(data->id, &saved) != 0) {
+			continue;
+		}
+
+		line.baudrate = saved.baudrate;
+		line.data_bits = LINE_FORMAT_DATA_BITS(saved.format);
+		line.parity = LINE_FORMAT_PARITY(saved.format);
+		line.stop_bits = LINE_FORMAT_STOP_BITS(saved.format);
+		if (line.data_bits > UART_CFG_DATA_BITS_9 || line.parity > UART_CFG_PARITY_SPACE) {
+			LOG_WRN("%s: invalid saved line format 0x%02x", bridge_devices[i]->name,
+				saved.format);
+			continue;
+		}
+
+		uart_bridge_line_apply(bridge_devices[i], &line);
+		LOG_INF("%s: power-on line coding %u baud, format 0x%02x", bridge_devices[i]->name,
+			line.baudrate, saved.format);
+	}
+}
+
+int uart_bridge_line_save(uint8_t idx, bool clear, struct uart_config *line)
+{
+	const struct uart_bridge_config *cfg;
+	const struct uart_bridge_data *data;
+	int ret;
+
+	if (idx >= bridge_count) {
+		return -EINVAL;
+	}
+
+	cfg = bridge_devices[idx]->config;
+	data = bridge_devices[idx]->data;
+
+	ret = uart_config_get(cfg->peer_dev[cfg->hw_idx], line);
+	if (ret) {
+		return ret;
+	}
+
+	if (clear) {
+		return probe_settings_uart_set(data->id, 0, 0);
+	}
+
+	return probe_settings_uart_set(data->id, line->baudrate,
+				       LINE_FORMAT(line->data_bits, line->parity, line->stop_bits));
+}
+
+uint16_t uart_bridge_id_get(uint8_t idx)
+{
+	const struct uart_bridge_data *data;
+
+	if (idx >= bridge_count) {
+		return 0;
+	}
+
+	data = bridge_devices[idx]->data;
+
+	return data->id;
+}
+
+uint8_t uart_bridge_count_get(void)
+{
+	return bridge_count;
+}
+
+uint32_t uart_bridge_buf_size_min(void)
+{
+	uint32_t size = UINT32_MAX;
+
+	for (uint8_t i = 0; i < bridge_count; i++) {
+		const struct uart_bridge_config *cfg = bridge_devices[i]->config;
+
+		size = MIN(size, cfg->buf_size);
+	}
+
+	return bridge_count == 0 ? 0 : size;
+}
+
+int uart_bridge_stats_get(uint8_t idx, uint8_t *priority, struct uart_bridge_port_stats stats[2],
+			  bool clear)
+{
+	const struct uart_bridge_config *cfg;
+	struct uart_bridge_data *data;
+	struct uart_bridge_peer_data *pd;
+	k_spinlock_key_t key;
+
+	if (idx >= bridge_count) {
+		return -EINVAL;
+	}
+
+	cfg = bridge_devices[idx]->config;
+	data = bridge_devices[idx]->data;
+	*priority = cfg->priority;
+
+	for (int p = 0; p < 2; p++) {
+		pd = &data->peer[p];
+		key = k_spin_lock(&pd->stamp_lock);
+		stats[p].bytes = pd->bytes;
+		stats[p].delay_avg_us =
+			pd->delay_samples == 0
+				? 0
+				: k_cyc_to_us_floor32(
+					  (uint32_t)(pd->delay_sum_cyc / pd->delay_samples));
+		stats[p].delay_max_us = k_cyc_to_us_floor32(pd->delay_max_cyc);
+		stats[p].throttled = pd->throttle_count;
+		stats[p].rx_irqs = pd->rx_irqs;
+		stats[p].rx_irqs_per_kb =
+			pd->bytes == 0 ? 0 : (uint32_t)((uint64_t)pd->rx_irqs * 1024 / pd->bytes);
+		stats[p].isr_calls = pd->isr_calls;
+		stats[p].isr_avg_cyc =
+			pd->isr_calls == 0 ? 0 : (uint32_t)(pd->isr_sum_cyc / pd->isr_calls);
+		stats[p].isr_max_cyc = pd->isr_max_cyc;
+		if (clear) {
+			pd->bytes = 0;
+			pd->delay_max_cyc = 0;
+			pd->delay_sum_cyc = 0;
+			pd->delay_samples = 0;
+			pd->throttle_count = 0;
+			pd->rx_irqs = 0;
+			pd->isr_calls = 0;
+			pd->isr_max_cyc = 0;
+			pd->isr_sum_cyc = 0;
+		}
+		k_spin_unlock(&pd->stamp_lock, key);
+	}
+
+	return 0;
+}
+
+void uart_bridge_usb_suspend(uart_bridge_wakeup_cb_t wakeup)
+{
+	bridge_wakeup_cb = wakeup;
+	for (int i = 0; i < bridge_count; i++) {
+		uart_bridge_suspend(bridge_devices[i]);
+	}
+}
+
+void uart_bridge_usb_resume(void)
+{
+	for (int i = 0; i < bridge_count; i++) {
+		uart_bridge_resume(bridge_devices[i]);
+	}
+
+	bridge_wakeup_cb = NULL;
+}
+
+int uart_bridge_suspend_stats_get(uint8_t idx, struct uart_bridge_suspend_stats *stats,
+				  bool clear)
+{
+	struct uart_bridge_data *data;
+
+	if (idx >= bridge_count) {
+		return -EINVAL;
+	}
+
+	data = bridge_devices[idx]->data;
+	stats->suspends = data->suspend_count;
+	stats->held_bytes = data->suspend_held;
+	stats->resume_latency_us = k_cyc_to_us_floor32(data->resume_latency_cyc);
+	stats->resume_latency_max_us = k_cyc_to_us_floor32(data->resume_latency_max_cyc);
+	if (clear) {
+		data->suspend_count = 0;
+		data->suspend_held = 0;
+		data->resume_latency_cyc = 0;
+		data->resume_latency_max_cyc = 0;
+	}
+
+	return 0;
+}
+
+/* Drop the queued data and forget its arrival times */
+static void uart_bridge_flush(struct uart_bridge_peer_data *pd)
+{
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&pd->stamp_lock);
+	ring_buf_reset(&pd->rb);
+	pd->out_total = pd->in_total;
+	pd->stamp_count = 0;
+	pd->paused = false;
+	pd->throttled = false;
+	k_spin_unlock(&pd->stamp_lock, key);
+}
+
+int uart_bridge_prbs_set(uint8_t idx, enum uart_bridge_prbs_mode mode, uint8_t order)
+{
+	const struct uart_bridge_config *cfg;
+	struct uart_bridge_data *data;
+	struct uart_bridge_prbs *prbs;
+	struct prbs_gen gen;
+	k_spinlock_key_t key;
+
+	if (idx >= bridge_count || mode > UART_BRIDGE_PRBS_UART_INTERNAL) {
+		return -EINVAL;
+	}
+
+	if (mode != UART_BRIDGE_PRBS_OFF && prbs_init(&gen, order) != 0) {
+		return -EINVAL;
+	}
+
+	cfg = bridge_devices[idx]->config;
+	data = bridge_devices[idx]->data;
+	prbs = &data->prbs;
+	if (mode == UART_BRIDGE_PRBS_UART_INTERNAL && !uart_bridge_has_loopback(cfg)) {
+		return -ENOTSUP;
+	}
+
+	for (int p = 0; p < 2; p++) {
+		uart_irq_rx_disable(cfg->peer_dev[p]);
+		uart_irq_tx_disable(cfg->peer_dev[p]);
+	}
+
+	key = k_spin_lock(&prbs->lock);
+	if (mode == UART_BRIDGE_PRBS_OFF) {
+		if (prbs->mode != UART_BRIDGE_PRBS_OFF) {
+			prbs->stop_ms = k_uptime_get_32();
+		}
+	} else {
+		/* Counters of the last test are kept until the next one starts */
+		prbs->idx = mode == UART_BRIDGE_PRBS_USB ? 1 - cfg->hw_idx : cfg->hw_idx;
+		prbs->gen = gen;
+		(void)prbs_check_init(&prbs->check, order);
+		prbs->start_ms = k_uptime_get_32();
+		prbs->tx_bytes = 0;
+		prbs->rx_bytes = 0;
+		prbs->mark = false;
+		prbs->latency_min_cyc = UINT32_MAX;
+		prbs->latency_max_cyc = 0;
+		prbs->latency_sum_cyc = 0;
+		prbs->latency_samples = 0;
+	}
+	prbs->mode = mode;
+	k_spin_unlock(&prbs->lock, key);
+
+	uart_bridge_flush(&data->peer[0]);
+	uart_bridge_flush(&data->peer[1]);
+
+#if defined(CONFIG_RFPROS_UART_PL011_CTRL)
+	if (uart_bridge_has_loopback(cfg)) {
+		(void)uart_pl011_loopback_set(cfg->peer_dev[cfg->hw_idx],
+					      mode == UART_BRIDGE_PRBS_UART_INTERNAL);
+	}
+#endif
+
+	for (int p = 0; p < 2; p++) {
+		uart_irq_rx_enable(cfg->peer_dev[p]);
+	}
+
+	if (mode != UART_BRIDGE_PRBS_OFF) {
+		LOG_INF("%s: PRBS-%u test on %s", bridge_devices[idx]->name, order,
+			cfg->peer_dev[prbs->idx]->name);
+		uart_irq_tx_enable(cfg->peer_dev[prbs->idx]);
+	} else {
+		LOG_INF("%s: PRBS test stopped", bridge_devices[idx]->name);
+	}
+
+	return 0;
+}
+
+int uart_bridge_prbs_stats_get(uint8_t idx, struct uart_bridge_prbs_stats *stats)
+{
+	struct uart_bridge_prbs *prbs;
+	k_spinlock_key_t key;
+	uint32_t now;
+
+	if (idx >= bridge_count) {
+		return -EINVAL;
+	}
+
+	prbs = &((struct uart_bridge_data *)bridge_devices[idx]->data)->prbs;
+	key = k_spin_lock(&prbs->lock);
+	stats->mode = prbs->mode;
+	stats->locked = prbs->check.locked;
+	now = prbs->mode == UART_BRIDGE_PRBS_OFF ? prbs->stop_ms : k_uptime_get_32();
+	stats->elapsed_ms = now - prbs->start_ms;
+	stats->tx_bytes = prbs->tx_bytes;
+	stats->rx_bytes = prbs->rx_bytes;
+	stats->bits = prbs->check.bits;
+	stats->bit_errors = prbs->check.errors;
+	stats->resyncs = prbs->check.resyncs;
+	if (prbs->latency_samples == 0) {
+		stats->latency_min_us = 0;
+		stats->latency_avg_us = 0;
+	} else {
+		stats->latency_min_us = k_cyc_to_us_floor32(prbs->latency_min_cyc);
+		stats->latency_avg_us = k_cyc_to_us_floor32(
+			(uint32_t)(prbs->latency_sum_cyc / prbs->latency_samples));
+	}
+	stats->latency_max_us = k_cyc_to_us_floor32(prbs->latency_max_cyc);
+	k_spin_unlock(&prbs->lock, key);
+
+	return 0;
+}
+
+static void uart_bridge_autobaud_edge(const struct device *port, struct gpio_callback *cb,
+				      uint32_t pins)
+{
+	uint32_t now = k_cycle_get_32();
+
+	ARG_UNUSED(port);
+	ARG_UNUSED(pins);
+
+	if (autobaud.count < AUTOBAUD_EDGES) {
+		autobaud.edges[autobaud.count++] = now;
+		if (autobaud.count == AUTOBAUD_EDGES) {
+			k_sem_give(&autobaud.done);
+		}
+	}
+}
+
+/* Bit time in cycles from the edge timestamps, 0 if the intervals do not agree on one.
+ *
+ * The shortest pulse is one bit, but interrupt latency makes single intervals too short or too
+ * long. Every interval close to a whole number of bits is added to the estimate, which averages
+ * the latency out and lets frames without single bit pulses still contribute.
+ */
+static uint32_t uart_bridge_autobaud_bit(uint32_t *intervals, uint8_t n, uint16_t *matched)
+{
+	uint64_t sum = 0;
+	uint32_t bits = 0;
+	uint32_t tmp;
+	uint32_t t0 = 0;
+	uint32_t k;
+	uint32_t err;
+	int j;
+
+	/* Insertion sort, n is small */
+	for (int i = 1; i < n; i++) {
+		tmp = intervals[i];
+		for (j = i - 1; j >= 0 && intervals[j] > tmp; j--) {
+			intervals[j + 1] = intervals[j];
+		}
+		intervals[j + 1] = tmp;
+	}
+
+	for (int i = 0; i + AUTOBAUD_MIN_MATCH <= n; i++) {
+		if (intervals[i] != 0 &&
+		    intervals[i + AUTOBAUD_MIN_MATCH - 1] <= intervals[i] + intervals[i] / 8) {
+			t0 = intervals[i + AUTOBAUD_MIN_MATCH / 2];
+			break;
+		}
+	}
+
+	*matched = 0;
+	if (t0 == 0) {
+		return 0;
+	}
+
+	for (int i = 0; i < n; i++) {
+		k = (intervals[i] + t0 / 2) / t0;
+		if (k == 0 || k > AUTOBAUD_MAX_RUN) {
+			continue;
+		}
+
+		/* Idle gaps of arbitrary length between frames */
+		err = intervals[i] > k * t0 ? intervals[i] - k * t0 : k * t0 - intervals[i];
+		if (err > t0 / 4) {
+			continue;
+		}
+
+		sum += intervals[i];
+		bits += k;
+		(*matched)++;
+	}
+
+	if (*matched < n / 4) {
+		return 0;
+	}
+
+	return (uint32_t)((sum + bits / 2) / bits);
+}
+
+int uart_bridge_autobaud(uint8_t idx, uint32_t timeout_ms, bool apply,
+			 struct uart_bridge_autobaud_result *result)
+{
+	const struct uart_bridge_config *cfg;
+	const struct gpio_dt_spec *spec;
+	uint32_t bit_cyc;
+	uint32_t diff;
+	uint32_t best_diff = UINT32_MAX;
+	uint32_t min_us;
+	uint8_t n;
+	int ret;
+
+	if (idx >= bridge_count) {
+		return -EINVAL;
+	}
+
+	cfg = bridge_devices[idx]->config;
+	spec = &cfg->autobaud_gpio;
+	if (spec->port == NULL) {
+		return -ENOTSUP;
+	}
+
+	k_mutex_lock(&autobaud.lock, K_FOREVER);
+	autobaud.count = 0;
+	k_sem_reset(&autobaud.done);
+
+	/* The pin stays muxed to the UART, the GPIO block sees the pad input whatever its
+	 * function, so the bridge keeps forwarding while the edges are timed
+	 */
+	gpio_init_callback(&autobaud.cb, uart_bridge_autobaud_edge, BIT(spec->pin));
+	ret = gpio_add_callback(spec->port, &autobaud.cb);
+	if (ret == 0) {
+		ret = gpio_pin_interrupt_configure_dt(spec, GPIO_INT_EDGE_BOTH);
+		if (ret == 0) {
+			ret = k_sem_take(&autobaud.done, K_MSEC(timeout_ms));
+			(void)gpio_pin_interrupt_configure_dt(spec, GPIO_INT_DISABLE);
+		}
+		(void)gpio_remove_callback(spec->port, &autobaud.cb);
+	}
+
+	n = autobaud.count;
+	if (ret == -EAGAIN) {
+		LOG_WRN("%s: autobaud timed out after %u edges", bridge_devices[idx]->name, n);
+	}
+
+	if (ret != 0) {
+		k_mutex_unlock(&autobaud.lock);
+		return ret;
+	}
+
+	for (int i = 0; i < n - 1; i++) {
+		autobaud.edges[i] = autobaud.edges[i + 1] - autobaud.edges[i];
+	}
+
+	/* Sorts the intervals, the shortest one is first */
+	bit_cyc = uart_bridge_autobaud_bit(autobaud.edges, n - 1, &result->intervals);
+	min_us = k_cyc_to_us_floor32(autobaud.edges[0]);
+	k_mutex_unlock(&autobaud.lock);
+	if (min_us < AUTOBAUD_INTERVAL_MIN_US) {
+		LOG_WRN("%s: autobaud edges %u us apart, too close to time",
+			bridge_devices[idx]->name, min_us);
+		return -ERANGE;
+	}
+
+	if (bit_cyc == 0) {
+		LOG_WRN("%s: autobaud found no consistent bit time", bridge_devices[idx]->name);
+		return -EIO;
+	}
+
+	result->measured = (sys_clock_hw_cycles_per_sec() + bit_cyc / 2) / bit_cyc;
+	if ((uint64_t)result->measured * 1000 >
+	    (uint64_t)AUTOBAUD_RATE_MAX * (1000 + AUTOBAUD_SNAP_PERMILLE)) {
+		LOG_WRN("%s: autobaud measured %u baud, above %u", bridge_devices[idx]->name,
+			result->measured, AUTOBAUD_RATE_MAX);
+		return -ERANGE;
+	}
+
+	result->baudrate = result->measured;
+	for (int i = 0; i < ARRAY_SIZE(autobaud_rates); i++) {
+		diff = result->measured > autobaud_rates[i] ? result->measured - autobaud_rates[i]
+							    : autobaud_rates[i] - result->measured;
+		if (diff < best_diff &&
+		    (uint64_t)diff * 1000 <= (uint64_t)autobaud_rates[i] * AUTOBAUD_SNAP_PERMILLE) {
+			best_diff = diff;
+			result->baudrate = autobaud_rates[i];
+		}
+	}
+
+	LOG_INF("%s: autobaud measured %u baud, %u intervals, %u baud", bridge_devices[idx]->name,
+		result->measured, result->intervals, result->baudrate);
+	if (apply) {
+		const struct uart_bridge_config *cfg = bridge_devices[idx]->config;
+		struct uart_config line;
+
+		if (uart_config_get(cfg->peer_dev[cfg->hw_idx], &line) == 0) {
+			line.baudrate = result->baudrate;
+			uart_bridge_line_apply(bridge_devices[idx], &line);
+		}
+	}
+
+	return 0;
+}
+
+static int uart_bridge_init(const struct device *dev)
+{
+	const struct uart_bridge_config *cfg = dev->config;
+	struct uart_bridge_data *data = dev->data;
+	device_handle_t handle;
+
+	ring_buf_init(&data->peer[0].rb, cfg->buf_size, cfg->buf[0]);
+	ring_buf_init(&data->peer[1].rb, cfg->buf_size, cfg->buf[1]);
+	if (cfg->history_size != 0) {
+		ring_buf_init(&data->history, cfg->history_size, cfg->history_buf);
+	}
+
+	data->activity = false;
+	data->id = crc16_ccitt(0, (const uint8_t *)cfg->path, strlen(cfg->path));
+
+	k_timer_init(&data->modem_pulse, uart_bridge_modem_pulse_expiry, NULL);
+	k_timer_user_data_set(&data->modem_pulse, (void *)dev);
+
+	k_timer_init(&data->de_timer, uart_bridge_de_timer_expiry, NULL);
+	k_timer_user_data_set(&data->de_timer, (void *)dev);
+	data->char_us = 1;
+	if (cfg->de_gpio.port != NULL) {
+		int ret = gpio_pin_configure_dt(&cfg->de_gpio, GPIO_OUTPUT_INACTIVE);
+
+		if (ret) {
+			LOG_ERR("%s: failed to configure DE pin: %d", dev->name, ret);
+			return ret;
+		}
+	}
+
+	/* Register this bridge and initialize global LED work once */
+	if (bridge_count == 0) {
+		k_work_init_delayable(&global_led_work, global_led_work_handler);
+		k_work_init_delayable(&global_throttle_work, global_throttle_work_handler);
+		k_work_init(&global_wakeup_work, global_wakeup_work_handler);
+		k_mutex_init(&autobaud.lock);
+		k_sem_init(&autobaud.done, 0, 1);
+	}
+
+	for (int p = 0; p < 2; p++) {
+		handle = device_handle_get(cfg->peer_dev[p]);
+		if (handle <= DEVICE_HANDLE_NULL || handle >= BRIDGE_MAP_SIZE) {
+			LOG_ERR("%s: device handle %d out of range", cfg->peer_dev[p]->name,
+				handle);
+			return -EINVAL;
+		}
+
+		bridge_map[handle] = dev;
+	}
+
+	/* Each bridge keeps the set it yields to, so the isrs never walk the bridge list */
+	for (uint8_t i = 0; i < bridge_count; i++) {
+		const struct uart_bridge_config *other_cfg = bridge_devices[i]->config;
+		struct uart_bridge_data *other = bridge_devices[i]->data;
+
+		if (other_cfg->priority > cfg->priority) {
+			data->higher_mask |= BIT(i);
+		} else if (other_cfg->priority < cfg->priority) {
+			other->higher_mask |= BIT(bridge_count);
+		}
+	}
+
+	data->idx = bridge_count;
+	bridge_devices[bridge_count++] = dev;
+
+	return pm_device_driver_init(dev, uart_bridge_pm_action);
+}
+
+/* The hardware side of a bridge is the peer that is not a USB CDC-ACM port */
+#define UART_BRIDGE_HW_PEER_IDX(n)                                                                 \
+	(DT_NODE_HAS_COMPAT(DT_INST_PHANDLE_BY_IDX(n, peers, 1), zephyr_cdc_acm_uart) ? 0 : 1)
+
+/* Isr context of peer own, everything the isr needs to know about its side is constant */
+#define UART_BRIDGE_PORT_INIT(n, own, other)                                                       \
+	{                                                                                          \
+		.bridge_dev = DEVICE_DT_INST_GET(n),                                               \
+		.peer_dev = DEVICE_DT_GET(DT_INST_PHANDLE_BY_IDX(n, peers, other)),                \
+		.own_data = &uart_bridge_data_##n.peer[own],                                       \
+		.peer_data = &uart_bridge_data_##n.peer[other],                                    \
+		.idx = own,                                                                        \
+		.hw = UART_BRIDGE_HW_PEER_IDX(n) == own,                                           \
+		.de = UART_BRIDGE_HW_PEER_IDX(n) == own && DT_INST_NODE_HAS_PROP(n, de_gpios),     \
+	}
+
+#define UART_BRIDGE_BUF_SIZE(n) DT_INST_PROP_OR(n, buf_size, CONFIG_RFPROS_UART_BRIDGE_BUF_SIZE)
+
+#define UART_BRIDGE_INIT(n)                                                                        \
+	BUILD_ASSERT(DT_INST_PROP_LEN(n, peers) == 2,                                              \
+		     "uart-bridge peers property must have exactly 2 members");                    \
+	BUILD_ASSERT(DT_INST_PROP_OR(n, de_setup_us, 0) <= DE_SETUP_MAX_US,                        \
+		     "uart-bridge de-setup-us must be at most 100");                               \
+	BUILD_ASSERT(DT_INST_PROP_OR(n, de_hold_us, 0) <= DE_HOLD_MAX_US,                          \
+		     "uart-bridge de-hold-us must be at most 10000");                              \
+                                                                                                   \
+	static struct uart_bridge_data uart_bridge_data_##n;                                       \
+	static uint8_t uart_bridge_buf_##n[2][UART_BRIDGE_BUF_SIZE(n)];                            \
+                                                                                                   \
+	static const struct uart_bridge_port uart_bridge_port_##n[2] = {                           \
+		UART_BRIDGE_PORT_INIT(n, 0, 1),                                                    \
+		UART_BRIDGE_PORT_INIT(n, 1, 0),                                                    \
+	};                                                                                         \
+                                                                                                   \
+	IF_ENABLED(DT_INST_NODE_HAS_PROP(n, history_size),                                         \
+		   (static uint8_t uart_bridge_history_##n[DT_INST_PROP(n, history_size)];))       \
+                                                                                                   \
+	static const struct uart_bridge_config uart_bridge_cfg_##n = {                             \
+		.peer_dev = {DT_INST_FOREACH_PROP_ELEM_SEP(n, peers, DEVICE_DT_GET_BY_IDX, (, ))}, \
+		.port = uart_bridge_port_##n,                                                      \
+		.buf = {uart_bridge_buf_##n[0], uart_bridge_buf_##n[1]},                           \
+		.buf_size = UART_BRIDGE_BUF_SIZE(n),                                               \
+		.full_threshold = RING_BUF_FULL_THRESHOLD(UART_BRIDGE_BUF_SIZE(n)),                \
+		.dtr_gpio = GPIO_DT_SPEC_INST_GET_OR(n, dtr_gpios, {0}),                           \
+		.rts_gpio = GPIO_DT_SPEC_INST_GET_OR(n, rts_gpios, {0}),                           \
+		.reset_pulse_us = DT_INST_PROP_OR(n, reset_pulse_us, 0),                           \
+		.esp_autoreset = DT_INST_PROP(n, esp_autoreset),                                   \
+		.de_gpio = GPIO_DT_SPEC_INST_GET_OR(n, de_gpios, {0}),                             \
+		.de_setup_us = DT_INST_PROP_OR(n, de_setup_us, 0),                                 \
+		.de_hold_us = DT_INST_PROP_OR(n, de_hold_us, 0),                                   \
+		.hw_idx = UART_BRIDGE_HW_PEER_IDX(n),                                              \
+		.echo_suppress = DT_INST_PROP(n, echo_suppress),                                   \
+		.priority = DT_INST_PROP(n, priority),                                             \
+		.history_buf = COND_CODE_1(DT_INST_NODE_HAS_PROP(n, history_size),                 \
+					   (uart_bridge_history_##n), (NULL)),                     \
+		.history_size = DT_INST_PROP_OR(n, history_size, 0),                               \
+		.tap_dev = COND_CODE_1(DT_INST_NODE_HAS_PROP(n, tap),                              \
+				       (DEVICE_DT_GET(DT_INST_PHANDLE(n, tap))), (NULL)),          \
+		.rx_fifo_threshold = DT_INST_PROP_OR(n, rx_fifo_threshold, -1),                    \
+		.autobaud_gpio = GPIO_DT_SPEC_INST_GET_OR(n, autobaud_gpios, {0}),                 \
+		.path = DT_NODE_PATH(DT_DRV_INST(n)),                                              \
+	};                                                                                         \
                                                                                                    \
 	PM_DEVICE_DT_INST_DEFINE(n, uart_bridge_pm_action);                                        \
                                                                                                    \
@@ -0,0 +1,309 @@
+/**
+ * @file vuart.c
+ * @brief Virtual UART devices backed by firmware instead of hardware
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "vuart.h"
+
+LOG_MODULE_REGISTER(vuart, CONFIG_DVK_PROBE_LOG_LEVEL);
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static bool vuart_irq_pending(struct vuart_data *data)
+{
+	return (data->rx_irq_enabled && !ring_buf_is_empty(&data->rx_rb)) ||
+	       (data->tx_irq_enabled && ring_buf_space_get(&data->tx_rb) > 0);
+}
+
+static void vuart_kick(struct vuart_data *data)
+{
+	if (data->cb != NULL && vuart_irq_pending(data)) {
+		k_work_submit(&data->cb_work);
+	}
+}
+
+static void vuart_cb_work_handler(struct k_work *work)
+{
+	struct vuart_data *data = CONTAINER_OF(work, struct vuart_data, cb_work);
+
+	if (data->cb != NULL) {
+		data->cb(data->dev, data->cb_data);
+	}
+}
+
+static int vuart_poll_in(const struct device *dev, unsigned char *c)
+{
+	return uart_fifo_read(dev, c, 1) == 1 ? 0 : -1;
+}
+
+static void vuart_poll_out(const struct device *dev, unsigned char c)
+{
+	(void)uart_fifo_fill(dev, &c, 1);
+}
+
+static int vuart_configure(const struct device *dev, const struct uart_config *cfg)
+{
+	vuart_set_config(dev, cfg);
+
+	return 0;
+}
+
+static int vuart_config_get(const struct device *dev, struct uart_config *cfg)
+{
+	struct vuart_data *data = dev->data;
+
+	*cfg = data->uart_cfg;
+
+	return 0;
+}
+
+static int vuart_fifo_fill(const struct device *dev, const uint8_t *tx_data, int len)
+{
+	const struct vuart_config *config = dev->config;
+	struct vuart_data *data = dev->data;
+	k_spinlock_key_t key;
+	uint32_t put;
+
+	key = k_spin_lock(&data->lock);
+	put = ring_buf_put(&data->tx_rb, tx_data, len);
+	k_spin_unlock(&data->lock, key);
+
+	if (put > 0 && config->backend->tx_ready != NULL) {
+		config->backend->tx_ready(dev);
+	}
+
+	return put;
+}
+
+static int vuart_fifo_read(const struct device *dev, uint8_t *rx_data, const int size)
+{
+	const struct vuart_config *config = dev->config;
+	struct vuart_data *data = dev->data;
+	k_spinlock_key_t key;
+	uint32_t got;
+
+	key = k_spin_lock(&data->lock);
+	got = ring_buf_get(&data->rx_rb, rx_data, size);
+	k_spin_unlock(&data->lock, key);
+
+	if (got > 0 && config->backend->rx_consumed != NULL) {
+		config->backend->rx_consumed(dev, got);
+	}
+
+	return got;
+}
+
+static void vuart_irq_tx_enable(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	data->tx_irq_enabled = true;
+	vuart_kick(data);
+}
+
+static void vuart_irq_tx_disable(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	data->tx_irq_enabled = false;
+}
+
+static int vuart_irq_tx_ready(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	return data->tx_irq_enabled && ring_buf_space_get(&data->tx_rb) > 0;
+}
+
+static int vuart_irq_tx_complete(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	return ring_buf_is_empty(&data->tx_rb);
+}
+
+static void vuart_irq_rx_enable(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	data->rx_irq_enabled = true;
+	vuart_kick(data);
+}
+
+static void vuart_irq_rx_disable(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	data->rx_irq_enabled = false;
+}
+
+static int vuart_irq_rx_ready(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	return data->rx_irq_enabled && !ring_buf_is_empty(&data->rx_rb);
+}
+
+static int vuart_irq_is_pending(const struct device *dev)
+{
+	return vuart_irq_pending(dev->data);
+}
+
+static int vuart_irq_update(const struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	return 1;
+}
+
+static void vuart_irq_callback_set(const struct device *dev, uart_irq_callback_user_data_t cb,
+				   void *cb_data)
+{
+	struct vuart_data *data = dev->data;
+
+	data->cb = cb;
+	data->cb_data = cb_data;
+}
+
+#if defined(CONFIG_UART_LINE_CTRL)
+static int vuart_line_ctrl_set(const struct device *dev, uint32_t ctrl, uint32_t val)
+{
+	const struct vuart_config *config = dev->config;
+
+	if (ctrl != UART_LINE_CTRL_DTR || config->backend->host_attach == NULL) {
+		return -ENOTSUP;
+	}
+
+	config->backend->host_attach(dev, val != 0);
+
+	return 0;
+}
+#endif
+
+/**************************************************************************************************/
+/* Global Data Definitions                                                                        */
+/**************************************************************************************************/
+const struct uart_driver_api vuart_api = {
+	.poll_in = vuart_poll_in,
+	.poll_out = vuart_poll_out,
+	.configure = vuart_configure,
+	.config_get = vuart_config_get,
+	.fifo_fill = vuart_fifo_fill,
+	.fifo_read = vuart_fifo_read,
+	.irq_tx_enable = vuart_irq_tx_enable,
+	.irq_tx_disable = vuart_irq_tx_disable,
+	.irq_tx_ready = vuart_irq_tx_ready,
+	.irq_tx_complete = vuart_irq_tx_complete,
+	.irq_rx_enable = vuart_irq_rx_enable,
+	.irq_rx_disable = vuart_irq_rx_disable,
+	.irq_rx_ready = vuart_irq_rx_ready,
+	.irq_is_pending = vuart_irq_is_pending,
+	.irq_update = vuart_irq_update,
+	.irq_callback_set = vuart_irq_callback_set,
+#if defined(CONFIG_UART_LINE_CTRL)
+	.line_ctrl_set = vuart_line_ctrl_set,
+#endif
+};
+
+/**************************************************************************************************/
+/* Global Function Definitions                                                                    */
+/**************************************************************************************************/
+int vuart_init(const struct device *dev)
+{
+	const struct vuart_config *config = dev->config;
+	struct vuart_data *data = dev->data;
+
+	data->dev = dev;
+	ring_buf_init(&data->rx_rb, config->rx_size, config->rx_buf);
+	ring_buf_init(&data->tx_rb, config->tx_size, config->tx_buf);
+	k_work_init(&data->cb_work, vuart_cb_work_handler);
+	data->uart_cfg = (struct uart_config){
+		.baudrate = 115200,
+		.parity = UART_CFG_PARITY_NONE,
+		.stop_bits = UART_CFG_STOP_BITS_1,
+		.data_bits = UART_CFG_DATA_BITS_8,
+		.flow_ctrl = UART_CFG_FLOW_CTRL_NONE,
+	};
+
+	return 0;
+}
+
+size_t vuart_rx_put(const struct device *dev, const uint8_t *data_in, size_t len)
+{
+	struct vuart_data *data = dev->data;
+	k_spinlock_key_t key;
+	uint32_t put;
+
+	key = k_spin_lock(&data->lock);
+	put = ring_buf_put(&data->rx_rb, data_in, len);
+	k_spin_unlock(&data->lock, key);
+
+	if (put < len) {
+		LOG_WRN("%s: rx overrun, dropped %u bytes", dev->name, (uint32_t)(len - put));
+	}
+
+	vuart_kick(data);
+
+	return put;
+}
+
+size_t vuart_rx_space(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	return ring_buf_space_get(&data->rx_rb);
+}
+
+size_t vuart_tx_get(const struct device *dev, uint8_t *data_out, size_t len)
+{
+	struct vuart_data *data = dev->data;
+	k_spinlock_key_t key;
+	uint32_t got;
+
+	key = k_spin_lock(&data->lock);
+	got = ring_buf_get(&data->tx_rb, data_out, len);
+	k_spin_unlock(&data->lock, key);
+
+	if (got > 0) {
+		vuart_kick(data);
+	}
+
+	return got;
+}
+
+size_t vuart_tx_pending(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+
+	return ring_buf_size_get(&data->tx_rb);
+}
+
+void vuart_reset(const struct device *dev)
+{
+	struct vuart_data *data = dev->data;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&data->lock);
+	ring_buf_reset(&data->rx_rb);
+	ring_buf_reset(&data->tx_rb);
+	k_spin_unlock(&data->lock, key);
+
+	vuart_kick(data);
+}
+
+void vuart_set_config(const struct device *dev, const struct uart_config *cfg)
+{
+	struct vuart_data *data = dev->data;
+
+	data->uart_cfg = *cfg;
+}
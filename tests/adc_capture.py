@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port, frames
+
+"""
+This script captures the analog dynamic pins of the DVK Probe, decodes the sample stream of its
+serial port and prints the per-channel voltage range, as seen by the host and by the probe
+reduction. With --trigger it waits for one rail to cross a level and prints when the other rails
+crossed it relative to the trigger.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with target power rails on GP26 to GP28 connected to PC via USB, or a DVK Probe built
+  with -DCONFIG_APP_ADC_EMUL=y
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_ADC_CAPTURE = 31 - 23
+
+ADC_CAPTURE_ENABLE = 0x01
+ADC_CAPTURE_TRIGGERED = 0x02
+ADC_CAPTURE_FALLING = 0x04
+ADC_CAPTURE_QUERY = 0x80
+
+FRAME_MAGIC = 0xAD
+FRAME_HDR_SIZE = 8
+CHANNELS_MAX = 4
+
+STATES = ['idle', 'running', 'armed', 'done']
+
+# 12 bit ADC with a 3.3 V reference
+MV_PER_LSB = 3300 / 4096
+
+
+def capture(link, flags: int, channels: int = 0, rate: int = 0, trigger_channel: int = 0,
+            level: int = 0, post: int = 0) -> tuple:
+    req = struct.pack('<BBIBHI', flags, channels, rate, trigger_channel, level, post)
+    resp = link.command(VENDOR_ADC_CAPTURE, req, 'ADC capture')
+    state, error, rounds, overruns, trigger, measured = struct.unpack_from('<BbIIII', resp)
+    reduction = [struct.unpack_from('<HHHI', resp, 18 + i * 10) for i in range(CHANNELS_MAX)]
+    return STATES[state], error, rounds, overruns, trigger, measured, reduction
+
+
+def frame_size(buf: bytes) -> int:
+    mask, rounds = struct.unpack_from('<BH', buf, 1)
+    return FRAME_HDR_SIZE + rounds * bin(mask).count('1') * 2
+
+
+def sample_frames(port: serial.Serial, duration: float):
+    for frame in frames(port, duration, FRAME_MAGIC, FRAME_HDR_SIZE, frame_size):
+        mask, rounds, first = struct.unpack_from('<BHI', frame, 1)
+        samples = struct.unpack_from(f'<{(len(frame) - FRAME_HDR_SIZE) // 2}H', frame,
+                                     FRAME_HDR_SIZE)
+        yield mask, first, rounds, samples
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe ADC capture')
+    parser.add_argument('-p', '--port', help='Serial port of the ADC capture')
+    parser.add_argument('-c', '--channels', type=lambda x: int(x, 0), default=0x7,
+                        help='Channel mask, bit n = io-channel n')
+    parser.add_argument('-r', '--rate', type=int, default=30000, help='Total samples per second')
+    parser.add_argument('-t', '--time', type=float, default=2, help='Capture time in seconds')
+    parser.add_argument('--trigger', type=int, help='Trigger channel, captures once')
+    parser.add_argument('--level', type=int, default=1500, help='Trigger level in mV')
+    parser.add_argument('--falling', action='store_true', help='Trigger on a falling level')
+    parser.add_argument('--post', type=int, default=1000, help='Rounds after the trigger')
+    args = parser.parse_args()
+
+    port = serial.Serial(args.port or find_port('USB CDC-ACM ADC capture'), timeout=0.1)
+    enabled = [i for i in range(CHANNELS_MAX) if args.channels & (1 << i)]
+    flags = ADC_CAPTURE_ENABLE
+    if args.trigger is not None:
+        flags |= ADC_CAPTURE_TRIGGERED
+        flags |= ADC_CAPTURE_FALLING if args.falling else 0
+    level = int(args.level / MV_PER_LSB)
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    lo = {ch: 0xFFFF for ch in enabled}
+    hi = {ch: 0 for ch in enabled}
+    crossed = {}
+    expected = None
+    received = gaps = 0
+    try:
+        port.reset_input_buffer()
+        capture(link, flags, args.channels, args.rate, args.trigger or 0, level, args.post)
+        for mask, first, rounds, samples in sample_frames(port, args.time):
+            if expected is not None and first != expected:
+                gaps += 1
+            expected = first + rounds
+            received += rounds
+            for r in range(rounds):
+                for i, ch in enumerate(enabled):
+                    v = samples[r * len(enabled) + i]
+                    lo[ch], hi[ch] = min(lo[ch], v), max(hi[ch], v)
+                    if ch not in crossed and v >= level:
+                        crossed[ch] = first + r
+        stats = capture(link, ADC_CAPTURE_QUERY)
+    finally:
+        capture(link, 0)
+        probe.close()
+
+    state, error, rounds, overruns, trigger, measured, reduction = stats
+    logging.info(f'Probe: {state}, error {error}, {rounds} rounds, {overruns} dropped, '
+                 f'{measured} samples/s')
+    logging.info(f'Host: {received} rounds, {gaps} gaps')
+    for ch in enabled:
+        mn, mx, mean, n = reduction[ch]
+        logging.info(f'Channel {ch}: stream {lo[ch] * MV_PER_LSB:.0f} to {hi[ch] * MV_PER_LSB:.0f}'
+                     f' mV, probe {mn} to {mx} mV, mean {mean} mV over {n} samples')
+    if args.trigger is not None:
+        for ch, r in sorted(crossed.items()):
+            logging.info(f'Channel {ch} reached {args.level} mV at round {r - trigger:+d}')
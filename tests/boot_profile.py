@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script reads the boot phase timestamps of the DVK Probe and checks the time from boot to
+USB enumeration against a budget. Power cycle the probe before running it.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_BOOT_PROFILE = 31 - 24
+
+# In the order of enum boot_phase, see boot_profile.h
+PHASES = ['main', 'dap ready', 'settings loaded', 'usb init', 'usb enabled', 'usb configured',
+          'target reset released', 'offline prog ready']
+PHASE_USB_CONFIGURED = 5
+
+
+def boot_profile(link) -> list:
+    resp = link.command(VENDOR_BOOT_PROFILE, what='Boot profile')
+    return list(struct.unpack_from(f'<{resp[0]}I', resp, 1))
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe boot profile')
+    parser.add_argument('-b', '--budget', type=float, default=100,
+                        help='Boot to USB enumeration budget in ms')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    try:
+        stamps = boot_profile(VendorLink(probe))
+    finally:
+        probe.close()
+
+    prev = 0
+    for i, us in enumerate(stamps):
+        name = PHASES[i] if i < len(PHASES) else f'phase {i}'
+        if us == 0:
+            logging.info(f'{name:24s} not reached')
+            continue
+        logging.info(f'{name:24s} {us / 1000:8.3f} ms  (+{(us - prev) / 1000:.3f} ms)')
+        prev = us
+
+    configured = stamps[PHASE_USB_CONFIGURED] / 1000
+    if configured == 0 or configured > args.budget:
+        logging.error(f'USB enumeration at {configured:.3f} ms, budget {args.budget} ms')
+        sys.exit(1)
+    logging.info(f'USB enumeration at {configured:.3f} ms, within {args.budget} ms')
@@ -0,0 +1,303 @@
+/**
+ * @file main.c
+ * @brief Peer lookup, priority yield and isr cost of the uart bridges
+ *
+ * Four bridges of different priorities join pairs of virtual UARTs with no backend: the test
+ * puts what a port receives in its rx ring and takes what the bridge sends from its tx ring.
+ * The isrs of the bridges run from the system workqueue, each call goes through a trampoline
+ * that times it. native_sim time stands still while code runs, so the calls are timed with the
+ * monotonic clock of the host, through the host C library. Run the cost case before and after a
+ * change to the bridge dispatch to compare them.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/crc.h>
+#include <string.h>
+#include <time.h>
+#include "led.h"
+#include "probe_settings.h"
+#include "uart_bridge.h"
+#include "vuart.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define DT_DRV_COMPAT rfpros_test_uart
+
+#define TEST_UART_RX_SIZE  1024
+/* Small, so the highest priority bridge keeps data queued in the yield case */
+#define TEST_UART_TX_SIZE  64
+#define BURST              16
+#define YIELD_LEN          512
+#define FORWARD_TIMEOUT_MS 50
+/* Longer than the stall time of a busy bridge */
+#define SETTLE_MS          20
+#define FIND_PASSES        100000
+#define ISR_PASSES         2000
+
+struct test_bridge {
+	const struct device *dev;
+	const struct device *peer[2];
+	const char *path;
+	uint8_t priority;
+	/* Index of the bridge in the uart_bridge API, found by its ID */
+	uint8_t idx;
+};
+
+#define TEST_BRIDGE(node)                                                                          \
+	{                                                                                          \
+		.dev = DEVICE_DT_GET(node),                                                        \
+		.peer = {DEVICE_DT_GET(DT_PHANDLE_BY_IDX(node, peers, 0)),                         \
+			 DEVICE_DT_GET(DT_PHANDLE_BY_IDX(node, peers, 1))},                        \
+		.path = DT_NODE_PATH(node),                                                        \
+		.priority = DT_PROP(node, priority),                                               \
+		.idx = UINT8_MAX,                                                                  \
+	},
+
+#define TEST_UART_GET(n) DEVICE_DT_INST_GET(n),
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static struct test_bridge bridges[] = {DT_FOREACH_STATUS_OKAY(rfpros_uart_bridge, TEST_BRIDGE)};
+static struct test_bridge *top;
+static struct test_bridge *bottom;
+
+static const struct device *const test_uarts[] = {DT_INST_FOREACH_STATUS_OKAY(TEST_UART_GET)};
+static const struct device *const spare = DEVICE_DT_GET(DT_NODELABEL(test_uart8));
+
+/* No backend, the test reads and writes the rings directly */
+static const struct vuart_backend_api test_uart_backend_api;
+
+#define TEST_UART_DEFINE(n)                                                                        \
+	VUART_DT_INST_DEFINE(n, TEST_UART_RX_SIZE, TEST_UART_TX_SIZE, &test_uart_backend_api,      \
+			     vuart_init, PRE_KERNEL_1, CONFIG_SERIAL_INIT_PRIORITY);
+
+DT_INST_FOREACH_STATUS_OKAY(TEST_UART_DEFINE)
+
+static uart_irq_callback_user_data_t bridge_isr;
+static uint64_t isr_ns;
+static uint32_t isr_calls;
+
+static uint8_t pattern[YIELD_LEN];
+static uint8_t rx[YIELD_LEN];
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+/* The bridges flash the activity LEDs, there is no strip here */
+void toggle_led(led_color_t led_color)
+{
+	ARG_UNUSED(led_color);
+}
+
+void led_off(led_color_t led_color)
+{
+	ARG_UNUSED(led_color);
+}
+
+/* The bridges keep the line coding of the virtual UARTs, saved settings are not tested here */
+int probe_settings_uart_get(uint16_t bridge_id, probe_settings_uart_t *uart)
+{
+	ARG_UNUSED(bridge_id);
+	ARG_UNUSED(uart);
+
+	return -ENOENT;
+}
+
+int probe_settings_uart_set(uint16_t bridge_id, uint32_t baudrate, uint8_t format)
+{
+	ARG_UNUSED(bridge_id);
+	ARG_UNUSED(baudrate);
+	ARG_UNUSED(format);
+
+	return 0;
+}
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static void isr_timed(const struct device *dev, void *user_data)
+{
+	uint64_t start = host_ns();
+
+	bridge_isr(dev, user_data);
+	isr_ns += host_ns() - start;
+	isr_calls++;
+}
+
+/* Lets the isrs run, native_sim time only moves while the test sleeps */
+static size_t tx_wait(const struct device *dev, uint8_t *buf, size_t len)
+{
+	int64_t end = k_uptime_get() + FORWARD_TIMEOUT_MS;
+	size_t got = 0;
+
+	while (got < len && k_uptime_get() < end) {
+		k_sleep(K_TICKS(1));
+		got += vuart_tx_get(dev, &buf[got], len - got);
+	}
+
+	return got;
+}
+
+static void test_uarts_reset(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(test_uarts); i++) {
+		vuart_reset(test_uarts[i]);
+	}
+}
+
+static void *bridge_dispatch_setup(void)
+{
+	struct test_bridge *b;
+	struct vuart_data *data;
+	uint16_t id;
+
+	for (size_t i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = i * 13 + 1;
+	}
+
+	zassert_equal(uart_bridge_count_get(), ARRAY_SIZE(bridges));
+	for (size_t i = 0; i < ARRAY_SIZE(bridges); i++) {
+		b = &bridges[i];
+		zassert_true(device_is_ready(b->dev));
+
+		id = crc16_ccitt(0, (const uint8_t *)b->path, strlen(b->path));
+		for (uint8_t idx = 0; idx < uart_bridge_count_get(); idx++) {
+			if (uart_bridge_id_get(idx) == id) {
+				b->idx = idx;
+			}
+		}
+		zassert_not_equal(b->idx, UINT8_MAX, "%s not registered", b->path);
+
+		if (top == NULL || b->priority > top->priority) {
+			top = b;
+		}
+		if (bottom == NULL || b->priority < bottom->priority) {
+			bottom = b;
+		}
+
+		/* Every peer calls the isr of its bridge through the trampoline */
+		for (int p = 0; p < 2; p++) {
+			data = b->peer[p]->data;
+			zassert_not_null(data->cb);
+			bridge_isr = data->cb;
+			data->cb = isr_timed;
+		}
+	}
+
+	return NULL;
+}
+
+static void bridge_dispatch_before(void *fixture)
+{
+	struct uart_bridge_port_stats stats[2];
+	uint8_t priority;
+
+	ARG_UNUSED(fixture);
+
+	/* Drops what a failed case left queued, and lets a busy bridge go stale */
+	test_uarts_reset();
+	k_sleep(K_MSEC(SETTLE_MS));
+	test_uarts_reset();
+
+	for (uint8_t idx = 0; idx < uart_bridge_count_get(); idx++) {
+		(void)uart_bridge_stats_get(idx, &priority, stats, true);
+	}
+}
+
+/**************************************************************************************************/
+/* Tests                                                                                          */
+/**************************************************************************************************/
+ZTEST(bridge_dispatch, test_find)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(bridges); i++) {
+		zassert_equal_ptr(uart_bridge_find(bridges[i].peer[0]), bridges[i].dev);
+		zassert_equal_ptr(uart_bridge_find(bridges[i].peer[1]), bridges[i].dev);
+		zassert_is_null(uart_bridge_find(bridges[i].dev));
+	}
+
+	zassert_is_null(uart_bridge_find(spare));
+}
+
+ZTEST(bridge_dispatch, test_forward)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(bridges); i++) {
+		for (int p = 0; p < 2; p++) {
+			zassert_equal(vuart_rx_put(bridges[i].peer[p], pattern, BURST), BURST);
+			zassert_equal(tx_wait(bridges[i].peer[!p], rx, BURST), BURST, "%s",
+				      bridges[i].path);
+			zassert_mem_equal(rx, pattern, BURST);
+		}
+	}
+}
+
+ZTEST(bridge_dispatch, test_yield)
+{
+	struct uart_bridge_port_stats stats[2];
+	uint8_t priority;
+
+	/* The top bridge fills the tx ring of its peer and keeps the rest queued */
+	zassert_equal(vuart_rx_put(top->peer[0], pattern, YIELD_LEN), YIELD_LEN);
+	k_sleep(K_TICKS(1));
+	zassert_equal(vuart_tx_pending(top->peer[1]), TEST_UART_TX_SIZE);
+
+	/* The bottom bridge pauses a port that can hold its sender off instead of receiving */
+	zassert_equal(vuart_rx_put(bottom->peer[0], pattern, BURST), BURST);
+	k_sleep(K_TICKS(1));
+	zassert_ok(uart_bridge_stats_get(bottom->idx, &priority, stats, false));
+	zassert_true(stats[0].throttled >= 1, "not throttled");
+	zassert_equal(vuart_tx_pending(bottom->peer[1]), 0);
+
+	/* Once the top bridge has sent everything the paused port resumes */
+	zassert_equal(tx_wait(top->peer[1], rx, YIELD_LEN), YIELD_LEN);
+	zassert_mem_equal(rx, pattern, YIELD_LEN);
+	zassert_equal(tx_wait(bottom->peer[1], rx, BURST), BURST);
+	zassert_mem_equal(rx, pattern, BURST);
+}
+
+ZTEST(bridge_dispatch, test_isr_cost)
+{
+	uint64_t start;
+	uint64_t find_ns;
+
+	start = host_ns();
+	for (int pass = 0; pass < FIND_PASSES; pass++) {
+		for (size_t i = 0; i < ARRAY_SIZE(test_uarts); i++) {
+			(void)uart_bridge_find(test_uarts[i]);
+		}
+	}
+	find_ns = (host_ns() - start) / (FIND_PASSES * ARRAY_SIZE(test_uarts));
+	TC_PRINT("uart_bridge_find  %llu ns\n", (unsigned long long)find_ns);
+
+	/* One burst at a time with the other bridges idle, every rx event checks the higher ones */
+	TC_PRINT("priority  isr calls  ns per call\n");
+	for (size_t i = 0; i < ARRAY_SIZE(bridges); i++) {
+		isr_ns = 0;
+		isr_calls = 0;
+		for (int pass = 0; pass < ISR_PASSES; pass++) {
+			zassert_equal(vuart_rx_put(bridges[i].peer[0], pattern, BURST), BURST);
+			zassert_equal(tx_wait(bridges[i].peer[1], rx, BURST), BURST);
+		}
+
+		zassert_true(isr_calls > 0);
+		TC_PRINT("%8u  %9u  %11llu\n", bridges[i].priority, isr_calls,
+			 (unsigned long long)(isr_ns / isr_calls));
+	}
+}
+
+ZTEST_SUITE(bridge_dispatch, NULL, bridge_dispatch_setup, bridge_dispatch_before, NULL, NULL);
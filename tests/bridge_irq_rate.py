@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+import threading
+import time
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port
+
+"""
+This script measures the receive interrupt rate and queueing delay of the hardware UART of a
+uart bridge of the DVK Probe at several baud rates. Data written to the bridge port is looped
+back by a jumper, read back and compared, then the bridge counters are read and cleared.
+At low rates the receive FIFO interrupts at its lowest level of 4 bytes, at high rates the count
+should drop well below one interrupt per byte. The average and longest time spent in the isr of
+the hardware UART is printed too, for firmware built with CONFIG_RFPROS_UART_BRIDGE_ISR_STATS.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+- The RP2040 side of P_UART_TXD and P_UART_RXD connected together
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_BRIDGE_STATS = 31 - 8
+
+STATS_CLEAR = 0x01
+RATES = [9600, 115200, 921600, 3000000]
+
+
+def stats(link, bridge: int, clear: bool) -> tuple:
+    resp = link.command(VENDOR_BRIDGE_STATS, [bridge, STATS_CLEAR if clear else 0],
+                        'Bridge stats')
+    ports = [struct.unpack_from('<4I', resp, 2 + 16 * i) for i in range(2)]
+    irqs = [struct.unpack_from('<2I', resp, 34 + 8 * i) for i in range(2)]
+    isrs = [struct.unpack_from('<3I', resp, 66 + 12 * i) for i in range(2)]
+    cycles_per_sec = struct.unpack_from('<I', resp, 90)[0]
+    return ports, irqs, isrs, cycles_per_sec
+
+
+def loop(port: serial.Serial, data: bytes) -> bytes:
+    received = bytearray()
+    reader = threading.Thread(target=lambda: received.extend(port.read(len(data))), daemon=True)
+    reader.start()
+    port.write(data)
+    reader.join()
+    return bytes(received)
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe bridge receive interrupt rate')
+    parser.add_argument('-i', '--index', type=int, default=0, help='Bridge index')
+    parser.add_argument('-p', '--port', help='Serial port of the bridge')
+    parser.add_argument('-r', '--rate', type=int, action='append', help='Rate to test')
+    parser.add_argument('-t', '--time', type=float, default=1, help='Transfer time per rate')
+    parser.add_argument('--hw-port', type=int, default=1,
+                        help='Position of the hardware UART in the bridge peers')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    failed = 0
+    try:
+        for rate in args.rate or RATES:
+            port = serial.Serial(args.port or find_port(f'USB CDC-ACM UART{args.index}'), rate,
+                                 timeout=args.time * 4 + 1, rtscts=True)
+            try:
+                port.reset_input_buffer()
+                time.sleep(0.1)
+                stats(link, args.index, True)
+                data = bytes(range(256)) * max(1, int(rate / 10 * args.time / 256))
+                received = loop(port, data)
+                ports, irqs, isrs, cycles_per_sec = stats(link, args.index, True)
+            finally:
+                port.close()
+
+            nbytes, delay_avg, delay_max, _ = ports[args.hw_port]
+            rx_irqs, per_kb = irqs[args.hw_port]
+            isr_calls, isr_avg, isr_max = isrs[args.hw_port]
+            logging.info(f'{rate:8d} baud: {nbytes} bytes, {rx_irqs} rx irqs, {per_kb} per KiB, '
+                         f'queue delay {delay_avg} / {delay_max} us (avg / max)')
+            logging.info(f'{rate:8d} baud: {isr_calls} isr calls, {isr_avg} / {isr_max} cycles '
+                         f'(avg / max), {isr_max * 1e6 / cycles_per_sec:.1f} us max')
+            if received != data:
+                logging.error(f'{rate} baud: looped back data differs, {len(received)} of '
+                              f'{len(data)} bytes received')
+                failed += 1
+    finally:
+        probe.close()
+
+    if failed:
+        sys.exit(1)
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+import threading
+import time
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port
+
+"""
+This script runs the built-in PRBS test of one uart bridge of the DVK Probe and reports the
+throughput, bit error rate and round trip latency measured by the probe. In usb mode the script
+loops the pattern back on the bridge port, which measures the USB and firmware path without the
+UART. In uart mode the UART is tested on its own, with the internal loopback or a TX to RX jumper.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+- For --mode uart, the RP2040 side of P_UART_TXD and P_UART_RXD connected together
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_BRIDGE_PRBS = 31 - 25
+
+MODES = {'off': 0, 'usb': 1, 'uart': 2, 'internal': 3}
+PRBS_QUERY = 0x80
+
+
+def prbs(link, bridge: int, mode: int, order: int = 0) -> tuple:
+    resp = link.command(VENDOR_BRIDGE_PRBS, [bridge, mode, order], 'PRBS test')
+    return struct.unpack_from('<BB9I', resp)
+
+
+def echo(port: serial.Serial, stop: threading.Event):
+    while not stop.is_set():
+        data = port.read(port.in_waiting or 1)
+        if data:
+            port.write(data)
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe bridge PRBS test')
+    parser.add_argument('-i', '--index', type=int, default=0, help='Bridge index')
+    parser.add_argument('-m', '--mode', choices=['usb', 'uart', 'internal'], default='internal',
+                        help='Side under test')
+    parser.add_argument('-o', '--order', type=int, choices=[7, 15, 31], default=15,
+                        help='PRBS pattern')
+    parser.add_argument('-p', '--port', help='Serial port of the bridge, for --mode usb')
+    parser.add_argument('-b', '--baudrate', type=int, default=3000000, help='UART baud rate')
+    parser.add_argument('-t', '--time', type=float, default=3, help='Test time in seconds')
+    parser.add_argument('--max-ber', type=float, default=1e-9, help='Highest passing bit error rate')
+    args = parser.parse_args()
+
+    # The bridge applies the line coding of the host port to the UART
+    port = serial.Serial(args.port or find_port(f'USB CDC-ACM UART{args.index}'), args.baudrate,
+                         timeout=0.05)
+    stop = threading.Event()
+    looper = threading.Thread(target=echo, args=(port, stop), daemon=True)
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    try:
+        prbs(link, args.index, MODES[args.mode], args.order)
+        if args.mode == 'usb':
+            looper.start()
+        time.sleep(args.time)
+        stop.set()
+        if looper.is_alive():
+            looper.join()
+        prbs(link, args.index, MODES['off'])
+        mode, locked, ms, tx, rx, bits, errors, resyncs, lat_min, lat_avg, lat_max = \
+            prbs(link, args.index, PRBS_QUERY)
+    finally:
+        stop.set()
+        probe.close()
+        port.close()
+
+    ber = errors / bits if bits else 1
+    logging.info(f'PRBS-{args.order} {args.mode}: {ms} ms, locked {bool(locked)}, '
+                 f'{resyncs} resyncs')
+    logging.info(f'Sent {tx * 1000 / max(ms, 1) / 1024:.1f} KiB/s, '
+                 f'received {rx * 1000 / max(ms, 1) / 1024:.1f} KiB/s')
+    logging.info(f'{errors} bit errors in {bits} bits, BER {ber:.2e}')
+    logging.info(f'Round trip latency {lat_min} / {lat_avg} / {lat_max} us (min / avg / max)')
+    if bits == 0 or ber > args.max_ber:
+        logging.error(f'BER above {args.max_ber:.0e}')
+        sys.exit(1)
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script reads an I2C EEPROM through the DVK Probe dynamic GPIO pins, setting the EEPROM address
+and reading the data back in one batch.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+- A 24C02 style I2C EEPROM with pull-ups on two of the dynamic GPIO pins
+"""
+
+# CMSIS-DAP vendor command indexes, see dap_vendor.h
+VENDOR_IO_BUS_CONFIG = 31 - 21
+VENDOR_IO_BUS_BATCH = 31 - 22
+
+IO_BUS_OFF = 0
+IO_BUS_I2C = 1
+PIN_NONE = 0xFF
+
+OP_WRITE = 0
+OP_READ = 1
+OP_STOP = 0x80
+
+
+def io_bus_config(link, mode: int, clock: int, pins: list) -> int:
+    req = struct.pack('<BBI4B', mode, 0, clock, *pins)
+    resp = link.command(VENDOR_IO_BUS_CONFIG, req, 'IO bus config')
+    return struct.unpack_from('<I', resp)[0]
+
+
+def io_bus_batch(link, ops: list) -> bytes:
+    req = bytes([len(ops)]) + b''.join(ops)
+    return link.command(VENDOR_IO_BUS_BATCH, req, 'IO bus batch')[1:]
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe I2C EEPROM read')
+    parser.add_argument('--scl', type=int, required=True, help='SCL GPIO number')
+    parser.add_argument('--sda', type=int, required=True, help='SDA GPIO number')
+    parser.add_argument('-a', '--address', type=lambda x: int(x, 0), default=0x50,
+                        help='EEPROM I2C address')
+    parser.add_argument('-c', '--clock', type=int, default=100000, help='SCL frequency in Hz')
+    parser.add_argument('-n', '--length', type=int, default=64, help='Bytes to read')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    try:
+        clock = io_bus_config(link, IO_BUS_I2C, args.clock, [args.scl, args.sda, PIN_NONE,
+                                                             PIN_NONE])
+        logging.info(f'I2C at {clock} Hz')
+        # Word address 0, repeated start, then read
+        data = io_bus_batch(link, [
+            struct.pack('<BBHB', OP_WRITE, args.address, 1, 0),
+            struct.pack('<BBH', OP_READ | OP_STOP, args.address, args.length),
+        ])
+        for offset in range(0, len(data), 16):
+            logging.info(f'{offset:04x}: {data[offset:offset + 16].hex(" ")}')
+    finally:
+        io_bus_config(link, IO_BUS_OFF, 0, [PIN_NONE] * 4)
+        probe.close()
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import time
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script connects the DVK Probe JTAG port, reads the IDCODE of every TAP in the scan chain and
+measures the shift rate of long DR scans.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a JTAG target connected to PC via USB, or a DVK Probe built with
+  -DCONFIG_APP_JTAG_EMUL=y (expects IR lengths 4 5 5)
+"""
+
+# CMSIS-DAP vendor command indexes, see dap_vendor.h
+VENDOR_JTAG_CONNECT = 31 - 17
+VENDOR_JTAG_SEQUENCE = 31 - 18
+VENDOR_JTAG_IDCODE = 31 - 19
+
+SEQ_TMS = 0x40
+SEQ_TDO_CAPTURE = 0x80
+
+# 64 bit sequences that fit in one 512 byte packet
+SEQ_PER_PACKET = 56
+
+
+def jtag_connect(link, clock: int, ir_lengths: list):
+    req = struct.pack('<IB', clock, len(ir_lengths)) + bytes(ir_lengths)
+    link.command(VENDOR_JTAG_CONNECT, req, 'JTAG connect')
+
+
+def jtag_sequence(link, sequences: list) -> bytes:
+    """sequences: list of (bits, tms, capture, tdi bytes)"""
+    req = bytes([len(sequences)])
+    for bits, tms, capture, tdi in sequences:
+        info = (bits & 0x3F) | (SEQ_TMS if tms else 0) | (SEQ_TDO_CAPTURE if capture else 0)
+        req += bytes([info]) + tdi
+    return link.command(VENDOR_JTAG_SEQUENCE, req, 'JTAG sequence')
+
+
+def jtag_idcode(link, index: int) -> int:
+    resp = link.command(VENDOR_JTAG_IDCODE, [index], f'IDCODE of TAP {index}')
+    return struct.unpack_from('<I', resp)[0]
+
+
+def reset_to_idle(link):
+    jtag_sequence(link, [(6, True, False, b'\xff'), (1, False, False, b'\x00')])
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe JTAG IDCODE scan')
+    parser.add_argument('-c', '--clock', type=int, default=10000000, help='TCK frequency in Hz')
+    parser.add_argument('-i', '--ir', type=int, nargs='+', default=[4, 5, 5],
+                        help='IR length of each TAP, TAP 0 closest to TDO')
+    parser.add_argument('-n', '--packets', type=int, default=200,
+                        help='Number of packets for the shift rate test')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    try:
+        jtag_connect(link, args.clock, args.ir)
+        reset_to_idle(link)
+        for index in range(len(args.ir)):
+            logging.info(f'TAP {index}: IDCODE {jtag_idcode(link, index):#010x}')
+
+        # Idle -> Shift-DR, then long scans that never leave Shift-DR
+        jtag_sequence(link, [(1, True, False, b'\x00'), (2, False, False, b'\x00')])
+        packet = [(64, False, True, bytes(8))] * SEQ_PER_PACKET
+        start = time.perf_counter()
+        for _ in range(args.packets):
+            jtag_sequence(link, packet)
+        elapsed = time.perf_counter() - start
+        bits = args.packets * SEQ_PER_PACKET * 64
+        logging.info(f'Shifted {bits} bits in {elapsed:.3f} s, {bits / elapsed / 1e6:.2f} Mbit/s')
+        reset_to_idle(link)
+    finally:
+        jtag_connect(link, 0, [])
+        probe.close()
@@ -0,0 +1,160 @@
+/**
+ * @file main.c
+ * @brief Memory hash over an emulated debug port
+ *
+ * Fills the RAM of the emulated MEM-AP through swd_target and checks the CRC32 and SHA-256 of
+ * region lists against digests computed on the host with zlib.crc32() and hashlib.sha256().
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include "mem_hash.h"
+#include "probe_settings.h"
+#include "swd_target.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define EMUL_NODE DT_CHOSEN(rfpros_swdp)
+#define RAM_BASE  DT_PROP(EMUL_NODE, ram_base)
+#define RAM_SIZE  DT_PROP(EMUL_NODE, ram_size)
+
+BUILD_ASSERT(RAM_SIZE == 0x2000, "The digests below are for 8 KiB of RAM");
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+/* Aligned, unaligned across a 1 KiB TAR block, the end of the RAM, empty and short */
+static const struct mem_region regions[] = {
+	{RAM_BASE, 1024},
+	{RAM_BASE + 0x403, 1500},
+	{RAM_BASE + 0x1FF0, 16},
+	{RAM_BASE + 0x100, 0},
+	{RAM_BASE + 0x7FE, 3},
+};
+
+static const uint8_t regions_sha256[] = {
+	0x9b, 0x1a, 0xad, 0xe6, 0x3e, 0x6f, 0x12, 0x82, 0xcb, 0x1d, 0x31, 0xe1,
+	0x08, 0xf6, 0x1d, 0xf9, 0xf3, 0xe3, 0x80, 0xcb, 0x51, 0xf2, 0x27, 0x83,
+	0xed, 0x25, 0x08, 0xd0, 0x8f, 0x81, 0xd6, 0xc7,
+};
+
+#define REGIONS_CRC32 0xd6d70a29
+#define RAM_CRC32     0x6f8ae152
+
+/* SHA-256 of no data */
+static const uint8_t empty_sha256[] = {
+	0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8,
+	0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+	0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55,
+};
+
+static uint8_t pattern[RAM_SIZE];
+static uint8_t readback[RAM_SIZE];
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+/* swd_target saves per-target clock limits in the probe settings, not part of this test */
+uint32_t probe_settings_swd_clock_get(uint32_t idcode)
+{
+	ARG_UNUSED(idcode);
+
+	return 0;
+}
+
+int probe_settings_swd_clock_set(uint32_t idcode, uint32_t max_clock_hz)
+{
+	ARG_UNUSED(idcode);
+	ARG_UNUSED(max_clock_hz);
+
+	return 0;
+}
+
+static uint32_t crc32_of(const struct mem_region *list, size_t count)
+{
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+
+	zassert_equal(mem_hash(MEM_HASH_CRC32, list, count, digest), 4);
+
+	return sys_get_le32(digest);
+}
+
+static void *mem_hash_setup(void)
+{
+	for (size_t i = 0; i < sizeof(pattern); i++) {
+		pattern[i] = i * 7 + (i >> 8);
+	}
+
+	/* Unaligned heads and tails take the byte write path of swd_target_mem_write() */
+	zassert_ok(swd_target_begin(0));
+	zassert_ok(swd_target_mem_write(RAM_BASE, pattern, 5));
+	zassert_ok(swd_target_mem_write(RAM_BASE + 5, &pattern[5], RAM_SIZE - 10));
+	zassert_ok(swd_target_mem_write(RAM_BASE + RAM_SIZE - 5, &pattern[RAM_SIZE - 5], 5));
+	swd_target_end();
+
+	return NULL;
+}
+
+/**************************************************************************************************/
+/* Tests                                                                                          */
+/**************************************************************************************************/
+ZTEST(mem_hash, test_readback)
+{
+	zassert_ok(swd_target_begin(0));
+	zassert_ok(swd_target_mem_read(RAM_BASE, readback, sizeof(readback)));
+	swd_target_end();
+
+	zassert_mem_equal(readback, pattern, sizeof(pattern));
+}
+
+ZTEST(mem_hash, test_crc32)
+{
+	const struct mem_region ram = {RAM_BASE, RAM_SIZE};
+
+	zassert_equal(crc32_of(&ram, 1), RAM_CRC32);
+	zassert_equal(crc32_of(regions, ARRAY_SIZE(regions)), REGIONS_CRC32);
+}
+
+ZTEST(mem_hash, test_sha256)
+{
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+
+	zassert_equal(mem_hash(MEM_HASH_SHA256, regions, ARRAY_SIZE(regions), digest), 32);
+	zassert_mem_equal(digest, regions_sha256, sizeof(regions_sha256));
+}
+
+ZTEST(mem_hash, test_empty)
+{
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+
+	zassert_equal(crc32_of(regions, 0), 0);
+	zassert_equal(mem_hash(MEM_HASH_SHA256, regions, 0, digest), 32);
+	zassert_mem_equal(digest, empty_sha256, sizeof(empty_sha256));
+}
+
+ZTEST(mem_hash, test_bus_fault)
+{
+	const struct mem_region past_end = {RAM_BASE + RAM_SIZE - 64, 256};
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+
+	zassert_equal(mem_hash(MEM_HASH_CRC32, &past_end, 1, digest), -EIO);
+	/* The sticky error must not stay behind */
+	zassert_equal(crc32_of(regions, ARRAY_SIZE(regions)), REGIONS_CRC32);
+}
+
+ZTEST(mem_hash, test_unknown_algo)
+{
+	uint8_t digest[MEM_HASH_MAX_DIGEST_SIZE];
+
+	zassert_equal(mem_hash(MEM_HASH_SHA256 + 1, regions, 1, digest), -EINVAL);
+}
+
+ZTEST_SUITE(mem_hash, NULL, mem_hash_setup, NULL, NULL, NULL);
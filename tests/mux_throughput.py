@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import os
+import threading
+import time
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+from usb_ep_stats import ep_stats as read_ep_stats, log_stats
+from usb_mux import UsbMux
+
+"""
+This test measures the aggregate loopback throughput of the serial mux vendor interface
+(firmware built with -DCONFIG_APP_USBD_MUX=y). Data is sent on several channels at once and
+every channel checks that its data comes back unchanged.
+
+Compare the result with loopback_throughput.py running on the same ports of a CDC-ACM build
+to see the gain of sharing one pair of bulk endpoints. With --ep-stats the endpoint counters of
+the probe are printed as well, compare a build with -DCONFIG_APP_USBD_MUX_EP_QUEUE_DEPTH=1 to see
+the NAK windows a second queued transfer removes.
+
+Hardware Setup
+This sample requires the following hardware:
+- DVK Probe connected to PC via USB
+- TX and RX of every tested bridge UART connected together on the RP2040 side for a loopback
+"""
+
+BAUD_RATE = 1000000
+THROUGHPUT_TEST_TIMEOUT_SECS = 10
+SEND_DATA_CHUNK_LEN = 4096
+RX_TIMEOUT_SECS = 1
+
+
+def ep_stats(clear: bool = False) -> tuple:
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    try:
+        return read_ep_stats(VendorLink(probe), clear)
+    finally:
+        probe.close()
+
+
+def channel_test(mux: UsbMux, channel: int, results: dict):
+    ch = mux.channel(channel)
+    ch.open(BAUD_RATE)
+    data_sent = bytearray()
+    data_received = bytearray()
+    start = time.time()
+    while (time.time() - start) < THROUGHPUT_TEST_TIMEOUT_SECS:
+        chunk = os.urandom(SEND_DATA_CHUNK_LEN)
+        ch.send(chunk)
+        data_sent.extend(chunk)
+        data_received.extend(ch.read())
+
+    last_rx_time = time.time()
+    while time.time() - last_rx_time < RX_TIMEOUT_SECS and len(data_received) < len(data_sent):
+        rx_data = ch.read()
+        if len(rx_data) > 0:
+            last_rx_time = time.time()
+            data_received.extend(rx_data)
+        else:
+            time.sleep(0.001)
+
+    results[channel] = (data_sent == data_received, len(data_received), last_rx_time - start)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--debug', action='store_true',
+                        help="Enable verbose debug messages")
+    parser.add_argument('-c', '--channels', type=int, nargs='+', default=[0, 1],
+                        help="Mux channels to test, each must be looped back")
+    parser.add_argument('--ep-stats', action='store_true',
+                        help="Print the probe endpoint counters of the run")
+    args, unknown = parser.parse_known_args()
+    logging.basicConfig(
+        format='%(asctime)s [%(module)s] %(levelname)s: %(message)s', level=logging.INFO)
+    if args.debug:
+        logging.info("Debugging mode enabled")
+        logging.getLogger().setLevel(logging.DEBUG)
+
+    if args.ep_stats:
+        ep_stats(clear=True)
+
+    mux = UsbMux()
+    results = {}
+    threads = [threading.Thread(target=channel_test, args=(mux, c, results))
+               for c in args.channels]
+    logging.info(f"Running mux throughput test @{BAUD_RATE} baud on channels {args.channels}")
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    mux.close()
+
+    total = 0
+    failed = False
+    for channel, (ok, received, duration) in sorted(results.items()):
+        bytes_per_sec = received / duration
+        total += bytes_per_sec
+        logging.info(f"ch{channel}: {'OK' if ok else 'DATA MISMATCH'} "
+                     f"{received} bytes, {bytes_per_sec:.2f} Bps")
+        failed |= not ok
+    logging.info(f"Aggregate throughput: {total:.2f} Bps ({total * 8:.2f} bps)")
+    if args.ep_stats:
+        log_stats(*ep_stats())
+    exit(1 if failed else 0)
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import time
+import zlib
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script uploads a binary image and the pyOCD flash algorithm of the target to the DVK Probe,
+then lets the probe program the target on its own and reports the progress.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a Cortex-M target connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command indexes, see dap_vendor.h
+VENDOR_IMAGE_WRITE = 31 - 10
+VENDOR_IMAGE_COMMIT = 31 - 11
+VENDOR_IMAGE_PROGRAM = 31 - 12
+CHUNK_SIZE = 256
+
+OFFLINE_PROG_MAGIC = 0x494B5644
+OFFLINE_PROG_VERSION = 1
+OFFLINE_PROG_FLAG_AT_BOOT = 0x01
+
+STATES = ['idle', 'erase', 'program', 'verify', 'done', 'failed']
+
+
+def build_upload(region, image: bytes, address: int, flags: int) -> tuple:
+    algo = region.algo
+    blob = b''.join(struct.pack('<I', w) for w in algo['instructions'])
+    blob += b'\0' * (-len(blob) % 4)
+    data = blob + image
+    buffers = algo.get('page_buffers', [algo['begin_data']])[:2]
+    buffers += [0] * (2 - len(buffers))
+    header = struct.pack('<IBBHIIII', OFFLINE_PROG_MAGIC, OFFLINE_PROG_VERSION, flags, 0,
+                         len(data), zlib.crc32(data), len(blob), address)
+    header += struct.pack('<11I', algo['load_address'], algo['pc_init'], algo['pc_unInit'],
+                          algo['pc_erase_sector'], algo['pc_program_page'],
+                          algo['static_base'], algo['begin_stack'], buffers[0], buffers[1],
+                          region.page_size, region.sector_size)
+    return data, header
+
+
+def status(link, start: bool = False) -> tuple:
+    resp = link.command(VENDOR_IMAGE_PROGRAM, [1 if start else 0], 'Program')
+    state, error, done, total = struct.unpack_from('<BbII', resp)
+    return STATES[state], error, done, total
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--debug', action='store_true',
+                        help="Enable verbose debug messages")
+    parser.add_argument('-t', '--target', help="pyOCD target type, for the flash algorithm")
+    parser.add_argument('-a', '--address', type=lambda x: int(x, 0), default=None,
+                        help="Target flash address, start of the boot memory by default")
+    parser.add_argument('--at-boot', action='store_true',
+                        help="Program the target every time the probe boots")
+    parser.add_argument('--no-start', action='store_true',
+                        help="Store the image without programming the target")
+    parser.add_argument('image', help="Binary image file")
+    logging.basicConfig(format='%(asctime)s: %(message)s', level=logging.INFO)
+    args, unknown = parser.parse_known_args()
+    if args.debug:
+        logging.info('Debugging mode enabled')
+        logging.getLogger().setLevel(logging.DEBUG)
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+
+    with ConnectHelper.session_with_chosen_probe(target_override=args.target) as session:
+        target = session.board.target
+        link = VendorLink(session.probe)
+        address = args.address
+        if address is None:
+            address = target.memory_map.get_boot_memory().start
+        region = target.memory_map.get_region_for_address(address)
+        data, header = build_upload(region, image, address,
+                                    OFFLINE_PROG_FLAG_AT_BOOT if args.at_boot else 0)
+
+        logging.info(f'Uploading {len(data)} bytes, image {len(image)} bytes at 0x{address:08x}')
+        start = time.time()
+        for offset in range(0, len(data), CHUNK_SIZE):
+            chunk = data[offset:offset + CHUNK_SIZE]
+            link.command(VENDOR_IMAGE_WRITE, struct.pack('<IH', offset, len(chunk)) + chunk,
+                         'Write')
+        link.command(VENDOR_IMAGE_COMMIT, header, 'Commit')
+        logging.info(f'Upload done in {time.time() - start:.2f} s')
+
+        if args.no_start:
+            exit(0)
+
+        start = time.time()
+        state, error, done, total = status(link, True)
+        while state not in ('done', 'failed'):
+            time.sleep(0.2)
+            state, error, done, total = status(link)
+            logging.info(f'{state}: {done}/{total}')
+        logging.info(f'Programming {state} in {time.time() - start:.2f} s, error {error}')
+
+    exit(0 if state == 'done' else 1)
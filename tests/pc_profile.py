@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port, frames
+
+"""
+This script starts the DVK Probe PC sampler, decodes the profile stream of its serial port and
+prints the hottest code regions of the target.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a running Cortex-M target connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_PC_SAMPLER = 31 - 15
+
+PC_SAMPLER_ENABLE = 0x01
+PC_SAMPLER_RAW = 0x02
+PC_SAMPLER_ALLOW_HALT = 0x04
+PC_SAMPLER_QUERY = 0x80
+
+FRAME_SYNC = 0xA5
+FRAME_HISTOGRAM = 1
+FRAME_RAW = 2
+PC_SAMPLE_IDLE = 0xFFFFFFFF
+
+MODES = ['off', 'pcsr', 'halt']
+
+
+def varint(buf: bytes, pos: int) -> tuple:
+    val = 0
+    shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        val |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return val, pos
+
+
+def decode_histogram(payload: bytes) -> tuple:
+    shift = payload[0]
+    samples, pos = varint(payload, 1)
+    idle, pos = varint(payload, pos)
+    lost, pos = varint(payload, pos)
+    n, pos = varint(payload, pos)
+    buckets = {}
+    bucket = 0
+    for _ in range(n):
+        delta, pos = varint(payload, pos)
+        count, pos = varint(payload, pos)
+        bucket += delta
+        buckets[bucket << shift] = count
+    return samples, idle, lost, buckets
+
+
+def decode_raw(payload: bytes) -> list:
+    count, pos = varint(payload, 0)
+    pcs = []
+    pc = 0
+    for _ in range(count):
+        zz, pos = varint(payload, pos)
+        pc = (pc + ((zz >> 1) ^ -(zz & 1))) & 0xFFFFFFFF
+        pcs.append(pc)
+    return pcs
+
+
+def frame_size(buf: bytes) -> int:
+    return 4 + struct.unpack_from('<H', buf, 2)[0]
+
+
+def report_frames(port: serial.Serial, duration: float):
+    for frame in frames(port, duration, FRAME_SYNC, 4, frame_size):
+        yield frame[1], frame[4:]
+
+
+def sampler(link, flags: int, shift: int = 0, rate: int = 0) -> tuple:
+    resp = link.command(VENDOR_PC_SAMPLER, struct.pack('<BBI', flags, shift, rate), 'PC sampler')
+    mode, error, samples, idle, lost, skipped = struct.unpack_from('<BbIIII', resp)
+    return MODES[mode], error, samples, idle, lost, skipped
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe PC sampling profiler')
+    parser.add_argument('-p', '--port', help='Serial port of the PC sampler')
+    parser.add_argument('-r', '--rate', type=int, default=10000, help='Samples per second')
+    parser.add_argument('-s', '--shift', type=int, default=4, help='log2 of the bucket size')
+    parser.add_argument('-t', '--time', type=float, default=5, help='Profiling time in seconds')
+    parser.add_argument('-n', '--top', type=int, default=20, help='Number of buckets to print')
+    parser.add_argument('--raw', action='store_true', help='Stream raw PCs instead')
+    parser.add_argument('--allow-halt', action='store_true',
+                        help='Fall back to halting the core if it has no PCSR')
+    args = parser.parse_args()
+
+    port = serial.Serial(args.port or find_port('USB CDC-ACM PC sampler'), timeout=0.1)
+    flags = PC_SAMPLER_ENABLE
+    flags |= PC_SAMPLER_RAW if args.raw else 0
+    flags |= PC_SAMPLER_ALLOW_HALT if args.allow_halt else 0
+
+    totals = {}
+    samples = idle = lost = 0
+    with ConnectHelper.session_with_chosen_probe(connect_mode='attach') as session:
+        link = VendorLink(session.probe)
+        mode = sampler(link, flags, args.shift, args.rate)
+        logging.info(f'Sampling in {mode[0]} mode at {args.rate} Hz')
+        port.reset_input_buffer()
+        for ftype, payload in report_frames(port, args.time):
+            if ftype == FRAME_HISTOGRAM:
+                s, i, lo, buckets = decode_histogram(payload)
+                samples, idle, lost = samples + s, idle + i, lost + lo
+                for addr, count in buckets.items():
+                    totals[addr] = totals.get(addr, 0) + count
+            elif ftype == FRAME_RAW:
+                for pc in decode_raw(payload):
+                    samples += 1
+                    if pc == PC_SAMPLE_IDLE:
+                        idle += 1
+                    else:
+                        addr = pc & ~((1 << args.shift) - 1)
+                        totals[addr] = totals.get(addr, 0) + 1
+        stats = sampler(link, PC_SAMPLER_QUERY)
+        sampler(link, 0)
+        logging.info(f'Probe: {stats[2]} samples, {stats[3]} idle, {stats[4]} lost, '
+                     f'{stats[5]} skipped')
+
+    logging.info(f'{samples} samples, {idle} idle, {lost} lost')
+    for addr, count in sorted(totals.items(), key=lambda kv: -kv[1])[:args.top]:
+        logging.info(f'0x{addr:08x} {count:8d} {100 * count / max(samples, 1):6.2f}%')
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+import struct
+import time
+import serial
+import serial.tools.list_ports
+
+"""
+Helpers shared by the DVK Probe test scripts: CMSIS-DAP vendor commands, the lookup of the probe
+serial ports by USB interface name and the reader of the framed streams of the probe.
+"""
+
+
+class VendorLink:
+    """
+    CMSIS-DAP vendor commands of an open pyOCD probe. pyOCD has no public API for them, this is the
+    only place that uses the private link of the probe.
+    """
+
+    def __init__(self, probe):
+        self._link = probe._link
+
+    def vendor(self, index: int, data=b'') -> bytes:
+        """Send vendor command index, the response does not include the command byte."""
+        return bytes(self._link.vendor(index, list(data)))
+
+    def command(self, index: int, data=b'', what: str = 'Vendor command') -> bytes:
+        """Send a vendor command and return its response after the status byte."""
+        return check(self.vendor(index, data), what)
+
+
+def check(resp: bytes, what: str) -> bytes:
+    status = struct.unpack_from('<b', resp)[0]
+    if status != 0:
+        raise IOError(f'{what} failed: {status}')
+    return resp[1:]
+
+
+def find_port(name: str) -> str:
+    for p in serial.tools.list_ports.comports():
+        if p.interface and name in p.interface:
+            return p.device
+    raise IOError(f'No "{name}" serial port found')
+
+
+def frames(port: serial.Serial, duration: float, magic: int, header_size: int, size):
+    """
+    Yield the frames read from port for duration seconds. Every frame starts with the magic byte,
+    size(buf) returns the length of the frame at the start of buf, header included, from the
+    header_size bytes of its header. Bytes outside of frames are skipped.
+    """
+    buf = b''
+    end = time.time() + duration
+    while time.time() < end:
+        buf += port.read(port.in_waiting or 1)
+        while len(buf) >= header_size:
+            if buf[0] != magic:
+                buf = buf[1:]
+                continue
+            length = size(buf)
+            if len(buf) < length:
+                break
+            yield buf[:length]
+            buf = buf[length:]
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script calibrates the DVK Probe SWD clock for the connected target and prints the clock and
+transfer statistics of the probe.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a Cortex-M target connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_SWD_CLOCK = 31 - 16
+
+SWD_CLOCK_READ = 0
+SWD_CLOCK_READ_CLEAR = 1
+SWD_CLOCK_CALIBRATE = 2
+SWD_CLOCK_FORGET = 3
+
+FIELDS = ['idcode', 'host_clock', 'clock', 'clock_limit', 'transfers', 'waits', 'faults',
+          'errors', 'clamps', 'calibrations', 'calib_failures', 'calib_max_hz',
+          'calib_effective_hz']
+
+
+def swd_clock(link, op: int, max_hz: int = 0) -> dict:
+    resp = link.command(VENDOR_SWD_CLOCK, struct.pack('<BI', op, max_hz),
+                        f'SWD clock command {op}')
+    return dict(zip(FIELDS, struct.unpack_from(f'<{len(FIELDS)}I', resp)))
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe SWD clock calibration')
+    parser.add_argument('-m', '--max', type=int, default=0, help='Highest clock to try in Hz')
+    parser.add_argument('-s', '--stats', action='store_true', help='Only print the statistics')
+    parser.add_argument('-f', '--forget', action='store_true',
+                        help='Forget the saved limit of the target')
+    parser.add_argument('-c', '--clear', action='store_true', help='Clear the counters')
+    args = parser.parse_args()
+
+    with ConnectHelper.session_with_chosen_probe(connect_mode='attach') as session:
+        link = VendorLink(session.probe)
+        if args.forget:
+            op = SWD_CLOCK_FORGET
+        elif args.stats:
+            op = SWD_CLOCK_READ_CLEAR if args.clear else SWD_CLOCK_READ
+        else:
+            op = SWD_CLOCK_CALIBRATE
+        stats = swd_clock(link, op, args.max)
+
+    for name, value in stats.items():
+        logging.info(f'{name:>20}: {value:#010x}' if name == 'idcode' else f'{name:>20}: {value}')
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script lists the targets on a multi-drop SWD bus and prints how many host reselections the
+DVK Probe dropped because the target was already selected.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a multi-drop SWD target (e.g. RP2040) connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_SWD_TARGETS = 31 - 20
+
+SWD_TARGETS_FLAG_INSTANCES = 0x01
+
+# RP2040 core 0, all instances are tried with --instances
+DEFAULT_CANDIDATES = [0x01002927]
+
+
+def swd_targets(link, candidates: list, instances: bool) -> tuple:
+    flags = SWD_TARGETS_FLAG_INSTANCES if instances else 0
+    req = struct.pack(f'<BB{len(candidates)}I', flags, len(candidates), *candidates)
+    resp = link.command(VENDOR_SWD_TARGETS, req, 'SWD targets command')
+    selected, reselects, skipped, count = struct.unpack_from('<IIIB', resp)
+    found = [struct.unpack_from('<III', resp, 13 + i * 12) for i in range(count)]
+    return selected, reselects, skipped, found
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe multi-drop SWD enumeration')
+    parser.add_argument('-t', '--targetsel', type=lambda x: int(x, 0), nargs='*',
+                        default=DEFAULT_CANDIDATES, help='Candidate TARGETSEL values')
+    parser.add_argument('-i', '--instances', action='store_true',
+                        help='Try all 16 instances of each candidate')
+    parser.add_argument('-s', '--stats', action='store_true', help='Only print the counters')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    try:
+        candidates = [] if args.stats else args.targetsel
+        selected, reselects, skipped, found = swd_targets(VendorLink(probe), candidates,
+                                                          args.instances)
+    finally:
+        probe.close()
+
+    for targetsel, idcode, targetid in found:
+        logging.info(f'TARGETSEL {targetsel:#010x}: IDCODE {idcode:#010x}, '
+                     f'TARGETID {targetid:#010x}')
+    logging.info(f'Selected TARGETSEL {selected:#010x}, {reselects} reselections, '
+                 f'{skipped} dropped')
@@ -0,0 +1,190 @@
+/**
+ * @file main.c
+ * @brief Framing and cost of the uart bridge traffic tap
+ *
+ * Feeds uart_tap_put() the way the bridge receive isr does and reads the frames back from the
+ * rfpros_uart_tap virtual UART the way its bridge does. The overhead case times the framed put
+ * against a plain vuart_rx_put() of the same bursts and prints both, with the header bytes per
+ * data byte, for every burst length. native_sim time stands still while code runs, so the calls
+ * are timed with the monotonic clock of the host, through the host C library.
+ *
+ * Copyright (c) 2026 Ezurio
+ *
+ * SPDX-License-Identifier: LicenseRef-Ezurio-Clause
+ */
+
+/**************************************************************************************************/
+/* Includes                                                                                       */
+/**************************************************************************************************/
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/sys/byteorder.h>
+#include <time.h>
+#include "uart_tap.h"
+#include "vuart.h"
+
+/**************************************************************************************************/
+/* Local Constant, Macro and Type Definitions                                                     */
+/**************************************************************************************************/
+#define TAP_BUF_SIZE CONFIG_APP_UART_TAP_BUF_SIZE
+/* Passes over a full stream buffer per burst length */
+#define OVERHEAD_PASSES 200
+#define BURST_MAX       64
+
+/**************************************************************************************************/
+/* Local Data Definitions                                                                         */
+/**************************************************************************************************/
+static const struct device *const tap = DEVICE_DT_GET(DT_NODELABEL(uart_tap0));
+
+/* Received byte counts of a bridge isr, one byte is the slowest baud rates, 64 a full FIFO */
+static const size_t burst_lens[] = {1, 4, 16, 32, 64};
+
+static uint8_t burst[BURST_MAX];
+static uint8_t stream[TAP_BUF_SIZE];
+
+/**************************************************************************************************/
+/* Local Function Definitions                                                                     */
+/**************************************************************************************************/
+static size_t tap_read(void)
+{
+	size_t got = 0;
+	int n;
+
+	do {
+		n = uart_fifo_read(tap, &stream[got], sizeof(stream) - got);
+		got += MAX(n, 0);
+	} while (n > 0 && got < sizeof(stream));
+
+	return got;
+}
+
+static const uint8_t *frame_check(const uint8_t *p, uint8_t source, const uint8_t *data,
+				  size_t len)
+{
+	zassert_equal(p[0], UART_TAP_FRAME_MAGIC);
+	zassert_equal(p[1], source);
+	zassert_equal(sys_get_le16(&p[2]), len);
+	zassert_mem_equal(&p[UART_TAP_FRAME_HDR_SIZE], data, len);
+
+	return p + UART_TAP_FRAME_HDR_SIZE + len;
+}
+
+static uint64_t host_ns(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/* Host time to queue the bursts of one full stream buffer, framed or not */
+static uint64_t fill_ns(size_t len, bool framed)
+{
+	size_t frame = UART_TAP_FRAME_HDR_SIZE + len;
+	size_t bursts = TAP_BUF_SIZE / frame;
+	uint64_t total = 0;
+	uint64_t start;
+
+	for (int pass = 0; pass < OVERHEAD_PASSES; pass++) {
+		vuart_reset(tap);
+		start = host_ns();
+		for (size_t i = 0; i < bursts; i++) {
+			if (framed) {
+				uart_tap_put(tap, UART_TAP_SRC(0, 0), burst, len);
+			} else {
+				(void)vuart_rx_put(tap, burst, len);
+			}
+		}
+		total += host_ns() - start;
+	}
+
+	/* Every framed burst must have fit, a drop would skip the copy and flatter the result */
+	if (framed) {
+		zassert_equal(vuart_rx_space(tap), TAP_BUF_SIZE - bursts * frame);
+	}
+
+	return total;
+}
+
+static void *uart_tap_setup(void)
+{
+	for (size_t i = 0; i < sizeof(burst); i++) {
+		burst[i] = i * 13 + 1;
+	}
+
+	zassert_true(device_is_ready(tap));
+
+	return NULL;
+}
+
+static void uart_tap_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	vuart_reset(tap);
+}
+
+/**************************************************************************************************/
+/* Tests                                                                                          */
+/**************************************************************************************************/
+ZTEST(uart_tap, test_frames)
+{
+	const uint8_t *p = stream;
+	uint32_t t0;
+	uint32_t t1;
+
+	uart_tap_put(tap, UART_TAP_SRC(0, 1), burst, 5);
+	uart_tap_put(tap, UART_TAP_SRC(1, 0), &burst[5], 1);
+	uart_tap_put(tap, UART_TAP_SRC(1, 0), burst, 0);
+
+	zassert_equal(tap_read(), 2 * UART_TAP_FRAME_HDR_SIZE + 6);
+	t0 = sys_get_le32(&p[4]);
+	p = frame_check(p, UART_TAP_SRC(0, 1), burst, 5);
+	t1 = sys_get_le32(&p[4]);
+	(void)frame_check(p, UART_TAP_SRC(1, 0), &burst[5], 1);
+	zassert_true((int32_t)(t1 - t0) >= 0, "timestamps out of order");
+}
+
+ZTEST(uart_tap, test_drop_record)
+{
+	size_t frame = UART_TAP_FRAME_HDR_SIZE + BURST_MAX;
+	size_t fit = TAP_BUF_SIZE / frame;
+	const uint8_t *p = stream;
+
+	/* The frames that do not fit are dropped whole and reported before the next one */
+	for (size_t i = 0; i < fit + 3; i++) {
+		uart_tap_put(tap, UART_TAP_SRC(0, 0), burst, BURST_MAX);
+	}
+
+	zassert_equal(tap_read(), fit * frame);
+	uart_tap_put(tap, UART_TAP_SRC(0, 1), burst, 2);
+	zassert_equal(tap_read(), 2 * UART_TAP_FRAME_HDR_SIZE + sizeof(uint32_t) + 2);
+
+	zassert_equal(p[0], UART_TAP_FRAME_MAGIC);
+	zassert_equal(p[1], UART_TAP_SRC_DROP);
+	zassert_equal(sys_get_le16(&p[2]), sizeof(uint32_t));
+	zassert_equal(sys_get_le32(&p[UART_TAP_FRAME_HDR_SIZE]), 3 * BURST_MAX);
+	p += UART_TAP_FRAME_HDR_SIZE + sizeof(uint32_t);
+	(void)frame_check(p, UART_TAP_SRC(0, 1), burst, 2);
+}
+
+ZTEST(uart_tap, test_overhead)
+{
+	uint64_t framed;
+	uint64_t plain;
+	size_t bursts;
+
+	TC_PRINT("burst  plain ns  framed ns  extra ns  header bytes per data byte\n");
+	for (size_t i = 0; i < ARRAY_SIZE(burst_lens); i++) {
+		bursts = TAP_BUF_SIZE / (UART_TAP_FRAME_HDR_SIZE + burst_lens[i]) * OVERHEAD_PASSES;
+		plain = fill_ns(burst_lens[i], false) / bursts;
+		framed = fill_ns(burst_lens[i], true) / bursts;
+
+		TC_PRINT("%5zu  %8llu  %9llu  %8lld  %d/%zu\n", burst_lens[i],
+			 (unsigned long long)plain, (unsigned long long)framed,
+			 (long long)(framed - plain), UART_TAP_FRAME_HDR_SIZE, burst_lens[i]);
+	}
+}
+
+ZTEST_SUITE(uart_tap, NULL, uart_tap_setup, uart_tap_before, NULL, NULL);
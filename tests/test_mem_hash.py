@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+
+import argparse
+import hashlib
+import logging
+import struct
+import time
+import zlib
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This test compares the probe side memory hash vendor command with a host side digest of the
+same target memory read back through regular DAP transfers, and reports the time of both.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK with a Cortex-M target connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, ID_DAP_VENDOR_MEM_HASH = ID_DAP_VENDOR31 - 9
+VENDOR_MEM_HASH = 31 - 9
+ALGO_CRC32 = 0
+ALGO_SHA256 = 1
+
+
+def probe_hash(link, algo: int, regions: list) -> bytes:
+    request = struct.pack('<BB', algo, len(regions))
+    for addr, length in regions:
+        request += struct.pack('<II', addr, length)
+    return link.command(VENDOR_MEM_HASH, request, 'Memory hash')
+
+
+def host_hash(target, algo: int, regions: list) -> bytes:
+    crc = 0
+    sha = hashlib.sha256()
+    for addr, length in regions:
+        data = bytes(target.read_memory_block8(addr, length))
+        crc = zlib.crc32(data, crc)
+        sha.update(data)
+    return struct.pack('<I', crc) if algo == ALGO_CRC32 else sha.digest()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-d', '--debug', action='store_true',
+                        help="Enable verbose debug messages")
+    parser.add_argument('-a', '--address', type=lambda x: int(x, 0), default=0x0,
+                        help="Start address of the region to hash")
+    parser.add_argument('-s', '--size', type=lambda x: int(x, 0), default=0x10000,
+                        help="Size of the region to hash")
+    logging.basicConfig(format='%(asctime)s: %(message)s', level=logging.INFO)
+    args, unknown = parser.parse_known_args()
+    if args.debug:
+        logging.info('Debugging mode enabled')
+        logging.getLogger().setLevel(logging.DEBUG)
+
+    # Split the range in two regions to exercise the region list
+    half = (args.size // 2) & ~3
+    regions = [(args.address, half), (args.address + half, args.size - half)]
+
+    failed = False
+    with ConnectHelper.session_with_chosen_probe() as session:
+        target = session.board.target
+        link = VendorLink(session.probe)
+        for algo, name in ((ALGO_CRC32, 'CRC32'), (ALGO_SHA256, 'SHA-256')):
+            start = time.time()
+            expected = host_hash(target, algo, regions)
+            host_time = time.time() - start
+            start = time.time()
+            digest = probe_hash(link, algo, regions)
+            probe_time = time.time() - start
+            ok = digest == expected
+            failed |= not ok
+            logging.info(f'{name}: {"OK" if ok else "MISMATCH"} probe {digest.hex()} '
+                         f'({probe_time:.2f} s), host {expected.hex()} ({host_time:.2f} s)')
+
+    exit(1 if failed else 0)
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+import threading
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port
+
+"""
+This script checks the baud rate detection of a uart bridge of the DVK Probe. For each rate the
+bridge port is opened at that rate and a stream of 'U' characters is sent to the looped back
+UART while the probe times the edges on its receive pin. The detected rate must match.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+- The RP2040 side of P_UART_TXD and P_UART_RXD connected together
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_BRIDGE_AUTOBAUD = 31 - 27
+
+AUTOBAUD_APPLY = 0x01
+RATES = [9600, 19200, 38400, 57600, 74880, 115200, 230400]
+# Above the 230400 baud the edge interrupt can time, the probe must refuse to guess
+RANGE_RATES = [460800, 921600]
+DAP_VENDOR_ERR_RANGE = 11
+
+
+def autobaud(link, bridge: int, flags: int, timeout_ms: int) -> tuple:
+    resp = link.command(VENDOR_BRIDGE_AUTOBAUD, struct.pack('<BBH', bridge, flags, timeout_ms),
+                        'Autobaud')
+    return struct.unpack_from('<IIH', resp)
+
+
+def autobaud_status(link, bridge: int, timeout_ms: int) -> int:
+    resp = link.vendor(VENDOR_BRIDGE_AUTOBAUD, struct.pack('<BBH', bridge, 0, timeout_ms))
+    return struct.unpack_from('<b', resp)[0]
+
+
+def send(port: serial.Serial, stop: threading.Event):
+    while not stop.is_set():
+        port.write(b'U' * 64)
+        port.reset_input_buffer()
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe bridge baud rate detection test')
+    parser.add_argument('-i', '--index', type=int, default=0, help='Bridge index')
+    parser.add_argument('-p', '--port', help='Serial port of the bridge')
+    parser.add_argument('-r', '--rate', type=int, action='append', help='Rate to test')
+    parser.add_argument('-a', '--apply', action='store_true',
+                        help='Configure the bridge to the detected rate')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    failed = 0
+    try:
+        for rate in (args.rate or RATES) + ([] if args.rate else RANGE_RATES):
+            # The bridge applies the line coding of the host port to the UART
+            port = serial.Serial(args.port or find_port(f'USB CDC-ACM UART{args.index}'), rate,
+                                 timeout=0.05)
+            stop = threading.Event()
+            sender = threading.Thread(target=send, args=(port, stop), daemon=True)
+            sender.start()
+            status = 0
+            try:
+                if rate in RANGE_RATES:
+                    status = autobaud_status(link, args.index, 2000)
+                else:
+                    detected, measured, intervals = autobaud(link, args.index,
+                                                             AUTOBAUD_APPLY if args.apply else 0,
+                                                             2000)
+            except IOError as e:
+                detected, measured, intervals = 0, 0, 0
+                logging.error(f'{rate} baud: {e}')
+            finally:
+                stop.set()
+                sender.join()
+                port.close()
+
+            if rate in RANGE_RATES:
+                logging.info(f'{rate} baud: status {status}')
+                if status != -DAP_VENDOR_ERR_RANGE:
+                    failed += 1
+                continue
+
+            error = (measured - rate) * 100 / rate
+            logging.info(f'{rate} baud: detected {detected}, measured {measured} '
+                         f'({error:+.2f} %), {intervals} intervals')
+            if detected != rate:
+                failed += 1
+    finally:
+        probe.close()
+
+    if failed:
+        logging.error(f'{failed} rates not detected')
+        sys.exit(1)
@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import time
+import serial
+from probe_link import find_port
+
+"""
+This script checks that the DVK Probe keeps the target output received while the port was closed
+and replays it when the port is opened. Reset or power cycle the target while the port is closed,
+then run the script: the boot banner is printed without rebooting the target again.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK whose target prints a boot banner on the UART bridged to "USB CDC-ACM UART0"
+"""
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe UART history replay')
+    parser.add_argument('-p', '--port', help='Serial port of the target UART')
+    parser.add_argument('-b', '--baudrate', type=int, default=115200, help='Target baud rate')
+    parser.add_argument('-t', '--time', type=float, default=0.5,
+                        help='Seconds to read after opening the port')
+    args = parser.parse_args()
+
+    # Opening the port raises DTR, which starts the replay
+    start = time.perf_counter()
+    with serial.Serial(args.port or find_port('USB CDC-ACM UART0'), args.baudrate,
+                       timeout=0.05) as port:
+        data = b''
+        first = None
+        while time.perf_counter() - start < args.time:
+            chunk = port.read(4096)
+            if chunk and first is None:
+                first = time.perf_counter() - start
+            data += chunk
+
+    if not data:
+        logging.error('No history replayed')
+        raise SystemExit(1)
+    logging.info(f'{len(data)} bytes replayed, first after {first * 1000:.1f} ms')
+    print(data.decode('utf-8', errors='replace'))
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+import serial
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink, find_port
+
+"""
+This script checks the power-on line coding of a uart bridge of the DVK Probe. For each line
+coding the bridge port is opened with it and saved, the probe must report the same baud rate,
+data bits, parity and stop bits under the same bridge ID. The saved entry is removed at the end
+unless --keep is given.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_BRIDGE_SAVE = 31 - 30
+
+SAVE_CLEAR = 0x01
+PARITY = {serial.PARITY_NONE: 0, serial.PARITY_ODD: 1, serial.PARITY_EVEN: 2}
+STOP_BITS = {serial.STOPBITS_ONE: 1, serial.STOPBITS_TWO: 3}
+LINES = [
+    (115200, serial.EIGHTBITS, serial.PARITY_NONE, serial.STOPBITS_ONE),
+    (9600, serial.SEVENBITS, serial.PARITY_EVEN, serial.STOPBITS_ONE),
+    (57600, serial.EIGHTBITS, serial.PARITY_ODD, serial.STOPBITS_TWO),
+]
+
+
+def bridge_save(link, bridge: int, flags: int) -> tuple:
+    resp = link.command(VENDOR_BRIDGE_SAVE, struct.pack('<BB', bridge, flags), 'Bridge save')
+    return struct.unpack_from('<HIBBB', resp)
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe bridge power-on line coding test')
+    parser.add_argument('-i', '--index', type=int, default=0, help='Bridge index')
+    parser.add_argument('-p', '--port', help='Serial port of the bridge')
+    parser.add_argument('-k', '--keep', action='store_true',
+                        help='Keep the last line coding as the power-on default')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    failed = 0
+    bridge_id = None
+    try:
+        for rate, data_bits, parity, stop_bits in LINES:
+            # The bridge applies the line coding of the host port to the UART
+            port = serial.Serial(args.port or find_port(f'USB CDC-ACM UART{args.index}'), rate,
+                                 bytesize=data_bits, parity=parity, stopbits=stop_bits)
+            try:
+                saved = bridge_save(link, args.index, 0)
+            finally:
+                port.close()
+
+            expected = (rate, data_bits, PARITY[parity], STOP_BITS[stop_bits])
+            logging.info(f'bridge ID 0x{saved[0]:04x}: {saved[1]} baud, {saved[2]} data bits, '
+                         f'parity {saved[3]}, stop bits {saved[4]}')
+            if saved[1:] != expected or bridge_id not in (None, saved[0]):
+                logging.error(f'expected {expected}')
+                failed += 1
+            bridge_id = saved[0]
+
+        if not args.keep:
+            bridge_save(link, args.index, SAVE_CLEAR)
+    finally:
+        probe.close()
+
+    if failed:
+        logging.error(f'{failed} line codings not saved')
+        sys.exit(1)
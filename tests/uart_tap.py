@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import serial
+from probe_link import find_port, frames
+
+"""
+This script decodes the traffic tap of the DVK Probe while data is sent through a bridged UART,
+prints the timestamped bursts and measures the framing overhead of the tap stream. With --echo
+it writes a test pattern to the bridged port so that both directions show up on the tap.
+
+Hardware Setup
+This sample requires the following hardware:
+- A DVK Probe built with -DCONFIG_APP_UART_TAP=y
+- Optionally a loopback between TX and RX of the UART bridged to "USB CDC-ACM UART0"
+"""
+
+FRAME_MAGIC = 0x7A
+FRAME_HDR_SIZE = 8
+SRC_DROP = 0xFF
+
+
+def frame_size(buf: bytes) -> int:
+    return FRAME_HDR_SIZE + struct.unpack_from('<H', buf, 2)[0]
+
+
+def tap_frames(port: serial.Serial, duration: float):
+    for frame in frames(port, duration, FRAME_MAGIC, FRAME_HDR_SIZE, frame_size):
+        source, us = struct.unpack_from('<BxxI', frame, 1)
+        yield source, us, frame[FRAME_HDR_SIZE:]
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe UART traffic tap')
+    parser.add_argument('-p', '--port', help='Serial port of the tap')
+    parser.add_argument('-u', '--uart', help='Bridged serial port to send the test pattern on')
+    parser.add_argument('-b', '--baudrate', type=int, default=115200, help='Target baud rate')
+    parser.add_argument('-t', '--time', type=float, default=2, help='Capture time in seconds')
+    parser.add_argument('-e', '--echo', action='store_true', help='Send a test pattern')
+    parser.add_argument('-v', '--verbose', action='store_true', help='Print every burst')
+    args = parser.parse_args()
+
+    tap = serial.Serial(args.port or find_port('USB CDC-ACM tap'), timeout=0.1)
+    uart = None
+    if args.echo:
+        uart = serial.Serial(args.uart or find_port('USB CDC-ACM UART0'), args.baudrate,
+                             timeout=0)
+    tap.reset_input_buffer()
+
+    bursts = payload = dropped = 0
+    per_source = {}
+    first = last = None
+    try:
+        if uart:
+            uart.write(bytes(range(256)) * 16)
+        for source, us, data in tap_frames(tap, args.time):
+            if source == SRC_DROP:
+                lost = struct.unpack('<I', data)[0]
+                dropped += lost
+                logging.warning(f'{us:10d} us: {lost} bytes dropped by the tap')
+                continue
+            bursts += 1
+            payload += len(data)
+            per_source[source] = per_source.get(source, 0) + len(data)
+            first = us if first is None else first
+            if args.verbose:
+                delta = 0 if last is None else (us - last) & 0xFFFFFFFF
+                logging.info(f'{us:10d} us (+{delta:6d}) bridge {source >> 1} peer {source & 1}: '
+                             f'{data[:16].hex()}{"..." if len(data) > 16 else ""}')
+            last = us
+    finally:
+        tap.close()
+        if uart:
+            uart.close()
+
+    if bursts == 0:
+        logging.error('No traffic on the tap')
+        raise SystemExit(1)
+
+    for source, n in sorted(per_source.items()):
+        logging.info(f'Bridge {source >> 1} peer {source & 1}: {n} bytes')
+    overhead = bursts * FRAME_HDR_SIZE
+    logging.info(f'{bursts} bursts, {payload} bytes in {((last - first) & 0xFFFFFFFF) / 1000:.1f} '
+                 f'ms, {dropped} dropped')
+    logging.info(f'Framing overhead {overhead} bytes, {overhead * 100 / (payload + overhead):.1f} % '
+                 f'of the stream, {payload / bursts:.1f} bytes per burst')
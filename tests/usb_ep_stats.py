@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import time
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script reads the USB endpoint counters of the DVK Probe. Run it with --clear before a
+throughput test on the DAP, CDC-ACM or serial mux interfaces, then without it afterwards to see
+how often each endpoint ran out of queued transfers and how long it took to queue the next one.
+With --interval the counters are printed periodically. A firmware built without
+CONFIG_APP_USB_EP_STATS only reports the serial mux endpoints.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_USB_EP_STATS = 31 - 26
+USB_EP_STATS_CLEAR = 0x01
+
+
+def ep_stats(link, clear: bool = False) -> tuple:
+    """Return the mux queue depth, the mux OUT and IN counters and the counters per endpoint."""
+    resp = link.command(VENDOR_USB_EP_STATS, [USB_EP_STATS_CLEAR if clear else 0],
+                        'Endpoint stats')
+    mux = [struct.unpack_from('<4I', resp, 1 + i * 16) for i in range(2)]
+    count = resp[33]
+    eps = {}
+    for i in range(count):
+        ep, *counters = struct.unpack_from('<B4I', resp, 34 + i * 17)
+        eps[ep] = counters
+    return resp[0], mux, eps
+
+
+def log_stats(depth: int, mux: list, eps: dict):
+    if depth:
+        for name, (transfers, naks, rearm_avg, rearm_max) in zip(['OUT', 'IN'], mux):
+            logging.info(f"mux {name}: {depth} queued, {transfers} transfers, {naks} NAK windows, "
+                         f"re-arm {rearm_avg} us avg {rearm_max} us max")
+    for ep, (transfers, empty, rearm_avg, rearm_max) in sorted(eps.items()):
+        logging.info(f"ep 0x{ep:02x}: {transfers} transfers, {empty} empty windows, "
+                     f"re-arm {rearm_avg} us avg {rearm_max} us max")
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe USB endpoint counters')
+    parser.add_argument('-c', '--clear', action='store_true', help='Clear the counters')
+    parser.add_argument('-i', '--interval', type=float, help='Print every INTERVAL seconds')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    try:
+        link = VendorLink(probe)
+        while True:
+            log_stats(*ep_stats(link, args.clear))
+            if not args.interval:
+                break
+            time.sleep(args.interval)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        probe.close()
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+
+import struct
+import threading
+import usb.core
+import usb.util
+
+"""
+Host side of the DVK Probe serial mux vendor interface (firmware built with CONFIG_APP_USBD_MUX).
+All bridge channels share one bulk OUT and one bulk IN endpoint, see include/usbd_mux.h for the
+framing and the credit based flow control.
+"""
+
+MUX_INTERFACE_STRING = 'DVK Probe Serial Mux'
+MUX_TRANSFER_SIZE = 512
+MUX_FRAME_MAX_PAYLOAD = 255
+MUX_CTRL_FLAG = 0x80
+MUX_CHANNEL_MASK = 0x7F
+
+MUX_CTRL_NOP = 0x00
+MUX_CTRL_CREDIT = 0x01
+MUX_CTRL_LINE_CODING = 0x02
+MUX_CTRL_OPEN = 0x03
+
+# Receive buffer the host grants to each channel
+HOST_RX_CREDIT = 16384
+
+
+class MuxChannel:
+    def __init__(self, mux, channel: int):
+        self.mux = mux
+        self.channel = channel
+        self.tx_credit = 0
+        self.rx_data = bytearray()
+        self.cond = threading.Condition(mux.lock)
+
+    def open(self, baud: int = 115200):
+        self.mux._send_ctrl(self.channel, bytes([MUX_CTRL_OPEN]))
+        with self.mux.lock:
+            self.tx_credit = 0
+            self.rx_data.clear()
+        self.set_line_coding(baud)
+        self.mux._send_ctrl(self.channel, struct.pack('<BH', MUX_CTRL_CREDIT, HOST_RX_CREDIT))
+
+    def set_line_coding(self, baud: int, parity: int = 0, stop_bits: int = 1, data_bits: int = 3,
+                        flow_ctrl: int = 0):
+        self.mux._send_ctrl(self.channel, struct.pack('<BIBBBB', MUX_CTRL_LINE_CODING, baud,
+                                                      parity, stop_bits, data_bits, flow_ctrl))
+
+    def send(self, data: bytes, timeout: float = 5.0):
+        """Send data, blocking until the device granted enough credit"""
+        view = memoryview(data)
+        while len(view) > 0:
+            with self.cond:
+                if not self.cond.wait_for(lambda: self.tx_credit > 0, timeout):
+                    raise TimeoutError(f'ch{self.channel}: no credit from the device')
+                n = min(len(view), self.tx_credit)
+                self.tx_credit -= n
+            self.mux._send_data(self.channel, view[:n])
+            view = view[n:]
+
+    def read(self) -> bytes:
+        with self.cond:
+            data = bytes(self.rx_data)
+            self.rx_data.clear()
+        if len(data) > 0:
+            self.mux._send_ctrl(self.channel, struct.pack('<BH', MUX_CTRL_CREDIT, len(data)))
+        return data
+
+
+class UsbMux:
+    def __init__(self, serial_number: str = None):
+        self.dev = None
+        for dev in usb.core.find(find_all=True, idVendor=0x3016, idProduct=0x0008):
+            if serial_number is None or dev.serial_number == serial_number:
+                self.dev = dev
+                break
+        if self.dev is None:
+            raise IOError('DVK Probe not found')
+
+        self.intf = None
+        for intf in self.dev.get_active_configuration():
+            if intf.iInterface and \
+                    usb.util.get_string(self.dev, intf.iInterface) == MUX_INTERFACE_STRING:
+                self.intf = intf
+                break
+        if self.intf is None:
+            raise IOError('Serial mux interface not found, was the firmware built with it?')
+
+        self.ep_out = usb.util.find_descriptor(self.intf, custom_match=lambda e:
+                                               usb.util.endpoint_direction(e.bEndpointAddress) ==
+                                               usb.util.ENDPOINT_OUT)
+        self.ep_in = usb.util.find_descriptor(self.intf, custom_match=lambda e:
+                                              usb.util.endpoint_direction(e.bEndpointAddress) ==
+                                              usb.util.ENDPOINT_IN)
+        usb.util.claim_interface(self.dev, self.intf)
+        self.lock = threading.Lock()
+        self.out_lock = threading.Lock()
+        self.channels = {}
+        self.running = True
+        self.rx_thread = threading.Thread(target=self.__rx_thread, daemon=True)
+        self.rx_thread.start()
+
+    def close(self):
+        self.running = False
+        self.rx_thread.join()
+        usb.util.release_interface(self.dev, self.intf)
+        usb.util.dispose_resources(self.dev)
+
+    def channel(self, channel: int) -> MuxChannel:
+        if channel not in self.channels:
+            self.channels[channel] = MuxChannel(self, channel)
+        return self.channels[channel]
+
+    def _write(self, transfer: bytes):
+        mps = self.ep_out.wMaxPacketSize
+        if len(transfer) % mps == 0 and len(transfer) < MUX_TRANSFER_SIZE:
+            transfer += bytes([MUX_CTRL_FLAG, 1, MUX_CTRL_NOP])
+        with self.out_lock:
+            self.ep_out.write(transfer)
+
+    def _send_ctrl(self, channel: int, payload: bytes):
+        self._write(bytes([MUX_CTRL_FLAG | channel, len(payload)]) + payload)
+
+    def _send_data(self, channel: int, data: bytes):
+        transfer = bytearray()
+        view = memoryview(data)
+        while len(view) > 0:
+            n = min(len(view), MUX_FRAME_MAX_PAYLOAD,
+                    MUX_TRANSFER_SIZE - len(transfer) - 2)
+            if n <= 0:
+                self._write(bytes(transfer))
+                transfer.clear()
+                continue
+            transfer += bytes([channel, n]) + view[:n]
+            view = view[n:]
+        if len(transfer) > 0:
+            self._write(bytes(transfer))
+
+    def __rx_thread(self):
+        while self.running:
+            try:
+                transfer = bytes(self.ep_in.read(MUX_TRANSFER_SIZE, timeout=100))
+            except usb.core.USBTimeoutError:
+                continue
+            pos = 0
+            while pos + 2 <= len(transfer):
+                is_ctrl = transfer[pos] & MUX_CTRL_FLAG
+                channel = transfer[pos] & MUX_CHANNEL_MASK
+                length = transfer[pos + 1]
+                payload = transfer[pos + 2:pos + 2 + length]
+                pos += 2 + length
+                ch = self.channel(channel)
+                with ch.cond:
+                    if is_ctrl:
+                        if length >= 3 and payload[0] == MUX_CTRL_CREDIT:
+                            ch.tx_credit += struct.unpack_from('<H', payload, 1)[0]
+                    else:
+                        ch.rx_data.extend(payload)
+                    ch.cond.notify_all()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+
+import argparse
+import logging
+import struct
+import sys
+from pyocd.core.helpers import ConnectHelper
+from probe_link import VendorLink
+
+"""
+This script reads the vendor command capabilities of the DVK Probe and prints the supported
+commands, their limits and the buffer sizes. With --check it also sends every command that is
+not advertised and expects the probe to reject it, which only probes IDs known to be unused.
+
+Hardware Setup
+This sample requires the following hardware:
+- Any DVK connected to PC via USB
+"""
+
+# CMSIS-DAP vendor command index, see dap_vendor.h
+VENDOR_CAPABILITIES = 31 - 28
+
+COMMANDS = {
+    31: 'SET_IO_DIR', 30: 'SET_IO', 29: 'READ_IO', 26: 'REBOOT', 25: 'READ_SETTINGS',
+    24: 'WRITE_SETTINGS', 23: 'BRIDGE_STATS', 22: 'MEM_HASH', 21: 'IMAGE_WRITE',
+    20: 'IMAGE_COMMIT', 19: 'IMAGE_PROGRAM', 18: 'TARGET_MONITOR', 17: 'TARGET_EVENT',
+    16: 'PC_SAMPLER', 15: 'SWD_CLOCK', 14: 'JTAG_CONNECT', 13: 'JTAG_SEQUENCE', 12: 'JTAG_IDCODE',
+    11: 'SWD_TARGETS', 10: 'IO_BUS_CONFIG', 9: 'IO_BUS_BATCH', 8: 'ADC_CAPTURE',
+    7: 'BOOT_PROFILE', 6: 'BRIDGE_PRBS', 5: 'USB_EP_STATS', 4: 'BRIDGE_AUTOBAUD',
+    3: 'CAPABILITIES', 2: 'RTT_CONTROL', 1: 'BRIDGE_SAVE',
+}
+VENDOR0 = 0x80
+
+
+def capabilities(link) -> tuple:
+    resp = link.command(VENDOR_CAPABILITIES, what='Capabilities')
+    supported, packet_size, bridge_buf, count = struct.unpack_from('<IHHB', resp)
+    limits = {}
+    for i in range(count):
+        cmd, limit = struct.unpack_from('<BH', resp, 9 + 3 * i)
+        limits[cmd - VENDOR0] = limit
+    return supported, packet_size, bridge_buf, limits
+
+
+if __name__ == '__main__':
+    logging.basicConfig(format='%(asctime)s [%(levelname)s] %(message)s', level=logging.INFO)
+    parser = argparse.ArgumentParser(description='DVK Probe vendor command capabilities')
+    parser.add_argument('-c', '--check', action='store_true',
+                        help='Check that commands not advertised are rejected')
+    args = parser.parse_args()
+
+    probe = ConnectHelper.choose_probe()
+    probe.open()
+    link = VendorLink(probe)
+    failed = 0
+    try:
+        supported, packet_size, bridge_buf, limits = capabilities(link)
+        logging.info(f'DAP packet size {packet_size}, smallest bridge buffer {bridge_buf} bytes')
+        for index in sorted(COMMANDS, reverse=True):
+            if supported & (1 << index):
+                limit = f', limit {limits[index]}' if index in limits else ''
+                logging.info(f'  {COMMANDS[index]}{limit}')
+        if not supported & (1 << VENDOR_CAPABILITIES):
+            logging.error('Capabilities command not advertised')
+            failed += 1
+
+        for index in range(32) if args.check else []:
+            if supported & (1 << index):
+                continue
+            try:
+                link.vendor(index)
+                logging.error(f'Vendor command {index} accepted but not advertised')
+                failed += 1
+            except Exception:
+                pass
+    finally:
+        probe.close()
+
+    if failed:
+        sys.exit(1)